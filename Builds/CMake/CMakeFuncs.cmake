@@ -154,6 +154,8 @@ macro(setup_build_cache)
     instrumentation")
   set_property(CACHE san PROPERTY STRINGS ";address;thread")
   set(assert false CACHE BOOL "Enables asserts, even in release builds")
+  set(profile_locks false CACHE BOOL
+    "Record contention and hold times of the busiest locks")
   set(static false CACHE BOOL
     "On linux, link protobuf, openssl, libc++, and boost statically")
 
@@ -555,6 +557,10 @@ macro(setup_build_boilerplate)
     STRING(REGEX REPLACE "[-/]DNDEBUG" "" CMAKE_C_FLAGS_RELEASECLASSIC "${CMAKE_C_FLAGS_RELEASECLASSIC}")
   endif()
 
+  if (profile_locks)
+    add_definitions(-DCASINOCOIN_PROFILE_LOCKS=1)
+  endif()
+
   if (NOT WIN32)
     add_definitions(-D_FILE_OFFSET_BITS=64)
     append_flags(CMAKE_CXX_FLAGS -frtti -std=c++14 -Wno-invalid-offsetof
@@ -163,6 +163,15 @@
 #define CASINOCOIN_SINGLE_IO_SERVICE_THREAD 0
 #endif
 
+/** Config: CASINOCOIN_PROFILE_LOCKS
+    When set, the busiest locks record how often they were contended and
+    how long they were waited for and held. The totals are reported by the
+    get_counts command. Adds a few clock reads to every lock and unlock.
+*/
+#ifndef CASINOCOIN_PROFILE_LOCKS
+#define CASINOCOIN_PROFILE_LOCKS 0
+#endif
+
 // Uses OpenSSL instead of alternatives
 #ifndef CASINOCOIN_USE_OPENSSL
 #define CASINOCOIN_USE_OPENSSL 1
@@ -30,6 +30,7 @@
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/app/ledger/LocalTxs.h>
 #include <casinocoin/app/ledger/OpenLedger.h>
+#include <casinocoin/app/main/CollectorManager.h>
 #include <casinocoin/app/misc/AmendmentTable.h>
 #include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
@@ -62,6 +63,10 @@ CCLConsensus::CCLConsensus(
     , localTxs_(localTxs)
     , inboundTransactions_{inboundTransactions}
     , j_(journal)
+    , roundTime_(app.getCollectorManager().collector()->
+        make_event("consensus", "round"))
+    , buildTime_(app.getCollectorManager().collector()->
+        make_event("consensus", "build_ledger"))
     , nodeID_{calcNodeID(app.nodeIdentity().first)}
 {
 }
@@ -361,7 +366,7 @@ CCLConsensus::onForceAccept(
     CloseTimes const& rawCloseTimes,
     Mode const& mode)
 {
-    doAccept(result, prevLedger, closeResolution, rawCloseTimes, mode);
+    doAccept(result, prevLedger, closeResolution, rawCloseTimes, mode, true);
 }
 
 void
@@ -378,7 +383,8 @@ CCLConsensus::onAccept(
             // is fine since once a ledger is accepted, consensus
             // will not touch any internal state until startRound is called
             that->doAccept(
-                result, prevLedger, closeResolution, rawCloseTimes, mode);
+                result, prevLedger, closeResolution, rawCloseTimes, mode,
+                false);
             that->app_.getOPs().endConsensus();
         });
 }
@@ -389,7 +395,8 @@ CCLConsensus::doAccept(
     CCLCxLedger const& prevLedger,
     NetClock::duration closeResolution,
     CloseTimes const& rawCloseTimes,
-    Mode const& mode)
+    Mode const& mode,
+    bool synchronous)
 {
     bool closeTimeCorrect;
 
@@ -423,7 +430,9 @@ CCLConsensus::doAccept(
     //--------------------------------------------------------------------------
     // Put transactions into a deterministic, but unpredictable, order
     CanonicalTXSet retriableTxs{result.set.id()};
+    NodeStore::Batch dirty;
 
+    auto const buildStart = std::chrono::steady_clock::now();
     auto sharedLCL = buildLCL(
         prevLedger,
         result.set,
@@ -431,15 +440,15 @@ CCLConsensus::doAccept(
         closeTimeCorrect,
         closeResolution,
         result.roundTime.read(),
-        retriableTxs);
+        retriableTxs,
+        dirty);
+    roundTime_.notify(result.roundTime.read());
+    buildTime_.notify(std::chrono::steady_clock::now() - buildStart);
 
     auto const newLCLHash = sharedLCL.id();
     JLOG(j_.debug()) << "Report: NewL  = " << newLCLHash << ":"
                      << sharedLCL.seq();
 
-    // Tell directly connected peers that we have a new LCL
-    notify(protocol::neACCEPTED_LEDGER, sharedLCL, haveCorrectLCL);
-
     if (validating_)
         validating_ = ledgerMaster_.isCompatible(
             *sharedLCL.ledger_,
@@ -454,8 +463,26 @@ CCLConsensus::doAccept(
     else
         JLOG(j_.info()) << "CNF buildLCL " << newLCLHash;
 
-    // See if we can accept a ledger as fully-validated
-    ledgerMaster_.consensusBuilt(sharedLCL.ledger_, getJson(true));
+    // The nodes are already shared through the tree node cache, so the
+    // next round can start while they are written. The ledger master
+    // and our peers only hear about the ledger once they are stored.
+    // Store jobs run one at a time, so ledgers are stored in order.
+    {
+        auto store = [
+            that = this->shared_from_this(),
+            sharedLCL,
+            dirty = std::move(dirty),
+            haveCorrectLCL,
+            consensus = getJson(true)]() {
+            that->storeLCL(sharedLCL, dirty, haveCorrectLCL, consensus);
+        };
+        ledgerMaster_.pendStore(newLCLHash);
+        if (synchronous)
+            store();
+        else
+            app_.getJobQueue().addJob(jtSTORE_LEDGER, "storeLedger",
+                [store = std::move(store)](Job&) { store(); });
+    }
 
     //-------------------------------------------------------------------------
     {
@@ -534,7 +561,10 @@ CCLConsensus::doAccept(
 
     //-------------------------------------------------------------------------
     {
-        ledgerMaster_.switchLCL(sharedLCL.ledger_);
+        // The next round builds on the new last closed ledger, so set it
+        // now. The ledger master won't accept it as validated until
+        // storeLCL has written its nodes.
+        ledgerMaster_.setLCL(sharedLCL.ledger_);
 
         // Do these need to exist?
         assert(ledgerMaster_.getClosedLedger()->info().hash == sharedLCL.id());
@@ -584,6 +614,33 @@ CCLConsensus::doAccept(
     }
 }
 
+void
+CCLConsensus::storeLCL(
+    CCLCxLedger const& ledger,
+    NodeStore::Batch const& nodes,
+    bool haveCorrectLCL,
+    Json::Value const& consensus)
+{
+    auto& db = app_.family().db();
+    for (auto const& object : nodes)
+        db.store(object->getType(), Blob(object->getData()), object->getHash());
+
+    // And stash the ledger in the ledger master
+    if (ledgerMaster_.storeLedger(ledger.ledger_))
+        JLOG(j_.debug()) << "Consensus built ledger we already had";
+    else if (app_.getInboundLedgers().find(ledger.id()))
+        JLOG(j_.debug()) << "Consensus built ledger we were acquiring";
+    else
+        JLOG(j_.debug()) << "Consensus built new ledger";
+
+    // Tell directly connected peers that we have a new LCL
+    notify(protocol::neACCEPTED_LEDGER, ledger, haveCorrectLCL);
+
+    // See if we can accept a ledger as fully-validated
+    ledgerMaster_.acceptLCL(ledger.ledger_);
+    ledgerMaster_.consensusBuilt(ledger.ledger_, consensus);
+}
+
 void
 CCLConsensus::notify(
     protocol::NodeEvent ne,
@@ -728,7 +785,8 @@ CCLConsensus::buildLCL(
     bool closeTimeCorrect,
     NetClock::duration closeResolution,
     std::chrono::milliseconds roundTime,
-    CanonicalTXSet& retriableTxs)
+    CanonicalTXSet& retriableTxs,
+    NodeStore::Batch& dirty)
 {
     auto replay = ledgerMaster_.releaseReplay();
     if (replay)
@@ -790,13 +848,13 @@ CCLConsensus::buildLCL(
     buildLCL->updateSkipList();
 
     {
-        // Write the final version of all modified SHAMap
-        // nodes to the node store to preserve the new LCL
+        // Collect the final version of all modified SHAMap
+        // nodes so the caller can preserve the new LCL
 
         int asf = buildLCL->stateMap().flushDirty(
-            hotACCOUNT_NODE, buildLCL->info().seq);
+            hotACCOUNT_NODE, buildLCL->info().seq, dirty);
         int tmf = buildLCL->txMap().flushDirty(
-            hotTRANSACTION_NODE, buildLCL->info().seq);
+            hotTRANSACTION_NODE, buildLCL->info().seq, dirty);
         JLOG(j_.debug()) << "Flushed " << asf << " accounts and " << tmf
                          << " transaction nodes";
     }
@@ -805,14 +863,6 @@ CCLConsensus::buildLCL(
     // Accept ledger
     buildLCL->setAccepted(
         closeTime, closeResolution, closeTimeCorrect, app_.config());
-
-    // And stash the ledger in the ledger master
-    if (ledgerMaster_.storeLedger(buildLCL))
-        JLOG(j_.debug()) << "Consensus built ledger we already had";
-    else if (app_.getInboundLedgers().find(buildLCL->info().hash))
-        JLOG(j_.debug()) << "Consensus built ledger we were acquiring";
-    else
-        JLOG(j_.debug()) << "Consensus built new ledger";
     return CCLCxLedger{std::move(buildLCL)};
 }
 
@@ -33,6 +33,7 @@
 #include <casinocoin/app/misc/FeeVote.h>
 #include <casinocoin/basics/CountedObject.h>
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/beast/insight/Event.h>
 #include <casinocoin/beast/utility/Journal.h>
 #include <casinocoin/consensus/Consensus.h>
 #include <casinocoin/core/JobQueue.h>
@@ -317,7 +318,14 @@ private:
 
     /** Accept a new ledger based on the given transactions.
 
+        Builds and validates the new last closed ledger and the open
+        ledger which follows it. Unless synchronous is set, the new
+        ledger's nodes are stored by a job which may overlap the next
+        round; see storeLCL. Store jobs run one at a time, in the order
+        the ledgers were built.
+
         @ref onAccept
+        @param synchronous Store the new ledger before returning
      */
     void
     doAccept(
@@ -325,7 +333,24 @@ private:
         CCLCxLedger const& prevLedger,
         NetClock::duration closeResolution,
         CloseTimes const& rawCloseTimes,
-        Mode const& mode);
+        Mode const& mode,
+        bool synchronous);
+
+    /** Write the nodes of a ledger built by doAccept to the node store,
+        then stash the ledger in the ledger master, tell peers about it
+        and see if it can be accepted as fully validated.
+
+        @param ledger The newly built last closed ledger
+        @param nodes The ledger's dirty nodes from buildLCL
+        @param haveCorrectLCL Whether we believe we have the correct LCL
+        @param consensus State of the round which built the ledger
+    */
+    void
+    storeLCL(
+        CCLCxLedger const& ledger,
+        NodeStore::Batch const& nodes,
+        bool haveCorrectLCL,
+        Json::Value const& consensus);
 
     /** Build the new last closed ledger.
 
@@ -342,6 +367,8 @@ private:
         @param closeResolution Resolution used to determine consensus close time
         @param roundTime Duration of this consensus rorund
         @param retriableTxs Populate with transactions to retry in next round
+        @param dirty Populate with the new ledger's nodes, which the caller
+                     must store
         @return The newly built ledger
   */
     CCLCxLedger
@@ -352,7 +379,8 @@ private:
         bool closeTimeCorrect,
         NetClock::duration closeResolution,
         std::chrono::milliseconds roundTime,
-        CanonicalTXSet& retriableTxs);
+        CanonicalTXSet& retriableTxs,
+        NodeStore::Batch& dirty);
 
     /** Validate the given ledger and share with peers as necessary
 
@@ -374,6 +402,11 @@ private:
     InboundTransactions& inboundTransactions_;
     beast::Journal j_;
 
+    // How long rounds take from close to accept, and
+    // how long building the new last closed ledger takes
+    beast::insight::Event roundTime_;
+    beast::insight::Event buildTime_;
+
     NodeID nodeID_;
     PublicKey valPublic_;
     SecretKey valSecret_;
@@ -30,6 +30,7 @@
 #include <casinocoin/app/ledger/Ledger.h>
 #include <casinocoin/overlay/PeerSet.h>
 #include <casinocoin/basics/CountedObject.h>
+#include <casinocoin/basics/ProfiledMutex.h>
 #include <mutex>
 #include <set>
 #include <utility>
@@ -81,8 +82,12 @@ public:
         return mSeq;
     }
 
+    // Held on the InboundLedgers collection while the ledger is added
+    using CollectionLockType =
+        std::unique_lock <ProfiledMutex <std::recursive_mutex>>;
+
     bool checkLocal ();
-    void init (ScopedLockType& collectionLock);
+    void init (CollectionLockType& collectionLock);
 
     bool gotData (std::weak_ptr<Peer>, std::shared_ptr<protocol::TMLedgerData>);
 
@@ -94,6 +99,13 @@ public:
 
     void runData ();
 
+    /** Parse a stored or received ledger header. */
+    static
+    LedgerInfo
+    deserializeHeader (
+        Slice data,
+        bool hasPrefix);
+
 private:
     enum class TriggerReason
     {
@@ -127,6 +139,14 @@ private:
 
     std::weak_ptr <PeerSet> pmDowncast () override;
 
+    // Filling in history must not hold up the reads
+    // of ledgers we need to stay in sync
+    NodeStore::FetchPriority readPriority () const
+    {
+        return (mReason == fcHISTORY) ?
+            NodeStore::FetchPriority::low : NodeStore::FetchPriority::high;
+    }
+
     int processData (std::shared_ptr<Peer> peer, protocol::TMLedgerData& data);
 
     bool takeHeader (std::string const& data);
@@ -152,11 +172,6 @@ private:
     neededStateHashes (
         int max, SHAMapSyncFilter* filter) const;
 
-    LedgerInfo
-    deserializeHeader (
-        Slice data,
-        bool hasPrefix);
-
 private:
     std::shared_ptr<Ledger> mLedger;
     bool               mHaveHeader;
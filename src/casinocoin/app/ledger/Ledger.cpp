@@ -664,7 +664,7 @@ Ledger::peek (Keylet const& k) const
 }
 
 //------------------------------------------------------------------------------
-bool Ledger::walkLedger (beast::Journal j) const
+bool Ledger::walkLedger (beast::Journal j, int threads) const
 {
     std::vector <SHAMapMissingNode> missingNodes1;
     std::vector <SHAMapMissingNode> missingNodes2;
@@ -677,7 +677,7 @@ bool Ledger::walkLedger (beast::Journal j) const
     }
     else
     {
-        stateMap_->walkMap (missingNodes1, 32);
+        stateMap_->walkMap (missingNodes1, 32, threads);
     }
 
     if (!missingNodes1.empty ())
@@ -697,7 +697,7 @@ bool Ledger::walkLedger (beast::Journal j) const
     }
     else
     {
-        txMap_->walkMap (missingNodes2, 32);
+        txMap_->walkMap (missingNodes2, 32, threads);
     }
 
     if (!missingNodes2.empty ())
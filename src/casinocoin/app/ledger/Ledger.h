@@ -312,7 +312,10 @@ public:
 
     void updateSkipList ();
 
-    bool walkLedger (beast::Journal j) const;
+    /** Check that every node of the ledger's maps is available.
+        Each map is walked by `threads` threads.
+    */
+    bool walkLedger (beast::Journal j, int threads = 1) const;
 
     bool assertSane (beast::Journal ledgerJ) const;
 
@@ -52,9 +52,9 @@ LedgerHistory::LedgerHistory (
     , collector_ (collector)
     , mismatch_counter_ (collector->make_counter ("ledger.history", "mismatch"))
     , m_ledgers_by_hash ("LedgerCache", CACHED_LEDGER_NUM, CACHED_LEDGER_AGE,
-        stopwatch(), app_.journal("TaggedCache"))
+        stopwatch(), app_.journal("TaggedCache"), collector)
     , m_consensus_validated ("ConsensusValidated", 64, 300,
-        stopwatch(), app_.journal("TaggedCache"))
+        stopwatch(), app_.journal("TaggedCache"), collector)
     , j_ (app.journal ("LedgerHistory"))
 {
 }
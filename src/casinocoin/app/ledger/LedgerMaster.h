@@ -34,9 +34,11 @@
 #include <casinocoin/app/ledger/LedgerHolder.h>
 #include <casinocoin/app/misc/CanonicalTXSet.h>
 #include <casinocoin/basics/chrono.h>
+#include <casinocoin/basics/ProfiledMutex.h>
 #include <casinocoin/basics/RangeSet.h>
 #include <casinocoin/basics/ScopedLock.h>
 #include <casinocoin/basics/StringUtilities.h>
+#include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/protocol/CasinocoinLedgerHash.h>
 #include <casinocoin/protocol/STValidation.h>
 #include <casinocoin/beast/insight/Collector.h>
@@ -71,6 +73,8 @@ class LedgerMaster
     , public AbstractFetchPackContainer
 {
 public:
+    using mutex_type = ProfiledMutex <std::recursive_mutex>;
+
     explicit
     LedgerMaster(Application& app, Stopwatch& stopwatch,
         Stoppable& parent,
@@ -87,7 +91,7 @@ public:
         beast::Journal::Stream,
         char const* reason);
 
-    std::recursive_mutex& peekMutex ();
+    mutex_type& peekMutex ();
 
     // The current ledger is the ledger we believe new transactions should go in
     std::shared_ptr<ReadView const>
@@ -129,6 +133,22 @@ public:
 
     void switchLCL (std::shared_ptr<Ledger const> const& lastClosed);
 
+    /** The two halves of switchLCL.
+
+        setLCL makes the ledger the last closed ledger. acceptLCL sees
+        if it can be accepted as validated, which may save and publish
+        it, so its nodes must already be in the node store.
+    */
+    void setLCL (std::shared_ptr<Ledger const> const& lastClosed);
+    void acceptLCL (std::shared_ptr<Ledger const> const& lastClosed);
+
+    /** Note that a ledger's nodes are still being stored.
+
+        checkAccept leaves the ledger alone until acceptLCL is
+        called for it.
+    */
+    void pendStore (uint256 const& hash);
+
     void failedSave(std::uint32_t seq, uint256 const& hash);
 
     std::string getCompleteLedgers ();
@@ -258,7 +278,15 @@ private:
         std::shared_ptr<Ledger const> ledger);
 
     void getFetchPack(LedgerHash missingHash, LedgerIndex missingIndex);
+    // Acquire the next ledger wanted by the history shard store
+    void fetchForHistoryShard(NodeStore::DatabaseShard& shards);
+    void storeShardLedger(std::shared_ptr<Ledger const> const& ledger);
     boost::optional<LedgerHash> getLedgerHashForHistory(LedgerIndex index);
+    // Load a ledger older than the node store keeps from the
+    // history shards, if they have it
+    std::shared_ptr<Ledger const> getLedgerFromShards(std::uint32_t index);
+    std::shared_ptr<Ledger const> loadFromShards(
+        std::uint32_t index, LedgerHash const& hash);
     std::size_t getNeededValidations();
     void advanceThread();
     // Try to publish ledgers, acquire missing ledgers
@@ -277,17 +305,20 @@ private:
     void newPFWork(const char *name);
 
 private:
-    using ScopedLockType = std::lock_guard <std::recursive_mutex>;
-    using ScopedUnlockType = GenericScopedUnlock <std::recursive_mutex>;
+    using ScopedLockType = std::lock_guard <mutex_type>;
+    using ScopedUnlockType = GenericScopedUnlock <mutex_type>;
 
     Application& app_;
     beast::Journal m_journal;
 
-    std::recursive_mutex mutable m_mutex;
+    mutex_type mutable m_mutex {"LedgerMaster::m_mutex"};
 
     // The ledger that most recently closed.
     LedgerHolder mClosedLedger;
 
+    // Closed ledgers whose nodes aren't stored yet.
+    hash_set<uint256> mPendingStores;
+
     // The highest-sequence ledger we have fully accepted.
     LedgerHolder mValidLedger;
 
@@ -310,7 +341,7 @@ private:
     // A set of transactions to replay during the next close
     std::unique_ptr<LedgerReplay> replayData;
 
-    std::recursive_mutex mCompleteLock;
+    mutex_type mCompleteLock {"LedgerMaster::mCompleteLock"};
     RangeSet mCompleteLedgers;
 
     std::unique_ptr <detail::LedgerCleaner> mLedgerCleaner;
@@ -349,6 +380,17 @@ private:
 
     std::uint32_t fetch_seq_;
 
+    // A ledger is being stored in the history shard store
+    std::atomic <bool> mShardFillInProgress {false};
+
+    // The last ledger stored in the history shard store
+    std::shared_ptr<Ledger const> mShardLedger;
+
+    // How many times acquiring a ledger for the history shard store
+    // failed, and which one. The shard is abandoned after too many.
+    std::uint32_t mShardFailedSeq = 0;
+    int mShardFailures = 0;
+    bool mShardFailureCounted = false;
 };
 
 } // casinocoin
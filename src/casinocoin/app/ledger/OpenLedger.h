@@ -48,9 +48,26 @@ using OrderedTxs = CanonicalTXSet;
 /** Represents the open ledger. */
 class OpenLedger
 {
+public:
+    /** Open ledger tuning parameters. */
+    struct Setup
+    {
+        /** Carry unaffected transactions forward in `accept`.
+
+            When set, transactions in the current open view
+            whose effects are limited to the accounts they name,
+            and which share no accounts with the newly closed
+            ledger, are applied to the new open view without
+            repeating the signature authorization and transaction
+            specific `preclaim` checks.
+        */
+        bool incremental = false;
+    };
+
 private:
     beast::Journal j_;
     CachedSLEs& cache_;
+    Setup const setup_;
     std::mutex mutable modify_mutex_;
     std::mutex mutable current_mutex_;
     std::shared_ptr<OpenView const> current_;
@@ -77,12 +94,13 @@ public:
     /** Create a new open ledger object.
 
         @param ledger A closed ledger
+        @param setup Tuning parameters
     */
-    explicit
     OpenLedger(std::shared_ptr<
         Ledger const> const& ledger,
             CachedSLEs& cache,
-                beast::Journal journal);
+                beast::Journal journal,
+                    Setup const& setup);
 
     /** Returns `true` if there are no transactions.
 
@@ -139,7 +157,10 @@ public:
             depending on the value of `retriesFirst`.
 
             The transactions in the current open view
-            are applied to the new open view.
+            are applied to the new open view. In
+            incremental mode, those not affected by the
+            accepted ledger are carried forward without
+            repeating most of their validity checks.
 
             The list of local transactions are applied
             to the new open view.
@@ -192,6 +213,11 @@ private:
     create (Rules const& rules,
         std::shared_ptr<Ledger const> const& ledger);
 
+    void
+    carry (Application& app, OpenView& view,
+        ReadView const& ledger, OrderedTxs& retries,
+            ApplyFlags flags);
+
     static
     Result
     apply_one (Application& app, OpenView& view,
@@ -267,6 +293,11 @@ OpenLedger::apply (Application& app, OpenView& view,
 
 //------------------------------------------------------------------------------
 
+OpenLedger::Setup
+setup_OpenLedger (Config const& config);
+
+//------------------------------------------------------------------------------
+
 // For debug logging
 
 std::string
@@ -16,7 +16,6 @@
     OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 */
 //==============================================================================
-
 //==============================================================================
 /*
     2017-06-26  ajochems        Refactored for casinocoin
@@ -27,24 +26,64 @@
 #include <casinocoin/app/ledger/OrderBookDB.h>
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/app/main/Application.h>
+#include <casinocoin/basics/contract.h>
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/Slice.h>
 #include <casinocoin/core/Config.h>
 #include <casinocoin/core/JobQueue.h>
+#include <casinocoin/protocol/digest.h>
 #include <casinocoin/protocol/Indexes.h>
+#include <casinocoin/protocol/Serializer.h>
+#include <boost/filesystem/fstream.hpp>
+#include <algorithm>
 
 namespace casinocoin {
 
+namespace {
+
+// Beyond this many ledgers behind, scanning the state map is
+// cheaper than loading every ledger in between.
+std::uint32_t const maxCatchUp = 256;
+
+// How often, in ledgers, the books are saved to disk
+std::uint32_t const snapshotInterval = 256;
+
+std::uint32_t const snapshotVersion = 1;
+
+// The book served by the root of a quality directory
+Book
+bookFromDirectory (STObject const& dir)
+{
+    // The metadata of a created entry leaves out
+    // the fields that have their default value.
+    auto field = [&dir](SF_U160 const& f)
+    {
+        return dir.isFieldPresent (f) ? dir.getFieldH160 (f) : uint160 ();
+    };
+
+    Book book;
+    book.in.currency.copyFrom (field (sfTakerPaysCurrency));
+    book.in.account.copyFrom (field (sfTakerPaysIssuer));
+    book.out.currency.copyFrom (field (sfTakerGetsCurrency));
+    book.out.account.copyFrom (field (sfTakerGetsIssuer));
+    return book;
+}
+
+}
+
 OrderBookDB::OrderBookDB (Application& app, Stoppable& parent)
     : Stoppable ("OrderBookDB", parent)
     , app_ (app)
     , mSeq (0)
+    , mSavedSeq (0)
+    , mTriedSnapshot (false)
     , j_ (app.journal ("OrderBookDB"))
 {
 }
 
 void OrderBookDB::invalidate ()
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    ScopedLockType sl (mLock);
     mSeq = 0;
 }
 
@@ -52,24 +91,15 @@ void OrderBookDB::setup(
     std::shared_ptr<ReadView const> const& ledger)
 {
     {
-        std::lock_guard <std::recursive_mutex> sl (mLock);
+        ScopedLockType sl (mLock);
         auto seq = ledger->info().seq;
 
-        // Do a full update every 256 ledgers
-        if (mSeq != 0)
-        {
-            if (seq == mSeq)
-                return;
-            if ((seq > mSeq) && ((seq - mSeq) < 256))
-                return;
-            if ((seq < mSeq) && ((mSeq - seq) < 16))
-                return;
-        }
+        // Ledgers we already have, or slightly older ones, change nothing
+        if (mSeq != 0 && seq <= mSeq && (mSeq - seq) < 16)
+            return;
 
         JLOG (j_.debug())
             << "Advancing from " << mSeq << " to " << seq;
-
-        mSeq = seq;
     }
 
     if (app_.config().PATH_SEARCH_MAX == 0)
@@ -87,22 +117,224 @@ void OrderBookDB::setup(
 void OrderBookDB::update(
     std::shared_ptr<ReadView const> const& ledger)
 {
-    hash_set< uint256 > seen;
-    OrderBookDB::IssueToOrderBook destMap;
-    OrderBookDB::IssueToOrderBook sourceMap;
-    hash_set< Issue > CSCBooks;
-
-    JLOG (j_.debug()) << "OrderBookDB::update>";
-
     if (app_.config().PATH_SEARCH_MAX == 0)
     {
         // pathfinding has been disabled
         return;
     }
 
-    // walk through the entire ledger looking for orderbook entries
-    int books = 0;
+    std::lock_guard <std::mutex> ul (mUpdateLock);
+
+    if (! mTriedSnapshot)
+    {
+        mTriedSnapshot = true;
+        loadSnapshot ();
+    }
 
+    std::uint32_t seq;
+    uint256 hash;
+    {
+        ScopedLockType sl (mLock);
+        seq = mSeq;
+        hash = mHash;
+    }
+
+    if (seq != 0)
+    {
+        // Updates queue up behind each other, so this one may be stale
+        if (ledger->info().hash == hash)
+            return;
+        if (ledger->info().seq <= seq && (seq - ledger->info().seq) < 16)
+            return;
+
+        if (catchUp (ledger))
+        {
+            if (ledger->info().seq >= mSavedSeq + snapshotInterval)
+                saveSnapshot ();
+            return;
+        }
+    }
+
+    rebuild (ledger);
+}
+
+bool OrderBookDB::catchUp (
+    std::shared_ptr<ReadView const> const& ledger)
+{
+    std::uint32_t seq;
+    uint256 hash;
+    {
+        ScopedLockType sl (mLock);
+        seq = mSeq;
+        hash = mHash;
+    }
+
+    if (ledger->info().seq <= seq || ledger->info().seq - seq > maxCatchUp)
+        return false;
+
+    // Walk back to the ledger the books reflect, so that
+    // the changes are only taken from its descendants.
+    std::vector <std::shared_ptr<ReadView const>> chain {ledger};
+    while (chain.back ()->info().seq > seq + 1)
+    {
+        auto prev = app_.getLedgerMaster ().getLedgerByHash (
+            chain.back ()->info().parentHash);
+        if (! prev)
+        {
+            JLOG (j_.debug())
+                << "OrderBookDB::catchUp missing ledger "
+                << (chain.back ()->info().seq - 1);
+            return false;
+        }
+        chain.push_back (std::move (prev));
+    }
+    if (chain.back ()->info().parentHash != hash)
+    {
+        JLOG (j_.info())
+            << "OrderBookDB::catchUp ledger " << ledger->info().seq
+            << " doesn't descend from " << seq;
+        return false;
+    }
+
+    bool changed = false;
+    try
+    {
+        for (auto it = chain.rbegin (); it != chain.rend (); ++it)
+        {
+            if (applyLedger (**it))
+                changed = true;
+        }
+    }
+    catch (const SHAMapMissingNode&)
+    {
+        JLOG (j_.info())
+            << "OrderBookDB::catchUp encountered a missing node";
+        ScopedLockType sl (mLock);
+        mSeq = 0;
+        return false;
+    }
+
+    JLOG (j_.trace())
+        << "OrderBookDB::catchUp< " << chain.size () << " ledgers applied";
+
+    if (changed)
+        app_.getLedgerMaster().newOrderBookDB();
+    return true;
+}
+
+bool OrderBookDB::applyLedger (ReadView const& ledger)
+{
+    // The net change in the number of quality directories of each book
+    hash_map <uint256, std::pair <Book, int>> deltas;
+
+    for (auto const& item : ledger.txs)
+    {
+        if (! item.second)
+            continue;
+
+        for (auto const& node : item.second->getFieldArray (sfAffectedNodes))
+        {
+            if (node.getFieldU16 (sfLedgerEntryType) != ltDIR_NODE)
+                continue;
+
+            int delta;
+            SField const* field;
+            if (node.getFName () == sfCreatedNode)
+            {
+                delta = 1;
+                field = &sfNewFields;
+            }
+            else if (node.getFName () == sfDeletedNode)
+            {
+                delta = -1;
+                field = &sfFinalFields;
+            }
+            else
+            {
+                continue;
+            }
+
+            // Only the root of a quality directory stands for a book
+            auto dir = dynamic_cast<const STObject*> (
+                node.peekAtPField (*field));
+            if (! dir ||
+                ! dir->isFieldPresent (sfExchangeRate) ||
+                ! dir->isFieldPresent (sfRootIndex) ||
+                dir->getFieldH256 (sfRootIndex) !=
+                    node.getFieldH256 (sfLedgerIndex))
+            {
+                continue;
+            }
+
+            auto const book = bookFromDirectory (*dir);
+            auto& entry = deltas[getBookBase (book)];
+            entry.first = book;
+            entry.second += delta;
+        }
+    }
+
+    auto const seq = ledger.info().seq;
+    bool changed = false;
+
+    ScopedLockType sl (mLock);
+    for (auto const& d : deltas)
+    {
+        auto const delta = d.second.second;
+        auto it = mBooks.find (d.first);
+        if (delta > 0)
+        {
+            if (it == mBooks.end ())
+            {
+                rawAddBook (d.first, d.second.first, delta, 0);
+                changed = true;
+            }
+            else
+            {
+                it->second.dirs += delta;
+            }
+        }
+        else if (delta < 0 && it != mBooks.end ())
+        {
+            auto const removed = static_cast<std::uint32_t> (-delta);
+            if (it->second.dirs > removed)
+            {
+                it->second.dirs -= removed;
+            }
+            else
+            {
+                rawRemoveBook (it);
+                changed = true;
+            }
+        }
+    }
+
+    // Books added ahead of a ledger that never created them
+    for (auto it = mBooks.begin (); it != mBooks.end ();)
+    {
+        if (it->second.dirs == 0 && it->second.expires <= seq)
+        {
+            rawRemoveBook (it++);
+            changed = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    mSeq = seq;
+    mHash = ledger.info().hash;
+    return changed;
+}
+
+void OrderBookDB::rebuild (
+    std::shared_ptr<ReadView const> const& ledger)
+{
+    BookMap books;
+
+    JLOG (j_.debug()) << "OrderBookDB::rebuild>";
+
+    // walk through the entire ledger looking for orderbook entries
     try
     {
         for(auto& sle : ledger->sles)
@@ -111,108 +343,290 @@ void OrderBookDB::update(
                 sle->isFieldPresent (sfExchangeRate) &&
                 sle->getFieldH256 (sfRootIndex) == sle->key())
             {
-                Book book;
-                book.in.currency.copyFrom(sle->getFieldH160(
-                    sfTakerPaysCurrency));
-                book.in.account.copyFrom(sle->getFieldH160 (
-                    sfTakerPaysIssuer));
-                book.out.account.copyFrom(sle->getFieldH160(
-                    sfTakerGetsIssuer));
-                book.out.currency.copyFrom (sle->getFieldH160(
-                    sfTakerGetsCurrency));
-
+                auto const book = bookFromDirectory (*sle);
                 uint256 index = getBookBase (book);
-                if (seen.insert (index).second)
+                auto& entry = books[index];
+                if (! entry.book)
                 {
-                    auto orderBook = std::make_shared<OrderBook> (index, book);
-                    sourceMap[book.in].push_back (orderBook);
-                    destMap[book.out].push_back (orderBook);
-                    if (isCSC(book.out))
-                        CSCBooks.insert(book.in);
-                    ++books;
+                    entry.book = std::make_shared<OrderBook> (index, book);
+                    entry.dirs = 0;
+                    entry.expires = 0;
                 }
+                ++entry.dirs;
             }
         }
     }
     catch (const SHAMapMissingNode&)
     {
         JLOG (j_.info())
-            << "OrderBookDB::update encountered a missing node";
-        std::lock_guard <std::recursive_mutex> sl (mLock);
+            << "OrderBookDB::rebuild encountered a missing node";
+        ScopedLockType sl (mLock);
         mSeq = 0;
         return;
     }
 
     JLOG (j_.debug())
-        << "OrderBookDB::update< " << books << " books found";
-    {
-        std::lock_guard <std::recursive_mutex> sl (mLock);
+        << "OrderBookDB::rebuild< " << books.size() << " books found";
 
-        mCSCBooks.swap(CSCBooks);
-        mSourceMap.swap(sourceMap);
-        mDestMap.swap(destMap);
-    }
+    installBooks (std::move (books), ledger->info().seq, ledger->info().hash);
+    saveSnapshot ();
     app_.getLedgerMaster().newOrderBookDB();
 }
 
+void OrderBookDB::installBooks (BookMap books,
+    std::uint32_t seq, uint256 const& hash)
+{
+    OrderBookDB::IssueToOrderBook destMap;
+    OrderBookDB::IssueToOrderBook sourceMap;
+    hash_set< Issue > CSCBooks;
+
+    for (auto const& entry : books)
+    {
+        auto const& book = entry.second.book->book ();
+        sourceMap[book.in].push_back (entry.second.book);
+        destMap[book.out].push_back (entry.second.book);
+        if (isCSC(book.out))
+            CSCBooks.insert(book.in);
+    }
+
+    ScopedLockType sl (mLock);
+
+    mBooks.swap(books);
+    mCSCBooks.swap(CSCBooks);
+    mSourceMap.swap(sourceMap);
+    mDestMap.swap(destMap);
+    mSeq = seq;
+    mHash = hash;
+}
+
+void OrderBookDB::rawAddBook (uint256 const& index, Book const& book,
+    std::uint32_t dirs, std::uint32_t expires)
+{
+    auto orderBook = std::make_shared<OrderBook> (index, book);
+
+    mBooks[index] = {orderBook, dirs, expires};
+    mSourceMap[book.in].push_back (orderBook);
+    mDestMap[book.out].push_back (orderBook);
+    if (isCSC (book.out))
+        mCSCBooks.insert(book.in);
+}
+
+void OrderBookDB::rawRemoveBook (BookMap::iterator it)
+{
+    auto const orderBook = it->second.book;
+    auto const& book = orderBook->book ();
+
+    auto unlink = [&orderBook](IssueToOrderBook& map, Issue const& issue)
+    {
+        auto const found = map.find (issue);
+        if (found == map.end ())
+            return;
+        auto& list = found->second;
+        list.erase (std::remove (list.begin (), list.end (), orderBook),
+            list.end ());
+        if (list.empty ())
+            map.erase (found);
+    };
+    unlink (mSourceMap, book.in);
+    unlink (mDestMap, book.out);
+
+    // There is only one book from an issue to CSC
+    if (isCSC (book.out))
+        mCSCBooks.erase (book.in);
+
+    mBooks.erase (it);
+}
+
 void OrderBookDB::addOrderBook(Book const& book)
 {
-    bool toCSC = isCSC (book.out);
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    uint256 index = getBookBase(book);
+    ScopedLockType sl (mLock);
+
+    if (mBooks.count (index) != 0)
+        return;
+
+    // Give the ledger being built and the one after it
+    // a chance to create the book.
+    rawAddBook (index, book, 0, mSeq == 0 ? 0 : mSeq + 2);
+}
+
+boost::filesystem::path OrderBookDB::snapshotPath () const
+{
+    auto const dbPath = app_.config().legacy ("database_path");
+    if (dbPath.empty ())
+        return {};
+    return boost::filesystem::path (dbPath) / "orderbooks.dat";
+}
+
+bool OrderBookDB::loadSnapshot ()
+{
+    using namespace boost::filesystem;
 
-    if (toCSC)
+    auto const path = snapshotPath ();
+    if (path.empty () || ! exists (path))
+        return false;
+
+    BookMap books;
+    std::uint32_t seq;
+    uint256 hash;
+    try
     {
-        // We don't want to search through all the to-CSC or from-CSC order
-        // books!
-        for (auto ob: mSourceMap[book.in])
+        Blob data (file_size (path));
+        {
+            ifstream ifs (path, std::ios::binary);
+            if (! ifs.read (reinterpret_cast<char*> (data.data ()),
+                    data.size ()))
+            {
+                Throw<std::runtime_error> ("unable to read");
+            }
+        }
+
+        // The file ends with a hash of its contents
+        if (data.size () < uint256::bytes)
+            Throw<std::runtime_error> ("truncated");
+        auto const size = data.size () - uint256::bytes;
+        if (sha512Half (Slice (data.data (), size)) !=
+            uint256::fromVoid (data.data () + size))
+        {
+            Throw<std::runtime_error> ("checksum mismatch");
+        }
+
+        SerialIter sit (data.data (), size);
+        if (sit.get32 () != snapshotVersion)
+            Throw<std::runtime_error> ("unknown version");
+        seq = sit.get32 ();
+        hash = sit.get256 ();
+        for (auto count = sit.get32 (); count != 0; --count)
         {
-            if (isCSC (ob->getCurrencyOut ())) // also to CSC
-                return;
+            Book book;
+            book.in.currency.copyFrom (sit.get160 ());
+            book.in.account.copyFrom (sit.get160 ());
+            book.out.currency.copyFrom (sit.get160 ());
+            book.out.account.copyFrom (sit.get160 ());
+            auto const dirs = sit.get32 ();
+
+            auto const index = getBookBase (book);
+            books[index] = {
+                std::make_shared<OrderBook> (index, book), dirs, 0};
         }
+        if (! sit.empty () || seq == 0)
+            Throw<std::runtime_error> ("invalid contents");
     }
-    else
+    catch (std::exception const& e)
+    {
+        JLOG (j_.warn())
+            << "ignoring order book snapshot " << path << ": " << e.what ();
+        return false;
+    }
+
+    JLOG (j_.info())
+        << "loaded " << books.size () << " books of ledger " << seq;
+
+    installBooks (std::move (books), seq, hash);
+    mSavedSeq = seq;
+    return true;
+}
+
+void OrderBookDB::saveSnapshot ()
+{
+    auto const path = snapshotPath ();
+    if (path.empty ())
+        return;
+
+    Serializer s;
+    std::uint32_t seq;
+    {
+        ScopedLockType sl (mLock);
+        if (mSeq == 0)
+            return;
+        seq = mSeq;
+
+        std::uint32_t count = 0;
+        for (auto const& entry : mBooks)
+        {
+            if (entry.second.dirs != 0)
+                ++count;
+        }
+
+        s.add32 (snapshotVersion);
+        s.add32 (mSeq);
+        s.add256 (mHash);
+        s.add32 (count);
+        for (auto const& entry : mBooks)
+        {
+            if (entry.second.dirs == 0)
+                continue;
+            auto const& book = entry.second.book->book ();
+            s.add160 (book.in.currency);
+            s.add160 (book.in.account);
+            s.add160 (book.out.currency);
+            s.add160 (book.out.account);
+            s.add32 (entry.second.dirs);
+        }
+    }
+    s.add256 (s.getSHA512Half ());
+
+    // Write a new file and swap it in, so a crash
+    // never leaves a truncated snapshot behind.
+    try
     {
-        for (auto ob: mDestMap[book.out])
+        auto temp = path;
+        temp += ".tmp";
         {
-            if (ob->getCurrencyIn() == book.in.currency &&
-                ob->getIssuerIn() == book.in.account)
-            {
-                return;
-            }
+            boost::filesystem::ofstream ofs (temp,
+                std::ios::binary | std::ios::trunc);
+            ofs.write (reinterpret_cast<char const*> (s.data ()), s.size ());
+            if (! ofs)
+                Throw<std::runtime_error> ("unable to write " + temp.string());
         }
+        boost::filesystem::rename (temp, path);
+        mSavedSeq = seq;
     }
-    uint256 index = getBookBase(book);
-    auto orderBook = std::make_shared<OrderBook> (index, book);
+    catch (std::exception const& e)
+    {
+        JLOG (j_.warn())
+            << "unable to save order book snapshot: " << e.what ();
+    }
+}
 
-    mSourceMap[book.in].push_back (orderBook);
-    mDestMap[book.out].push_back (orderBook);
-    if (toCSC)
-        mCSCBooks.insert(book.in);
+void OrderBookDB::onStop ()
+{
+    {
+        std::lock_guard <std::mutex> ul (mUpdateLock);
+        bool saved;
+        {
+            ScopedLockType sl (mLock);
+            saved = mSeq == mSavedSeq;
+        }
+        if (! saved)
+            saveSnapshot ();
+    }
+    stopped ();
 }
 
 // return list of all orderbooks that want this issuerID and currencyID
 OrderBook::List OrderBookDB::getBooksByTakerPays (Issue const& issue)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    ScopedLockType sl (mLock);
     auto it = mSourceMap.find (issue);
     return it == mSourceMap.end () ? OrderBook::List() : it->second;
 }
 
 int OrderBookDB::getBookSize(Issue const& issue) {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    ScopedLockType sl (mLock);
     auto it = mSourceMap.find (issue);
     return it == mSourceMap.end () ? 0 : it->second.size();
 }
 
 bool OrderBookDB::isBookToCSC(Issue const& issue)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    ScopedLockType sl (mLock);
     return mCSCBooks.count(issue) > 0;
 }
 
 BookListeners::pointer OrderBookDB::makeBookListeners (Book const& book)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    ScopedLockType sl (mLock);
     auto ret = getBookListeners (book);
 
     if (!ret)
@@ -229,7 +643,7 @@ BookListeners::pointer OrderBookDB::makeBookListeners (Book const& book)
 BookListeners::pointer OrderBookDB::getBookListeners (Book const& book)
 {
     BookListeners::pointer ret;
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    ScopedLockType sl (mLock);
 
     auto it0 = mListeners.find (book);
     if (it0 != mListeners.end ())
@@ -244,7 +658,7 @@ void OrderBookDB::processTxn (
     std::shared_ptr<ReadView const> const& ledger,
         const AcceptedLedgerTx& alTx, Json::Value const& jvObj)
 {
-    std::lock_guard <std::recursive_mutex> sl (mLock);
+    ScopedLockType sl (mLock);
     if (alTx.getResult () == tesSUCCESS)
     {
         // For this particular transaction, maintain the set of unique
@@ -30,6 +30,8 @@
 #include <casinocoin/app/ledger/BookListeners.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/OrderBook.h>
+#include <casinocoin/basics/ProfiledMutex.h>
+#include <boost/filesystem.hpp>
 #include <mutex>
 
 namespace casinocoin {
@@ -40,10 +42,22 @@ class OrderBookDB
 public:
     OrderBookDB (Application& app, Stoppable& parent);
 
+    /** Bring the order books up to date with a ledger.
+
+        The books are kept current from the metadata of each ledger
+        following the one they reflect. The state map is only scanned
+        when the books share no recent history with the ledger, or at
+        startup if the snapshot saved on disk can't be used.
+    */
     void setup (std::shared_ptr<ReadView const> const& ledger);
     void update (std::shared_ptr<ReadView const> const& ledger);
     void invalidate ();
 
+    /** Add a book ahead of the ledger that creates it.
+
+        The book is dropped again if it doesn't show up in one of the
+        next ledgers.
+    */
     void addOrderBook(Book const&);
 
     /** @return a list of all orderbooks that want this issuerID and currencyID.
@@ -67,10 +81,44 @@ public:
     using IssueToOrderBook = hash_map <Issue, OrderBook::List>;
 
 private:
-    void rawAddBook(Book const&);
+    struct BookEntry
+    {
+        OrderBook::pointer book;
+
+        // The number of quality directories the book has in the
+        // ledger, zero for a book added by addOrderBook.
+        std::uint32_t dirs;
+
+        // The ledger by which a book without directories is dropped
+        std::uint32_t expires;
+    };
+
+    using BookMap = hash_map <uint256, BookEntry>;
+
+    void onStop () override;
+
+    void rawAddBook (uint256 const& index, Book const& book,
+        std::uint32_t dirs, std::uint32_t expires);
+    void rawRemoveBook (BookMap::iterator it);
+    void installBooks (BookMap books,
+        std::uint32_t seq, uint256 const& hash);
+
+    // Apply the changes in the ledgers after the ones the books reflect
+    bool catchUp (std::shared_ptr<ReadView const> const& ledger);
+    bool applyLedger (ReadView const& ledger);
+
+    // Scan the entire state map of a ledger for books
+    void rebuild (std::shared_ptr<ReadView const> const& ledger);
+
+    boost::filesystem::path snapshotPath () const;
+    bool loadSnapshot ();
+    void saveSnapshot ();
 
     Application& app_;
 
+    // by book base index
+    BookMap mBooks;
+
     // by ci/ii
     IssueToOrderBook mSourceMap;
 
@@ -80,13 +128,24 @@ private:
     // does an order book to CSC exist
     hash_set <Issue> mCSCBooks;
 
-    std::recursive_mutex mLock;
+    using ScopedLockType =
+        std::lock_guard <ProfiledMutex <std::recursive_mutex>>;
+    ProfiledMutex <std::recursive_mutex> mLock {"OrderBookDB::mLock"};
 
     using BookToListenersMap = hash_map <Book, BookListeners::pointer>;
 
     BookToListenersMap mListeners;
 
+    // The ledger the books reflect, zero if none
     std::uint32_t mSeq;
+    uint256 mHash;
+
+    // The ledger of the last snapshot saved
+    std::uint32_t mSavedSeq;
+    bool mTriedSnapshot;
+
+    // Held by whoever brings the books up to date
+    std::mutex mUpdateLock;
 
     beast::Journal j_;
 };
@@ -89,7 +89,7 @@ InboundLedger::InboundLedger (
         "Acquiring ledger " << mHash;
 }
 
-void InboundLedger::init (ScopedLockType& collectionLock)
+void InboundLedger::init (CollectionLockType& collectionLock)
 {
     ScopedLockType sl (mLock);
     collectionLock.unlock ();
@@ -190,7 +190,8 @@ InboundLedger::neededTxHashes (
         if (mLedger->txMap().getHash().isZero ())
             ret.push_back (mLedger->info().txHash);
         else
-            ret = mLedger->txMap().getNeededHashes (max, filter);
+            ret = mLedger->txMap().getNeededHashes (
+                max, filter, readPriority ());
     }
 
     return ret;
@@ -207,7 +208,8 @@ InboundLedger::neededStateHashes (
         if (mLedger->stateMap().getHash().isZero ())
             ret.push_back (mLedger->info().accountHash);
         else
-            ret = mLedger->stateMap().getNeededHashes (max, filter);
+            ret = mLedger->stateMap().getNeededHashes (
+                max, filter, readPriority ());
     }
 
     return ret;
@@ -622,7 +624,7 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
             // Release the lock while we process the large state map
             sl.unlock();
             auto nodes = mLedger->stateMap().getMissingNodes (
-                missingNodesFind, &filter);
+                missingNodesFind, &filter, readPriority ());
             sl.lock();
 
             // Make sure nothing happened while we released the lock
@@ -694,7 +696,7 @@ void InboundLedger::trigger (std::shared_ptr<Peer> const& peer, TriggerReason re
                 app_.getLedgerMaster());
 
             auto nodes = mLedger->txMap().getMissingNodes (
-                missingNodesFind, &filter);
+                missingNodesFind, &filter, readPriority ());
 
             if (nodes.empty ())
             {
@@ -864,6 +866,11 @@ bool InboundLedger::takeTxNode (const std::vector<SHAMapNodeID>& nodeIDs,
     TransactionStateSF filter(mLedger->txMap().family(),
         app_.getLedgerMaster());
 
+    // Parsing the nodes together lets their hashes be checked in bulk
+    auto const nodes = SHAMapAbstractNode::make (
+        data, nodeIDs, 0, m_journal);
+    auto nodeit = nodes.begin ();
+
     while (nodeIDit != nodeIDs.cend ())
     {
         if (nodeIDit->isRoot ())
@@ -876,14 +883,15 @@ bool InboundLedger::takeTxNode (const std::vector<SHAMapNodeID>& nodeIDs,
         }
         else
         {
-            san +=  mLedger->txMap().addKnownNode (
-                *nodeIDit, makeSlice(*nodeDatait), &filter);
+            san += mLedger->txMap().addKnownNode (
+                *nodeIDit, *nodeit, &filter);
             if (!san.isGood())
                 return false;
         }
 
         ++nodeIDit;
         ++nodeDatait;
+        ++nodeit;
     }
 
     if (!mLedger->txMap().isSynching ())
@@ -936,6 +944,11 @@ bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
     AccountStateSF filter(mLedger->stateMap().family(),
         app_.getLedgerMaster());
 
+    // Parsing the nodes together lets their hashes be checked in bulk
+    auto const nodes = SHAMapAbstractNode::make (
+        data, nodeIDs, 0, m_journal);
+    auto nodeit = nodes.begin ();
+
     while (nodeIDit != nodeIDs.cend ())
     {
         if (nodeIDit->isRoot ())
@@ -953,7 +966,7 @@ bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
         else
         {
             san += mLedger->stateMap().addKnownNode (
-                *nodeIDit, makeSlice(*nodeDatait), &filter);
+                *nodeIDit, *nodeit, &filter);
             if (!san.isGood ())
             {
                 JLOG (m_journal.warn()) <<
@@ -964,6 +977,7 @@ bool InboundLedger::takeAsNode (const std::vector<SHAMapNodeID>& nodeIDs,
 
         ++nodeIDit;
         ++nodeDatait;
+        ++nodeit;
     }
 
     if (!mLedger->stateMap().isSynching ())
@@ -30,6 +30,7 @@
 #include <casinocoin/app/misc/NetworkOPs.h>
 #include <casinocoin/basics/DecayingSample.h>
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/ProfiledMutex.h>
 #include <casinocoin/core/JobQueue.h>
 #include <casinocoin/protocol/JsonFields.h>
 #include <casinocoin/beast/core/LexicalCast.h>
@@ -67,6 +68,10 @@ public:
         , m_clock (clock)
         , mRecentFailures (clock)
         , mCounter(collector->make_counter("ledger_fetches"))
+        , mAcquiring (collector->make_gauge ("ledgers_acquiring"))
+        , mFailures (collector->make_gauge ("ledger_fetch_failures"))
+        , mHook (collector->make_hook (
+            std::bind (&InboundLedgersImp::collect_metrics, this)))
     {
     }
 
@@ -407,10 +412,17 @@ public:
     }
 
 private:
+    void collect_metrics ()
+    {
+        ScopedLockType sl (mLock);
+        mAcquiring = mLedgers.size ();
+        mFailures = mRecentFailures.size ();
+    }
+
     clock_type& m_clock;
 
-    using ScopedLockType = std::unique_lock <std::recursive_mutex>;
-    std::recursive_mutex mLock;
+    using ScopedLockType = InboundLedger::CollectionLockType;
+    ProfiledMutex <std::recursive_mutex> mLock {"InboundLedgers::mLock"};
 
     using MapType = hash_map <uint256, std::shared_ptr<InboundLedger>>;
     MapType mLedgers;
@@ -418,6 +430,11 @@ private:
     beast::aged_map <uint256, std::uint32_t> mRecentFailures;
 
     beast::insight::Counter mCounter;
+    beast::insight::Gauge mAcquiring;
+    beast::insight::Gauge mFailures;
+
+    // Last, so that it is unhooked before anything it reads goes away
+    beast::insight::Hook mHook;
 };
 
 //------------------------------------------------------------------------------
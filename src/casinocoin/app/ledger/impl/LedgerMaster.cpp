@@ -46,6 +46,7 @@
 #include <casinocoin/basics/TaggedCache.h>
 #include <casinocoin/basics/UptimeTimer.h>
 #include <casinocoin/core/TimeKeeper.h>
+#include <casinocoin/nodestore/DatabaseShard.h>
 #include <casinocoin/overlay/Overlay.h>
 #include <casinocoin/overlay/Peer.h>
 #include <casinocoin/protocol/digest.h>
@@ -66,6 +67,10 @@ using namespace std::chrono_literals;
 // Don't acquire history if ledger is too old
 auto constexpr MAX_LEDGER_AGE_ACQUIRE = 10min;
 
+// Give up on a history shard after failing to acquire one of its
+// ledgers this many times
+int constexpr SHARD_ACQUIRE_ATTEMPTS = 3;
+
 LedgerMaster::LedgerMaster (Application& app, Stopwatch& stopwatch,
     Stoppable& parent,
     beast::insight::Collector::ptr const& collector, beast::Journal journal)
@@ -94,7 +99,7 @@ LedgerMaster::LedgerMaster (Application& app, Stopwatch& stopwatch,
     , ledger_history_ (app_.config().LEDGER_HISTORY)
     , ledger_fetch_size_ (app_.config().getSize (siLedgerFetch))
     , fetch_packs_ ("FetchPack", 65536, 45, stopwatch,
-        app_.journal("TaggedCache"))
+        app_.journal("TaggedCache"), collector)
     , fetch_seq_ (0)
 {
 }
@@ -254,10 +259,17 @@ LedgerMaster::addHeldTransaction (
 
 void
 LedgerMaster::switchLCL(std::shared_ptr<Ledger const> const& lastClosed)
+{
+    setLCL (lastClosed);
+    acceptLCL (lastClosed);
+}
+
+void
+LedgerMaster::setLCL(std::shared_ptr<Ledger const> const& lastClosed)
 {
     assert (lastClosed);
     if(! lastClosed->isImmutable())
-        LogicError("mutable ledger in switchLCL");
+        LogicError("mutable ledger in setLCL");
 
     if (lastClosed->open())
         LogicError ("The new last closed ledger is open!");
@@ -266,6 +278,22 @@ LedgerMaster::switchLCL(std::shared_ptr<Ledger const> const& lastClosed)
         ScopedLockType ml (m_mutex);
         mClosedLedger.set (lastClosed);
     }
+}
+
+void
+LedgerMaster::pendStore(uint256 const& hash)
+{
+    ScopedLockType ml (m_mutex);
+    mPendingStores.insert (hash);
+}
+
+void
+LedgerMaster::acceptLCL(std::shared_ptr<Ledger const> const& lastClosed)
+{
+    {
+        ScopedLockType ml (m_mutex);
+        mPendingStores.erase (lastClosed->info().hash);
+    }
 
     if (standalone_)
     {
@@ -769,6 +797,14 @@ LedgerMaster::checkAccept (
     if (ledger->info().seq <= mValidLedgerSeq)
         return;
 
+    // acceptLCL checks again once the nodes are stored
+    if (mPendingStores.count (ledger->info().hash))
+    {
+        JLOG (m_journal.trace()) <<
+            "Not yet stored " << ledger->info().hash;
+        return;
+    }
+
     auto const minVal = getNeededValidations();
     auto const tvc = app_.getValidations().getTrustedValidationCount(
         ledger->info().hash);
@@ -962,6 +998,151 @@ LedgerMaster::getLedgerHashForHistory (LedgerIndex index)
     return ret;
 }
 
+void
+LedgerMaster::fetchForHistoryShard (NodeStore::DatabaseShard& shards)
+{
+    if (mShardFillInProgress)
+        return;
+
+    auto const seq = shards.prepare (mValidLedgerSeq);
+    if (! seq)
+        return;
+
+    auto const hash = getLedgerHashForHistory (*seq);
+    if (! hash)
+    {
+        JLOG (m_journal.debug()) <<
+            "tryAdvance no hash for shard ledger " << *seq;
+        return;
+    }
+
+    if (*seq != mShardFailedSeq)
+    {
+        mShardFailedSeq = *seq;
+        mShardFailures = 0;
+        mShardFailureCounted = false;
+    }
+
+    auto ledger = getLedgerByHash (*hash);
+    if (! ledger)
+    {
+        // A failure is remembered for a while before we try again,
+        // so only count it once
+        if (app_.getInboundLedgers().isFailure (*hash))
+        {
+            if (! mShardFailureCounted)
+            {
+                mShardFailureCounted = true;
+                if (++mShardFailures >= SHARD_ACQUIRE_ATTEMPTS)
+                {
+                    JLOG (m_journal.warn()) <<
+                        "Unable to acquire ledger " << *seq <<
+                        " for the shard store";
+                    shards.abandon ();
+                    mShardFailedSeq = 0;
+                }
+            }
+            return;
+        }
+        mShardFailureCounted = false;
+
+        // We are called again once the acquire completes
+        ledger = app_.getInboundLedgers().acquire (
+            *hash, *seq, InboundLedger::fcHISTORY);
+        if (! ledger)
+            return;
+    }
+
+    mShardFillInProgress = true;
+    app_.getJobQueue().addJob (
+        jtADVANCE, "storeShardLedger",
+        [this, ledger] (Job&)
+        {
+            storeShardLedger (ledger);
+            mShardFillInProgress = false;
+            tryAdvance ();
+        });
+}
+
+void
+LedgerMaster::storeShardLedger (std::shared_ptr<Ledger const> const& ledger)
+{
+    auto const shards = app_.getShardStore ();
+    auto const seq = ledger->info().seq;
+
+    // Ledgers are stored from the end of a shard back. A state node
+    // shared with the following ledger of the same shard is already
+    // stored, so only the differences need to be.
+    std::shared_ptr<Ledger const> next;
+    if (mShardLedger && mShardLedger->info().seq == seq + 1 &&
+        mShardLedger->info().parentHash == ledger->info().hash &&
+        shards->seqToShardIndex (seq + 1) == shards->seqToShardIndex (seq) &&
+        shards->hasLedger (seq + 1))
+    {
+        next = mShardLedger;
+    }
+
+    bool stored = true;
+    auto const store = [&](SHAMapAbstractNode& node, NodeObjectType type)
+    {
+        Serializer s;
+        node.addRaw (s, snfPREFIX);
+        stored = shards->store (type, std::move (s.modData ()),
+            node.getNodeHash ().as_uint256 (), seq);
+        return stored;
+    };
+
+    try
+    {
+        Serializer s (128);
+        s.add32 (HashPrefix::ledgerMaster);
+        addRaw (ledger->info (), s);
+        stored = shards->store (hotLEDGER,
+            std::move (s.modData ()), ledger->info().hash, seq);
+
+        if (stored && ledger->info().accountHash.isNonZero ())
+        {
+            ledger->stateMap().visitDifferences (
+                next ? &next->stateMap () : nullptr,
+                [&](SHAMapAbstractNode& node)
+                {
+                    return store (node, hotACCOUNT_NODE);
+                }, 1);
+        }
+
+        if (stored && ledger->info().txHash.isNonZero ())
+        {
+            ledger->txMap().visitDifferences (nullptr,
+                [&](SHAMapAbstractNode& node)
+                {
+                    return store (node, hotTRANSACTION_NODE);
+                }, 1);
+        }
+
+        if (stored && shards->setStored (seq))
+        {
+            // Checking the full shard reads all of it
+            app_.getJobQueue().addJob (
+                jtSHARD, "finalizeShard",
+                [shards] (Job&) { shards->finalize (); });
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (m_journal.warn()) <<
+            "Unable to store ledger " << seq <<
+            " in the shard store: " << e.what ();
+        stored = false;
+    }
+
+    if (stored)
+    {
+        JLOG (m_journal.debug()) <<
+            "Stored ledger " << seq << " in the shard store";
+        mShardLedger = ledger;
+    }
+}
+
 bool
 LedgerMaster::shouldFetchPack (std::uint32_t seq) const
 {
@@ -1250,7 +1431,7 @@ LedgerMaster::newPFWork (const char *name)
     }
 }
 
-std::recursive_mutex&
+LedgerMaster::mutex_type&
 LedgerMaster::peekMutex ()
 {
     return m_mutex;
@@ -1410,7 +1591,11 @@ LedgerMaster::getLedgerBySeq (std::uint32_t index)
                 auto const hash = hashOfSeq(*valid, index, m_journal);
 
                 if (hash)
-                    return mLedgerHistory.getLedgerByHash (*hash);
+                {
+                    if (auto ret = mLedgerHistory.getLedgerByHash (*hash))
+                        return ret;
+                    return loadFromShards (index, *hash);
+                }
             }
             catch (std::exception const&)
             {
@@ -1426,10 +1611,94 @@ LedgerMaster::getLedgerBySeq (std::uint32_t index)
     if (ret && (ret->info().seq == index))
         return ret;
 
+    // Older than what the node store keeps
+    ret = getLedgerFromShards (index);
+    if (ret)
+        return ret;
+
     clearLedger (index);
     return {};
 }
 
+std::shared_ptr<Ledger const>
+LedgerMaster::getLedgerFromShards (std::uint32_t index)
+{
+    auto const shards = app_.getShardStore ();
+    if (! shards || ! shards->hasLedger (index))
+        return {};
+
+    boost::optional<LedgerHash> hash;
+    auto const dbHash = getHashBySeq (index);
+    if (dbHash.isNonZero ())
+        hash = dbHash;
+
+    auto const valid = mValidLedger.get ();
+    if (! hash && valid && valid->info().seq > index)
+    {
+        try
+        {
+            hash = hashOfSeq (*valid, index, m_journal);
+            if (! hash)
+            {
+                // Find the hash in the skip list of a ledger which is
+                // in the node store or in the shards itself
+                auto const refIndex = getCandidateLedger (index);
+                auto const refHash = hashOfSeq (*valid, refIndex, m_journal);
+                if (refHash)
+                {
+                    auto ref = mLedgerHistory.getLedgerByHash (*refHash);
+                    if (! ref)
+                        ref = loadFromShards (refIndex, *refHash);
+                    if (ref)
+                        hash = hashOfSeq (*ref, index, m_journal);
+                }
+            }
+        }
+        catch (SHAMapMissingNode const&)
+        {
+            hash = boost::none;
+        }
+    }
+
+    if (! hash)
+    {
+        JLOG (m_journal.debug()) <<
+            "No hash for shard ledger " << index;
+        return {};
+    }
+    return loadFromShards (index, *hash);
+}
+
+std::shared_ptr<Ledger const>
+LedgerMaster::loadFromShards (std::uint32_t index, LedgerHash const& hash)
+{
+    auto const shards = app_.getShardStore ();
+    if (! shards)
+        return {};
+
+    auto const object = shards->fetch (hash, index);
+    if (! object)
+        return {};
+
+    bool loaded = false;
+    auto ledger = std::make_shared<Ledger> (
+        InboundLedger::deserializeHeader (
+            makeSlice (object->getData ()), true),
+        loaded, app_.config (), *app_.shardFamily (), m_journal);
+    if (! loaded)
+        return {};
+
+    ledger->setImmutable (app_.config ());
+    if (ledger->info().hash != hash || ledger->info().seq != index)
+    {
+        JLOG (m_journal.warn()) <<
+            "Shard ledger " << index << " does not match " << hash;
+        return {};
+    }
+    ledger->setFull ();
+    return ledger;
+}
+
 std::shared_ptr<Ledger const>
 LedgerMaster::getLedgerByHash (uint256 const& hash)
 {
@@ -1685,6 +1954,12 @@ void LedgerMaster::doAdvance ()
                         progress = true;
                     }
                 }
+
+                if (auto const shards = app_.getShardStore ())
+                {
+                    ScopedUnlockType sl(m_mutex);
+                    fetchForHistoryShard (*shards);
+                }
             }
             else
             {
@@ -1716,6 +1991,7 @@ void LedgerMaster::doAdvance ()
                 {
                     ScopedUnlockType sul(m_mutex);
                     app_.getOPs().pubLedger(ledger);
+                    app_.getOrderBookDB().setup(ledger);
                 }
             }
 
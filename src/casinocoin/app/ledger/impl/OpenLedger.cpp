@@ -30,16 +30,22 @@
 #include <casinocoin/app/tx/apply.h>
 #include <casinocoin/ledger/CachedView.h>
 #include <casinocoin/protocol/Feature.h>
+#include <casinocoin/protocol/STAccount.h>
+#include <casinocoin/protocol/STArray.h>
+#include <casinocoin/protocol/STPathSet.h>
 #include <boost/range/adaptor/transformed.hpp>
+#include <algorithm>
 
 namespace casinocoin {
 
 OpenLedger::OpenLedger(std::shared_ptr<
     Ledger const> const& ledger,
         CachedSLEs& cache,
-            beast::Journal journal)
+            beast::Journal journal,
+                Setup const& setup)
     : j_ (journal)
     , cache_ (cache)
+    , setup_ (setup)
     , current_ (create(ledger->rules(), ledger))
 {
 }
@@ -104,18 +110,42 @@ OpenLedger::accept(Application& app, Rules const& rules,
     // would get lost.
     std::lock_guard<
         std::mutex> lock1(modify_mutex_);
+    // Carrying tx forward is only sound when the new
+    // ledger directly follows the one the current open
+    // view was built on, with the same rules and fees.
+    auto const canCarry = [&]
+    {
+        if (! setup_.incremental)
+            return false;
+        if (ledger->info().parentHash !=
+                current_->info().parentHash)
+            return false;
+        if (next->rules() != current_->rules())
+            return false;
+        auto const& from = current_->fees();
+        auto const& to = next->fees();
+        return from.base == to.base &&
+            from.units == to.units &&
+            from.reserve == to.reserve &&
+            from.increment == to.increment;
+    };
     // Apply tx from the current open view
     if (! current_->txs.empty())
-        apply (app, *next, *ledger,
-            boost::adaptors::transform(
-                current_->txs,
-            [](std::pair<std::shared_ptr<
-                STTx const>, std::shared_ptr<
-                    STObject const>> const& p)
-            {
-                return p.first;
-            }),
-                retries, flags, j_);
+    {
+        if (canCarry())
+            carry (app, *next, *ledger, retries, flags);
+        else
+            apply (app, *next, *ledger,
+                boost::adaptors::transform(
+                    current_->txs,
+                [](std::pair<std::shared_ptr<
+                    STTx const>, std::shared_ptr<
+                        STObject const>> const& p)
+                {
+                    return p.first;
+                }),
+                    retries, flags, j_);
+    }
     // Call the modifier
     if (f)
         f(*next, j_);
@@ -131,6 +161,220 @@ OpenLedger::accept(Application& app, Rules const& rules,
 
 //------------------------------------------------------------------------------
 
+// Adds every account an object refers to, including
+// the issuers of amounts and the steps of paths.
+static
+void
+addAccounts (STObject const& obj,
+    hash_set<AccountID>& accounts)
+{
+    for (auto const& field : obj)
+    {
+        switch (field.getSType())
+        {
+        case STI_ACCOUNT:
+            accounts.insert(static_cast<
+                STAccount const&>(field).value());
+            break;
+        case STI_AMOUNT:
+        {
+            auto const& amount =
+                static_cast<STAmount const&>(field);
+            if (! amount.native())
+                accounts.insert(amount.getIssuer());
+            break;
+        }
+        case STI_PATHSET:
+            for (auto const& path :
+                    static_cast<STPathSet const&>(field))
+            {
+                for (auto const& step : path)
+                {
+                    if (step.isAccount())
+                        accounts.insert(step.getAccountID());
+                    if (step.hasIssuer())
+                        accounts.insert(step.getIssuerID());
+                }
+            }
+            break;
+        case STI_OBJECT:
+            addAccounts(static_cast<
+                STObject const&>(field), accounts);
+            break;
+        case STI_ARRAY:
+            for (auto const& inner :
+                    static_cast<STArray const&>(field))
+                addAccounts(inner, accounts);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+// Returns `true` if everything the transaction can change
+// belongs to accounts named in the transaction itself.
+static
+bool
+isSelfContained (STTx const& tx)
+{
+    switch (tx.getTxnType())
+    {
+    case ttPAYMENT:
+        return tx[sfAmount].native() &&
+            ! tx.isFieldPresent(sfSendMax) &&
+            ! tx.isFieldPresent(sfPaths);
+    case ttACCOUNT_SET:
+    case ttREGULAR_KEY_SET:
+    case ttTRUST_SET:
+    case ttOFFER_CANCEL:
+    case ttSIGNER_LIST_SET:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*  The open view keeps neither the results nor the order of
+    its transactions, so what a transaction touches is taken
+    from the transaction. A self contained transaction is
+    carried forward with `reapply` when none of the accounts it
+    names were touched by the new ledger, by anything already
+    in the new open view, or by any other transaction that must
+    be fully re-checked, and every carried transaction sharing
+    an account with it has the same source account. Replaying
+    the carried transactions by account and sequence then
+    reproduces the state their `preclaim` checks passed against.
+*/
+void
+OpenLedger::carry (Application& app, OpenView& view,
+    ReadView const& ledger, OrderedTxs& retries,
+        ApplyFlags flags)
+{
+    struct Candidate
+    {
+        std::shared_ptr<STTx const> tx;
+        hash_set<AccountID> accounts;
+        bool clean = false;
+    };
+
+    hash_set<AccountID> dirty;
+    for (auto const& item : ledger.txs)
+    {
+        addAccounts(*item.first, dirty);
+        if (item.second)
+            addAccounts(*item.second, dirty);
+    }
+    for (auto const& item : view.txs)
+        addAccounts(*item.first, dirty);
+    for (auto const& item : retries)
+        addAccounts(*item.second, dirty);
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(current_->txCount());
+    hash_map<AccountID, std::vector<std::size_t>> byAccount;
+    for (auto const& item : current_->txs)
+    {
+        Candidate c;
+        c.tx = item.first;
+        addAccounts(*item.first, c.accounts);
+        c.clean = ! isPseudoTx(*item.first) &&
+            isSelfContained(*item.first);
+        for (auto const& id : c.accounts)
+            byAccount[id].push_back(candidates.size());
+        candidates.push_back(std::move(c));
+    }
+
+    // Anything that shares an account with a dirty
+    // transaction must be fully re-checked too.
+    std::vector<AccountID> work(dirty.begin(), dirty.end());
+    auto const taint = [&](Candidate& c)
+    {
+        c.clean = false;
+        for (auto const& id : c.accounts)
+            if (dirty.insert(id).second)
+                work.push_back(id);
+    };
+    for (auto& c : candidates)
+        if (! c.clean)
+            taint(c);
+    // Transactions from different source accounts that
+    // share an account can't be put back in order.
+    for (auto const& entry : byAccount)
+    {
+        auto const& ids = entry.second;
+        auto const mixed = std::any_of(ids.begin(), ids.end(),
+            [&](std::size_t i)
+            {
+                return candidates[i].tx->getAccountID(sfAccount) !=
+                    candidates[ids.front()].tx->getAccountID(sfAccount);
+            });
+        if (mixed)
+            for (auto const i : ids)
+                if (candidates[i].clean)
+                    taint(candidates[i]);
+    }
+    while (! work.empty())
+    {
+        auto const iter = byAccount.find(work.back());
+        work.pop_back();
+        if (iter == byAccount.end())
+            continue;
+        for (auto const i : iter->second)
+            if (candidates[i].clean)
+                taint(candidates[i]);
+    }
+
+    std::vector<Candidate const*> clean;
+    std::vector<std::shared_ptr<STTx const>> rest;
+    for (auto const& c : candidates)
+    {
+        if (c.clean)
+            clean.push_back(&c);
+        else
+            rest.push_back(c.tx);
+    }
+    std::sort(clean.begin(), clean.end(),
+        [](Candidate const* lhs, Candidate const* rhs)
+        {
+            auto const& a = *lhs->tx;
+            auto const& b = *rhs->tx;
+            return std::make_pair(a.getAccountID(sfAccount),
+                    a.getSequence()) <
+                std::make_pair(b.getAccountID(sfAccount),
+                    b.getSequence());
+        });
+
+    std::size_t carried = 0;
+    for (auto const c : clean)
+    {
+        try
+        {
+            if (! ledger.txExists(c->tx->getTransactionID()) &&
+                reapply(app, view, *c->tx,
+                    flags | tapRETRY, j_).second)
+            {
+                ++carried;
+                continue;
+            }
+        }
+        catch(std::exception const&)
+        {
+            JLOG(j_.error()) <<
+                "Caught exception";
+        }
+        rest.push_back(c->tx);
+    }
+
+    JLOG(j_.debug()) <<
+        "carried " << carried << " of " <<
+        candidates.size() << " open ledger transactions";
+
+    apply (app, view, ledger, rest, retries, flags, j_);
+}
+
+//------------------------------------------------------------------------------
+
 std::shared_ptr<OpenView>
 OpenLedger::create (Rules const& rules,
     std::shared_ptr<Ledger const> const& ledger)
@@ -162,6 +406,17 @@ OpenLedger::apply_one (Application& app, OpenView& view,
 
 //------------------------------------------------------------------------------
 
+OpenLedger::Setup
+setup_OpenLedger (Config const& config)
+{
+    OpenLedger::Setup setup;
+    auto const& section = config.section("open_ledger");
+    set(setup.incremental, "incremental", section);
+    return setup;
+}
+
+//------------------------------------------------------------------------------
+
 std::string
 debugTxstr (std::shared_ptr<STTx const> const& tx)
 {
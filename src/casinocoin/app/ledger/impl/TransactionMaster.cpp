@@ -27,6 +27,7 @@
 #include <casinocoin/app/ledger/TransactionMaster.h>
 #include <casinocoin/app/misc/Transaction.h>
 #include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/main/CollectorManager.h>
 #include <casinocoin/protocol/STTx.h>
 #include <casinocoin/basics/Log.h>
 #include <casinocoin/basics/chrono.h>
@@ -36,7 +37,8 @@ namespace casinocoin {
 TransactionMaster::TransactionMaster (Application& app)
     : mApp (app)
     , mCache ("TransactionCache", 65536, 1800, stopwatch(),
-        mApp.journal("TaggedCache"))
+        mApp.journal("TaggedCache"),
+            mApp.getCollectorManager ().collector ())
 {
 }
 
@@ -53,11 +53,15 @@
 #include <casinocoin/basics/Sustain.h>
 #include <casinocoin/json/json_reader.h>
 #include <casinocoin/core/DeadlineTimer.h>
+#include <casinocoin/core/PerfLog.h>
 #include <casinocoin/nodestore/DummyScheduler.h>
+#include <casinocoin/nodestore/Manager.h>
 #include <casinocoin/overlay/Cluster.h>
 #include <casinocoin/overlay/make_Overlay.h>
 #include <casinocoin/protocol/STParsedJSON.h>
+#include <casinocoin/protocol/SignatureCache.h>
 #include <casinocoin/resource/Fees.h>
+#include <casinocoin/shamap/TreeNodeSnapshot.h>
 #include <casinocoin/beast/asio/io_latency_probe.h>
 #include <casinocoin/beast/core/LexicalCast.h>
 #include <fstream>
@@ -108,7 +112,7 @@ public:
             CollectorManager& collectorManager)
         : app_ (app)
         , treecache_ ("TreeNodeCache", 65536, 60, stopwatch(),
-            app.journal("TaggedCache"))
+            app.journal("TaggedCache"), collectorManager.collector())
         , fullbelow_ ("full_below", stopwatch(),
             collectorManager.collector(),
                 fullBelowTargetSize, fullBelowExpirationSeconds)
@@ -294,7 +298,9 @@ public:
     std::unique_ptr<TimeKeeper> timeKeeper_;
 
     beast::Journal m_journal;
-    Application::MutexType m_masterMutex;
+    Application::MutexType m_masterMutex {"Application::masterMutex"};
+
+    std::unique_ptr <CollectorManager> m_collectorManager;
 
     // Required by the SHAMapStore
     TransactionMaster m_txMaster;
@@ -307,16 +313,19 @@ public:
 
     // These are not Stoppable-derived
     NodeCache m_tempNodeCache;
-    std::unique_ptr <CollectorManager> m_collectorManager;
     CachedSLEs cachedSLEs_;
     std::pair<PublicKey, SecretKey> nodeIdentity_;
 
     std::unique_ptr <Resource::Manager> m_resourceManager;
 
     // These are Stoppable-related
+    std::unique_ptr <perf::PerfLog> perfLog_;
     std::unique_ptr <JobQueue> m_jobQueue;
     std::unique_ptr <NodeStore::Database> m_nodeStore;
+    std::unique_ptr <NodeStore::Database> shardStore_;
+    NodeStore::DatabaseShard* shards_ = nullptr;
     detail::AppFamily family_;
+    std::unique_ptr <detail::AppFamily> shardFamily_;
     // VFALCO TODO Make OrderBookDB abstract
     OrderBookDB m_orderBookDB;
     std::unique_ptr <PathRequests> m_pathRequests;
@@ -341,6 +350,10 @@ public:
     DeadlineTimer m_entropyTimer;
     bool startTimers_;
 
+    // Nodes read from the tree node snapshot, held in the
+    // cache until the server has validated a ledger itself.
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> snapshotNodes_;
+
     std::unique_ptr <DatabaseCon> mTxnDB;
     std::unique_ptr <DatabaseCon> mLedgerDB;
     std::unique_ptr <DatabaseCon> mWalletDB;
@@ -383,9 +396,12 @@ public:
 
         , m_journal (logs_->journal("Application"))
 
+        , m_collectorManager (CollectorManager::New (
+            config_->section (SECTION_INSIGHT), logs_->journal("Collector")))
+
         , m_txMaster (*this)
 
-        , m_nodeStoreScheduler (*this)
+        , m_nodeStoreScheduler (*this, m_collectorManager->group ("nodestore"))
 
         , m_shaMapStore (make_SHAMapStore (*this, setup_SHAMapStore (*config_),
             *this, m_nodeStoreScheduler,
@@ -395,22 +411,24 @@ public:
         , accountIDCache_(128000)
 
         , m_tempNodeCache ("NodeCache", 16384, 90, stopwatch(),
-            logs_->journal("TaggedCache"))
-
-        , m_collectorManager (CollectorManager::New (
-            config_->section (SECTION_INSIGHT), logs_->journal("Collector")))
+            logs_->journal("TaggedCache"), m_collectorManager->collector ())
 
         , cachedSLEs_ (std::chrono::minutes(1), stopwatch())
 
         , m_resourceManager (Resource::make_Manager (
             m_collectorManager->collector(), logs_->journal("Resource")))
 
+        , perfLog_ (perf::make_PerfLog (
+            perf::setup_PerfLog (config_->section (SECTION_PERF),
+                config_->getConfigDir ()),
+            *this, logs_->journal ("PerfLog")))
+
         // The JobQueue has to come pretty early since
         // almost everything is a Stoppable child of the JobQueue.
         //
         , m_jobQueue (std::make_unique<JobQueue>(
             m_collectorManager->group ("jobq"), m_nodeStoreScheduler,
-            logs_->journal("JobQueue"), *logs_))
+            logs_->journal("JobQueue"), *logs_, *perfLog_))
 
         //
         // Anything which calls addJob must be a descendant of the JobQueue
@@ -446,7 +464,7 @@ public:
             }))
 
         , m_acceptedLedgerCache ("AcceptedLedger", 4, 60, stopwatch(),
-            logs_->journal("TaggedCache"))
+            logs_->journal("TaggedCache"), m_collectorManager->collector ())
 
         , m_networkOPs (make_NetworkOPs (*this, stopwatch(),
             config_->standalone(), config_->NETWORK_QUORUM, config_->START_VALID,
@@ -481,7 +499,8 @@ public:
 
         , m_loadManager (make_LoadManager (*this, *this, logs_->journal("LoadManager")))
 
-        , txQ_(make_TxQ(setup_TxQ(*config_), logs_->journal("TxQ")))
+        , txQ_(make_TxQ(setup_TxQ(*config_), logs_->journal("TxQ"),
+            m_collectorManager->group ("txq")))
 
         , m_sweepTimer (this)
 
@@ -515,6 +534,19 @@ public:
         //  started in this constructor.
         //
 
+        if (config_->exists (ConfigSection::shardDatabase ()))
+        {
+            auto shards = NodeStore::Manager::instance().make_DatabaseShard (
+                "ShardStore", m_nodeStoreScheduler, 4, *m_jobQueue,
+                config_->section (ConfigSection::shardDatabase ()),
+                logs_->journal ("ShardStore"));
+            shards_ = shards.get ();
+            shardStore_.reset (
+                dynamic_cast <NodeStore::Database*> (shards.release ()));
+            shardFamily_ = std::make_unique <detail::AppFamily> (
+                *this, *shardStore_, *m_collectorManager);
+        }
+
         // VFALCO HACK
         m_nodeStoreScheduler.setJobQueue (*m_jobQueue);
 
@@ -568,6 +600,11 @@ public:
         return *m_jobQueue;
     }
 
+    perf::PerfLog& getPerfLog () override
+    {
+        return *perfLog_;
+    }
+
     std::pair<PublicKey, SecretKey> const&
     nodeIdentity () override
     {
@@ -630,6 +667,16 @@ public:
         return *m_nodeStore;
     }
 
+    NodeStore::DatabaseShard* getShardStore () override
+    {
+        return shards_;
+    }
+
+    Family* shardFamily () override
+    {
+        return shardFamily_.get ();
+    }
+
     Application::MutexType& getMasterMutex () override
     {
         return m_masterMutex;
@@ -861,6 +908,8 @@ public:
 
         mValidations->flush ();
 
+        saveTreeSnapshot ();
+
         validatorSites_->stop ();
 
         // TODO Store manifests in manifests.sqlite instead of wallet.db
@@ -927,9 +976,21 @@ public:
         // VFALCO TODO fix the dependency inversion using an observer,
         //         have listeners register for "onSweep ()" notification.
 
+        if (! snapshotNodes_.empty () && m_ledgerMaster->getValidatedLedger ())
+        {
+            JLOG(m_journal.debug()) << "Releasing tree node snapshot";
+            snapshotNodes_.clear ();
+        }
+
         family().fullbelow().sweep ();
         getMasterTransaction().sweep();
         getNodeStore().sweep();
+        if (shardStore_)
+        {
+            shardStore_->sweep();
+            shardFamily_->fullbelow().sweep();
+            shardFamily_->treecache().sweep();
+        }
         getLedgerMaster().sweep();
         getTempNodeCache().sweep();
         getValidations().sweep();
@@ -950,6 +1011,10 @@ private:
     bool updateTables ();
     void startGenesisLedger ();
 
+    boost::filesystem::path treeSnapshotPath () const;
+    void loadTreeSnapshot ();
+    void saveTreeSnapshot ();
+
     std::shared_ptr<Ledger>
     getLastFullLedger();
 
@@ -1043,6 +1108,8 @@ bool ApplicationImp::setup()
 
     Pathfinder::initPathTable();
 
+    loadTreeSnapshot ();
+
     auto const startUp = config_->START_UP;
     if (startUp == Config::FRESH)
     {
@@ -1154,9 +1221,21 @@ bool ApplicationImp::setup()
     }
 
     m_nodeStore->tune (config_->getSize (siNodeCacheSize), config_->getSize (siNodeCacheAge));
+    if (shardStore_)
+    {
+        if (! shards_->init ())
+        {
+            JLOG(m_journal.fatal()) << "Cannot open the shard store!";
+            return false;
+        }
+        shardStore_->tune (config_->getSize (siNodeCacheSize),
+            config_->getSize (siNodeCacheAge));
+    }
     m_ledgerMaster->tune (config_->getSize (siLedgerSize), config_->getSize (siLedgerAge));
     family().treecache().setTargetSize (config_->getSize (siTreeCacheSize));
     family().treecache().setTargetAge (config_->getSize (siTreeCacheAge));
+    SignatureCache::instance ().setCapacity (
+        config_->getSize (siSignatureCacheSize));
 
     //----------------------------------------------------------------------
     //
@@ -1321,6 +1400,10 @@ int ApplicationImp::fdlimit() const
     // doubled if online delete is enabled).
     needed += std::max(5, m_shaMapStore->fdlimit());
 
+    // Each history shard has its own backend
+    if (shardStore_)
+        needed += shardStore_->fdlimit();
+
     // One fd per incoming connection a port can accept, or
     // if no limit is set, assume it'll handle 256 clients.
     for(auto const& p : serverHandler_->setup().ports)
@@ -1332,6 +1415,56 @@ int ApplicationImp::fdlimit() const
 
 //------------------------------------------------------------------------------
 
+boost::filesystem::path
+ApplicationImp::treeSnapshotPath () const
+{
+    if (! get<bool> (config_->section (ConfigSection::nodeDatabase ()),
+            "cache_snapshot", false))
+    {
+        return {};
+    }
+
+    auto const dbPath = config_->legacy ("database_path");
+    if (dbPath.empty ())
+        return {};
+    return boost::filesystem::path (dbPath) / "treenodes.dat";
+}
+
+void
+ApplicationImp::loadTreeSnapshot ()
+{
+    auto const path = treeSnapshotPath ();
+    if (path.empty ())
+        return;
+
+    auto snapshot = loadTreeNodeSnapshot (
+        path, family(), journal ("TreeNodeSnapshot"));
+    snapshotNodes_ = std::move (snapshot.nodes);
+}
+
+void
+ApplicationImp::saveTreeSnapshot ()
+{
+    auto const path = treeSnapshotPath ();
+    auto const ledger = m_ledgerMaster->getValidatedLedger ();
+    if (path.empty () || ! ledger)
+        return;
+
+    // Nodes past the size of the tree cache would not stay in it
+    try
+    {
+        saveTreeNodeSnapshot (path, ledger->stateMap (), ledger->info().seq,
+            config_->getSize (siTreeCacheSize));
+        JLOG(m_journal.info()) <<
+            "Saved tree node snapshot of ledger " << ledger->info().seq;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(m_journal.warn()) <<
+            "Unable to save tree node snapshot: " << e.what ();
+    }
+}
+
 void
 ApplicationImp::startGenesisLedger()
 {
@@ -1353,7 +1486,8 @@ ApplicationImp::startGenesisLedger()
     next->updateSkipList ();
     next->setImmutable (*config_);
     openLedger_.emplace(next, cachedSLEs_,
-        logs_->journal("OpenLedger"));
+        logs_->journal("OpenLedger"),
+            setup_OpenLedger(*config_));
     m_ledgerMaster->storeLedger(next);
     m_ledgerMaster->switchLCL (next);
 }
@@ -1640,7 +1774,9 @@ bool ApplicationImp::loadOldLedger (
             return false;
         }
 
-        if (!loadLedger->walkLedger (journal ("Ledger")))
+        // Nothing else is running yet, so the check can use every core
+        if (!loadLedger->walkLedger (journal ("Ledger"),
+            std::max (1u, std::thread::hardware_concurrency ())))
         {
             JLOG(m_journal.fatal()) << "Ledger is missing nodes.";
             assert(false);
@@ -1662,7 +1798,8 @@ bool ApplicationImp::loadOldLedger (
         loadLedger->setValidated();
         m_ledgerMaster->setFullLedger(loadLedger, true, false);
         openLedger_.emplace(loadLedger, cachedSLEs_,
-            logs_->journal("OpenLedger"));
+            logs_->journal("OpenLedger"),
+                setup_OpenLedger(*config_));
 
         if (replay)
         {
@@ -1944,16 +2081,26 @@ bool ApplicationImp::updateTables ()
     {
         auto j = logs_->journal("NodeObject");
         NodeStore::DummyScheduler scheduler;
+        auto const& section =
+            config_->section(ConfigSection::importNodeDatabase ());
         std::unique_ptr <NodeStore::Database> source =
             NodeStore::Manager::instance().make_Database ("NodeStore.import",
-                scheduler, 0, *m_jobQueue,
-                config_->section(ConfigSection::importNodeDatabase ()), j);
+                scheduler, 0, *m_jobQueue, section, j);
+
+        NodeStore::ImportOptions options;
+        options.threads = get<int> (section, "threads",
+            std::max (1u, std::thread::hardware_concurrency ()));
+        options.verify = get<bool> (section, "verify", options.verify);
+        options.checkpoint = get<std::string> (section, "checkpoint",
+            (boost::filesystem::path (config_->legacy ("database_path")) /
+                "import.checkpoint").string ());
 
         JLOG (j.warn())
             << "Node import from '" << source->getName () << "' to '"
-            << getNodeStore ().getName () << "'.";
+            << getNodeStore ().getName () << "' with "
+            << options.threads << " threads.";
 
-        getNodeStore().import (*source);
+        getNodeStore().import (*source, options);
     }
 
     return true;
@@ -28,6 +28,7 @@
 
 #include <casinocoin/shamap/FullBelowCache.h>
 #include <casinocoin/shamap/TreeNodeCache.h>
+#include <casinocoin/basics/ProfiledMutex.h>
 #include <casinocoin/basics/TaggedCache.h>
 #include <casinocoin/core/Config.h>
 #include <casinocoin/beast/utility/PropertyStream.h>
@@ -40,7 +41,8 @@ namespace casinocoin {
 
 namespace unl { class Manager; }
 namespace Resource { class Manager; }
-namespace NodeStore { class Database; }
+namespace NodeStore { class Database; class DatabaseShard; }
+namespace perf { class PerfLog; }
 
 // VFALCO TODO Fix forward declares required for header dependency loops
 class AmendmentTable;
@@ -94,7 +96,7 @@ public:
 
         other things
     */
-    using MutexType = std::recursive_mutex;
+    using MutexType = ProfiledMutex <std::recursive_mutex>;
     virtual MutexType& getMasterMutex () = 0;
 
 public:
@@ -127,6 +129,7 @@ public:
     virtual HashRouter&             getHashRouter () = 0;
     virtual LoadFeeTrack&           getFeeTrack () = 0;
     virtual LoadManager&            getLoadManager () = 0;
+    virtual perf::PerfLog&          getPerfLog () = 0;
     virtual Overlay&                overlay () = 0;
     virtual TxQ&                    getTxQ() = 0;
     virtual ValidatorList&          validators () = 0;
@@ -136,6 +139,11 @@ public:
     virtual Cluster&                cluster () = 0;
     virtual Validations&            getValidations () = 0;
     virtual NodeStore::Database&    getNodeStore () = 0;
+    /** The history shard store, or nullptr if [shard_db] isn't configured. */
+    virtual NodeStore::DatabaseShard* getShardStore () = 0;
+    /** The family of ledgers loaded from the history shard store, or
+        nullptr if [shard_db] isn't configured. */
+    virtual Family*                 shardFamily() = 0;
     virtual InboundLedgers&         getInboundLedgers () = 0;
     virtual InboundTransactions&    getInboundTransactions () = 0;
     virtual TaggedCache <uint256, AcceptedLedger>&
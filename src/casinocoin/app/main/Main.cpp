@@ -154,6 +154,7 @@ void printHelp (const po::options_description& desc)
            "     log_level [[<partition>] <severity>]\n"
            "     logrotate \n"
            "     peers\n"
+           "     perf\n"
            "     ping\n"
            "     random\n"
            "     casincoin ...\n"
@@ -29,10 +29,24 @@
 
 namespace casinocoin {
 
-NodeStoreScheduler::NodeStoreScheduler (Stoppable& parent)
+NodeStoreScheduler::Stats::Stats (
+        beast::insight::Collector::ptr const& collector)
+    : fetches (collector->make_counter ("fetches"))
+    , cache_hits (collector->make_counter ("cache_hits"))
+    , backend_misses (collector->make_counter ("backend_misses"))
+    , read_sync (collector->make_event ("read_sync"))
+    , read_async (collector->make_event ("read_async"))
+    , writes (collector->make_counter ("writes"))
+    , write_batch (collector->make_event ("write_batch"))
+{
+}
+
+NodeStoreScheduler::NodeStoreScheduler (Stoppable& parent,
+        beast::insight::Collector::ptr const& collector)
     : Stoppable ("NodeStoreScheduler", parent)
     , m_jobQueue (nullptr)
     , m_taskCount (0)
+    , m_stats (collector)
 {
 }
 
@@ -69,14 +83,31 @@ void NodeStoreScheduler::doTask (NodeStore::Task& task)
 
 void NodeStoreScheduler::onFetch (NodeStore::FetchReport const& report)
 {
-    if (report.wentToDisk)
-        m_jobQueue->addLoadEvents (
-            report.isAsync ? jtNS_ASYNC_READ : jtNS_SYNC_READ,
-                1, report.elapsed);
+    ++m_stats.fetches;
+    if (! report.wentToDisk)
+    {
+        if (report.wasFound)
+            ++m_stats.cache_hits;
+        return;
+    }
+
+    if (! report.wasFound)
+        ++m_stats.backend_misses;
+    if (report.isAsync)
+        m_stats.read_async.notify (report.elapsed);
+    else
+        m_stats.read_sync.notify (report.elapsed);
+
+    m_jobQueue->addLoadEvents (
+        report.isAsync ? jtNS_ASYNC_READ : jtNS_SYNC_READ,
+            1, report.elapsed);
 }
 
 void NodeStoreScheduler::onBatchWrite (NodeStore::BatchWriteReport const& report)
 {
+    m_stats.writes.increment (report.writeCount);
+    m_stats.write_batch.notify (report.elapsed);
+
     m_jobQueue->addLoadEvents (jtNS_WRITE,
         report.writeCount, report.elapsed);
 }
@@ -29,6 +29,7 @@
 #include <casinocoin/nodestore/Scheduler.h>
 #include <casinocoin/core/JobQueue.h>
 #include <casinocoin/core/Stoppable.h>
+#include <casinocoin/beast/insight/Collector.h>
 #include <atomic>
 
 namespace casinocoin {
@@ -39,7 +40,8 @@ class NodeStoreScheduler
     , public Stoppable
 {
 public:
-    NodeStoreScheduler (Stoppable& parent);
+    NodeStoreScheduler (Stoppable& parent,
+        beast::insight::Collector::ptr const& collector);
 
     // VFALCO NOTE This is a temporary hack to solve the problem
     //             of circular dependency.
@@ -57,6 +59,23 @@ private:
 
     JobQueue* m_jobQueue;
     std::atomic <int> m_taskCount;
+
+    // Only fetches which went to the backend are timed
+    struct Stats
+    {
+        explicit
+        Stats (beast::insight::Collector::ptr const& collector);
+
+        beast::insight::Counter fetches;
+        beast::insight::Counter cache_hits;
+        beast::insight::Counter backend_misses;
+        beast::insight::Event read_sync;
+        beast::insight::Event read_async;
+        beast::insight::Counter writes;
+        beast::insight::Event write_batch;
+    };
+
+    Stats m_stats;
 };
 
 } // casinocoin
@@ -99,6 +99,22 @@ bool HashRouter::setFlags (uint256 const& key, int flags)
     return true;
 }
 
+void HashRouter::setResult (uint256 const& key, uint256 const& context,
+    int result)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+
+    emplace(key).first.setResult (context, result);
+}
+
+boost::optional<int> HashRouter::getResult (uint256 const& key,
+    uint256 const& context)
+{
+    std::lock_guard <std::mutex> lock (mutex_);
+
+    return emplace(key).first.getResult (context);
+}
+
 auto
 HashRouter::shouldRelay (uint256 const& key)
     -> boost::optional<std::set<PeerShortID>>
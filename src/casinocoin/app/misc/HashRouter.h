@@ -32,6 +32,7 @@
 #include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/beast/container/aged_unordered_map.h>
 #include <boost/optional.hpp>
+#include <vector>
 
 namespace casinocoin {
 
@@ -92,6 +93,28 @@ private:
             flags_ |= flagsToSet;
         }
 
+        /** Returns the result remembered for `context`, if any */
+        boost::optional<int> getResult (uint256 const& context) const
+        {
+            for (auto const& result : results_)
+                if (result.first == context)
+                    return result.second;
+            return boost::none;
+        }
+
+        void setResult (uint256 const& context, int result)
+        {
+            for (auto& r : results_)
+            {
+                if (r.first == context)
+                {
+                    r.second = result;
+                    return;
+                }
+            }
+            results_.emplace_back (context, result);
+        }
+
         /** Return set of peers we've relayed to and reset tracking */
         std::set<PeerShortID> releasePeerSet()
         {
@@ -119,6 +142,9 @@ private:
         // This could be generalized to a map, if more
         // than one flag needs to expire independently.
         boost::optional<Stopwatch::time_point> relayed_;
+        // Results of checks on the item, by context. Rarely
+        // more than one or two, so a vector is sufficient.
+        std::vector<std::pair<uint256, int>> results_;
     };
 
 public:
@@ -156,6 +182,19 @@ public:
 
     int getFlags (uint256 const& key);
 
+    /** Remember the result of a check on a hashed item.
+
+        Results are kept per `context`, a digest of whatever
+        besides the item itself the check depends on. They
+        expire together with the item's entry.
+    */
+    void setResult (uint256 const& key, uint256 const& context,
+        int result);
+
+    /** Returns a result remembered with `setResult`, if any. */
+    boost::optional<int> getResult (uint256 const& key,
+        uint256 const& context);
+
     /** Determines whether the hashed item should be relayed.
 
         Effects:
@@ -39,12 +39,14 @@
 #include <casinocoin/app/main/LoadManager.h>
 #include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
+#include <casinocoin/app/misc/SHAMapStore.h>
 #include <casinocoin/app/misc/Transaction.h>
 #include <casinocoin/app/misc/TxQ.h>
 #include <casinocoin/app/misc/ValidatorList.h>
 #include <casinocoin/app/misc/impl/AccountTxPaging.h>
 #include <casinocoin/app/tx/apply.h>
 #include <casinocoin/basics/mulDiv.h>
+#include <casinocoin/basics/ProfiledMutex.h>
 #include <casinocoin/basics/UptimeTimer.h>
 #include <casinocoin/core/ConfigSections.h>
 #include <casinocoin/core/DeadlineTimer.h>
@@ -52,6 +54,7 @@
 #include <casinocoin/crypto/csprng.h>
 #include <casinocoin/crypto/RFC1751.h>
 #include <casinocoin/json/to_string.h>
+#include <casinocoin/nodestore/DatabaseShard.h>
 #include <casinocoin/overlay/Cluster.h>
 #include <casinocoin/overlay/Overlay.h>
 #include <casinocoin/overlay/predicates.h>
@@ -531,7 +534,8 @@ private:
     using subRpcMapType = hash_map<std::string, InfoSub::pointer>;
 
     // XXX Split into more locks.
-    using ScopedLockType = std::lock_guard <std::recursive_mutex>;
+    using ScopedLockType =
+        std::lock_guard <ProfiledMutex <std::recursive_mutex>>;
 
     Application& app_;
     clock_type& m_clock;
@@ -539,7 +543,7 @@ private:
 
     std::unique_ptr <LocalTxs> m_localTX;
 
-    std::recursive_mutex mSubLock;
+    ProfiledMutex <std::recursive_mutex> mSubLock {"NetworkOPs::mSubLock"};
 
     std::atomic<OperatingMode> mMode;
 
@@ -977,7 +981,7 @@ void NetworkOPsImp::apply (std::unique_lock<std::mutex>& batchLock)
         auto lock = make_lock(app_.getMasterMutex());
         bool changed = false;
         {
-            std::lock_guard <std::recursive_mutex> lock (
+            std::lock_guard <LedgerMaster::mutex_type> lock (
                 m_ledgerMaster.peekMutex());
 
             app_.openLedger().modify(
@@ -2160,6 +2164,9 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
     info[jss::complete_ledgers] =
             app_.getLedgerMaster ().getCompleteLedgers ();
 
+    if (auto const shards = app_.getShardStore ())
+        info[jss::complete_shards] = shards->getCompleteShards ();
+
     if (m_amendmentBlocked)
         info[jss::amendment_blocked] = true;
 
@@ -2170,6 +2177,10 @@ Json::Value NetworkOPsImp::getServerInfo (bool human, bool admin)
 
     info[jss::peers] = Json::UInt (app_.overlay ().size ());
 
+    auto onlineDelete = app_.getSHAMapStore ().getInfo ();
+    if (!onlineDelete.isNull ())
+        info[jss::online_delete] = std::move (onlineDelete);
+
     Json::Value lastClose = Json::objectValue;
     lastClose[jss::proposers] = Json::UInt(mConsensus->prevProposers());
 
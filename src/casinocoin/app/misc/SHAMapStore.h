@@ -54,6 +54,8 @@ public:
         std::uint32_t deleteBatch = 100;
         std::uint32_t backOff = 100;
         std::int32_t ageThreshold = 60;
+        std::uint32_t copyThreads = 2;
+        std::uint32_t copyRate = 0;
     };
 
     SHAMapStore (Stoppable& parent) : Stoppable ("SHAMapStore", parent) {}
@@ -83,6 +85,9 @@ public:
 
     /** The number of files that are needed. */
     virtual int fdlimit() const = 0;
+
+    /** Progress of online delete, or null if it is not configured. */
+    virtual Json::Value getInfo() const = 0;
 };
 
 //------------------------------------------------------------------------------
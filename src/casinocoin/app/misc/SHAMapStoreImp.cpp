@@ -29,7 +29,10 @@
 #include <casinocoin/app/ledger/TransactionMaster.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
 #include <casinocoin/core/ConfigSections.h>
+#include <casinocoin/protocol/JsonFields.h>
 #include <casinocoin/beast/core/CurrentThreadName.h>
+#include <exception>
+#include <mutex>
 
 namespace casinocoin {
 void SHAMapStoreImp::SavedStateDB::init (BasicConfig const& config,
@@ -279,19 +282,120 @@ SHAMapStoreImp::fdlimit () const
     return fdlimit_;
 }
 
+Json::Value
+SHAMapStoreImp::getInfo() const
+{
+    if (!setup_.deleteInterval)
+        return Json::nullValue;
+
+    Json::Value ret (Json::objectValue);
+    ret[jss::last_rotated] = lastRotated_.load();
+    if (rotating_)
+        ret[jss::state] = "rotating";
+    else if (copying_)
+        ret[jss::state] = "copying";
+    else
+        ret[jss::state] = "idle";
+    if (auto const seq = syncedSeq_.load())
+        ret[jss::synced_ledger] = seq;
+    ret[jss::nodes_copied] = std::to_string (copied_);
+    return ret;
+}
+
 bool
-SHAMapStoreImp::copyNode (std::uint64_t& nodeCount,
-        SHAMapAbstractNode const& node)
+SHAMapStoreImp::copyNode (uint256 const& hash)
 {
-    // Copy a single record from node to database_
-    database_->fetchNode (node.getNodeHash().as_uint256());
-    if (! (++nodeCount % checkHealthInterval_))
+    // DatabaseRotating copies the record from the archive
+    // backend if the writable backend doesn't have it.
+    database_->fetchNode (hash);
+    auto const count = ++copied_;
+
+    if (setup_.copyRate)
     {
-        if (health())
-            return true;
+        using namespace std::chrono;
+        std::this_thread::sleep_until (copyStart_ +
+            microseconds (count * 1000000 / setup_.copyRate));
     }
 
-    return false;
+    if (! (count % checkHealthInterval_))
+        return health() == Health::ok;
+
+    return true;
+}
+
+bool
+SHAMapStoreImp::copyNodes (std::vector<uint256> const& hashes)
+{
+    startCopy();
+
+    std::atomic<std::size_t> next {0};
+    std::atomic<bool> stopped {false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto const work = [&]()
+    {
+        try
+        {
+            for (auto i = next++; i < hashes.size() && !stopped; i = next++)
+            {
+                if (!copyNode (hashes[i]))
+                    stopped = true;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (errorMutex);
+            if (!error)
+                error = std::current_exception();
+            stopped = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::uint32_t i = 1; i < setup_.copyThreads; ++i)
+        workers.emplace_back (work);
+    work();
+    for (auto& t : workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception (error);
+    return !stopped;
+}
+
+bool
+SHAMapStoreImp::copyState (std::shared_ptr<Ledger const> const& ledger)
+{
+    auto const snapshot = ledger->stateMap().snapShot (false);
+    if (synced_ && synced_->is_v2() != snapshot->is_v2())
+        synced_.reset();
+
+    startCopy();
+    copying_ = true;
+    bool const completed = snapshot->visitDifferences (synced_.get(),
+        [this](SHAMapAbstractNode& node)
+        {
+            return copyNode (node.getNodeHash().as_uint256());
+        }, setup_.copyThreads);
+    copying_ = false;
+
+    JLOG(journal_.debug()) << "copied ledger " << ledger->info().seq
+        << " nodecount " << copied_ << (completed ? "" : " (incomplete)");
+
+    if (completed)
+    {
+        synced_ = snapshot;
+        syncedSeq_ = ledger->info().seq;
+    }
+    return completed;
+}
+
+void
+SHAMapStoreImp::startCopy()
+{
+    copied_ = 0;
+    copyStart_ = std::chrono::steady_clock::now();
 }
 
 void
@@ -308,10 +412,12 @@ SHAMapStoreImp::run()
 
     if (setup_.advisoryDelete)
         canDelete_ = state_db_.getCanDelete ();
+    lastRotated_ = lastRotated;
 
     while (1)
     {
         healthy_ = true;
+        rotating_ = false;
         std::shared_ptr<Ledger const> validatedLedger;
 
         {
@@ -323,7 +429,7 @@ SHAMapStoreImp::run()
                 stopped();
                 return;
             }
-            cond_.wait (lock);
+            cond_.wait (lock, [this] { return stop_ || newLedger_; });
             if (newLedger_)
             {
                 validatedLedger = std::move(newLedger_);
@@ -336,6 +442,7 @@ SHAMapStoreImp::run()
         if (!lastRotated)
         {
             lastRotated = validatedSeq;
+            lastRotated_ = lastRotated;
             state_db_.setLastRotated (lastRotated);
         }
 
@@ -343,6 +450,7 @@ SHAMapStoreImp::run()
         if (validatedSeq >= lastRotated + setup_.deleteInterval
                 && canDelete_ >= lastRotated - 1)
         {
+            rotating_ = true;
             JLOG(journal_.debug()) << "rotating  validatedSeq " << validatedSeq
                     << " lastRotated " << lastRotated << " deleteInterval "
                     << setup_.deleteInterval << " canDelete_ " << canDelete_;
@@ -372,13 +480,8 @@ SHAMapStoreImp::run()
                     ;
             }
 
-            std::uint64_t nodeCount = 0;
-            validatedLedger->stateMap().snapShot (
-                    false)->visitNodes (
-                    std::bind (&SHAMapStoreImp::copyNode, this,
-                    std::ref(nodeCount), std::placeholders::_1));
-            JLOG(journal_.debug()) << "copied ledger " << validatedSeq
-                    << " nodecount " << nodeCount;
+            // Usually only the nodes of the last few ledgers are left
+            copyState (validatedLedger);
             switch (health())
             {
                 case Health::stopping:
@@ -427,6 +530,7 @@ SHAMapStoreImp::run()
             std::string nextArchiveDir =
                     database_->getWritableBackend()->getName();
             lastRotated = validatedSeq;
+            lastRotated_ = lastRotated;
             {
                 std::lock_guard <std::mutex> lock (database_->peekMutex());
 
@@ -435,10 +539,24 @@ SHAMapStoreImp::run()
                 clearCaches (validatedSeq);
                 oldBackend = database_->rotateBackends (newBackend);
             }
+            // The synced state is now in the archive backend, which the
+            // next rotation deletes, so the first pass after a rotation
+            // copies the whole tree into the new writable backend. Later
+            // passes only copy what changed since that one.
+            synced_.reset();
+            syncedSeq_ = 0;
             JLOG(journal_.debug()) << "finished rotation " << validatedSeq;
 
             oldBackend->setDeletePath();
         }
+        else if (netOPs_->getOperatingMode() == NetworkOPs::omFULL)
+        {
+            // Between rotations, keep copying the validated state into
+            // the writable backend. Each pass only visits the nodes
+            // that changed since the last one, so by the time we
+            // rotate there is little left to do.
+            copyState (validatedLedger);
+        }
     }
 }
 
@@ -754,9 +872,13 @@ SHAMapStoreImp::health()
     auto age = ledgerMaster_->getValidatedLedgerAge();
     if (mode != NetworkOPs::omFULL || age.count() >= setup_.ageThreshold)
     {
-        JLOG(journal_.warn()) << "Not deleting. state: " << mode
-                               << " age " << age.count()
-                               << " age threshold " << setup_.ageThreshold;
+        // A copy between rotations just picks up again with the
+        // next validated ledger, so only a rotation is worth a warning
+        auto const stream = rotating_ ? journal_.warn() : journal_.debug();
+        JLOG(stream) << (rotating_ ? "Not deleting" : "Not copying")
+                     << ". state: " << mode
+                     << " age " << age.count()
+                     << " age threshold " << setup_.ageThreshold;
         healthy_ = false;
     }
 
@@ -830,6 +952,10 @@ setup_SHAMapStore (Config const& c)
     get_if_exists (setup.nodeDatabase, "delete_batch", setup.deleteBatch);
     get_if_exists (setup.nodeDatabase, "backOff", setup.backOff);
     get_if_exists (setup.nodeDatabase, "age_threshold", setup.ageThreshold);
+    get_if_exists (setup.nodeDatabase, "copy_threads", setup.copyThreads);
+    get_if_exists (setup.nodeDatabase, "copy_rate", setup.copyRate);
+    if (setup.copyThreads < 1)
+        setup.copyThreads = 1;
 
     return setup;
 }
@@ -30,6 +30,8 @@
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/core/DatabaseCon.h>
 #include <casinocoin/nodestore/DatabaseRotating.h>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <thread>
 
@@ -97,7 +99,7 @@ private:
     SavedStateDB state_db_;
     std::thread thread_;
     bool stop_ = false;
-    bool healthy_ = true;
+    std::atomic<bool> healthy_ {true};
     mutable std::condition_variable cond_;
     mutable std::condition_variable rendezvous_;
     mutable std::mutex mutex_;
@@ -115,6 +117,17 @@ private:
     DatabaseCon* ledgerDb_ = nullptr;
     int fdlimit_ = 0;
 
+    // The most recent state map known to be entirely in the writable
+    // backend. Only nodes which differ from it need to be copied.
+    std::shared_ptr<SHAMap const> synced_;
+    std::atomic<LedgerIndex> syncedSeq_ {0};
+    std::atomic<LedgerIndex> lastRotated_ {0};
+    std::atomic<bool> copying_ {false};
+    std::atomic<bool> rotating_ {false};
+    // nodes visited by the current (or last) copy pass
+    std::atomic<std::uint64_t> copied_ {0};
+    std::chrono::steady_clock::time_point copyStart_;
+
 public:
     SHAMapStoreImp (Application& app,
             Setup const& setup,
@@ -177,9 +190,17 @@ public:
     void rendezvous() const override;
     int fdlimit() const override;
 
+    Json::Value getInfo() const override;
+
 private:
-    // callback for visitNodes
-    bool copyNode (std::uint64_t& nodeCount, SHAMapAbstractNode const &node);
+    // Copy a record to the writable backend unless it's there already.
+    // Returns false if copying should stop.
+    bool copyNode (uint256 const& hash);
+    // Copy the records on copyThreads threads
+    bool copyNodes (std::vector<uint256> const& hashes);
+    // Copy the ledger's state nodes which differ from synced_
+    bool copyState (std::shared_ptr<Ledger const> const& ledger);
+    void startCopy();
     void run();
     void dbPaths();
     std::shared_ptr <NodeStore::Backend> makeBackendRotating (
@@ -205,16 +226,7 @@ private:
     bool
     freshenCache (CacheInstance& cache)
     {
-        std::uint64_t check = 0;
-
-        for (auto const& key: cache.getKeys())
-        {
-            database_->fetchNode (key);
-            if (! (++check % checkHealthInterval_) && health())
-                return true;
-        }
-
-        return false;
+        return ! copyNodes (cache.getKeys());
     }
 
     /** delete from sqlite table in batches to not lock the db excessively
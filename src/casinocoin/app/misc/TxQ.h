@@ -27,11 +27,15 @@
 #define CASINOCOIN_TXQ_H_INCLUDED
 
 #include <casinocoin/app/tx/applySteps.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/beast/insight/Collector.h>
 #include <casinocoin/ledger/OpenView.h>
 #include <casinocoin/ledger/ApplyView.h>
 #include <casinocoin/protocol/TER.h>
 #include <casinocoin/protocol/STTx.h>
+#include <boost/container/flat_map.hpp>
 #include <boost/intrusive/set.hpp>
+#include <memory>
 
 namespace casinocoin {
 
@@ -112,7 +116,8 @@ public:
     };
 
     TxQ(Setup const& setup,
-        beast::Journal j);
+        beast::Journal j,
+        beast::insight::Collector::ptr const& collector);
 
     virtual ~TxQ();
 
@@ -285,7 +290,8 @@ private:
     public:
         // Used by the TxQ::FeeHook and TxQ::FeeMultiSet below
         // to put each MaybeTx object into more than one
-        // set without copies, pointers, etc.
+        // set without copies, pointers, etc. The object
+        // itself is owned by its TxQAccount.
         boost::intrusive::set_member_hook<> byFeeListHook;
 
         std::shared_ptr<STTx const> txn;
@@ -343,7 +349,14 @@ private:
     class TxQAccount
     {
     public:
-        using TxMap = std::map <TxSeq, MaybeTx>;
+        /* An account can only hold a few transactions
+            (see Setup::maximumTxnPerAccount), so keep them in a
+            contiguous array sorted by sequence. The MaybeTx objects
+            are allocated separately so their addresses stay stable
+            while they are linked into the fee ordering.
+        */
+        using TxMap = boost::container::flat_map <TxSeq,
+            std::unique_ptr<MaybeTx>>;
 
         AccountID const account;
         // Sequence number will be used as the key.
@@ -394,7 +407,7 @@ private:
         < MaybeTx, FeeHook,
         boost::intrusive::compare <GreaterFee> >;
 
-    using AccountMap = std::map <AccountID, TxQAccount>;
+    using AccountMap = hardened_hash_map <AccountID, TxQAccount>;
 
     Setup const setup_;
     beast::Journal j_;
@@ -406,11 +419,45 @@ private:
     AccountMap byAccount_;
     boost::optional<size_t> maxSize_;
 
+    // The fee level an open ledger transaction needed when one
+    // was last applied. Only accessed under locked mutex_.
+    std::uint64_t openLedgerFeeLevel_;
+
     // Most queue operations are done under the master lock,
     // but use this mutex for the RPC "fee" command, which isn't.
     std::mutex mutable mutex_;
 
+    struct Stats
+    {
+        template <class Handler>
+        Stats (Handler const& handler,
+                beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , count (collector->make_gauge ("count"))
+            , max_size (collector->make_gauge ("max_size"))
+            , expected_size (collector->make_gauge ("expected_size"))
+            , min_fee_level (collector->make_gauge ("min_fee_level"))
+            , median_fee_level (collector->make_gauge ("median_fee_level"))
+            , open_ledger_fee_level (
+                collector->make_gauge ("open_ledger_fee_level"))
+        {
+        }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge count;
+        beast::insight::Gauge max_size;
+        beast::insight::Gauge expected_size;
+        beast::insight::Gauge min_fee_level;
+        beast::insight::Gauge median_fee_level;
+        beast::insight::Gauge open_ledger_fee_level;
+    };
+
+    Stats stats_;
+
 private:
+    void
+    collect_metrics();
+
     template<size_t fillPercentage = 100>
     bool
     isFull() const;
@@ -449,7 +496,8 @@ TxQ::Setup
 setup_TxQ(Config const&);
 
 std::unique_ptr<TxQ>
-make_TxQ(TxQ::Setup const&, beast::Journal);
+make_TxQ(TxQ::Setup const&, beast::Journal,
+    beast::insight::Collector::ptr const&);
 
 } // casinocoin
 
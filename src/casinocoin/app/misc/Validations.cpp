@@ -29,6 +29,7 @@
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/consensus/LedgerTiming.h>
 #include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/main/CollectorManager.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
 #include <casinocoin/app/misc/ValidatorList.h>
 #include <casinocoin/basics/Log.h>
@@ -83,7 +84,8 @@ public:
     ValidationsImp (Application& app)
         : app_ (app)
         , mValidations ("Validations", 4096, 600, stopwatch(),
-            app.journal("TaggedCache"))
+            app.journal("TaggedCache"),
+                app.getCollectorManager ().collector ())
         , mWriting (false)
         , j_ (app.journal ("Validations"))
     {
@@ -279,11 +279,12 @@ TxQ::TxQAccount::add(MaybeTx&& txn)
 {
     auto sequence = txn.sequence;
 
-    auto result = transactions.emplace(sequence, std::move(txn));
+    auto result = transactions.emplace(sequence,
+        std::make_unique<MaybeTx>(std::move(txn)));
     assert(result.second);
-    assert(&result.first->second != &txn);
+    assert(result.first->second.get() != &txn);
 
-    return result.first->second;
+    return *result.first->second;
 }
 
 bool
@@ -295,19 +296,40 @@ TxQ::TxQAccount::remove(TxSeq const& sequence)
 //////////////////////////////////////////////////////////////////////////
 
 TxQ::TxQ(Setup const& setup,
-    beast::Journal j)
+    beast::Journal j,
+    beast::insight::Collector::ptr const& collector)
     : setup_(setup)
     , j_(j)
     , feeMetrics_(setup, j)
     , maxSize_(boost::none)
+    , openLedgerFeeLevel_(baseLevel)
+    , stats_(std::bind(&TxQ::collect_metrics, this), collector)
 {
 }
 
 TxQ::~TxQ()
 {
+    // Must unhook before destroying
+    stats_.hook = beast::insight::Hook();
     byFee_.clear();
 }
 
+void
+TxQ::collect_metrics()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto const snapshot = feeMetrics_.getSnapshot();
+
+    stats_.count = byFee_.size();
+    stats_.max_size = maxSize_.value_or(0);
+    stats_.expected_size = snapshot.txnsExpected;
+    stats_.min_fee_level = isFull() ? byFee_.rbegin()->feeLevel + 1 :
+        baseLevel;
+    stats_.median_fee_level = snapshot.escalationMultiplier;
+    stats_.open_ledger_fee_level = openLedgerFeeLevel_;
+}
+
 template<size_t fillPercentage>
 bool
 TxQ::isFull() const
@@ -380,7 +402,7 @@ TxQ::eraseAndAdvance(TxQ::FeeMultiSet::const_iterator_type candidateIter)
         candidateIter->sequence);
     assert(accountIter != txQAccount.transactions.end());
     assert(accountIter == txQAccount.transactions.begin());
-    assert(byFee_.iterator_to(accountIter->second) == candidateIter);
+    assert(byFee_.iterator_to(*accountIter->second) == candidateIter);
     auto const accountNextIter = std::next(accountIter);
     /* Check if the next transaction for this account has the
         next sequence number, and a higher fee level, which means
@@ -399,11 +421,15 @@ TxQ::eraseAndAdvance(TxQ::FeeMultiSet::const_iterator_type candidateIter)
     bool const useAccountNext = accountNextIter != txQAccount.transactions.end() &&
         accountNextIter->first == candidateIter->sequence + 1 &&
             (feeNextIter == byFee_.end() ||
-                accountNextIter->second.feeLevel > feeNextIter->feeLevel);
+                accountNextIter->second->feeLevel > feeNextIter->feeLevel);
+    // Erasing from the TxMap shifts the later entries,
+    // so hold on to the object itself.
+    auto const accountNext = useAccountNext ?
+        accountNextIter->second.get() : nullptr;
     auto const candidateNextIter = byFee_.erase(candidateIter);
     txQAccount.transactions.erase(accountIter);
-    return useAccountNext ?
-        byFee_.iterator_to(accountNextIter->second) :
+    return accountNext ?
+        byFee_.iterator_to(*accountNext) :
             candidateNextIter;
 
 }
@@ -416,7 +442,7 @@ TxQ::erase(TxQ::TxQAccount& txQAccount,
 {
     for (auto it = begin; it != end; ++it)
     {
-        byFee_.erase(byFee_.iterator_to(it->second));
+        byFee_.erase(byFee_.iterator_to(*it->second));
     }
     return txQAccount.transactions.erase(begin, end);
 }
@@ -450,7 +476,7 @@ TxQ::tryClearAccountQueue(Application& app, OpenView& view,
         feeLevelPaid,
         [](auto const& total, auto const& tx)
         {
-            return total + tx.second.feeLevel;
+            return total + tx.second->feeLevel;
         });
 
     // This transaction did not pay enough, so fall back to the normal process.
@@ -461,13 +487,13 @@ TxQ::tryClearAccountQueue(Application& app, OpenView& view,
     // Attempt to apply the queued transactions.
     for (auto it = beginTxIter; it != endTxIter; ++it)
     {
-        auto txResult = it->second.apply(app, view);
+        auto txResult = it->second->apply(app, view);
         // Succeed or fail, use up a retry, because if the overall
         // process fails, we want the attempt to count. If it all
         // succeeds, the MaybeTx will be destructed, so it'll be
         // moot.
-        --it->second.retriesRemaining;
-        it->second.lastResult = txResult.first;
+        --it->second->retriesRemaining;
+        it->second->lastResult = txResult.first;
         if (!txResult.second)
         {
             // Transaction failed to apply. Fall back to the normal process.
@@ -612,6 +638,7 @@ TxQ::apply(Application& app, OpenView& view,
         baseLevel, baseFee, setup_);
     auto const requiredFeeLevel = FeeMetrics::scaleFeeLevel(
         j_, metricsSnapshot, view);
+    openLedgerFeeLevel_ = requiredFeeLevel;
 
     auto accountIter = byAccount_.find(account);
     bool const accountExists = accountIter != byAccount_.end();
@@ -627,17 +654,17 @@ TxQ::apply(Application& app, OpenView& view,
             // Is the current transaction's fee higher than
             // the queued transaction's fee + a percentage
             auto requiredRetryLevel = increase(
-                existingIter->second.feeLevel,
+                existingIter->second->feeLevel,
                     setup_.retrySequencePercent);
             JLOG(j_.trace()) << "Found transaction in queue for account " <<
                 account << " with sequence number " << tSeq <<
                 " new txn fee level is " << feeLevelPaid <<
                 ", old txn fee level is " <<
-                existingIter->second.feeLevel <<
+                existingIter->second->feeLevel <<
                 ", new txn needs fee level of " <<
                 requiredRetryLevel;
             if (feeLevelPaid > requiredRetryLevel
-                || (existingIter->second.feeLevel < requiredFeeLevel &&
+                || (existingIter->second->feeLevel < requiredFeeLevel &&
                     feeLevelPaid >= requiredFeeLevel &&
                     existingIter == txQAcct.transactions.begin()))
             {
@@ -655,12 +682,12 @@ TxQ::apply(Application& app, OpenView& view,
                     // !consequences, but an expired transaction can be
                     // replaced, and that replacement won't have it set,
                     // and that's ok.
-                    if (!existingIter->second.consequences)
-                        existingIter->second.consequences.emplace(
+                    if (!existingIter->second->consequences)
+                        existingIter->second->consequences.emplace(
                             calculateConsequences(
-                                *existingIter->second.pfresult));
+                                *existingIter->second->pfresult));
 
-                    if (existingIter->second.consequences->category ==
+                    if (existingIter->second->consequences->category ==
                         TxConsequences::normal)
                     {
                         assert(!consequences);
@@ -675,7 +702,7 @@ TxQ::apply(Application& app, OpenView& view,
                                 "Ignoring blocker transaction " <<
                                 transactionID <<
                                 " in favor of normal queued " <<
-                                existingIter->second.txID;
+                                existingIter->second->txID;
                             return{existingIter == txQAcct.transactions.begin() ?
                                 telINSUF_FEE_P : telCAN_NOT_QUEUE, false };
                         }
@@ -686,15 +713,15 @@ TxQ::apply(Application& app, OpenView& view,
                 // Remove the queued transaction and continue
                 JLOG(j_.trace()) <<
                     "Removing transaction from queue " <<
-                    existingIter->second.txID <<
+                    existingIter->second->txID <<
                     " in favor of " << transactionID;
                 // Then save the queued tx to remove from the queue if
                 // the new tx succeeds or gets queued. DO NOT REMOVE
                 // if the new tx fails, because there may be other txs
                 // dependent on it in the queue.
-                auto deleteIter = byFee_.iterator_to(existingIter->second);
+                auto deleteIter = byFee_.iterator_to(*existingIter->second);
                 assert(deleteIter != byFee_.end());
-                assert(&existingIter->second == &*deleteIter);
+                assert(existingIter->second.get() == &*deleteIter);
                 assert(deleteIter->sequence == tSeq);
                 assert(deleteIter->account == txQAcct.account);
                 replacedItemDeleteIter = deleteIter;
@@ -706,7 +733,7 @@ TxQ::apply(Application& app, OpenView& view,
                     "Ignoring transaction " <<
                     transactionID <<
                     " in favor of queued " <<
-                    existingIter->second.txID;
+                    existingIter->second->txID;
                 return{ telINSUF_FEE_P, false };
             }
         }
@@ -759,7 +786,7 @@ TxQ::apply(Application& app, OpenView& view,
                         // Is the current transaction's fee higher than
                         // the previous transaction's fee + a percentage
                         auto requiredMultiLevel = increase(
-                            workingIter->second.feeLevel,
+                            workingIter->second->feeLevel,
                             setup_.multiTxnPercent);
 
                         if (feeLevelPaid <= requiredMultiLevel)
@@ -786,14 +813,14 @@ TxQ::apply(Application& app, OpenView& view,
                                 txQAcct.transactions.end();
                         continue;
                     }
-                    if (!workingIter->second.consequences)
-                        workingIter->second.consequences.emplace(
+                    if (!workingIter->second->consequences)
+                        workingIter->second->consequences.emplace(
                             calculateConsequences(
-                                *workingIter->second.pfresult));
+                                *workingIter->second->pfresult));
                     // Don't worry about the blocker status of txs
                     // after the current.
                     if (workingIter->first < tSeq &&
-                        workingIter->second.consequences->category ==
+                        workingIter->second->consequences->category ==
                             TxConsequences::blocker)
                     {
                         // Drop the current transaction, because it's
@@ -806,9 +833,9 @@ TxQ::apply(Application& app, OpenView& view,
                         return{ telCAN_NOT_QUEUE, false };
                     }
                     multiTxn->fee +=
-                        workingIter->second.consequences->fee;
+                        workingIter->second->consequences->fee;
                     multiTxn->potentialSpend +=
-                        workingIter->second.consequences->potentialSpend;
+                        workingIter->second->consequences->potentialSpend;
                 }
                 if (workingSeq < tSeq)
                     // Transactions are missing before `tx`.
@@ -916,7 +943,7 @@ TxQ::apply(Application& app, OpenView& view,
         6) Tx is not a 0-fee / free transaction, regardless of fee level.
     */
     if (accountExists && multiTxn.is_initialized() &&
-        multiTxn->nextTxIter->second.retriesRemaining == MaybeTx::retriesAllowed &&
+        multiTxn->nextTxIter->second->retriesRemaining == MaybeTx::retriesAllowed &&
         feeLevelPaid > requiredFeeLevel &&
             requiredFeeLevel > baseLevel && baseFee != 0)
     {
@@ -1008,9 +1035,9 @@ TxQ::apply(Application& app, OpenView& view,
                         [&](auto const& total, auto const& tx)
                         {
                             // Check for overflow.
-                            auto next = tx.second.feeLevel /
+                            auto next = tx.second->feeLevel /
                                 endAccount.transactions.size();
-                            auto mod = tx.second.feeLevel %
+                            auto mod = tx.second->feeLevel %
                                 endAccount.transactions.size();
                             if (total.first >= max - next ||
                                     total.second >= max - mod)
@@ -1025,7 +1052,7 @@ TxQ::apply(Application& app, OpenView& view,
             // The queue is full, and this transaction is more
             // valuable, so kick out the cheapest transaction.
             auto dropRIter = endAccount.transactions.rbegin();
-            assert(dropRIter->second.account == lastRIter->account);
+            assert(dropRIter->second->account == lastRIter->account);
             JLOG(j_.warn()) <<
                 "Removing last item of account " <<
                 lastRIter->account <<
@@ -1033,7 +1060,7 @@ TxQ::apply(Application& app, OpenView& view,
                 endEffectiveFeeLevel << " in favor of " <<
                 transactionID << " with fee of " <<
                 feeLevelPaid;
-            erase(byFee_.iterator_to(dropRIter->second));
+            erase(byFee_.iterator_to(*dropRIter->second));
         }
         else
         {
@@ -1267,14 +1294,14 @@ TxQ::accept(Application& app,
                         things worse, drop the _last_ transaction for this account.
                     */
                     auto dropRIter = account.transactions.rbegin();
-                    assert(dropRIter->second.account == candidateIter->account);
+                    assert(dropRIter->second->account == candidateIter->account);
                     JLOG(j_.warn()) <<
                         "Queue is nearly full, and transaction " <<
                         candidateIter->txID << " failed with " <<
                         transToken(txnResult) <<
                         ". Removing last item of account " <<
                         account.account;
-                    auto endIter = byFee_.iterator_to(dropRIter->second);
+                    auto endIter = byFee_.iterator_to(*dropRIter->second);
                     assert(endIter != candidateIter);
                     erase(endIter);
 
@@ -1289,6 +1316,9 @@ TxQ::accept(Application& app,
         }
     }
 
+    openLedgerFeeLevel_ = FeeMetrics::scaleFeeLevel(
+        j_, metricSnapshot, view);
+
     return ledgerChanged;
 }
 
@@ -1344,11 +1374,11 @@ TxQ::getAccountTxs(AccountID const& account, ReadView const& view) const
         result.emplace(tx.first, [&]
         {
             AccountTxDetails resultTx;
-            resultTx.feeLevel = tx.second.feeLevel;
-            if (tx.second.lastValid)
-                resultTx.lastValid.emplace(*tx.second.lastValid);
-            if (tx.second.consequences)
-                resultTx.consequences.emplace(*tx.second.consequences);
+            resultTx.feeLevel = tx.second->feeLevel;
+            if (tx.second->lastValid)
+                resultTx.lastValid.emplace(*tx.second->lastValid);
+            if (tx.second->consequences)
+                resultTx.consequences.emplace(*tx.second->consequences);
             return resultTx;
         }());
     }
@@ -1479,9 +1509,10 @@ setup_TxQ(Config const& config)
 
 
 std::unique_ptr<TxQ>
-make_TxQ(TxQ::Setup const& setup, beast::Journal j)
+make_TxQ(TxQ::Setup const& setup, beast::Journal j,
+    beast::insight::Collector::ptr const& collector)
 {
-    return std::make_unique<TxQ>(setup, std::move(j));
+    return std::make_unique<TxQ>(setup, std::move(j), collector);
 }
 
 } // casinocoin
@@ -25,7 +25,9 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/app/paths/CasinocoinLineCache.h>
+#include <casinocoin/app/paths/Tuning.h>
 #include <casinocoin/ledger/OpenView.h>
+#include <algorithm>
 
 namespace casinocoin {
 
@@ -38,6 +40,43 @@ CasinocoinLineCache::CasinocoinLineCache(
     mLedger = std::make_shared<OpenView>(&*ledger, ledger);
 }
 
+CasinocoinLineCache::CasinocoinLineCache(
+    std::shared_ptr <ReadView const> const& ledger,
+    CasinocoinLineCache& previous,
+    Changes const& changes)
+    : CasinocoinLineCache (ledger)
+{
+    std::lock_guard <std::mutex> sl (previous.mLock);
+
+    // The keys carry hashes made by the other cache's hasher
+    hasher_ = previous.hasher_;
+    for (auto const& entry : previous.lines_)
+    {
+        if (changes.accounts.count (entry.first.account_) == 0)
+            lines_.emplace (entry.first, entry.second);
+    }
+
+    // Paths are kept while nothing they go through changes. New
+    // lines or books elsewhere could make better paths, so old
+    // results are searched for again after a while regardless.
+    for (auto const& entry : previous.paths_)
+    {
+        auto const& found = *entry.second;
+        if (mLedger->seq () > found.seq + PATH_CACHE_MAX_AGE)
+            continue;
+        if (std::any_of (found.accounts.begin (), found.accounts.end (),
+            [&changes](AccountID const& account)
+            {
+                return changes.accounts.count (account) != 0 ||
+                    changes.issuers.count (account) != 0;
+            }))
+        {
+            continue;
+        }
+        paths_.emplace (entry.first, entry.second);
+    }
+}
+
 std::vector<CasinocoinState::pointer> const&
 CasinocoinLineCache::getCasinocoinLines (AccountID const& accountID)
 {
@@ -45,14 +84,102 @@ CasinocoinLineCache::getCasinocoinLines (AccountID const& accountID)
 
     std::lock_guard <std::mutex> sl (mLock);
 
-    auto it = lines_.emplace (key,
-        std::vector<CasinocoinState::pointer>());
+    auto it = lines_.emplace (key, nullptr);
 
     if (it.second)
-        it.first->second = getCasinocoinStateItems (
-            accountID, *mLedger);
+        it.first->second = std::make_shared <
+            std::vector<CasinocoinState::pointer> const> (
+                getCasinocoinStateItems (accountID, *mLedger));
+
+    return *it.first->second;
+}
+
+boost::optional <STPathSet>
+CasinocoinLineCache::getPaths (uint256 const& key)
+{
+    std::lock_guard <std::mutex> sl (mLock);
+    auto const it = paths_.find (key);
+    if (it == paths_.end ())
+        return boost::none;
+    return it->second->paths;
+}
+
+void
+CasinocoinLineCache::setPaths (uint256 const& key, STPathSet const& paths,
+    hash_set <AccountID> accounts)
+{
+    auto found = std::make_shared <FoundPaths> ();
+    found->paths = paths;
+    found->accounts = std::move (accounts);
+    found->seq = mLedger->seq ();
+
+    std::lock_guard <std::mutex> sl (mLock);
+    if (paths_.size () < PATH_CACHE_MAX_ENTRIES)
+        paths_[key] = std::move (found);
+}
+
+bool
+CasinocoinLineCache::getChanges (ReadView const& ledger, Changes& changes)
+{
+    if (ledger.open ())
+        return false;
+
+    for (auto const& item : ledger.txs)
+    {
+        if (! item.second)
+            return false;
+
+        for (auto const& node : item.second->getFieldArray (sfAffectedNodes))
+        {
+            auto const type = node.getFieldU16 (sfLedgerEntryType);
+
+            // The root of a quality directory created or removed
+            if (type == ltDIR_NODE && node.getFName () != sfModifiedNode)
+            {
+                auto const dir = dynamic_cast<STObject const*> (
+                    node.peekAtPField (node.getFName () == sfCreatedNode ?
+                        sfNewFields : sfFinalFields));
+                if (dir &&
+                    dir->isFieldPresent (sfExchangeRate) &&
+                    dir->isFieldPresent (sfRootIndex) &&
+                    dir->getFieldH256 (sfRootIndex) ==
+                        node.getFieldH256 (sfLedgerIndex))
+                {
+                    for (auto const field :
+                        {&sfTakerPaysIssuer, &sfTakerGetsIssuer})
+                    {
+                        if (dir->isFieldPresent (*field))
+                        {
+                            AccountID issuer;
+                            issuer.copyFrom (dir->getFieldH160 (*field));
+                            changes.issuers.insert (issuer);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            if (type != ltCASINOCOIN_STATE)
+                continue;
 
-    return it.first->second;
+            // Either account of a line sees it change
+            for (auto const field :
+                {&sfNewFields, &sfFinalFields, &sfPreviousFields})
+            {
+                auto const fields = dynamic_cast<STObject const*> (
+                    node.peekAtPField (*field));
+                if (! fields)
+                    continue;
+                if (fields->isFieldPresent (sfLowLimit))
+                    changes.accounts.insert (
+                        fields->getFieldAmount (sfLowLimit).getIssuer ());
+                if (fields->isFieldPresent (sfHighLimit))
+                    changes.accounts.insert (
+                        fields->getFieldAmount (sfHighLimit).getIssuer ());
+            }
+        }
+    }
+    return true;
 }
 
 } // casinocoin
@@ -29,6 +29,9 @@
 #include <casinocoin/app/ledger/Ledger.h>
 #include <casinocoin/app/paths/CasinocoinState.h>
 #include <casinocoin/basics/hardened_hash.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/protocol/STPathSet.h>
+#include <boost/optional.hpp>
 #include <cstddef>
 #include <memory>
 #include <mutex>
@@ -44,6 +47,36 @@ public:
     CasinocoinLineCache (
         std::shared_ptr <ReadView const> const& l);
 
+    /** What ledgers changed that the cached results depend on. */
+    struct Changes
+    {
+        // Accounts whose trust lines changed
+        hash_set <AccountID> accounts;
+
+        // Issuers of order books that were created or removed
+        hash_set <AccountID> issuers;
+    };
+
+    /** Create the cache of a ledger descending from another cache's.
+
+        Only the lines of the changed accounts can differ between the
+        two ledgers. The lines of every other account are shared with
+        the earlier cache instead of being read again, and so are the
+        paths found that don't go through anything that changed.
+    */
+    CasinocoinLineCache (
+        std::shared_ptr <ReadView const> const& l,
+        CasinocoinLineCache& previous,
+        Changes const& changes);
+
+    /** Add what a closed ledger changed.
+
+        @return false if the ledger has no metadata to tell.
+    */
+    static
+    bool
+    getChanges (ReadView const& ledger, Changes& changes);
+
     std::shared_ptr <ReadView const> const&
     getLedger () const
     {
@@ -53,7 +86,28 @@ public:
     std::vector<CasinocoinState::pointer> const&
     getCasinocoinLines (AccountID const& accountID);
 
+    /** Return the paths an earlier search with the same key found. */
+    boost::optional <STPathSet>
+    getPaths (uint256 const& key);
+
+    /** Remember the paths a search found.
+
+        @param accounts The accounts the search result depends on.
+    */
+    void
+    setPaths (uint256 const& key, STPathSet const& paths,
+        hash_set <AccountID> accounts);
+
 private:
+    struct FoundPaths
+    {
+        STPathSet paths;
+        hash_set <AccountID> accounts;
+
+        // The ledger the paths were found in
+        LedgerIndex seq;
+    };
+
     std::mutex mLock;
 
     casinocoin::hardened_hash<> hasher_;
@@ -95,10 +149,13 @@ private:
         };
     };
 
+    // Caches of later ledgers hold on to the lines they share
     hash_map <
         AccountKey,
-        std::vector <CasinocoinState::pointer>,
+        std::shared_ptr <std::vector <CasinocoinState::pointer> const>,
         AccountKey::Hash> lines_;
+
+    hash_map <uint256, std::shared_ptr <FoundPaths const>> paths_;
 };
 
 } // casinocoin
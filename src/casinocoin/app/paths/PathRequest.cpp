@@ -28,6 +28,7 @@
 #include <casinocoin/app/paths/CasinocoinCalc.h>
 #include <casinocoin/app/paths/PathRequest.h>
 #include <casinocoin/app/paths/PathRequests.h>
+#include <casinocoin/app/paths/Tuning.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/LoadFeeTrack.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
@@ -295,7 +296,7 @@ int PathRequest::parseJson (Json::Value const& jvParams)
         return PFR_PJ_INVALID;
     }
 
-    raSrcAccount = parseBase58<AccountID>(
+    raSrcAccount = app_.accountIDCache().fromBase58(
         jvParams[jss::source_account].asString());
     if (! raSrcAccount)
     {
@@ -303,7 +304,7 @@ int PathRequest::parseJson (Json::Value const& jvParams)
         return PFR_PJ_INVALID;
     }
 
-    raDstAccount = parseBase58<AccountID>(
+    raDstAccount = app_.accountIDCache().fromBase58(
         jvParams[jss::destination_account].asString());
     if (! raDstAccount)
     {
@@ -465,7 +466,7 @@ std::unique_ptr<Pathfinder> const&
 PathRequest::getPathFinder(std::shared_ptr<CasinocoinLineCache> const& cache,
     hash_map<Currency, std::unique_ptr<Pathfinder>>& currency_map,
         Currency const& currency, STAmount const& dst_amount,
-            int const level)
+            int const level, std::chrono::steady_clock::time_point deadline)
 {
     auto i = currency_map.find(currency);
     if (i != currency_map.end())
@@ -473,6 +474,7 @@ PathRequest::getPathFinder(std::shared_ptr<CasinocoinLineCache> const& cache,
     auto pathfinder = std::make_unique<Pathfinder>(
         cache, *raSrcAccount, *raDstAccount, currency,
             boost::none, dst_amount, saSendMax, app_);
+    pathfinder->setDeadline(deadline);
     if (pathfinder->findPaths(level))
         pathfinder->computePathRanks(max_paths_);
     else
@@ -482,7 +484,8 @@ PathRequest::getPathFinder(std::shared_ptr<CasinocoinLineCache> const& cache,
 
 bool
 PathRequest::findPaths (std::shared_ptr<CasinocoinLineCache> const& cache,
-    int const level, Json::Value& jvArray)
+    int const level, Json::Value& jvArray,
+        std::chrono::steady_clock::time_point deadline)
 {
     auto sourceCurrencies = sciSourceCurrencies;
     if (sourceCurrencies.empty ())
@@ -513,7 +516,7 @@ PathRequest::findPaths (std::shared_ptr<CasinocoinLineCache> const& cache,
             << STAmount(issue, 1).getFullText();
 
         auto& pathfinder = getPathFinder(cache, currency_map,
-            issue.currency, dst_amount, level);
+            issue.currency, dst_amount, level, deadline);
         if (! pathfinder)
         {
             assert(false);
@@ -629,6 +632,9 @@ Json::Value PathRequest::doUpdate(
     JLOG(m_journal.debug()) << iIdentifier
         << " update " << (fast ? "fast" : "normal");
 
+    auto const deadline = steady_clock::now() + (fast ?
+        PATH_REQUEST_FAST_DEADLINE : PATH_REQUEST_FULL_DEADLINE);
+
     {
         ScopedLockType sl (mLock);
 
@@ -692,7 +698,7 @@ Json::Value PathRequest::doUpdate(
         << " processing at level " << iLevel;
 
     Json::Value jvArray = Json::arrayValue;
-    if (findPaths(cache, iLevel, jvArray))
+    if (findPaths(cache, iLevel, jvArray, deadline))
     {
         bLastSuccess = jvArray.size() != 0;
         newStatus[jss::alternatives] = std::move (jvArray);
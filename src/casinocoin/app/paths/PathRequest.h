@@ -113,13 +113,16 @@ private:
     std::unique_ptr<Pathfinder> const&
     getPathFinder(std::shared_ptr<CasinocoinLineCache> const&,
         hash_map<Currency, std::unique_ptr<Pathfinder>>&, Currency const&,
-            STAmount const&, int const);
+            STAmount const&, int const,
+                std::chrono::steady_clock::time_point);
 
     /** Finds and sets a PathSet in the JSON argument.
         Returns false if the source currencies are inavlid.
+        The search stops at the deadline with the paths found by then.
     */
     bool
-    findPaths (std::shared_ptr<CasinocoinLineCache> const&, int const, Json::Value&);
+    findPaths (std::shared_ptr<CasinocoinLineCache> const&, int const,
+        Json::Value&, std::chrono::steady_clock::time_point deadline);
 
     int parseJson (Json::Value const&);
 
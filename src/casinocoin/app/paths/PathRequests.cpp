@@ -27,8 +27,10 @@
 #include <casinocoin/app/paths/PathRequests.h>
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/paths/Tuning.h>
 #include <casinocoin/basics/Log.h>
 #include <casinocoin/core/JobQueue.h>
+#include <casinocoin/core/ParallelFor.h>
 #include <casinocoin/protocol/JsonFields.h>
 #include <casinocoin/resource/Fees.h>
 #include <algorithm>
@@ -53,11 +55,60 @@ PathRequests::getLineCache (
          (authoritative && ((lgrSeq + 8)  < lineSeq)) ||   // we jumped way back for some reason
          (lgrSeq > (lineSeq + 8)))                         // we jumped way forward for some reason
     {
-        mLineCache = std::make_shared<CasinocoinLineCache> (ledger);
+        mLineCache = makeLineCache (ledger);
     }
     return mLineCache;
 }
 
+std::shared_ptr<CasinocoinLineCache>
+PathRequests::makeLineCache (
+    std::shared_ptr <ReadView const> const& ledger)
+{
+    if (! mLineCache)
+        return std::make_shared<CasinocoinLineCache> (ledger);
+
+    auto const& prev = mLineCache->getLedger ();
+    if (prev->open () || ledger->seq () <= prev->seq () ||
+        ledger->seq () > prev->seq () + LINE_CACHE_MAX_SHARE)
+    {
+        return std::make_shared<CasinocoinLineCache> (ledger);
+    }
+
+    // Collect the accounts whose lines the ledgers since the
+    // one of the current cache changed, newest ledger first.
+    CasinocoinLineCache::Changes changes;
+    try
+    {
+        std::shared_ptr <ReadView const> view = ledger;
+        for (;;)
+        {
+            if (! CasinocoinLineCache::getChanges (*view, changes))
+                return std::make_shared<CasinocoinLineCache> (ledger);
+            if (view->seq () == prev->seq () + 1)
+                break;
+            view = app_.getLedgerMaster ().getLedgerByHash (
+                view->info().parentHash);
+            if (! view)
+                return std::make_shared<CasinocoinLineCache> (ledger);
+        }
+        if (view->info().parentHash != prev->info().hash)
+            return std::make_shared<CasinocoinLineCache> (ledger);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (mJournal.debug()) <<
+            "unable to share lines with ledger " << prev->seq () <<
+            ": " << e.what ();
+        return std::make_shared<CasinocoinLineCache> (ledger);
+    }
+
+    JLOG (mJournal.trace()) <<
+        "line cache for ledger " << ledger->seq () << " drops " <<
+        changes.accounts.size () << " accounts from ledger " << prev->seq ();
+    return std::make_shared<CasinocoinLineCache> (
+        ledger, *mLineCache, changes);
+}
+
 void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
                               Job::CancelCallback shouldCancel)
 {
@@ -86,12 +137,21 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
 
     do
     {
-        for (auto const& wr : requests)
+        // Requests are updated in parallel. Each one is checked
+        // against the same cache, so they don't depend on each other.
+        std::mutex removeMutex;
+        std::vector<PathRequest::pointer> toRemove;
+        std::atomic<bool> stop {false};
+        std::atomic<int> done {0};
+
+        parallelFor (app_.getJobQueue (), jtUPDATE_PF,
+            app_.config ().PATH_SEARCH_THREADS, requests.size (),
+            [&](std::size_t i)
         {
-            if (shouldCancel())
-                break;
+            if (stop || shouldCancel())
+                return;
 
-            auto request = wr.lock ();
+            auto request = requests[i].lock ();
             bool remove = true;
 
             if (request)
@@ -109,7 +169,7 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
                             update[jss::type] = "path_find";
                             ipSub->send (update, false);
                             remove = false;
-                            ++processed;
+                            ++done;
                         }
                     }
                     else if (request->hasCompletion ())
@@ -117,40 +177,49 @@ void PathRequests::updateAll (std::shared_ptr <ReadView const> const& inLedger,
                         // One-shot request with completion function
                         request->doUpdate (cache, false);
                         request->updateComplete();
-                        ++processed;
+                        ++done;
                     }
                 }
             }
 
             if (remove)
             {
-                ScopedLockType sl (mLock);
+                std::lock_guard <std::mutex> sl (removeMutex);
+                toRemove.push_back (request);
+            }
 
-                // Remove any dangling weak pointers or weak
-                // pointers that refer to this path request.
-                auto ret = std::remove_if (
-                    requests_.begin(), requests_.end(),
-                    [&removed,&request](auto const& wl)
-                    {
-                        auto r = wl.lock();
+            // We weren't handling new requests and then
+            // there was a new request
+            if (!newRequests &&
+                app_.getLedgerMaster().isNewPathRequest())
+            {
+                stop = true;
+            }
+        });
 
-                        if (r && r != request)
-                            return false;
-                        ++removed;
-                        return true;
-                    });
+        processed += done;
+        mustBreak = stop;
 
-                requests_.erase (ret, requests_.end());
-            }
+        if (! toRemove.empty ())
+        {
+            ScopedLockType sl (mLock);
 
-            mustBreak = !newRequests &&
-                app_.getLedgerMaster().isNewPathRequest();
+            // Remove any dangling weak pointers or weak
+            // pointers that refer to the removed path requests.
+            auto ret = std::remove_if (
+                requests_.begin(), requests_.end(),
+                [&removed,&toRemove](auto const& wl)
+                {
+                    auto r = wl.lock();
 
-            // We weren't handling new requests and then
-            // there was a new request
-            if (mustBreak)
-                break;
+                    if (r && std::find (toRemove.begin (),
+                            toRemove.end (), r) == toRemove.end ())
+                        return false;
+                    ++removed;
+                    return true;
+                });
 
+            requests_.erase (ret, requests_.end());
         }
 
         if (mustBreak)
@@ -264,7 +333,19 @@ PathRequests::doLegacyPathRequest (
         std::shared_ptr<ReadView const> const& inLedger,
         Json::Value const& request)
 {
-    auto cache = std::make_shared<CasinocoinLineCache> (inLedger);
+    // Share the cache of the path requests when asked
+    // about its ledger, along with the paths it found.
+    std::shared_ptr<CasinocoinLineCache> cache;
+    {
+        ScopedLockType sl (mLock);
+        if (mLineCache && ! inLedger->open () &&
+            mLineCache->getLedger ()->info ().hash == inLedger->info ().hash)
+        {
+            cache = mLineCache;
+        }
+    }
+    if (! cache)
+        cache = std::make_shared<CasinocoinLineCache> (inLedger);
 
     auto req = std::make_shared<PathRequest> (app_, []{},
         consumer, ++mLastIdentifier, *this, mJournal);
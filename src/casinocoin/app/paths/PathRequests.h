@@ -92,6 +92,11 @@ public:
 private:
     void insertPathRequest (PathRequest::pointer const&);
 
+    // Make the line cache of a ledger, sharing what it
+    // can with the current cache
+    std::shared_ptr<CasinocoinLineCache> makeLineCache (
+        std::shared_ptr <ReadView const> const& ledger);
+
     Application& app_;
     beast::Journal                   mJournal;
 
@@ -33,8 +33,10 @@
 #include <casinocoin/app/ledger/OrderBookDB.h>
 #include <casinocoin/basics/Log.h>
 #include <casinocoin/json/to_string.h>
+#include <casinocoin/protocol/Serializer.h>
 #include <casinocoin/core/JobQueue.h>
 #include <casinocoin/core/Config.h>
+#include <casinocoin/core/ParallelFor.h>
 #include <tuple>
 
 /*
@@ -305,12 +307,31 @@ bool Pathfinder::findPaths (int searchLevel)
         paymentType = pt_nonCSC_to_nonCSC;
     }
 
+    // The same search may have been made recently. Its paths are
+    // ranked again against this ledger, which checks their liquidity.
+    auto const key = getSearchKey (searchLevel);
+    if (auto paths = mRLCache->getPaths (key))
+    {
+        mCompletePaths = std::move (*paths);
+        JLOG (j_.debug())
+                << mCompletePaths.size () << " complete paths reused";
+        return true;
+    }
+
     // Now iterate over all paths for that paymentType.
+    bool complete = true;
     for (auto const& costedPath : mPathTable[paymentType])
     {
         // Only use paths with at most the current search level.
         if (costedPath.searchLevel <= searchLevel)
         {
+            if (std::chrono::steady_clock::now () > deadline_)
+            {
+                JLOG (j_.debug()) << "findPaths: deadline passed";
+                complete = false;
+                break;
+            }
+
             addPathsForType (costedPath.type);
 
             // TODO(tom): we might be missing other good paths with this
@@ -323,6 +344,10 @@ bool Pathfinder::findPaths (int searchLevel)
     JLOG (j_.debug())
             << mCompletePaths.size () << " complete paths found";
 
+    // Only remember searches that weren't cut short
+    if (complete)
+        mRLCache->setPaths (key, mCompletePaths, getSearchAccounts ());
+
     // Even if we find no paths, default paths may work, and we don't check them
     // currently.
     return true;
@@ -397,6 +422,58 @@ TER Pathfinder::getPathLiquidity (
 
 namespace {
 
+// The number of decimal digits before the point
+int magnitude (STAmount const& amount)
+{
+    int digits = 0;
+    for (auto m = amount.mantissa (); m != 0; m /= 10)
+        ++digits;
+    return amount.exponent () + digits;
+}
+
+} // namespace
+
+uint256 Pathfinder::getSearchKey (int searchLevel) const
+{
+    Serializer s;
+    s.add160 (mSrcAccount);
+    s.add160 (mDstAccount);
+    s.add160 (mSrcAmount.getCurrency ());
+    s.add160 (mSrcAmount.getIssuer ());
+    s.add8 (mSrcIssuer ? 1 : 0);
+    s.add160 (mSrcIssuer.value_or (AccountID ()));
+    s.add160 (mDstAmount.getCurrency ());
+    s.add160 (mDstAmount.getIssuer ());
+    s.add32 (searchLevel);
+
+    // Amounts of the same order of magnitude share searches
+    s.add8 (convert_all_ ? 1 : 0);
+    s.add32 (convert_all_ ? 0 : magnitude (mDstAmount));
+    return s.getSHA512Half ();
+}
+
+hash_set<AccountID> Pathfinder::getSearchAccounts () const
+{
+    hash_set<AccountID> accounts {
+        mSrcAccount, mDstAccount, mEffectiveDst,
+        mSrcAmount.getIssuer (), mDstAmount.getIssuer ()};
+    if (mSrcIssuer)
+        accounts.insert (*mSrcIssuer);
+    for (auto const& path : mCompletePaths)
+    {
+        for (auto const& element : path)
+        {
+            if (element.isAccount ())
+                accounts.insert (element.getAccountID ());
+            if (element.hasIssuer ())
+                accounts.insert (element.getIssuerID ());
+        }
+    }
+    return accounts;
+}
+
+namespace {
+
 // Return the smallest amount of useful liquidity for a given amount, and the
 // total number of paths we have to evaluate.
 STAmount smallestUsefulAmount (STAmount const& amount, int maxPaths)
@@ -505,15 +582,47 @@ void Pathfinder::rankPaths (
         saMinDstAmount = smallestUsefulAmount(mDstAmount, maxPaths);
     }
 
+    // Each path is checked in a sandbox of its own, so the
+    // checks can run in parallel. They are ranked in order.
+    struct Liquidity
+    {
+        bool checked = false;
+        TER resultCode = tesSUCCESS;
+        STAmount amount;
+        uint64_t quality = 0;
+    };
+    std::vector <Liquidity> results (paths.size ());
+
+    parallelFor (app_.getJobQueue (), jtUPDATE_PF,
+        app_.config ().PATH_SEARCH_THREADS, paths.size (),
+        [&](std::size_t i)
+        {
+            if (paths[i].empty () ||
+                std::chrono::steady_clock::now () > deadline_)
+            {
+                return;
+            }
+
+            auto& result = results[i];
+            result.resultCode = getPathLiquidity (paths[i],
+                saMinDstAmount, result.amount, result.quality);
+            result.checked = true;
+        });
+
     for (int i = 0; i < paths.size (); ++i)
     {
         auto const& currentPath = paths[i];
-        if (! currentPath.empty())
+        if (! currentPath.empty() && ! results[i].checked)
+        {
+            JLOG (j_.debug()) <<
+                "findPaths: deadline passed, dropping : " <<
+                currentPath.getJson (0);
+        }
+        else if (! currentPath.empty())
         {
-            STAmount liquidity;
-            uint64_t uQuality;
-            auto const resultCode = getPathLiquidity (
-                currentPath, saMinDstAmount, liquidity, uQuality);
+            auto const& liquidity = results[i].amount;
+            auto const uQuality = results[i].quality;
+            auto const resultCode = results[i].resultCode;
             if (resultCode != tesSUCCESS)
             {
                 JLOG (j_.debug()) <<
@@ -31,6 +31,7 @@
 #include <casinocoin/core/LoadEvent.h>
 #include <casinocoin/protocol/STAmount.h>
 #include <casinocoin/protocol/STPathSet.h>
+#include <chrono>
 
 namespace casinocoin {
 
@@ -59,6 +60,22 @@ public:
 
     static void initPathTable ();
 
+    /** Return the key of the search findPaths makes at a level.
+
+        Requests for the same accounts and currencies, with amounts
+        of the same magnitude, make the same search.
+    */
+    uint256 getSearchKey (int searchLevel) const;
+
+    /** Stop searching and ranking paths once the deadline passes.
+
+        The paths found and ranked by then are still used.
+    */
+    void setDeadline (std::chrono::steady_clock::time_point deadline)
+    {
+        deadline_ = deadline;
+    }
+
     bool findPaths (int searchLevel);
 
     /** Compute the rankings of the paths. */
@@ -133,6 +150,9 @@ private:
     // Add all paths of one type to mCompletePaths.
     STPathSet& addPathsForType (PathType const& type);
 
+    // The accounts the paths found depend on
+    hash_set<AccountID> getSearchAccounts () const;
+
     bool issueMatchesOrigin (Issue const&);
 
     int getPathsOut (
@@ -187,6 +207,8 @@ private:
         been removed. */
     STAmount mRemainingAmount;
     bool convert_all_;
+    std::chrono::steady_clock::time_point deadline_ =
+        std::chrono::steady_clock::time_point::max ();
 
     std::shared_ptr <ReadView const> mLedger;
     std::unique_ptr<LoadEvent> m_loadEvent;
@@ -26,6 +26,10 @@
 #ifndef CASINOCOIN_APP_PATHS_TUNING_H_INCLUDED
 #define CASINOCOIN_APP_PATHS_TUNING_H_INCLUDED
 
+#include <casinocoin/protocol/Protocol.h>
+#include <chrono>
+#include <cstddef>
+
 namespace casinocoin {
 
 int const CALC_NODE_DELIVER_MAX_LOOPS = 100;
@@ -37,6 +41,20 @@ int const PATHFINDER_MAX_PATHS = 50;
 int const PATHFINDER_MAX_COMPLETE_PATHS = 1000;
 int const PATHFINDER_MAX_PATHS_FROM_SOURCE = 10;
 
+// The most ledgers a line cache may trail a newer one
+// and still share the lines that didn't change.
+int const LINE_CACHE_MAX_SHARE = 8;
+
+// The most searches a line cache remembers the paths of, and how many
+// ledgers later the paths are searched for again.
+std::size_t const PATH_CACHE_MAX_ENTRIES = 10000;
+LedgerIndex const PATH_CACHE_MAX_AGE = 32;
+
+// How long one update of a path request may search for paths. Paths
+// not evaluated in time are left out of that update.
+std::chrono::milliseconds const PATH_REQUEST_FAST_DEADLINE {1000};
+std::chrono::milliseconds const PATH_REQUEST_FULL_DEADLINE {5000};
+
 } // casinocoin
 
 #endif
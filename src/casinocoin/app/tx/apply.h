@@ -132,6 +132,23 @@ apply (Application& app, OpenView& view,
         beast::Journal journal);
 
 
+/** Apply a transaction carried over from a previous open ledger.
+
+    Like `apply`, but `preflight` is skipped and `preclaim`
+    is reduced to the sequence and fee checks.
+
+    @warning Use with extreme care. Only valid for a transaction
+    that was applied in an earlier open view whose accounts are
+    unchanged, up to this transaction, in `view`.
+
+    @see apply, preclaimCarried
+*/
+std::pair<TER, bool>
+reapply (Application& app, OpenView& view,
+    STTx const& tx, ApplyFlags flags,
+        beast::Journal journal);
+
+
 /** Enum class for return value from `applyTransaction`
 
     @see applyTransaction
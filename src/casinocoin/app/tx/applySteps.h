@@ -182,6 +182,12 @@ struct TxConsequences
     @param flags `ApplyFlags` describing processing options.
     @param j A journal.
 
+    @note The result only depends on the transaction, the
+    rules and the flags, so it is remembered in the
+    `HashRouter` entry for the transaction. Repeated calls,
+    for example from each pass that re-applies the
+    transaction, reuse it until the entry expires.
+
     @see PreflightResult, preclaim, doApply, apply
 
     @return A `PreflightResult` object containing, among
@@ -224,6 +230,37 @@ PreclaimResult
 preclaim(PreflightResult const& preflightResult,
     Application& app, OpenView const& view);
 
+/** Repeat only the sequence and fee checks of `preclaim`.
+
+    Used for a transaction carried from one open ledger
+    to the next when none of the ledger state that the
+    rest of `preclaim` depends on has changed. The
+    sequence and fee checks are repeated since they
+    depend on the ledger sequence and the server load.
+    The signature authorization and the transaction
+    specific checks are assumed to give the same result
+    they gave in the previous open ledger.
+
+    @warning Use with extreme care. The caller is
+    responsible for establishing that the transaction
+    passed `preflight` and `preclaim` against equivalent
+    ledger state.
+
+    @param app The current running `Application`.
+    @param view The open ledger that the transaction
+        will attempt to be applied to.
+    @param tx The transaction to be checked.
+    @param flags `ApplyFlags` describing processing options.
+    @param j A journal.
+
+    @see preclaim, doApply, reapply
+
+    @return A `PreclaimResult` object to pass to `doApply`.
+*/
+PreclaimResult
+preclaimCarried(Application& app, OpenView const& view,
+    STTx const& tx, ApplyFlags flags, beast::Journal j);
+
 /** Compute only the expected base fee for a transaction.
 
     Base fees are transaction specific, so any calculation
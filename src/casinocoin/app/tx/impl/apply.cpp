@@ -120,6 +120,16 @@ apply (Application& app, OpenView& view,
     return doApply(pcresult, app, view);
 }
 
+std::pair<TER, bool>
+reapply (Application& app, OpenView& view,
+    STTx const& tx, ApplyFlags flags,
+        beast::Journal j)
+{
+    STAmountSO saved(view.info().parentCloseTime);
+    auto pcresult = preclaimCarried(app, view, tx, flags, j);
+    return doApply(pcresult, app, view);
+}
+
 ApplyResult
 applyTransaction (Application& app, OpenView& view,
     STTx const& txn,
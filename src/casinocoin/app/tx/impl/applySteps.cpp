@@ -26,6 +26,8 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/app/tx/applySteps.h>
+#include <casinocoin/app/main/Application.h>
+#include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/tx/impl/ApplyContext.h>
 #include <casinocoin/app/tx/impl/CancelOffer.h>
 #include <casinocoin/app/tx/impl/CancelTicket.h>
@@ -40,6 +42,7 @@
 #include <casinocoin/app/tx/impl/SetTrust.h>
 #include <casinocoin/app/tx/impl/PayChan.h>
 #include <casinocoin/app/tx/impl/SetKYC.h>
+#include <casinocoin/protocol/digest.h>
 
 namespace casinocoin {
 
@@ -244,6 +247,16 @@ invoke_apply (ApplyContext& ctx)
     }
 }
 
+// Identifies everything besides the transaction
+// that the result of preflight depends on.
+static
+uint256
+preflightContext(Rules const& rules, ApplyFlags flags)
+{
+    return sha512Half(rules.digest(),
+        static_cast<std::uint32_t>(flags));
+}
+
 PreflightResult
 preflight(Application& app, Rules const& rules,
     STTx const& tx, ApplyFlags flags,
@@ -253,7 +266,14 @@ preflight(Application& app, Rules const& rules,
         rules, flags, j);
     try
     {
-        return{ pfctx, invoke_preflight(pfctx) };
+        auto& router = app.getHashRouter();
+        auto const id = tx.getTransactionID();
+        auto const context = preflightContext(rules, flags);
+        if (auto const known = router.getResult(id, context))
+            return{ pfctx, TER(*known) };
+        auto const ter = invoke_preflight(pfctx);
+        router.setResult(id, context, ter);
+        return{ pfctx, ter };
     }
     catch (std::exception const& e)
     {
@@ -296,6 +316,28 @@ preclaim (PreflightResult const& preflightResult,
     }
 }
 
+PreclaimResult
+preclaimCarried(Application& app, OpenView const& view,
+    STTx const& tx, ApplyFlags flags, beast::Journal j)
+{
+    PreclaimContext const ctx(
+        app, view, tesSUCCESS, tx, flags, j);
+    try
+    {
+        auto const baseFee = invoke_calculateBaseFee(ctx);
+        auto result = Transactor::checkSeq(ctx);
+        if (result == tesSUCCESS)
+            result = Transactor::checkFee(ctx, baseFee);
+        return{ ctx, result, baseFee };
+    }
+    catch (std::exception const& e)
+    {
+        JLOG(ctx.j.fatal()) <<
+            "apply: " << e.what();
+        return{ ctx, tefEXCEPTION, 0 };
+    }
+}
+
 std::uint64_t
 calculateBaseFee(Application& app, ReadView const& view,
     STTx const& tx, beast::Journal j)
@@ -0,0 +1,190 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_BASICS_PROFILEDMUTEX_H_INCLUDED
+#define CASINOCOIN_BASICS_PROFILEDMUTEX_H_INCLUDED
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace casinocoin {
+
+/** The counters of all profiled locks sharing a name.
+
+    Times are in nanoseconds. A lock is contended when it could not be
+    taken at once; only contended locks add to the wait time.
+*/
+struct LockStats
+{
+    std::string name;
+    std::uint64_t acquired = 0;
+    std::uint64_t contended = 0;
+    std::uint64_t waitTotal = 0;
+    std::uint64_t waitMax = 0;
+    std::uint64_t holdTotal = 0;
+    std::uint64_t holdMax = 0;
+};
+
+/** Returns the counters of every profiled lock, sorted by name.
+
+    Always empty unless built with CASINOCOIN_PROFILE_LOCKS.
+*/
+std::vector <LockStats>
+getLockStats ();
+
+namespace detail {
+
+struct LockCounters
+{
+    std::atomic <std::uint64_t> acquired {0};
+    std::atomic <std::uint64_t> contended {0};
+    std::atomic <std::uint64_t> waitTotal {0};
+    std::atomic <std::uint64_t> waitMax {0};
+    std::atomic <std::uint64_t> holdTotal {0};
+    std::atomic <std::uint64_t> holdMax {0};
+
+    void
+    addWait (std::uint64_t ns);
+
+    void
+    addHold (std::uint64_t ns);
+};
+
+// Counters live as long as the process, so locks may keep a reference
+LockCounters&
+getLockCounters (std::string const& name);
+
+} // detail
+
+//------------------------------------------------------------------------------
+
+/** A mutex which can record how long it is waited for and held.
+
+    Meets the requirements of Lockable, so std::lock_guard and
+    std::unique_lock work with it, and wraps any Mutex which does,
+    including recursive ones. Locks with the same name share their
+    counters, which are returned by getLockStats.
+
+    Unless built with CASINOCOIN_PROFILE_LOCKS the name is ignored
+    and every call goes straight to the wrapped mutex.
+*/
+template <class Mutex>
+class ProfiledMutex
+{
+private:
+    Mutex mutex_;
+
+#if CASINOCOIN_PROFILE_LOCKS
+    using clock_type = std::chrono::steady_clock;
+
+    detail::LockCounters& counters_;
+
+    // Only touched by the thread holding the lock
+    clock_type::time_point acquired_;
+    int depth_ = 0;
+
+    void
+    onAcquire (clock_type::time_point now)
+    {
+        if (depth_++ == 0)
+        {
+            acquired_ = now;
+            ++counters_.acquired;
+        }
+    }
+#endif
+
+public:
+    explicit
+    ProfiledMutex (std::string const& name)
+#if CASINOCOIN_PROFILE_LOCKS
+        : counters_ (detail::getLockCounters (name))
+#endif
+    {
+    }
+
+    ProfiledMutex (ProfiledMutex const&) = delete;
+    ProfiledMutex& operator= (ProfiledMutex const&) = delete;
+
+#if CASINOCOIN_PROFILE_LOCKS
+    void
+    lock ()
+    {
+        if (mutex_.try_lock ())
+        {
+            onAcquire (clock_type::now ());
+            return;
+        }
+
+        auto const start = clock_type::now ();
+        mutex_.lock ();
+        auto const now = clock_type::now ();
+        ++counters_.contended;
+        counters_.addWait (std::chrono::duration_cast <
+            std::chrono::nanoseconds> (now - start).count ());
+        onAcquire (now);
+    }
+
+    bool
+    try_lock ()
+    {
+        if (! mutex_.try_lock ())
+            return false;
+        onAcquire (clock_type::now ());
+        return true;
+    }
+
+    void
+    unlock ()
+    {
+        if (--depth_ == 0)
+        {
+            counters_.addHold (std::chrono::duration_cast <
+                std::chrono::nanoseconds> (
+                    clock_type::now () - acquired_).count ());
+        }
+        mutex_.unlock ();
+    }
+#else
+    void
+    lock ()
+    {
+        mutex_.lock ();
+    }
+
+    bool
+    try_lock ()
+    {
+        return mutex_.try_lock ();
+    }
+
+    void
+    unlock ()
+    {
+        mutex_.unlock ();
+    }
+#endif
+};
+
+} // casinocoin
+
+#endif
@@ -28,6 +28,7 @@
 
 #include <casinocoin/basics/hardened_hash.h>
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/ProfiledMutex.h>
 #include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/beast/clock/abstract_clock.h>
 #include <casinocoin/beast/insight/Insight.h>
@@ -64,7 +65,7 @@ template <
 class TaggedCache
 {
 public:
-    using mutex_type = Mutex;
+    using mutex_type = ProfiledMutex <Mutex>;
     // VFALCO DEPRECATED The caller can just use std::unique_lock <type>
     using ScopedLockType = std::unique_lock <mutex_type>;
     using lock_guard = std::lock_guard <mutex_type>;
@@ -85,6 +86,7 @@ public:
         , m_stats (name,
             std::bind (&TaggedCache::collect_metrics, this),
                 collector)
+        , m_mutex ("TaggedCache:" + name)
         , m_name (name)
         , m_target_size (size)
         , m_target_age (std::chrono::seconds (expiration_seconds))
@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/basics/ProfiledMutex.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace casinocoin {
+namespace detail {
+
+static
+void
+raiseMax (std::atomic <std::uint64_t>& max, std::uint64_t value)
+{
+    auto current = max.load (std::memory_order_relaxed);
+    while (current < value &&
+        ! max.compare_exchange_weak (current, value,
+            std::memory_order_relaxed))
+    {
+    }
+}
+
+void
+LockCounters::addWait (std::uint64_t ns)
+{
+    waitTotal.fetch_add (ns, std::memory_order_relaxed);
+    raiseMax (waitMax, ns);
+}
+
+void
+LockCounters::addHold (std::uint64_t ns)
+{
+    holdTotal.fetch_add (ns, std::memory_order_relaxed);
+    raiseMax (holdMax, ns);
+}
+
+namespace {
+
+struct LockRegistry
+{
+    std::mutex mutex;
+    std::map <std::string, std::unique_ptr <LockCounters>> counters;
+};
+
+// Never destroyed, so locks in static objects can be
+// used and released at any time during shutdown.
+LockRegistry&
+getRegistry ()
+{
+    static LockRegistry* registry = new LockRegistry;
+    return *registry;
+}
+
+}
+
+LockCounters&
+getLockCounters (std::string const& name)
+{
+    auto& registry = getRegistry ();
+    std::lock_guard <std::mutex> lock (registry.mutex);
+    auto& counters = registry.counters[name];
+    if (! counters)
+        counters = std::make_unique <LockCounters> ();
+    return *counters;
+}
+
+} // detail
+
+std::vector <LockStats>
+getLockStats ()
+{
+    std::vector <LockStats> ret;
+#if CASINOCOIN_PROFILE_LOCKS
+    auto& registry = detail::getRegistry ();
+    std::lock_guard <std::mutex> lock (registry.mutex);
+    ret.reserve (registry.counters.size ());
+    for (auto const& x : registry.counters)
+    {
+        auto const& c = *x.second;
+        LockStats s;
+        s.name = x.first;
+        s.acquired = c.acquired.load ();
+        s.contended = c.contended.load ();
+        s.waitTotal = c.waitTotal.load ();
+        s.waitMax = c.waitMax.load ();
+        s.holdTotal = c.holdTotal.load ();
+        s.holdMax = c.holdMax.load ();
+        ret.push_back (std::move (s));
+    }
+#endif
+    return ret;
+}
+
+} // casinocoin
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_CORE_CHECKBATCHER_H_INCLUDED
+#define CASINOCOIN_CORE_CHECKBATCHER_H_INCLUDED
+
+#include <casinocoin/core/JobQueue.h>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace casinocoin {
+
+/** Runs checks which arrive close together as one batch.
+
+    Peers send proposals and validations in bursts, with every validator
+    sending at once when a ledger closes. Rather than a job for each one,
+    their signature checks are queued here by job type and the first of
+    a type schedules a job of that type. When that job runs it takes
+    everything of its type which arrived in the meantime, runs the
+    checks in parallel with parallelFor, and then hands each result to
+    its dispatcher.
+
+    A job only takes checks of its own type, so trusted checks never
+    wait behind untrusted ones and the job queue's limits and
+    priorities apply to each type.
+
+    Checks must be safe to run concurrently. A check which throws fails.
+*/
+class CheckBatcher
+    : public std::enable_shared_from_this <CheckBatcher>
+{
+public:
+    using Check = std::function <bool ()>;
+    using Dispatch = std::function <void (bool)>;
+
+    /** The most checks taken by one job */
+    static std::size_t const maxBatch = 256;
+
+    /** Create a batcher.
+
+        @param threads The most threads a batch runs on.
+    */
+    CheckBatcher (JobQueue& jobQueue, int threads);
+
+    /** Queue a check.
+
+        @param type The job type of the batch which runs the check.
+        @param dispatch Called with the result of the check, on the
+                        thread which ran the batch.
+    */
+    void
+    add (JobType type, Check check, Dispatch dispatch);
+
+private:
+    struct Item
+    {
+        Check check;
+        Dispatch dispatch;
+        bool valid = false;
+    };
+
+    JobQueue& jobQueue_;
+    int const threads_;
+
+    struct Queue
+    {
+        std::vector <Item> items;
+        // Whether a job is queued to take the items
+        bool scheduled = false;
+    };
+
+    std::mutex mutex_;
+    std::map <JobType, Queue> queues_;
+
+    void
+    schedule (JobType type);
+
+    void
+    run (JobType type);
+};
+
+} // casinocoin
+
+#endif
@@ -68,6 +68,7 @@ enum SizedItemName
     siHashNodeDBCache,
     siTxnDBCache,
     siLgrDBCache,
+    siSignatureCacheSize,
 };
 
 struct SizedItem
@@ -96,6 +97,12 @@ public:
     /** Returns the full path and filename of the entropy seed file. */
     boost::filesystem::path getEntropyFile () const;
 
+    /** Returns the directory holding the configuration file. */
+    boost::filesystem::path const& getConfigDir () const
+    {
+        return CONFIG_DIR;
+    }
+
 private:
     boost::filesystem::path CONFIG_FILE;
     boost::filesystem::path CONFIG_DIR;
@@ -161,6 +168,7 @@ public:
     int                         PATH_SEARCH = 7;
     int                         PATH_SEARCH_FAST = 2;
     int                         PATH_SEARCH_MAX = 10;
+    int                         PATH_SEARCH_THREADS = 4;
 
     // Validation
     boost::optional<std::size_t> VALIDATION_QUORUM;     // Minimum validations to consider ledger authoritative
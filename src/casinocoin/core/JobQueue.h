@@ -35,9 +35,14 @@
 #include <casinocoin/core/impl/Workers.h>
 #include <casinocoin/json/json_value.h>
 #include <boost/coroutine/all.hpp>
+#include <atomic>
 
 namespace casinocoin {
 
+namespace perf {
+class PerfLog;
+}
+
 class Logs;
 struct Coro_create_t {};
 
@@ -114,7 +119,8 @@ public:
     using JobFunction = std::function <void(Job&)>;
 
     JobQueue (beast::insight::Collector::ptr const& collector,
-        Stoppable& parent, beast::Journal journal, Logs& logs);
+        Stoppable& parent, beast::Journal journal, Logs& logs,
+        perf::PerfLog& perfLog);
     ~JobQueue ();
 
     /** Adds a job to the JobQueue.
@@ -197,14 +203,20 @@ private:
     using JobDataMap = std::map <JobType, JobTypeData>;
 
     beast::Journal m_journal;
+
+    // Guards the stop and suspend state. Waiting jobs are kept per type
+    // in m_jobData, each type with its own lock, so that adding and
+    // taking jobs of different types never contend.
     mutable std::mutex m_mutex;
-    std::uint64_t m_lastJob;
-    std::set <Job> m_jobSet;
+    std::atomic <std::uint64_t> m_lastJob;
     JobDataMap m_jobData;
     JobTypeData m_invalidJobData;
 
+    // The number of jobs waiting, of all types
+    std::atomic <int> m_jobCount;
+
     // The number of jobs currently in processTask()
-    int m_processCount;
+    std::atomic <int> m_processCount;
 
     // The number of suspended coroutines
     int nSuspend_ = 0;
@@ -217,6 +229,8 @@ private:
     beast::insight::Gauge job_count;
     beast::insight::Hook hook;
 
+    perf::PerfLog& perfLog_;
+
     std::condition_variable cv_;
 
     static JobTypes const& getJobTypes()
@@ -237,7 +251,7 @@ private:
     //
     // Pre-conditions:
     //  The JobType must be valid.
-    //  The Job must exist in mJobSet.
+    //  The Job must have been added to the queue of its type.
     //  The Job must not have previously been queued.
     //
     // Post-conditions:
@@ -245,32 +259,37 @@ private:
     //  If JobQueue exists, and has at least one thread, Job will eventually run.
     //
     // Invariants:
-    //  The calling thread owns the JobLock
-    void queueJob (Job const& job, std::lock_guard <std::mutex> const& lock);
+    //  The calling thread holds the lock of the JobTypeData
+    void queueJob (JobTypeData& data, std::lock_guard <std::mutex> const& lock);
 
-    // Returns the next Job we should run now.
+    // Takes the next Job we should run now.
     //
     // RunnableJob:
-    //  A Job in the JobSet whose slots count for its type is greater than zero.
+    //  A waiting Job whose type is running fewer jobs than its limit.
+    //
+    // Types are tried from the highest priority down, and jobs of
+    // a type in the order they were added. Another thread may take
+    // the job found for a type first, in which case the search goes
+    // on with the next type.
     //
     // Pre-conditions:
-    //  mJobSet must not be empty.
-    //  mJobSet holds at least one RunnableJob
+    //  At least one RunnableJob exists for each outstanding task.
     //
     // Post-conditions:
-    //  job is a valid Job object.
-    //  job is removed from mJobQueue.
-    //  Waiting job count of its type is decremented
-    //  Running job count of its type is incremented
+    //  If true is returned:
+    //   job is a valid Job object.
+    //   job is removed from the queue of its type.
+    //   Waiting job count of its type is decremented
+    //   Running job count of its type is incremented
     //
     // Invariants:
-    //  The calling thread owns the JobLock
-    void getNextJob (Job& job);
+    //  The calling thread holds no JobTypeData lock
+    bool getNextJob (Job& job);
 
     // Indicates that a running Job has completed its task.
     //
     // Pre-conditions:
-    //  Job must not exist in mJobSet.
+    //  Job must not be waiting.
     //  The JobType must not be invalid.
     //
     // Post-conditions:
@@ -278,7 +297,7 @@ private:
     //  A new task is signaled if there are more waiting Jobs than the limit, if any.
     //
     // Invariants:
-    //  <none>
+    //  The calling thread holds no JobTypeData lock
     void finishJob (JobType type);
 
     template <class Rep, class Period>
@@ -292,7 +311,7 @@ private:
     // Runs the next appropriate waiting Job.
     //
     // Pre-conditions:
-    //  A RunnableJob must exist in the JobSet
+    //  A RunnableJob must be waiting
     //
     // Post-conditions:
     //  The chosen RunnableJob will have Job::doJob() called.
@@ -27,8 +27,12 @@
 #define CASINOCOIN_CORE_JOBTYPEDATA_H_INCLUDED
 
 #include <casinocoin/basics/Log.h>
+#include <casinocoin/core/Job.h>
 #include <casinocoin/core/JobTypeInfo.h>
 #include <casinocoin/beast/insight/Collector.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 namespace casinocoin
 {
@@ -54,6 +58,17 @@ public:
     /* And the number we deferred executing because of job limits */
     int deferred;
 
+    /* Guards the queue and the counts above */
+    std::mutex mutable mutex;
+
+    /* The jobs waiting, oldest first */
+    std::deque <Job> jobs;
+
+    /* Waiting jobs which may start now. Updated with the mutex held,
+       read without it to skip types with nothing to run.
+    */
+    std::atomic <int> runnable;
+
     /* Notification callbacks */
     beast::insight::Event dequeue;
     beast::insight::Event execute;
@@ -66,6 +81,7 @@ public:
         , waiting (0)
         , running (0)
         , deferred (0)
+        , runnable (0)
     {
         m_load.setTargetLatency (
             info.getAverageLatency (),
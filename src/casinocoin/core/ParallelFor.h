@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_CORE_PARALLELFOR_H_INCLUDED
+#define CASINOCOIN_CORE_PARALLELFOR_H_INCLUDED
+
+#include <casinocoin/core/JobQueue.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace casinocoin {
+
+/** Call a function for each index in [0, count) on up to threads threads.
+
+    The calling thread takes part and helpers are borrowed from the job
+    queue. Indexes are handed out as threads become free, and the call
+    returns once every index is done. Helpers that start late find no
+    work left, so the caller never waits on a job that hasn't started,
+    even when the job queue is busy.
+
+    If the function throws, the first exception is rethrown to the
+    caller once the other indexes are done.
+*/
+inline
+void
+parallelFor (JobQueue& jobQueue, JobType type, int threads,
+    std::size_t count, std::function <void (std::size_t)> f)
+{
+    if (threads <= 1 || count <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            f (i);
+        return;
+    }
+
+    // Shared with the helpers, which may outlive the call
+    struct State
+    {
+        std::function <void (std::size_t)> f;
+        std::size_t count;
+        std::atomic <std::size_t> next {0};
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t done = 0;
+        std::exception_ptr error;
+
+        void
+        run ()
+        {
+            for (std::size_t i; (i = next++) < count;)
+            {
+                std::exception_ptr e;
+                try
+                {
+                    f (i);
+                }
+                catch (...)
+                {
+                    e = std::current_exception ();
+                }
+
+                std::lock_guard <std::mutex> lock (mutex);
+                if (e && ! error)
+                    error = e;
+                if (++done == count)
+                    cond.notify_all ();
+            }
+        }
+    };
+
+    auto state = std::make_shared <State> ();
+    state->f = std::move (f);
+    state->count = count;
+
+    auto const helpers = std::min <std::size_t> (threads - 1, count - 1);
+    for (std::size_t i = 0; i < helpers; ++i)
+        jobQueue.addJob (type, "parallelFor",
+            [state] (Job&) { state->run (); });
+
+    state->run ();
+
+    std::unique_lock <std::mutex> lock (state->mutex);
+    state->cond.wait (lock,
+        [&state] { return state->done == state->count; });
+    if (state->error)
+        std::rethrow_exception (state->error);
+}
+
+} // casinocoin
+
+#endif
@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_CORE_PERFLOG_H_INCLUDED
+#define CASINOCOIN_CORE_PERFLOG_H_INCLUDED
+
+#include <casinocoin/basics/BasicConfig.h>
+#include <casinocoin/core/Job.h>
+#include <casinocoin/core/Stoppable.h>
+#include <casinocoin/json/json_value.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+
+namespace casinocoin {
+namespace perf {
+
+/** Records how long jobs and RPC commands wait and run.
+
+    For every job type and every RPC command the time spent waiting
+    to run and the time spent running are kept in histograms, from
+    which percentiles are reported. The counters are cumulative since
+    the server started. They are written periodically as one JSON
+    object per line to the configured file, and are available through
+    the perf admin command.
+*/
+class PerfLog
+{
+public:
+    using microseconds = std::chrono::microseconds;
+
+    struct Setup
+    {
+        // Where to write the counters, no file when empty
+        boost::filesystem::path perfLog;
+
+        // How often to write the counters
+        std::chrono::milliseconds logInterval {std::chrono::seconds (10)};
+    };
+
+    virtual ~PerfLog () = default;
+
+    /** Record a job which ran.
+
+        @param type The type of the job.
+        @param queued Time between adding the job and starting it.
+        @param ran Time the job took to run.
+    */
+    virtual
+    void
+    jobFinish (JobType type, microseconds queued, microseconds ran) = 0;
+
+    /** Record an RPC command which ran.
+
+        @param method The name of the command.
+        @param queued Time between receiving the request and starting the
+                      command, or zero if not known.
+        @param ran Time the command took to run.
+        @param failed Whether the command returned an error.
+    */
+    virtual
+    void
+    rpcFinish (std::string const& method, microseconds queued,
+        microseconds ran, bool failed) = 0;
+
+    /** Returns the counters of every job type and command seen so far. */
+    virtual
+    Json::Value
+    countersJson () const = 0;
+};
+
+/** Read the [perf] section.
+
+    A relative perf_log is taken to be relative to configDir.
+*/
+PerfLog::Setup
+setup_PerfLog (Section const& section,
+    boost::filesystem::path const& configDir);
+
+std::unique_ptr<PerfLog>
+make_PerfLog (PerfLog::Setup const& setup, Stoppable& parent,
+    beast::Journal journal);
+
+} // perf
+} // casinocoin
+
+#endif
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/core/CheckBatcher.h>
+#include <casinocoin/core/ParallelFor.h>
+#include <algorithm>
+#include <exception>
+#include <iterator>
+
+namespace casinocoin {
+
+CheckBatcher::CheckBatcher (JobQueue& jobQueue, int threads)
+    : jobQueue_ (jobQueue)
+    , threads_ (std::max (threads, 1))
+{
+}
+
+void
+CheckBatcher::add (JobType type, Check check, Dispatch dispatch)
+{
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        auto& queue = queues_[type];
+        queue.items.push_back (
+            Item {std::move (check), std::move (dispatch)});
+        if (queue.scheduled)
+            return;
+        queue.scheduled = true;
+    }
+
+    schedule (type);
+}
+
+void
+CheckBatcher::schedule (JobType type)
+{
+    auto self = shared_from_this ();
+    jobQueue_.addJob (type, "checkBatch",
+        [self, type] (Job&) { self->run (type); });
+}
+
+void
+CheckBatcher::run (JobType type)
+{
+    std::vector <Item> batch;
+    bool more;
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        auto& items = queues_[type].items;
+        auto const n = std::min (items.size (), maxBatch);
+        std::move (items.begin (), items.begin () + n,
+            std::back_inserter (batch));
+        items.erase (items.begin (), items.begin () + n);
+
+        // Checks arriving from now on need another job. If some are
+        // still left over, this job schedules it.
+        more = ! items.empty ();
+        queues_[type].scheduled = more;
+    }
+
+    if (more)
+        schedule (type);
+
+    parallelFor (jobQueue_, type, threads_, batch.size (),
+        [&batch] (std::size_t i)
+        {
+            try
+            {
+                batch[i].valid = batch[i].check ();
+            }
+            catch (std::exception const&)
+            {
+                batch[i].valid = false;
+            }
+        });
+
+    for (auto& item : batch)
+        item.dispatch (item.valid);
+}
+
+} // casinocoin
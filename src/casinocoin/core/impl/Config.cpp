@@ -513,6 +513,8 @@ void Config::loadFromString (std::string const& fileContents)
         PATH_SEARCH_FAST    = beast::lexicalCastThrow <int> (strTemp);
     if (getSingleSection (secConfig, SECTION_PATH_SEARCH_MAX, strTemp, j_))
         PATH_SEARCH_MAX     = beast::lexicalCastThrow <int> (strTemp);
+    if (getSingleSection (secConfig, SECTION_PATH_SEARCH_THREADS, strTemp, j_))
+        PATH_SEARCH_THREADS = beast::lexicalCastThrow <int> (strTemp);
 
     if (getSingleSection (secConfig, SECTION_DEBUG_LOGFILE, strTemp, j_))
         DEBUG_LOGFILE       = strTemp;
@@ -623,6 +625,8 @@ int Config::getSize (SizedItemName item) const
         { siHashNodeDBCache,    {   4,      12,     24,     64,         128     } },
         { siTxnDBCache,         {   4,      12,     24,     64,         128     } },
         { siLgrDBCache,         {   4,      8,      16,     32,         128     } },
+
+        { siSignatureCacheSize, {   16384,  32768,  65536,  131072,     262144  } },
     };
 
     for (int i = 0; i < (sizeof (sizeTable) / sizeof (SizedItem)); ++i)
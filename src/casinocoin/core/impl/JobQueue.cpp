@@ -25,38 +25,41 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/core/JobQueue.h>
+#include <casinocoin/core/PerfLog.h>
 #include <casinocoin/basics/contract.h>
+#include <thread>
 
 namespace casinocoin {
 
 JobQueue::JobQueue (beast::insight::Collector::ptr const& collector,
-    Stoppable& parent, beast::Journal journal, Logs& logs)
+    Stoppable& parent, beast::Journal journal, Logs& logs,
+    perf::PerfLog& perfLog)
     : Stoppable ("JobQueue", parent)
     , m_journal (journal)
     , m_lastJob (0)
     , m_invalidJobData (getJobTypes ().getInvalid (), collector, logs)
+    , m_jobCount (0)
     , m_processCount (0)
     , m_workers (*this, "JobQueue", 0)
     , m_cancelCallback (std::bind (&Stoppable::isStopping, this))
     , m_collector (collector)
+    , perfLog_ (perfLog)
 {
     hook = m_collector->make_hook (std::bind (&JobQueue::collect, this));
     job_count = m_collector->make_gauge ("job_count");
 
+    // The map is never changed after this, so it is
+    // read without a lock.
+    for (auto const& x : getJobTypes ())
     {
-        std::lock_guard <std::mutex> lock (m_mutex);
-
-        for (auto const& x : getJobTypes ())
-        {
-            JobTypeInfo const& jt = x.second;
-
-            // And create dynamic information for all jobs
-            auto const result (m_jobData.emplace (std::piecewise_construct,
-                std::forward_as_tuple (jt.type ()),
-                std::forward_as_tuple (jt, m_collector, logs)));
-            assert (result.second == true);
-            (void) result.second;
-        }
+        JobTypeInfo const& jt = x.second;
+
+        // And create dynamic information for all jobs
+        auto const result (m_jobData.emplace (std::piecewise_construct,
+            std::forward_as_tuple (jt.type ()),
+            std::forward_as_tuple (jt, m_collector, logs)));
+        assert (result.second == true);
+        (void) result.second;
     }
 }
 
@@ -69,8 +72,7 @@ JobQueue::~JobQueue ()
 void
 JobQueue::collect ()
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-    job_count = m_jobSet.size ();
+    job_count = m_jobCount.load ();
 }
 
 void
@@ -91,7 +93,7 @@ JobQueue::addJob (JobType type, std::string const& name,
     assert (type == jtCLIENT || m_workers.getNumberOfThreads () > 0);
 
     {
-        std::lock_guard <std::mutex> lock (m_mutex);
+        std::lock_guard <std::mutex> lock (data.mutex);
 
         // If this goes off it means that a child didn't follow
         // the Stoppable API rules. A job may only be added if:
@@ -106,38 +108,38 @@ JobQueue::addJob (JobType type, std::string const& name,
         //
         assert (! isStopped() && (
             m_processCount>0 ||
-            ! m_jobSet.empty () ||
+            m_jobCount>0 ||
             ! areChildrenStopped()));
 
-        std::pair <std::set <Job>::iterator, bool> result (
-            m_jobSet.insert (Job (type, name, ++m_lastJob,
-                data.load (), func, m_cancelCallback)));
-        queueJob (*result.first, lock);
+        data.jobs.emplace_back (type, name, ++m_lastJob,
+            data.load (), func, m_cancelCallback);
+        ++m_jobCount;
+        queueJob (data, lock);
     }
 }
 
 int
 JobQueue::getJobCount (JobType t) const
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find (t);
 
-    return (c == m_jobData.end ())
-        ? 0
-        : c->second.waiting;
+    if (c == m_jobData.end ())
+        return 0;
+
+    std::lock_guard <std::mutex> lock (c->second.mutex);
+    return c->second.waiting;
 }
 
 int
 JobQueue::getJobCountTotal (JobType t) const
 {
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     JobDataMap::const_iterator c = m_jobData.find (t);
 
-    return (c == m_jobData.end ())
-        ? 0
-        : (c->second.waiting + c->second.running);
+    if (c == m_jobData.end ())
+        return 0;
+
+    std::lock_guard <std::mutex> lock (c->second.mutex);
+    return c->second.waiting + c->second.running;
 }
 
 int
@@ -146,12 +148,13 @@ JobQueue::getJobCountGE (JobType t) const
     // return the number of jobs at this priority level or greater
     int ret = 0;
 
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     for (auto const& x : m_jobData)
     {
         if (x.first >= t)
+        {
+            std::lock_guard <std::mutex> lock (x.second.mutex);
             ret += x.second.waiting;
+        }
     }
 
     return ret;
@@ -232,8 +235,6 @@ JobQueue::getJson (int c)
 
     Json::Value priorities = Json::arrayValue;
 
-    std::lock_guard <std::mutex> lock (m_mutex);
-
     for (auto& x : m_jobData)
     {
         assert (x.first != jtINVALID);
@@ -245,8 +246,13 @@ JobQueue::getJson (int c)
 
         LoadMonitor::Stats stats (data.stats ());
 
-        int waiting (data.waiting);
-        int running (data.running);
+        int waiting;
+        int running;
+        {
+            std::lock_guard <std::mutex> lock (data.mutex);
+            waiting = data.waiting;
+            running = data.running;
+        }
 
         if ((stats.count != 0) || (waiting != 0) ||
             (stats.latencyPeak != 0) || (running != 0))
@@ -287,7 +293,7 @@ JobQueue::rendezvous()
     cv_.wait(lock, [&]
     {
         return m_processCount == 0 &&
-            m_jobSet.empty();
+            m_jobCount == 0;
     });
 }
 
@@ -320,13 +326,13 @@ JobQueue::checkStopped (std::lock_guard <std::mutex> const& lock)
     //  1. A stop notification was received
     //  2. All Stoppable children have stopped
     //  3. There are no executing calls to processTask
-    //  4. There are no remaining Jobs in the job set
+    //  4. There are no remaining waiting Jobs
     //  5. There are no suspended coroutines
     //
     if (isStopping() &&
         areChildrenStopped() &&
         (m_processCount == 0) &&
-        m_jobSet.empty() &&
+        (m_jobCount == 0) &&
         nSuspend_ == 0)
     {
         stopped();
@@ -334,16 +340,14 @@ JobQueue::checkStopped (std::lock_guard <std::mutex> const& lock)
 }
 
 void
-JobQueue::queueJob (Job const& job, std::lock_guard <std::mutex> const& lock)
+JobQueue::queueJob (JobTypeData& data, std::lock_guard <std::mutex> const& lock)
 {
-    JobType const type (job.getType ());
-    assert (type != jtINVALID);
-    assert (m_jobSet.find (job) != m_jobSet.end ());
-
-    JobTypeData& data (getJobTypeData (type));
+    assert (data.type () != jtINVALID);
+    assert (! data.jobs.empty ());
 
-    if (data.waiting + data.running < getJobLimit (type))
+    if (data.waiting + data.running < getJobLimit (data.type ()))
     {
+        ++data.runnable;
         m_workers.addTask ();
     }
     else
@@ -355,38 +359,39 @@ JobQueue::queueJob (Job const& job, std::lock_guard <std::mutex> const& lock)
     ++data.waiting;
 }
 
-void
+bool
 JobQueue::getNextJob (Job& job)
 {
-    assert (! m_jobSet.empty ());
-
-    std::set <Job>::const_iterator iter;
-    for (iter = m_jobSet.begin (); iter != m_jobSet.end (); ++iter)
+    // Highest priority first
+    for (auto iter = m_jobData.rbegin (); iter != m_jobData.rend (); ++iter)
     {
-        JobTypeData& data (getJobTypeData (iter->getType ()));
+        JobTypeData& data (iter->second);
+
+        if (data.runnable.load (std::memory_order_relaxed) <= 0)
+            continue;
+
+        std::lock_guard <std::mutex> lock (data.mutex);
 
         assert (data.running <= getJobLimit (data.type ()));
 
         // Run this job if we're running below the limit.
-        if (data.running < getJobLimit (data.type ()))
-        {
-            assert (data.waiting > 0);
-            break;
-        }
-    }
-
-    assert (iter != m_jobSet.end ());
+        if (data.jobs.empty () || data.running >= getJobLimit (data.type ()))
+            continue;
 
-    JobType const type = iter->getType ();
-    JobTypeData& data (getJobTypeData (type));
+        assert (data.waiting > 0);
+        assert (data.type () != jtINVALID);
 
-    assert (type != jtINVALID);
+        job = std::move (data.jobs.front ());
+        data.jobs.pop_front ();
 
-    job = *iter;
-    m_jobSet.erase (iter);
+        --data.runnable;
+        --data.waiting;
+        ++data.running;
+        --m_jobCount;
+        return true;
+    }
 
-    --data.waiting;
-    ++data.running;
+    return false;
 }
 
 void
@@ -396,12 +401,15 @@ JobQueue::finishJob (JobType type)
 
     JobTypeData& data = getJobTypeData (type);
 
+    std::lock_guard <std::mutex> lock (data.mutex);
+
     // Queue a deferred task if possible
     if (data.deferred > 0)
     {
         assert (data.running + data.waiting >= getJobLimit (type));
 
         --data.deferred;
+        ++data.runnable;
         m_workers.addTask ();
     }
 
@@ -434,33 +442,50 @@ void
 JobQueue::processTask ()
 {
     JobType type;
+    Job::clock_type::duration queued;
 
     {
         Job::clock_type::time_point const start_time (
             Job::clock_type::now());
         {
             Job job;
-            {
-                std::lock_guard <std::mutex> lock (m_mutex);
-                getNextJob (job);
-                ++m_processCount;
-            }
+
+            // Counted as processing before the job leaves its queue,
+            // so the queue never looks idle while a job changes hands.
+            ++m_processCount;
+
+            // Every task has a runnable job, but with the types locked
+            // one at a time a job can be missed while other threads
+            // take and add jobs, so look again until one is found.
+            while (! getNextJob (job))
+                std::this_thread::yield ();
+
             type = job.getType();
             JobTypeData& data(getJobTypeData(type));
             JLOG(m_journal.trace()) << "Doing " << data.name () << " job";
-            on_dequeue (job.getType (), start_time - job.queue_time ());
+            queued = start_time - job.queue_time ();
+            on_dequeue (job.getType (), queued);
             job.doJob ();
         }
-        on_execute(type, Job::clock_type::now() - start_time);
+        auto const ran = Job::clock_type::now() - start_time;
+        on_execute(type, ran);
+
+        using namespace std::chrono;
+        perfLog_.jobFinish (type, duration_cast<microseconds> (queued),
+            duration_cast<microseconds> (ran));
     }
 
+    // Job should be destroyed before calling checkStopped
+    // otherwise destructors with side effects can access
+    // parent objects that are already destroyed.
+    finishJob (type);
+
+    // The queue can only become idle when the last job in
+    // progress finishes, so only then is the lock needed.
+    if (--m_processCount == 0)
     {
         std::lock_guard <std::mutex> lock (m_mutex);
-        // Job should be destroyed before calling checkStopped
-        // otherwise destructors with side effects can access
-        // parent objects that are already destroyed.
-        finishJob (type);
-        if(--m_processCount == 0 && m_jobSet.empty())
+        if (m_processCount == 0 && m_jobCount == 0)
             cv_.notify_all();
         checkStopped (lock);
     }
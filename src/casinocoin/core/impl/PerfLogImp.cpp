@@ -0,0 +1,313 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/core/impl/PerfLogImp.h>
+#include <casinocoin/basics/chrono.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/core/ConfigSections.h>
+#include <casinocoin/json/json_writer.h>
+#include <casinocoin/beast/core/CurrentThreadName.h>
+#include <algorithm>
+#include <cmath>
+
+namespace casinocoin {
+namespace perf {
+
+Histogram::Histogram ()
+{
+    counts_.fill (0);
+}
+
+std::size_t
+Histogram::bucket (std::uint64_t value)
+{
+    std::size_t const subBuckets = 1 << subBits;
+    if (value < subBuckets)
+        return value;
+
+    // The position of the highest bit picks the power of two,
+    // the next subBits bits the bucket within it.
+    int exponent = 63;
+    while (! (value & (std::uint64_t (1) << exponent)))
+        --exponent;
+    if (exponent >= maxBits)
+        return buckets - 1;
+
+    auto const sub = (value >> (exponent - subBits)) & (subBuckets - 1);
+    return ((exponent - subBits + 1) << subBits) + sub;
+}
+
+std::uint64_t
+Histogram::highestInBucket (std::size_t bucket)
+{
+    std::size_t const subBuckets = 1 << subBits;
+    if (bucket < subBuckets)
+        return bucket;
+
+    auto const shift = (bucket >> subBits) - 1;
+    auto const sub = bucket & (subBuckets - 1);
+    return ((subBuckets + sub + 1) << shift) - 1;
+}
+
+void
+Histogram::insert (std::uint64_t value)
+{
+    ++counts_[bucket (value)];
+    ++count_;
+    sum_ += value;
+    max_ = std::max (max_, value);
+}
+
+std::uint64_t
+Histogram::percentile (double p) const
+{
+    if (count_ == 0)
+        return 0;
+
+    auto const target = std::max<std::uint64_t> (1,
+        static_cast<std::uint64_t> (std::ceil (p / 100 * count_)));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets; ++i)
+    {
+        seen += counts_[i];
+        if (seen >= target)
+            return std::min (highestInBucket (i), max_);
+    }
+    return max_;
+}
+
+Json::Value
+Histogram::getJson () const
+{
+    Json::Value ret (Json::objectValue);
+    ret["count"] = std::to_string (count_);
+    if (count_ == 0)
+        return ret;
+    ret["avg_us"] = std::to_string (sum_ / count_);
+    ret["p50_us"] = std::to_string (percentile (50));
+    ret["p90_us"] = std::to_string (percentile (90));
+    ret["p99_us"] = std::to_string (percentile (99));
+    ret["max_us"] = std::to_string (max_);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+
+Json::Value
+PerfLogImp::Counters::getJson () const
+{
+    Json::Value ret;
+    std::lock_guard <std::mutex> lock (mutex);
+    if (ran.count () == 0)
+        return ret;
+    ret["queued"] = queued.getJson ();
+    ret["running"] = ran.getJson ();
+    if (failed != 0)
+        ret["failed"] = std::to_string (failed);
+    return ret;
+}
+
+PerfLogImp::PerfLogImp (Setup const& setup, Stoppable& parent,
+        beast::Journal journal)
+    : Stoppable ("PerfLog", parent)
+    , setup_ (setup)
+    , j_ (journal)
+{
+    for (auto const& x : jobTypes_)
+    {
+        jobs_.emplace (std::piecewise_construct,
+            std::forward_as_tuple (x.first), std::forward_as_tuple ());
+    }
+}
+
+PerfLogImp::~PerfLogImp ()
+{
+    onStop ();
+}
+
+void
+PerfLogImp::jobFinish (JobType type, microseconds queued,
+    microseconds ran)
+{
+    auto const iter = jobs_.find (type);
+    if (iter == jobs_.end ())
+        return;
+
+    auto& counters = iter->second;
+    std::lock_guard <std::mutex> lock (counters.mutex);
+    counters.queued.insert (queued.count ());
+    counters.ran.insert (ran.count ());
+}
+
+void
+PerfLogImp::rpcFinish (std::string const& method, microseconds queued,
+    microseconds ran, bool failed)
+{
+    Counters* counters = nullptr;
+    {
+        boost::shared_lock <boost::shared_mutex> lock (rpcMutex_);
+        auto const iter = rpc_.find (method);
+        if (iter != rpc_.end ())
+            counters = iter->second.get ();
+    }
+    if (! counters)
+    {
+        boost::unique_lock <boost::shared_mutex> lock (rpcMutex_);
+        auto& c = rpc_[method];
+        if (! c)
+            c = std::make_unique <Counters> ();
+        counters = c.get ();
+    }
+
+    std::lock_guard <std::mutex> lock (counters->mutex);
+    if (queued.count () != 0)
+        counters->queued.insert (queued.count ());
+    counters->ran.insert (ran.count ());
+    if (failed)
+        ++counters->failed;
+}
+
+Json::Value
+PerfLogImp::countersJson () const
+{
+    Json::Value ret (Json::objectValue);
+
+    Json::Value& jobs = ret["jobs"] = Json::objectValue;
+    for (auto const& x : jobs_)
+    {
+        auto counters = x.second.getJson ();
+        if (! counters.isNull ())
+            jobs[jobTypes_.get (x.first).name ()] = std::move (counters);
+    }
+
+    Json::Value& rpc = ret["rpc"] = Json::objectValue;
+    boost::shared_lock <boost::shared_mutex> lock (rpcMutex_);
+    for (auto const& x : rpc_)
+        rpc[x.first] = x.second->getJson ();
+
+    return ret;
+}
+
+void
+PerfLogImp::report (boost::filesystem::ofstream& out)
+{
+    auto counters = countersJson ();
+    counters["time"] = to_string (std::chrono::system_clock::now ());
+    out << Json::FastWriter ().write (counters) << std::endl;
+}
+
+void
+PerfLogImp::run ()
+{
+    beast::setCurrentThreadName ("PerfLog");
+
+    boost::filesystem::ofstream out;
+    boost::system::error_code ec;
+    if (setup_.perfLog.has_parent_path ())
+        boost::filesystem::create_directories (
+            setup_.perfLog.parent_path (), ec);
+    out.open (setup_.perfLog, std::ios::out | std::ios::app);
+    if (! out)
+    {
+        JLOG (j_.error()) <<
+            "Unable to open performance log " << setup_.perfLog;
+    }
+
+    std::unique_lock <std::mutex> lock (mutex_);
+    while (! stop_)
+    {
+        if (cond_.wait_for (lock, setup_.logInterval,
+                [this] { return stop_; }))
+            break;
+
+        if (out)
+        {
+            lock.unlock ();
+            report (out);
+            lock.lock ();
+        }
+    }
+
+    // The counters at shutdown cover the whole run
+    if (out)
+        report (out);
+}
+
+void
+PerfLogImp::onStart ()
+{
+    if (! setup_.perfLog.empty ())
+        thread_ = std::thread {&PerfLogImp::run, this};
+}
+
+void
+PerfLogImp::onStop ()
+{
+    if (thread_.joinable ())
+    {
+        {
+            std::lock_guard <std::mutex> lock (mutex_);
+            stop_ = true;
+        }
+        cond_.notify_all ();
+        thread_.join ();
+    }
+    if (! isStopped ())
+        stopped ();
+}
+
+//------------------------------------------------------------------------------
+
+PerfLog::Setup
+setup_PerfLog (Section const& section,
+    boost::filesystem::path const& configDir)
+{
+    PerfLog::Setup setup;
+
+    std::string path;
+    if (set (path, "perf_log", section))
+    {
+        setup.perfLog = path;
+        if (setup.perfLog.is_relative ())
+            setup.perfLog = configDir / setup.perfLog;
+    }
+
+    std::uint32_t interval = 0;
+    if (set (interval, "log_interval", section))
+    {
+        if (interval == 0)
+            Throw<std::runtime_error> (
+                "Invalid log_interval in [" SECTION_PERF "] section");
+        setup.logInterval = std::chrono::seconds (interval);
+    }
+
+    return setup;
+}
+
+std::unique_ptr<PerfLog>
+make_PerfLog (PerfLog::Setup const& setup, Stoppable& parent,
+    beast::Journal journal)
+{
+    return std::make_unique <PerfLogImp> (setup, parent, journal);
+}
+
+} // perf
+} // casinocoin
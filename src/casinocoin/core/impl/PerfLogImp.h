@@ -0,0 +1,168 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_CORE_PERFLOGIMP_H_INCLUDED
+#define CASINOCOIN_CORE_PERFLOGIMP_H_INCLUDED
+
+#include <casinocoin/core/PerfLog.h>
+#include <casinocoin/core/JobTypes.h>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace casinocoin {
+namespace perf {
+
+/** A histogram of durations, in the manner of HdrHistogram.
+
+    Values below 16 have a bucket each. Above that, every power of two
+    is split into 16 buckets, so a value is known to within 1/16th of
+    itself whatever its size, in a fixed and small amount of memory.
+    Values of 2^40 and above share the last bucket.
+
+    Not thread safe.
+*/
+class Histogram
+{
+public:
+    static int const subBits = 4;
+    static int const maxBits = 40;
+    static std::size_t const buckets =
+        (maxBits - subBits + 1) << subBits;
+
+    Histogram ();
+
+    void
+    insert (std::uint64_t value);
+
+    std::uint64_t
+    count () const
+    {
+        return count_;
+    }
+
+    std::uint64_t
+    max () const
+    {
+        return max_;
+    }
+
+    /** Returns the value below which lie p percent of the values.
+
+        The result is the highest value of the bucket the percentile
+        falls in, so it is never below the true percentile and is
+        above it by less than 1/16th.
+    */
+    std::uint64_t
+    percentile (double p) const;
+
+    /** Returns the count, average, p50, p90, p99 and max. */
+    Json::Value
+    getJson () const;
+
+    static
+    std::size_t
+    bucket (std::uint64_t value);
+
+    static
+    std::uint64_t
+    highestInBucket (std::size_t bucket);
+
+private:
+    std::array <std::uint64_t, buckets> counts_;
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t max_ = 0;
+};
+
+//------------------------------------------------------------------------------
+
+class PerfLogImp
+    : public PerfLog
+    , public Stoppable
+{
+private:
+    struct Counters
+    {
+        std::mutex mutable mutex;
+        Histogram queued;
+        Histogram ran;
+        std::uint64_t failed = 0;
+
+        Json::Value
+        getJson () const;
+    };
+
+    Setup const setup_;
+    beast::Journal j_;
+    JobTypes const jobTypes_;
+
+    // Made for every job type up front, so the map is never
+    // changed and is read without a lock.
+    std::map <JobType, Counters> jobs_;
+
+    // Commands are added as they are first seen. Recording takes
+    // the lock shared to find the counters of a command.
+    boost::shared_mutex mutable rpcMutex_;
+    std::map <std::string, std::unique_ptr <Counters>> rpc_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_ = false;
+
+    void
+    run ();
+
+    void
+    report (boost::filesystem::ofstream& out);
+
+public:
+    PerfLogImp (Setup const& setup, Stoppable& parent,
+        beast::Journal journal);
+
+    ~PerfLogImp () override;
+
+    void
+    jobFinish (JobType type, microseconds queued,
+        microseconds ran) override;
+
+    void
+    rpcFinish (std::string const& method, microseconds queued,
+        microseconds ran, bool failed) override;
+
+    Json::Value
+    countersJson () const override;
+
+    void
+    onStart () override;
+
+    void
+    onStop () override;
+};
+
+} // perf
+} // casinocoin
+
+#endif
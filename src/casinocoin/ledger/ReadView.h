@@ -153,6 +153,16 @@ public:
     bool
     enabled (uint256 const& id) const;
 
+    /** Returns a digest identifying the rule set.
+
+        The digest covers the amendments enabled in the
+        ledger the rules were constructed from as well as
+        the preset features, so rules built from the same
+        ledger and presets have the same digest.
+    */
+    uint256
+    digest () const;
+
     /** Returns `true` if these rules don't match the ledger. */
     bool
     changed (DigestAwareReadView const& ledger) const;
@@ -25,7 +25,10 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/ledger/ReadView.h>
+#include <casinocoin/protocol/digest.h>
 #include <boost/optional.hpp>
+#include <algorithm>
+#include <vector>
 
 namespace casinocoin {
 
@@ -36,12 +39,30 @@ private:
         hardened_hash<>> set_;
     boost::optional<uint256> digest_;
     std::unordered_set<uint256, beast::uhash<>> const& presets_;
+    // Covers both the amendments and the presets
+    uint256 id_;
+
+    // The presets go in sorted, so the same set
+    // always gives the same digest.
+    void
+    makeId()
+    {
+        std::vector<uint256> presets(presets_.begin(), presets_.end());
+        std::sort(presets.begin(), presets.end());
+        sha512_half_hasher h;
+        using beast::hash_append;
+        hash_append(h, digest_ ? *digest_ : uint256{zero});
+        for (auto const& feature : presets)
+            hash_append(h, feature);
+        id_ = static_cast<uint256>(h);
+    }
 
 public:
     explicit Impl(
             std::unordered_set<uint256, beast::uhash<>> const& presets)
         : presets_(presets)
     {
+        makeId();
     }
 
     explicit Impl(
@@ -51,6 +72,7 @@ public:
     {
         auto const k = keylet::amendments();
         digest_ = ledger.digest(k.key);
+        makeId();
         if (! digest_)
             return;
         auto const sle = ledger.read(k);
@@ -73,6 +95,12 @@ public:
         return set_.count(feature) > 0;
     }
 
+    uint256
+    digest () const
+    {
+        return id_;
+    }
+
     bool
     changed (DigestAwareReadView const& ledger) const
     {
@@ -117,6 +145,13 @@ Rules::enabled (uint256 const& id) const
     return impl_->enabled(id);
 }
 
+uint256
+Rules::digest () const
+{
+    assert (impl_);
+    return impl_->digest();
+}
+
 bool
 Rules::changed (DigestAwareReadView const& ledger) const
 {
@@ -103,6 +103,23 @@ public:
     */
     virtual void for_each (std::function <void (std::shared_ptr<NodeObject>)> f) = 0;
 
+    /** Visit the key of every object in the database
+        Unlike @ref for_each, the other methods may be called while
+        this runs. Objects stored in the meantime may not be visited.
+        @note This will not be called concurrently with itself.
+    */
+    virtual void for_each_key (std::function <void (void const* key)> f) = 0;
+
+    /** Make every object stored so far durable.
+
+        This is only called by an import, which stores into the backend
+        before anything else uses it. A backend may close and reopen its
+        files here, and is unusable if this throws.
+
+        @note This will not be called concurrently with other methods.
+    */
+    virtual void sync () = 0;
+
     /** Estimate the number of write operations pending. */
     virtual int getWriteLoad () = 0;
 
@@ -34,6 +34,24 @@
 namespace casinocoin {
 namespace NodeStore {
 
+/** How to import objects from another database. */
+struct ImportOptions
+{
+    /** Threads checking and storing the objects read from the source. */
+    int threads = 1;
+
+    /** Whether to skip objects whose key is not the hash of their data. */
+    bool verify = true;
+
+    /** A file recording the progress of the import, or empty for none.
+
+        An import interrupted for any reason resumes from the last
+        progress recorded, as long as the source and destination are
+        the same. The file is removed once the import completes.
+    */
+    std::string checkpoint;
+};
+
 /** Persistency layer for NodeObject
 
     A Node is a ledger object which is uniquely identified by a key, which is
@@ -93,13 +111,24 @@ public:
         @note This can be called concurrently.
         @param hash The key of the object to retrieve
         @param object The object retrieved
+        @param priority How soon the read is needed
         @return Whether the operation completed
     */
-    virtual bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object) = 0;
+    virtual bool asyncFetch (uint256 const& hash,
+        std::shared_ptr<NodeObject>& object, FetchPriority priority) = 0;
+
+    /** Wait for the currently pending async reads of a priority to complete.
+    */
+    virtual void waitReads (FetchPriority priority) = 0;
 
-    /** Wait for all currently pending async reads to complete.
+    /** Get the latency histogram of async reads of a priority.
+        The latency runs from the request to the completion of the read.
+        Element i counts the reads which took less than 2^i milliseconds
+        and more than the previous element. The last element counts the
+        reads slower than that.
     */
-    virtual void waitReads () = 0;
+    virtual std::vector<std::uint64_t>
+    getReadLatency (FetchPriority priority) const = 0;
 
     /** Get the maximum number of async reads the node store prefers.
         @return The number of async reads preferred.
@@ -131,8 +160,17 @@ public:
     */
     virtual void for_each(std::function <void(std::shared_ptr<NodeObject>)> f) = 0;
 
-    /** Import objects from another database. */
-    virtual void import (Database& source) = 0;
+    /** Import objects from another database.
+
+        The source is read in the order of its for_each, while the
+        objects are checked by a pool of threads and stored one batch
+        at a time.
+
+        @note This must finish before anything else uses this database,
+              since the destination backend is synced while storing.
+    */
+    virtual void import (Database& source,
+        ImportOptions const& options = {}) = 0;
 
     /** Retrieve the estimated number of pending write operations.
         This is used for diagnostics.
@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_NODESTORE_DATABASESHARD_H_INCLUDED
+#define CASINOCOIN_NODESTORE_DATABASESHARD_H_INCLUDED
+
+#include <casinocoin/nodestore/Database.h>
+#include <boost/optional.hpp>
+
+namespace casinocoin {
+namespace NodeStore {
+
+/* A store of ledger history split into shards of a fixed number of
+ * consecutive ledgers. Each shard lives in its own directory with its own
+ * backend. Only one shard is filled at a time; once every ledger in it is
+ * stored the shard is verified and never written again, so a complete
+ * shard directory can be backed up or copied to another server as is.
+ */
+
+class DatabaseShard
+{
+public:
+    virtual ~DatabaseShard() = default;
+
+    /** Open the shards found on disk.
+
+        @return `false` if the shard directory could not be used.
+    */
+    virtual bool init() = 0;
+
+    /** Choose the next ledger to store.
+
+        @param validLedgerSeq The last fully validated ledger. Only
+                              shards which end before it are filled.
+        @return The sequence of the ledger to acquire, or nothing if no
+                ledger is wanted right now.
+    */
+    virtual boost::optional<std::uint32_t>
+    prepare (std::uint32_t validLedgerSeq) = 0;
+
+    /** Fetch an object from the shard holding a ledger.
+
+        @param hash The key of the object.
+        @param seq The ledger the object belongs to.
+        @return The object, or nullptr if the shard doesn't have it.
+    */
+    virtual std::shared_ptr<NodeObject>
+    fetch (uint256 const& hash, std::uint32_t seq) = 0;
+
+    /** Store an object belonging to a ledger of the shard being filled.
+
+        @return `false` if the ledger is not part of that shard.
+    */
+    virtual bool
+    store (NodeObjectType type, Blob&& data,
+        uint256 const& hash, std::uint32_t seq) = 0;
+
+    /** Whether a ledger is stored in one of the shards. */
+    virtual bool hasLedger (std::uint32_t seq) = 0;
+
+    /** Record that every object of a ledger has been stored.
+
+        @return `true` if that filled the shard, which must then be
+                passed to finalize. No other shard is filled until then.
+    */
+    virtual bool setStored (std::uint32_t seq) = 0;
+
+    /** Verify the shard filled by setStored and make it complete, or
+        remove it if it fails to verify.
+
+        Reads every object of the shard, so it is meant to be run in
+        the background.
+    */
+    virtual void finalize () = 0;
+
+    /** Give up on the shard being filled, for instance because one of
+        its ledgers can't be acquired.
+
+        The shard is removed, and not chosen again until restart.
+    */
+    virtual void abandon () = 0;
+
+    /** The indexes of the complete shards, as a RangeSet string. */
+    virtual std::string getCompleteShards() = 0;
+
+    /** The number of ledgers in each shard. */
+    virtual std::uint32_t ledgersPerShard() const = 0;
+
+    std::uint32_t
+    seqToShardIndex (std::uint32_t seq) const
+    {
+        return (seq - 1) / ledgersPerShard();
+    }
+
+    std::uint32_t
+    firstSeq (std::uint32_t shardIndex) const
+    {
+        return 1 + shardIndex * ledgersPerShard();
+    }
+
+    std::uint32_t
+    lastSeq (std::uint32_t shardIndex) const
+    {
+        return (shardIndex + 1) * ledgersPerShard();
+    }
+};
+
+}
+}
+
+#endif
@@ -28,6 +28,7 @@
 
 #include <casinocoin/nodestore/Factory.h>
 #include <casinocoin/nodestore/DatabaseRotating.h>
+#include <casinocoin/nodestore/DatabaseShard.h>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -102,6 +103,22 @@ public:
                 std::shared_ptr <Backend> writableBackend,
                     std::shared_ptr <Backend> archiveBackend,
                         beast::Journal journal) = 0;
+
+    /** Construct a shard store for ledger history.
+
+        The shards are kept in subdirectories of the 'path' parameter,
+        each with a backend created from the other parameters. Call
+        init() on the result before using it.
+
+        @see DatabaseShard
+    */
+    virtual
+    std::unique_ptr <DatabaseShard>
+    make_DatabaseShard (std::string const& name,
+        Scheduler& scheduler, int readThreads,
+            Stoppable& parent,
+                Section const& config,
+                    beast::Journal journal) = 0;
 };
 
 //------------------------------------------------------------------------------
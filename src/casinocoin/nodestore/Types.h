@@ -52,6 +52,20 @@ enum Status
     customCode = 100
 };
 
+/** How urgently an asynchronous read is needed.
+
+    Pending reads of a higher priority are performed first.
+*/
+enum class FetchPriority
+{
+    // Needed to keep up with the network, such as acquiring
+    // a recent ledger or a consensus transaction set.
+    high,
+
+    // Background work such as acquiring ledger history.
+    low
+};
+
 /** A batch of NodeObjects to write at once. */
 using Batch = std::vector <std::shared_ptr<NodeObject>>;
 }
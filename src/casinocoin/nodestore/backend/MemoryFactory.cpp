@@ -31,6 +31,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -169,6 +170,25 @@ public:
             f (e.second);
     }
 
+    void
+    for_each_key (std::function <void(void const*)> f) override
+    {
+        std::vector <uint256> keys;
+        {
+            std::lock_guard<std::mutex> _(db_->mutex);
+            keys.reserve (db_->table.size ());
+            for (auto const& e : db_->table)
+                keys.push_back (e.first);
+        }
+        for (auto const& key : keys)
+            f (key.begin ());
+    }
+
+    void
+    sync () override
+    {
+    }
+
     int
     getWriteLoad() override
     {
@@ -30,6 +30,7 @@
 #include <casinocoin/nodestore/impl/codec.h>
 #include <casinocoin/nodestore/impl/DecodedBlob.h>
 #include <casinocoin/nodestore/impl/EncodedBlob.h>
+#include <casinocoin/nodestore/impl/Tuning.h>
 #include <nudb/nudb.hpp>
 #include <boost/filesystem.hpp>
 #include <cassert>
@@ -60,7 +61,12 @@ public:
     std::string const name_;
     nudb::store db_;
     std::atomic <bool> deletePath_;
+    // Set while sync has the store closed
+    std::atomic <bool> syncing_ {false};
     Scheduler& scheduler_;
+    // Whether new objects are compressed with dictionaries
+    bool const useDictionaries_;
+    std::unique_ptr <DictionaryCodec> dictionaries_;
 
     NuDBBackend (int keyBytes, Section const& keyValues,
         Scheduler& scheduler, beast::Journal journal)
@@ -69,6 +75,7 @@ public:
         , name_ (get<std::string>(keyValues, "path"))
         , deletePath_(false)
         , scheduler_ (scheduler)
+        , useDictionaries_ (useDictionaries (keyValues))
     {
         if (name_.empty())
             Throw<std::runtime_error> (
@@ -93,6 +100,11 @@ public:
                 Throw<nudb::system_error>(ec);
             if (db_.appnum() != currentType)
                 Throw<std::runtime_error> ("nodestore: unknown appnum");
+            // Existing dictionaries are always loaded,
+            // objects compressed with them may be stored.
+            dictionaries_ = std::make_unique <DictionaryCodec> (
+                folder / "dictionaries", useDictionaries_,
+                    dictionarySize, scheduler_, journal_);
         }
         catch (std::exception const& e)
         {
@@ -107,6 +119,19 @@ public:
         close();
     }
 
+    static
+    bool
+    useDictionaries (Section const& keyValues)
+    {
+        auto const codec = get<std::string>(keyValues, "codec", "lz4");
+        if (codec == "dictionary")
+            return true;
+        if (codec != "lz4")
+            Throw<std::runtime_error> (
+                "nodestore: unknown codec " + codec);
+        return false;
+    }
+
     std::string
     getName() override
     {
@@ -118,6 +143,8 @@ public:
     {
         if (db_.is_open())
         {
+            // Finish training before the files can be removed
+            dictionaries_.reset();
             nudb::error_code ec;
             db_.close(ec);
             if(ec)
@@ -132,15 +159,17 @@ public:
     Status
     fetch (void const* key, std::shared_ptr<NodeObject>* pno) override
     {
+        assert (! syncing_);
         Status status;
         pno->reset();
         nudb::error_code ec;
         db_.fetch (key,
-            [key, pno, &status](void const* data, std::size_t size)
+            [this, key, pno, &status](void const* data, std::size_t size)
             {
                 nudb::detail::buffer bf;
                 auto const result =
-                    nodeobject_decompress(data, size, bf);
+                    nodeobject_decompress(data, size, bf,
+                        dictionaries_.get());
                 DecodedBlob decoded (key, result.first, result.second);
                 if (! decoded.wasOk ())
                 {
@@ -173,12 +202,14 @@ public:
     void
     do_insert (std::shared_ptr <NodeObject> const& no)
     {
+        assert (! syncing_);
         EncodedBlob e;
         e.prepare (no);
         nudb::error_code ec;
         nudb::detail::buffer bf;
         auto const result = nodeobject_compress(
-            e.getData(), e.getSize(), bf);
+            e.getData(), e.getSize(), bf,
+                useDictionaries_ ? dictionaries_.get() : nullptr);
         db_.insert (e.getKey(), result.first, result.second, ec);
         if(ec && ec != nudb::error::key_exists)
             Throw<nudb::system_error>(ec);
@@ -233,7 +264,8 @@ public:
             {
                 nudb::detail::buffer bf;
                 auto const result =
-                    nodeobject_decompress(data, size, bf);
+                    nodeobject_decompress(data, size, bf,
+                        dictionaries_.get());
                 DecodedBlob decoded (key, result.first, result.second);
                 if (! decoded.wasOk ())
                 {
@@ -249,6 +281,49 @@ public:
             Throw<nudb::system_error>(ec);
     }
 
+    void
+    for_each_key (std::function <void(void const*)> f) override
+    {
+        // Scan the data file on the side, leaving the database open.
+        // Only records written when the scan starts are visited, and
+        // the last of them may still be in the middle of being written.
+        nudb::error_code ec;
+        nudb::visit(db_.dat_path(),
+            [&](
+                void const* key, std::size_t,
+                void const*, std::size_t,
+                nudb::error_code&)
+            {
+                f (key);
+            }, nudb::no_progress{}, ec);
+        if(ec && ec != nudb::error::short_read)
+            Throw<nudb::system_error>(ec);
+    }
+
+    void
+    sync() override
+    {
+        // Closing commits everything inserted and syncs the files.
+        // Only an import calls this, with nothing else using the
+        // store, since a fetch or insert would find it closed. If
+        // reopening fails the store stays closed and the import
+        // fails with the error.
+        auto const wasSyncing = syncing_.exchange (true);
+        assert (! wasSyncing);
+        (void) wasSyncing;
+        auto const dp = db_.dat_path();
+        auto const kp = db_.key_path();
+        auto const lp = db_.log_path();
+        nudb::error_code ec;
+        db_.close(ec);
+        if(ec)
+            Throw<nudb::system_error>(ec);
+        db_.open(dp, kp, lp, ec);
+        if(ec)
+            Throw<nudb::system_error>(ec);
+        syncing_ = false;
+    }
+
     int
     getWriteLoad () override
     {
@@ -88,6 +88,16 @@ public:
     {
     }
 
+    void
+    for_each_key (std::function <void(void const*)> f) override
+    {
+    }
+
+    void
+    sync () override
+    {
+    }
+
     int
     getWriteLoad () override
     {
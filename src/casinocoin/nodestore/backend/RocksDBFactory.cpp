@@ -344,6 +344,30 @@ public:
         }
     }
 
+    void
+    for_each_key (std::function <void(void const*)> f) override
+    {
+        rocksdb::ReadOptions options;
+        options.fill_cache = false;
+
+        std::unique_ptr <rocksdb::Iterator> it (m_db->NewIterator (options));
+
+        for (it->SeekToFirst (); it->Valid (); it->Next ())
+        {
+            if (it->key ().size () == m_keyBytes)
+                f (it->key ().data ());
+        }
+    }
+
+    void
+    sync () override
+    {
+        m_batch.waitForWriting ();
+        auto const ret = m_db->Flush (rocksdb::FlushOptions ());
+        if (! ret.ok ())
+            Throw<std::runtime_error> ("sync failed: " + ret.ToString());
+    }
+
     int
     getWriteLoad () override
     {
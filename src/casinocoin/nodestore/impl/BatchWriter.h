@@ -71,10 +71,12 @@ public:
     /** Get an estimate of the amount of writing I/O pending. */
     int getWriteLoad ();
 
+    /** Wait until everything stored so far has been written. */
+    void waitForWriting ();
+
 private:
     void performScheduledTask ();
     void writeBatch ();
-    void waitForWriting ();
 
 private:
     using LockType = std::recursive_mutex;
@@ -0,0 +1,124 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/nodestore/impl/BloomFilter.h>
+#include <casinocoin/beast/hash/xxhasher.h>
+#include <boost/filesystem/fstream.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace casinocoin {
+namespace NodeStore {
+
+// Identifies a saved filter, and the version of its format
+static char const bloomMagic[8] = { 'C','S','C','B','L','M','0','1' };
+
+BloomFilter::BloomFilter (std::uint64_t bits, int hashes)
+    : bits_ (std::max <std::uint64_t> (64, (bits + 63) / 64 * 64))
+    , hashes_ (std::max (1, hashes))
+    , words_ (new std::atomic <std::uint64_t>[bits_ / 64])
+{
+    for (std::uint64_t i = 0; i < bits_ / 64; ++i)
+        words_[i].store (0, std::memory_order_relaxed);
+}
+
+double
+BloomFilter::fill () const
+{
+    std::uint64_t set = 0;
+    for (std::uint64_t i = 0; i < bits_ / 64; ++i)
+    {
+        auto w = words_[i].load (std::memory_order_relaxed);
+        for (; w != 0; w &= w - 1)
+            ++set;
+    }
+    return static_cast <double> (set) / bits_;
+}
+
+bool
+BloomFilter::save (boost::filesystem::path const& file) const
+{
+    using namespace boost::filesystem;
+
+    std::vector <std::uint64_t> words (bits_ / 64);
+    for (std::size_t i = 0; i < words.size (); ++i)
+        words[i] = words_[i].load (std::memory_order_relaxed);
+    beast::xxhasher h;
+    h (words.data (), words.size () * sizeof (std::uint64_t));
+    std::uint64_t const checksum = static_cast <std::size_t> (h);
+    std::uint32_t const hashes = hashes_;
+
+    // Write a new file and swap it in, so a crash
+    // never leaves a truncated filter behind.
+    auto const temp = path (file).concat (".tmp");
+    {
+        ofstream ofs (temp, std::ios::binary | std::ios::trunc);
+        ofs.write (bloomMagic, sizeof (bloomMagic));
+        ofs.write (reinterpret_cast <char const*> (&bits_), sizeof (bits_));
+        ofs.write (reinterpret_cast <char const*> (&hashes), sizeof (hashes));
+        ofs.write (reinterpret_cast <char const*> (words.data ()),
+            words.size () * sizeof (std::uint64_t));
+        ofs.write (reinterpret_cast <char const*> (&checksum),
+            sizeof (checksum));
+        if (! ofs)
+            return false;
+    }
+    boost::system::error_code ec;
+    rename (temp, file, ec);
+    return ! ec;
+}
+
+bool
+BloomFilter::load (boost::filesystem::path const& file)
+{
+    boost::filesystem::ifstream ifs (file, std::ios::binary);
+    if (! ifs)
+        return false;
+
+    char magic[sizeof (bloomMagic)];
+    std::uint64_t bits;
+    std::uint32_t hashes;
+    ifs.read (magic, sizeof (magic));
+    ifs.read (reinterpret_cast <char*> (&bits), sizeof (bits));
+    ifs.read (reinterpret_cast <char*> (&hashes), sizeof (hashes));
+    if (! ifs || std::memcmp (magic, bloomMagic, sizeof (magic)) != 0 ||
+        bits != bits_ || hashes != hashes_)
+    {
+        return false;
+    }
+
+    std::vector <std::uint64_t> words (bits_ / 64);
+    std::uint64_t checksum;
+    ifs.read (reinterpret_cast <char*> (words.data ()),
+        words.size () * sizeof (std::uint64_t));
+    ifs.read (reinterpret_cast <char*> (&checksum), sizeof (checksum));
+    if (! ifs)
+        return false;
+    beast::xxhasher h;
+    h (words.data (), words.size () * sizeof (std::uint64_t));
+    if (checksum != static_cast <std::size_t> (h))
+        return false;
+
+    for (std::size_t i = 0; i < words.size (); ++i)
+        words_[i].store (words[i], std::memory_order_relaxed);
+    return true;
+}
+
+}
+}
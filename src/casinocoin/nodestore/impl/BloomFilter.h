@@ -0,0 +1,128 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_NODESTORE_BLOOMFILTER_H_INCLUDED
+#define CASINOCOIN_NODESTORE_BLOOMFILTER_H_INCLUDED
+
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace casinocoin {
+namespace NodeStore {
+
+/** A Bloom filter over node store keys.
+
+    Answers whether a key may have been inserted, with no false
+    negatives. Keys are hashes already, so the bit positions are
+    taken from the key itself instead of hashing it again.
+
+    Insertions and lookups can be called concurrently.
+*/
+class BloomFilter
+{
+public:
+    /** Create an empty filter.
+
+        @param bits The size of the filter, rounded up to 64 bits.
+        @param hashes The number of bits set for each key.
+    */
+    BloomFilter (std::uint64_t bits, int hashes);
+
+    BloomFilter (BloomFilter const&) = delete;
+    BloomFilter& operator= (BloomFilter const&) = delete;
+
+    /** Add a key of at least 16 bytes. */
+    void
+    insert (void const* key)
+    {
+        std::uint64_t h1, h2;
+        split (key, h1, h2);
+        for (int i = 0; i < hashes_; ++i)
+        {
+            auto const bit = (h1 + i * h2) % bits_;
+            words_[bit / 64].fetch_or (
+                std::uint64_t (1) << (bit % 64),
+                    std::memory_order_relaxed);
+        }
+    }
+
+    /** Returns `false` if the key was definitely never inserted. */
+    bool
+    mayContain (void const* key) const
+    {
+        std::uint64_t h1, h2;
+        split (key, h1, h2);
+        for (int i = 0; i < hashes_; ++i)
+        {
+            auto const bit = (h1 + i * h2) % bits_;
+            if ((words_[bit / 64].load (std::memory_order_relaxed) &
+                    (std::uint64_t (1) << (bit % 64))) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    std::uint64_t
+    size () const
+    {
+        return bits_;
+    }
+
+    /** The fraction of bits set, which grows with the number of keys. */
+    double
+    fill () const;
+
+    /** Write the filter to a file.
+        @note Insertions must not run concurrently.
+        @return `true` on success.
+    */
+    bool
+    save (boost::filesystem::path const& file) const;
+
+    /** Replace the contents by those of a file written by save.
+        @return `false`, leaving the filter unchanged, if the file
+                is missing, damaged or for a filter of another size.
+    */
+    bool
+    load (boost::filesystem::path const& file);
+
+private:
+    // The two independent hashes all the bit positions are made of
+    static
+    void
+    split (void const* key, std::uint64_t& h1, std::uint64_t& h2)
+    {
+        std::memcpy (&h1, key, sizeof (h1));
+        std::memcpy (&h2, static_cast <char const*> (key) + sizeof (h1),
+            sizeof (h2));
+        // An even stride could cycle through half the positions
+        h2 |= 1;
+    }
+
+    std::uint64_t const bits_;
+    int const hashes_;
+    std::unique_ptr <std::atomic <std::uint64_t>[]> words_;
+};
+
+}
+}
+
+#endif
@@ -30,8 +30,18 @@
 #include <casinocoin/nodestore/Scheduler.h>
 #include <casinocoin/nodestore/impl/Tuning.h>
 #include <casinocoin/basics/KeyCache.h>
+#include <casinocoin/basics/Slice.h>
 #include <casinocoin/basics/chrono.h>
 #include <casinocoin/beast/core/CurrentThreadName.h>
+#include <casinocoin/beast/core/LexicalCast.h>
+#include <casinocoin/protocol/digest.h>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <array>
+#include <cassert>
+#include <deque>
+#include <exception>
+#include <map>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -51,14 +61,29 @@ protected:
     // Negative cache
     KeyCache <uint256> m_negCache;
 private:
+    using clock_type = std::chrono::steady_clock;
+
+    // Pending async reads of one priority
+    struct ReadQueue
+    {
+        std::map <uint256, clock_type::time_point> reads; // to do, and when requested
+        uint256 last;                                    // last hash read
+        std::uint64_t generation = 0;                    // current read generation
+    };
+
+    static constexpr std::size_t numPriorities = 2;
+
     std::mutex                m_readLock;
     std::condition_variable   m_readCondVar;
     std::condition_variable   m_readGenCondVar;
-    std::set <uint256>        m_readSet;        // set of reads to do
-    uint256                   m_readLast;       // last hash read
+    std::array <ReadQueue, numPriorities> m_readQueues;
+    int const                 m_readThreadCount;
     std::vector <std::thread> m_readThreads;
+    int                       m_readActive;     // threads performing a read
+    int                       m_highReads;      // high reads since a low one
     bool                      m_readShut;
-    uint64_t                  m_readGen;        // current read generation
+    std::array <std::array <std::atomic <std::uint64_t>,
+        readLatencyBuckets>, numPriorities> m_readLatency;
     int                       fdlimit_;
     std::atomic <std::uint32_t> m_storeCount;
     std::atomic <std::uint32_t> m_fetchTotalCount;
@@ -81,8 +106,11 @@ public:
             stopwatch(), journal)
         , m_negCache ("NodeStore", stopwatch(),
             cacheTargetSize, cacheTargetSeconds)
+        , m_readThreadCount (readThreads)
+        , m_readActive (0)
+        , m_highReads (0)
         , m_readShut (false)
-        , m_readGen (0)
+        , m_readLatency {}
         , fdlimit_ (0)
         , m_storeCount (0)
         , m_fetchTotalCount (0)
@@ -116,7 +144,8 @@ public:
 
     //------------------------------------------------------------------------------
 
-    bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object) override
+    bool asyncFetch (uint256 const& hash, std::shared_ptr<NodeObject>& object,
+        FetchPriority priority) override
     {
         // See if the object is in cache
         object = m_cache.fetch (hash);
@@ -126,27 +155,58 @@ public:
         {
             // No. Post a read
             std::lock_guard <std::mutex> lock (m_readLock);
-            if (m_readSet.insert (hash).second)
+            auto& queue = m_readQueues[index (priority)];
+            auto& high = m_readQueues[index (FetchPriority::high)];
+            auto& low = m_readQueues[index (FetchPriority::low)];
+            if (&queue == &low && high.reads.count (hash) != 0)
+                return false;
+
+            auto requested = clock_type::now ();
+            if (&queue == &high)
+            {
+                // Promote the read if it was waiting at low priority
+                auto const iter = low.reads.find (hash);
+                if (iter != low.reads.end ())
+                {
+                    requested = iter->second;
+                    low.reads.erase (iter);
+                }
+            }
+
+            if (queue.reads.emplace (hash, requested).second)
                 m_readCondVar.notify_one ();
         }
 
         return false;
     }
 
-    void waitReads() override
+    void waitReads (FetchPriority priority) override
     {
         {
             std::unique_lock <std::mutex> lock (m_readLock);
+            auto const& queue = m_readQueues[index (priority)];
 
             // Wake in two generations
-            std::uint64_t const wakeGeneration = m_readGen + 2;
+            std::uint64_t const wakeGeneration = queue.generation + 2;
 
-            while (!m_readShut && !m_readSet.empty () && (m_readGen < wakeGeneration))
+            while (!m_readShut && !queue.reads.empty () &&
+                    (queue.generation < wakeGeneration))
                 m_readGenCondVar.wait (lock);
         }
 
     }
 
+    std::vector<std::uint64_t>
+    getReadLatency (FetchPriority priority) const override
+    {
+        auto const& latency = m_readLatency[index (priority)];
+        std::vector<std::uint64_t> ret;
+        ret.reserve (latency.size ());
+        for (auto const& count : latency)
+            ret.push_back (count.load ());
+        return ret;
+    }
+
     int getDesiredAsyncReadCount () override
     {
         // We prefer a client not fill our cache
@@ -327,6 +387,47 @@ public:
 
     //------------------------------------------------------------------------------
 
+    static
+    std::size_t
+    index (FetchPriority priority)
+    {
+        return priority == FetchPriority::high ? 0 : 1;
+    }
+
+    // The queue the calling read thread should take a read from,
+    // or nullptr if it should stay idle. Call with m_readLock held.
+    ReadQueue* nextReadQueue ()
+    {
+        auto& high = m_readQueues[index (FetchPriority::high)];
+        auto& low = m_readQueues[index (FetchPriority::low)];
+        auto const depth = high.reads.size () + low.reads.size ();
+        if (depth == 0)
+            return nullptr;
+
+        // Use more threads as the backlog grows, so a short queue
+        // is still read in key order.
+        auto const wanted = static_cast <int> (std::min <std::size_t> (
+            m_readThreadCount, 1 + (depth - 1) / readsPerThread));
+        if (m_readActive >= wanted)
+            return nullptr;
+
+        if (low.reads.empty ())
+            return &high;
+
+        // A steady stream of high priority reads still lets some
+        // low priority ones through
+        if (! high.reads.empty () && ++m_highReads <= lowReadInterval)
+            return &high;
+
+        // Leave threads free for urgent reads
+        if (high.reads.empty () &&
+                m_readActive >= std::max (1, m_readThreadCount / 2))
+            return nullptr;
+
+        m_highReads = 0;
+        return &low;
+    }
+
     // Entry point for async read threads
     void threadEntry ()
     {
@@ -334,13 +435,16 @@ public:
         while (1)
         {
             uint256 hash;
+            clock_type::time_point requested;
+            std::size_t priority;
 
             {
                 std::unique_lock <std::mutex> lock (m_readLock);
 
-                while (!m_readShut && m_readSet.empty ())
+                ReadQueue* queue;
+                while (!m_readShut && !(queue = nextReadQueue ()))
                 {
-                    // all work is done
+                    // all work is done, or enough threads are on it
                     m_readGenCondVar.notify_all ();
                     m_readCondVar.wait (lock);
                 }
@@ -349,23 +453,39 @@ public:
                     break;
 
                 // Read in key order to make the back end more efficient
-                std::set <uint256>::iterator it = m_readSet.lower_bound (m_readLast);
-                if (it == m_readSet.end ())
+                auto it = queue->reads.lower_bound (queue->last);
+                if (it == queue->reads.end ())
                 {
-                    it = m_readSet.begin ();
+                    it = queue->reads.begin ();
 
                     // A generation has completed
-                    ++m_readGen;
+                    ++queue->generation;
                     m_readGenCondVar.notify_all ();
                 }
 
-                hash = *it;
-                m_readSet.erase (it);
-                m_readLast = hash;
+                hash = it->first;
+                requested = it->second;
+                priority = queue - m_readQueues.data ();
+                queue->reads.erase (it);
+                queue->last = hash;
+                ++m_readActive;
             }
 
             // Perform the read
             doTimedFetch (hash, true);
+
+            auto const elapsed = std::chrono::duration_cast
+                <std::chrono::milliseconds> (clock_type::now () - requested);
+            std::size_t bucket = 0;
+            while (bucket + 1 < readLatencyBuckets &&
+                    elapsed.count () >= (1 << bucket))
+                ++bucket;
+            ++m_readLatency[priority][bucket];
+
+            {
+                std::lock_guard <std::mutex> lock (m_readLock);
+                --m_readActive;
+            }
          }
      }
 
@@ -376,33 +496,254 @@ public:
         m_backend->for_each (f);
     }
 
-    void import (Database& source) override
+    void import (Database& source, ImportOptions const& options) override
     {
-        importInternal (source, *m_backend.get());
+        importInternal (source, *m_backend.get(), options);
     }
 
-    void importInternal (Database& source, Backend& dest)
+    void importInternal (Database& source, Backend& dest,
+        ImportOptions const& options)
     {
-        Batch b;
-        b.reserve (batchWritePreallocationSize);
+        // The destination is synced below, which may close and reopen
+        // it, so nothing else may be reading from this database.
+#ifndef NDEBUG
+        {
+            std::lock_guard <std::mutex> lock (m_readLock);
+            assert (m_readActive == 0);
+            for (auto const& queue : m_readQueues)
+                assert (queue.reads.empty ());
+        }
+#endif
+
+        // The checkpoint is only good for the same source and destination
+        std::string const checkpointId =
+            source.getName () + "\n" + dest.getName () + "\n";
+        std::uint64_t const skip = options.checkpoint.empty () ? 0 :
+            readImportCheckpoint (options.checkpoint, checkpointId);
+        if (skip != 0)
+        {
+            JLOG (m_journal.warn()) <<
+                "import resuming after " << skip << " objects";
+        }
 
-        source.for_each ([&](std::shared_ptr<NodeObject> object)
+        // Batches of objects read, numbered in the order of the source
+        struct Job
         {
-            if (b.size() >= batchWritePreallocationSize)
+            std::uint64_t index;
+            Batch batch;
+        };
+
+        std::mutex mutex;
+        // The destination takes one batch at a time, and is only
+        // synced while no batch is being stored. The reads are
+        // serial too, so the workers only check the objects.
+        std::mutex storeMutex;
+        std::condition_variable workCond;
+        std::condition_variable spaceCond;
+        std::deque <Job> jobs;
+        bool readDone = false;
+        std::exception_ptr error;
+        // Batches finished out of order, and the objects in
+        // the batches before the first unfinished one.
+        std::map <std::uint64_t, std::size_t> finished;
+        std::uint64_t nextFinished = 0;
+        std::uint64_t processed = skip;
+        std::atomic <std::uint64_t> invalid {0};
+
+        auto work = [&]
+        {
+            beast::setCurrentThreadName ("import");
+            while (1)
             {
-                dest.storeBatch (b);
-                b.clear();
-                b.reserve (batchWritePreallocationSize);
+                Job job;
+                {
+                    std::unique_lock <std::mutex> lock (mutex);
+                    while (jobs.empty () && ! readDone && ! error)
+                        workCond.wait (lock);
+                    if (jobs.empty () || error)
+                        return;
+                    job = std::move (jobs.front ());
+                    jobs.pop_front ();
+                    spaceCond.notify_one ();
+                }
+
+                try
+                {
+                    Batch valid;
+                    valid.reserve (job.batch.size ());
+                    for (auto& object : job.batch)
+                    {
+                        if (options.verify && sha512Half (makeSlice (
+                            object->getData ())) != object->getHash ())
+                        {
+                            if (invalid++ == 0)
+                            {
+                                JLOG (m_journal.error()) <<
+                                    "import: skipping object " <<
+                                    object->getHash () <<
+                                    " which doesn't match its key";
+                            }
+                            continue;
+                        }
+                        m_storeSize += object->getData ().size ();
+                        valid.push_back (std::move (object));
+                    }
+
+                    std::lock_guard <std::mutex> lock (storeMutex);
+                    dest.storeBatch (valid);
+                    m_storeCount += valid.size ();
+                }
+                catch (...)
+                {
+                    std::lock_guard <std::mutex> lock (mutex);
+                    if (! error)
+                        error = std::current_exception ();
+                    spaceCond.notify_all ();
+                    workCond.notify_all ();
+                    return;
+                }
+
+                std::lock_guard <std::mutex> lock (mutex);
+                finished.emplace (job.index, job.batch.size ());
+                while (! finished.empty () &&
+                    finished.begin ()->first == nextFinished)
+                {
+                    processed += finished.begin ()->second;
+                    finished.erase (finished.begin ());
+                    ++nextFinished;
+                }
             }
+        };
 
-            b.push_back (object);
-            ++m_storeCount;
-            if (object)
-                m_storeSize += object->getData().size();
-        });
+        std::vector <std::thread> workers;
+        for (int i = 0; i < std::max (1, options.threads); ++i)
+            workers.emplace_back (work);
+
+        // Only objects the destination has synced are recorded,
+        // the rest are stored again if the import is interrupted.
+        auto lastCheckpoint = std::chrono::steady_clock::now ();
+
+        Batch batch;
+        std::uint64_t index = 0;
+        std::uint64_t visited = 0;
+        auto submit = [&]
+        {
+            {
+                std::unique_lock <std::mutex> lock (mutex);
+                while (jobs.size () >= 2 * workers.size () && ! error)
+                    spaceCond.wait (lock);
+                if (error)
+                    Throw<std::runtime_error> ("import: stopped");
+                jobs.push_back ({index++, std::move (batch)});
+                workCond.notify_one ();
+            }
+            batch.clear ();
+            batch.reserve (batchWritePreallocationSize);
+
+            auto const now = std::chrono::steady_clock::now ();
+            if (! options.checkpoint.empty () &&
+                now - lastCheckpoint >=
+                    std::chrono::seconds (importCheckpointSeconds))
+            {
+                // Every batch counted in processed has been stored
+                std::lock_guard <std::mutex> storeLock (storeMutex);
+                std::uint64_t stored;
+                {
+                    std::lock_guard <std::mutex> lock (mutex);
+                    stored = processed;
+                }
+                dest.sync ();
+                writeImportCheckpoint (options.checkpoint,
+                    checkpointId, stored);
+                lastCheckpoint = now;
+            }
+        };
+
+        try
+        {
+            batch.reserve (batchWritePreallocationSize);
+            source.for_each ([&](std::shared_ptr<NodeObject> object)
+            {
+                if (! object || ++visited <= skip)
+                    return;
+                batch.push_back (std::move (object));
+                if (batch.size () >= batchWritePreallocationSize)
+                    submit ();
+            });
+            if (! batch.empty ())
+                submit ();
+        }
+        catch (...)
+        {
+            std::lock_guard <std::mutex> lock (mutex);
+            if (! error)
+                error = std::current_exception ();
+        }
 
-        if (! b.empty())
-            dest.storeBatch (b);
+        {
+            std::lock_guard <std::mutex> lock (mutex);
+            readDone = true;
+            workCond.notify_all ();
+        }
+        for (auto& t : workers)
+            t.join ();
+
+        if (error)
+            std::rethrow_exception (error);
+
+        if (invalid != 0)
+        {
+            JLOG (m_journal.error()) <<
+                "import: skipped " << invalid << " invalid objects";
+        }
+        JLOG (m_journal.info()) <<
+            "import: read " << visited - skip << " objects";
+        if (! options.checkpoint.empty ())
+        {
+            dest.sync ();
+            boost::system::error_code ec;
+            boost::filesystem::remove (options.checkpoint, ec);
+        }
+    }
+
+    // Returns the number of objects a checkpoint says were imported
+    std::uint64_t readImportCheckpoint (std::string const& file,
+        std::string const& id)
+    {
+        boost::filesystem::ifstream ifs (file);
+        if (! ifs)
+            return 0;
+        std::string const s ((std::istreambuf_iterator<char> (ifs)),
+            std::istreambuf_iterator<char> ());
+        std::uint64_t count;
+        if (s.compare (0, id.size (), id) != 0 ||
+            ! beast::lexicalCastChecked (count, s.substr (id.size ())))
+        {
+            JLOG (m_journal.warn()) <<
+                "import: ignoring the checkpoint of another import in " <<
+                file;
+            return 0;
+        }
+        return count;
+    }
+
+    void writeImportCheckpoint (std::string const& file,
+        std::string const& id, std::uint64_t count)
+    {
+        // Write a new file and swap it in, so a crash
+        // never leaves a truncated checkpoint behind.
+        auto const temp = file + ".tmp";
+        {
+            boost::filesystem::ofstream ofs (temp, std::ios::trunc);
+            ofs << id << count;
+            if (! ofs)
+            {
+                JLOG (m_journal.warn()) << "import: unable to write " << temp;
+                return;
+            }
+        }
+        boost::system::error_code ec;
+        boost::filesystem::rename (temp, file, ec);
     }
 
     std::uint32_t getStoreCount () const override
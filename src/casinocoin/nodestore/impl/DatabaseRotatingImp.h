@@ -113,9 +113,9 @@ public:
         b.writableBackend->for_each (f);
     }
 
-    void import (Database& source) override
+    void import (Database& source, ImportOptions const& options) override
     {
-        importInternal (source, *getWritableBackend());
+        importInternal (source, *getWritableBackend(), options);
     }
 
     void store (NodeObjectType type,
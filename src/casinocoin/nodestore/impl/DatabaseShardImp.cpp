@@ -0,0 +1,385 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/nodestore/impl/DatabaseShardImp.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/random.h>
+#include <casinocoin/beast/core/LexicalCast.h>
+#include <algorithm>
+#include <cctype>
+
+namespace casinocoin {
+namespace NodeStore {
+
+DatabaseShardImp::DatabaseShardImp (std::string const& name,
+        Scheduler& scheduler,
+        int readThreads,
+        Stoppable& parent,
+        Section const& config,
+        beast::Journal journal)
+    : DatabaseImp (
+        name,
+        scheduler,
+        readThreads,
+        parent,
+        std::unique_ptr <Backend>(),
+        journal)
+    , scheduler_ (scheduler)
+    , config_ (config)
+    , dir_ (get<std::string> (config, "path"))
+    , ledgersPerShard_ (get<std::uint32_t> (
+        config, "ledgers_per_shard", 16384))
+    , maxDiskSpace_ (get<std::uint64_t> (
+        config, "max_size_gb", 0) << 30)
+    , validate_ (get<bool> (config, "validate", false))
+    , j_ (journal)
+{
+    if (dir_.empty ())
+        Throw<std::runtime_error> (
+            "Missing path in [shard_db] section");
+    if (ledgersPerShard_ == 0)
+        Throw<std::runtime_error> (
+            "Invalid ledgers_per_shard in [shard_db] section");
+}
+
+bool
+DatabaseShardImp::init ()
+{
+    using namespace boost::filesystem;
+
+    boost::unique_lock<boost::shared_mutex> lock (mutex_);
+    try
+    {
+        create_directories (dir_);
+        for (directory_iterator it (dir_), end; it != end; ++it)
+        {
+            auto const name = it->path ().filename ().string ();
+            if (! is_directory (it->status ()) || name.empty () ||
+                ! std::all_of (name.begin (), name.end (), ::isdigit))
+            {
+                continue;
+            }
+
+            auto const index =
+                beast::lexicalCastThrow <std::uint32_t> (name);
+            auto shard = std::make_unique <Shard> (
+                index, ledgersPerShard_, it->path (), j_);
+            shard->open (config_, scheduler_);
+
+            if (! shard->complete () && ! shard->prepare ())
+            {
+                // We stopped before the filled shard was finalized
+                filled_ = std::move (shard);
+            }
+            else if (! shard->complete ())
+            {
+                if (incomplete_)
+                {
+                    JLOG (j_.error()) <<
+                        "shards " << incomplete_->index () << " and " <<
+                        index << " are both incomplete, ignoring " << index;
+                    continue;
+                }
+                usedDiskSpace_ += shard->fileSize ();
+                incomplete_ = std::move (shard);
+            }
+            else if (validate_ && ! shard->validate ())
+            {
+                JLOG (j_.error()) <<
+                    "ignoring shard " << index << " which failed to validate";
+            }
+            else
+            {
+                usedDiskSpace_ += shard->fileSize ();
+                complete_.emplace (index, std::move (shard));
+            }
+        }
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j_.fatal()) <<
+            "unable to open shards in " << dir_ << ": " << e.what ();
+        return false;
+    }
+
+    JLOG (j_.info()) <<
+        complete_.size () << " complete shards, " <<
+        (incomplete_ ? "one" : "no") << " incomplete shard";
+    lock.unlock ();
+
+    finalize ();
+    return true;
+}
+
+boost::optional<std::uint32_t>
+DatabaseShardImp::prepare (std::uint32_t validLedgerSeq)
+{
+    boost::unique_lock<boost::shared_mutex> lock (mutex_);
+    if (incomplete_)
+        return incomplete_->prepare ();
+    if (filled_)
+        return boost::none;
+
+    if (maxDiskSpace_ != 0)
+    {
+        // Leave room for one more shard the size of an average one
+        auto const avgShardSize = complete_.empty () ?
+            0 : usedDiskSpace_ / complete_.size ();
+        if (usedDiskSpace_ + avgShardSize > maxDiskSpace_)
+            return boost::none;
+    }
+
+    // Only shards ending before the last validated ledger can be filled
+    auto const maxIndex = seqToShardIndex (validLedgerSeq);
+    std::vector <std::uint32_t> candidates;
+    for (std::uint32_t index = 0; index < maxIndex; ++index)
+    {
+        if (complete_.find (index) == complete_.end () &&
+            abandoned_.find (index) == abandoned_.end ())
+        {
+            candidates.push_back (index);
+        }
+    }
+    if (candidates.empty ())
+        return boost::none;
+
+    // Picking at random spreads the history between servers
+    auto const index = candidates.size () == 1 ? candidates.front () :
+        candidates[rand_int (candidates.size () - 1)];
+    auto shard = std::make_unique <Shard> (index, ledgersPerShard_,
+        dir_ / std::to_string (index), j_);
+    try
+    {
+        shard->open (config_, scheduler_);
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j_.error()) <<
+            "unable to create shard " << index << ": " << e.what ();
+        return boost::none;
+    }
+
+    JLOG (j_.info()) << "filling shard " << index;
+    incomplete_ = std::move (shard);
+    return incomplete_->prepare ();
+}
+
+std::shared_ptr<NodeObject>
+DatabaseShardImp::fetch (uint256 const& hash, std::uint32_t seq)
+{
+    auto object = m_cache.fetch (hash);
+    if (object)
+        return object;
+
+    {
+        boost::shared_lock<boost::shared_mutex> lock (mutex_);
+        Shard* shard = nullptr;
+        auto const it = complete_.find (seqToShardIndex (seq));
+        if (it != complete_.end ())
+            shard = it->second.get ();
+        else if (incomplete_ && incomplete_->hasLedger (seq))
+            shard = incomplete_.get ();
+        if (! shard)
+            return object;
+
+        object = fetchInternal (shard->getBackend (), hash);
+    }
+
+    if (object)
+        m_cache.canonicalize (hash, object);
+    return object;
+}
+
+bool
+DatabaseShardImp::store (NodeObjectType type, Blob&& data,
+    uint256 const& hash, std::uint32_t seq)
+{
+    boost::shared_lock<boost::shared_mutex> lock (mutex_);
+    if (! incomplete_ || incomplete_->index () != seqToShardIndex (seq))
+    {
+        JLOG (j_.warn()) <<
+            "ledger " << seq << " is not part of the shard being filled";
+        return false;
+    }
+
+    storeInternal (type, std::move (data), hash,
+        incomplete_->getBackend ());
+    return true;
+}
+
+bool
+DatabaseShardImp::hasLedger (std::uint32_t seq)
+{
+    boost::shared_lock<boost::shared_mutex> lock (mutex_);
+    if (complete_.find (seqToShardIndex (seq)) != complete_.end ())
+        return true;
+    return incomplete_ && incomplete_->hasLedger (seq);
+}
+
+bool
+DatabaseShardImp::setStored (std::uint32_t seq)
+{
+    boost::unique_lock<boost::shared_mutex> lock (mutex_);
+    if (! incomplete_ || incomplete_->index () != seqToShardIndex (seq))
+    {
+        JLOG (j_.warn()) <<
+            "ledger " << seq << " is not part of the shard being filled";
+        return false;
+    }
+    if (! incomplete_->setStored (seq))
+        return false;
+
+    // Nobody can reach the shard once it is out of the map, so
+    // it can be checked without holding up other shards.
+    filled_ = std::move (incomplete_);
+    usedDiskSpace_ -= std::min (usedDiskSpace_, filled_->fileSize ());
+    return true;
+}
+
+void
+DatabaseShardImp::finalize ()
+{
+    std::unique_ptr <Shard> shard;
+    {
+        boost::unique_lock<boost::shared_mutex> lock (mutex_);
+        shard = std::move (filled_);
+    }
+    if (! shard)
+        return;
+
+    auto const index = shard->index ();
+    if (! shard->validate ())
+    {
+        JLOG (j_.error()) <<
+            "removing shard " << index << " which failed to validate";
+        remove (std::move (shard));
+        return;
+    }
+
+    shard->finalize ();
+    JLOG (j_.info()) << "shard " << index << " is complete";
+
+    boost::unique_lock<boost::shared_mutex> lock (mutex_);
+    usedDiskSpace_ += shard->fileSize ();
+    complete_.emplace (index, std::move (shard));
+}
+
+void
+DatabaseShardImp::abandon ()
+{
+    std::unique_ptr <Shard> shard;
+    {
+        boost::unique_lock<boost::shared_mutex> lock (mutex_);
+        if (! incomplete_)
+            return;
+        shard = std::move (incomplete_);
+        usedDiskSpace_ -= std::min (usedDiskSpace_, shard->fileSize ());
+        abandoned_.insert (shard->index ());
+    }
+
+    JLOG (j_.warn()) << "abandoning shard " << shard->index ();
+    remove (std::move (shard));
+}
+
+void
+DatabaseShardImp::remove (std::unique_ptr <Shard> shard)
+{
+    auto const dir = shard->getDir ();
+    shard->close ();
+    shard.reset ();
+    boost::system::error_code ec;
+    boost::filesystem::remove_all (dir, ec);
+}
+
+std::string
+DatabaseShardImp::getCompleteShards ()
+{
+    RangeSet rs;
+    boost::shared_lock<boost::shared_mutex> lock (mutex_);
+    for (auto const& e : complete_)
+        rs.setValue (e.first);
+    return rs.toString ();
+}
+
+std::int32_t
+DatabaseShardImp::getWriteLoad () const
+{
+    boost::shared_lock<boost::shared_mutex> lock (mutex_);
+    if (! incomplete_)
+        return 0;
+    return incomplete_->getBackend ().getWriteLoad ();
+}
+
+void
+DatabaseShardImp::store (NodeObjectType, Blob&&, uint256 const& hash)
+{
+    // Ledgers loaded from the shards are read through the generic
+    // Database interface. Nothing written that way belongs to a
+    // ledger being filled, so it is dropped.
+    JLOG (j_.error()) <<
+        "object " << hash << " stored without a ledger sequence";
+}
+
+std::shared_ptr<NodeObject>
+DatabaseShardImp::fetchFrom (uint256 const& hash)
+{
+    // Without a ledger sequence every shard has to be asked,
+    // starting with the most recent history.
+    boost::shared_lock<boost::shared_mutex> lock (mutex_);
+    std::shared_ptr<NodeObject> object;
+    if (incomplete_)
+        object = fetchInternal (incomplete_->getBackend (), hash);
+    for (auto it = complete_.rbegin ();
+        ! object && it != complete_.rend (); ++it)
+    {
+        object = fetchInternal (it->second->getBackend (), hash);
+    }
+    return object;
+}
+
+void
+DatabaseShardImp::for_each (
+    std::function <void(std::shared_ptr<NodeObject>)> f)
+{
+    boost::unique_lock<boost::shared_mutex> lock (mutex_);
+    for (auto const& e : complete_)
+        e.second->getBackend ().for_each (f);
+}
+
+void
+DatabaseShardImp::import (Database&, ImportOptions const&)
+{
+    JLOG (j_.error()) << "import into the shard store is not supported";
+}
+
+int
+DatabaseShardImp::fdlimit () const
+{
+    boost::shared_lock<boost::shared_mutex> lock (mutex_);
+    int n = 0;
+    for (auto const& e : complete_)
+        n += e.second->getBackend ().fdlimit ();
+    if (incomplete_)
+        n += incomplete_->getBackend ().fdlimit ();
+    return n;
+}
+
+}
+}
@@ -0,0 +1,143 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_NODESTORE_DATABASESHARDIMP_H_INCLUDED
+#define CASINOCOIN_NODESTORE_DATABASESHARDIMP_H_INCLUDED
+
+#include <casinocoin/nodestore/impl/DatabaseImp.h>
+#include <casinocoin/nodestore/impl/Shard.h>
+#include <casinocoin/nodestore/DatabaseShard.h>
+#include <boost/thread/shared_mutex.hpp>
+#include <map>
+#include <set>
+
+namespace casinocoin {
+namespace NodeStore {
+
+class DatabaseShardImp
+    : public DatabaseImp
+    , public DatabaseShard
+{
+private:
+    Scheduler& scheduler_;
+    Section const config_;
+    boost::filesystem::path const dir_;
+    std::uint32_t const ledgersPerShard_;
+    std::uint64_t const maxDiskSpace_;
+    bool const validate_;
+    beast::Journal j_;
+
+    // Readers and writers of the shards hold the lock shared while
+    // they use a backend. Adding, removing or updating a shard needs
+    // the lock exclusively.
+    boost::shared_mutex mutable mutex_;
+    std::map <std::uint32_t, std::unique_ptr <Shard>> complete_;
+    std::unique_ptr <Shard> incomplete_;
+    // A shard which is full but not yet finalized
+    std::unique_ptr <Shard> filled_;
+    // Shards which were given up on
+    std::set <std::uint32_t> abandoned_;
+    std::uint64_t usedDiskSpace_ = 0;
+
+    // Close a shard and delete its directory
+    void
+    remove (std::unique_ptr <Shard> shard);
+
+public:
+    DatabaseShardImp (std::string const& name,
+                 Scheduler& scheduler,
+                 int readThreads,
+                 Stoppable& parent,
+                 Section const& config,
+                 beast::Journal journal);
+
+    ~DatabaseShardImp () override
+    {
+        // Stop threads before data members are destroyed.
+        DatabaseImp::stopThreads ();
+    }
+
+    bool
+    init () override;
+
+    boost::optional<std::uint32_t>
+    prepare (std::uint32_t validLedgerSeq) override;
+
+    using DatabaseImp::fetch;
+
+    std::shared_ptr<NodeObject>
+    fetch (uint256 const& hash, std::uint32_t seq) override;
+
+    bool
+    store (NodeObjectType type, Blob&& data,
+        uint256 const& hash, std::uint32_t seq) override;
+
+    bool
+    hasLedger (std::uint32_t seq) override;
+
+    bool
+    setStored (std::uint32_t seq) override;
+
+    void
+    finalize () override;
+
+    void
+    abandon () override;
+
+    std::string
+    getCompleteShards () override;
+
+    std::uint32_t
+    ledgersPerShard () const override
+    {
+        return ledgersPerShard_;
+    }
+
+    std::string
+    getName () const override
+    {
+        return dir_.string ();
+    }
+
+    std::int32_t
+    getWriteLoad () const override;
+
+    // Without a ledger sequence there is no shard to store into,
+    // so the object is dropped
+    void
+    store (NodeObjectType type, Blob&& data,
+        uint256 const& hash) override;
+
+    std::shared_ptr<NodeObject>
+    fetchFrom (uint256 const& hash) override;
+
+    void
+    for_each (std::function <void(std::shared_ptr<NodeObject>)> f) override;
+
+    // Shards are only filled a ledger at a time, so this does nothing
+    void
+    import (Database& source, ImportOptions const& options) override;
+
+    int
+    fdlimit () const override;
+};
+
+}
+}
+
+#endif
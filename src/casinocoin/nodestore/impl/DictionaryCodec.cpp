@@ -0,0 +1,381 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/nodestore/impl/DictionaryCodec.h>
+#include <casinocoin/nodestore/impl/Tuning.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/beast/core/Config.h>
+#include <casinocoin/beast/core/LexicalCast.h>
+#include <nudb/error.hpp>
+#include <nudb/native_file.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <unordered_map>
+#include <unordered_set>
+
+#if ! BEAST_WINDOWS
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace casinocoin {
+namespace NodeStore {
+
+// Identifies a dictionary file, and the version of its format
+static char const dictionaryMagic[8] = { 'C','S','C','D','I','C','T','1' };
+
+DictionaryCodec::DictionaryCodec (boost::filesystem::path dir,
+        bool train, std::size_t dictionarySize, Scheduler& scheduler,
+            beast::Journal journal)
+    : dir_ (std::move (dir))
+    , train_ (train)
+    , dictionarySize_ (std::min<std::size_t> (dictionarySize, 64 * 1024))
+    , scheduler_ (scheduler)
+    , j_ (journal)
+    , trainPending_ (false)
+{
+    using namespace boost::filesystem;
+
+    for (auto& d : byNumber_)
+        d.store (nullptr);
+    for (auto& d : byType_)
+        d.store (nullptr);
+    sampleBytes_.fill (0);
+    training_.fill (false);
+
+    if (! exists (dir_))
+        return;
+
+    // Later dictionaries of a type replace earlier ones
+    std::vector<path> files;
+    for (directory_iterator it (dir_), end; it != end; ++it)
+    {
+        if (it->path ().extension () == ".dict")
+            files.push_back (it->path ());
+    }
+    std::sort (files.begin (), files.end (),
+        [](path const& a, path const& b)
+        {
+            return beast::lexicalCast<std::size_t> (a.stem ().string ()) <
+                beast::lexicalCast<std::size_t> (b.stem ().string ());
+        });
+
+    for (auto const& file : files)
+    {
+        auto const number =
+            beast::lexicalCastThrow<std::size_t> (file.stem ().string ());
+        auto const size = file_size (file);
+        ifstream ifs (file, std::ios::binary);
+        char magic[sizeof (dictionaryMagic)];
+        char type = 0;
+        Blob data (size > sizeof (magic) + 1 ? size - sizeof (magic) - 1 : 0);
+        ifs.read (magic, sizeof (magic));
+        ifs.get (type);
+        ifs.read (reinterpret_cast<char*> (data.data ()), data.size ());
+        if (! ifs ||
+            std::memcmp (magic, dictionaryMagic, sizeof (magic)) != 0 ||
+            static_cast<std::uint8_t> (type) >= numTypes ||
+            number >= maxDictionaries || data.empty ())
+        {
+            Throw<std::runtime_error> (
+                "nodestore: invalid dictionary " + file.string ());
+        }
+        add (number, static_cast<std::uint8_t> (type), std::move (data));
+    }
+}
+
+DictionaryCodec::~DictionaryCodec ()
+{
+    std::unique_lock<std::mutex> lock (mutex_);
+    while (trainPending_)
+        trainCondition_.wait (lock);
+}
+
+DictionaryCodec::Dictionary const*
+DictionaryCodec::add (std::size_t number, std::size_t type, Blob data)
+{
+    auto dict = std::make_unique<Dictionary> ();
+    dict->number = number;
+    dict->data = std::move (data);
+    LZ4_resetStream (&dict->stream);
+    LZ4_loadDict (&dict->stream,
+        reinterpret_cast<char const*> (dict->data.data ()),
+            dict->data.size ());
+
+    Dictionary const* const ret = dict.get ();
+    std::lock_guard<std::mutex> lock (mutex_);
+    dictionaries_.push_back (std::move (dict));
+    byNumber_[number].store (ret);
+    byType_[type].store (ret);
+    return ret;
+}
+
+void
+DictionaryCodec::sample (std::size_t type,
+    void const* in, std::size_t in_size)
+{
+    // Large objects compress well enough on their own
+    if (in_size > dictionarySampleMax)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        if (byType_[type].load () || training_[type])
+            return;
+
+        auto const p = reinterpret_cast<std::uint8_t const*> (in);
+        samples_[type].emplace_back (p, p + in_size);
+        sampleBytes_[type] += in_size;
+        if (sampleBytes_[type] < dictionaryTrainingBytes)
+            return;
+
+        training_[type] = true;
+        pending_.push_back ({type, std::move (samples_[type])});
+        samples_[type].clear ();
+        sampleBytes_[type] = 0;
+        if (trainPending_)
+            return;
+        trainPending_ = true;
+    }
+
+    // Objects of the type keep using plain lz4 until it's done
+    scheduler_.scheduleTask (*this);
+}
+
+void
+DictionaryCodec::performScheduledTask ()
+{
+    for (;;)
+    {
+        std::vector<Training> pending;
+        {
+            std::lock_guard<std::mutex> lock (mutex_);
+            pending.swap (pending_);
+            if (pending.empty ())
+            {
+                trainPending_ = false;
+                trainCondition_.notify_all ();
+                return;
+            }
+        }
+
+        for (auto const& training : pending)
+            build (training);
+    }
+}
+
+void
+DictionaryCodec::build (Training const& training)
+{
+    auto const type = training.type;
+    auto data = train (training.samples, dictionarySize_);
+    if (data.empty ())
+    {
+        // Nothing in common, try again with new samples
+        std::lock_guard<std::mutex> lock (mutex_);
+        training_[type] = false;
+        return;
+    }
+
+    // Only one task trains at a time, so numbers aren't reused
+    std::size_t number = 0;
+    {
+        std::lock_guard<std::mutex> lock (mutex_);
+        for (auto const& d : dictionaries_)
+            number = std::max (number, d->number + 1);
+    }
+    if (number >= maxDictionaries)
+    {
+        // No room for more, the type stops sampling
+        JLOG (j_.warn()) << "too many dictionaries in " << dir_;
+        return;
+    }
+
+    try
+    {
+        save (number, type, data);
+    }
+    catch (std::exception const& e)
+    {
+        // Objects keep using plain lz4
+        JLOG (j_.error()) <<
+            "unable to save a dictionary in " << dir_ << ": " << e.what ();
+        return;
+    }
+
+    add (number, type, std::move (data));
+    JLOG (j_.info()) <<
+        "trained dictionary " << number << " for object type " << type;
+}
+
+void
+DictionaryCodec::save (std::size_t number,
+    std::size_t type, Blob const& data)
+{
+    // Objects compressed with the dictionary can't be read without
+    // it, so the file and its name are on disk before it is used.
+    auto const created = boost::filesystem::create_directories (dir_);
+    auto const file = dir_ / (std::to_string (number) + ".dict");
+    auto const temp = dir_ / (std::to_string (number) + ".tmp");
+    {
+        boost::filesystem::ofstream ofs (temp,
+            std::ios::binary | std::ios::trunc);
+        ofs.write (dictionaryMagic, sizeof (dictionaryMagic));
+        ofs.put (static_cast<char> (type));
+        ofs.write (reinterpret_cast<char const*> (data.data ()),
+            data.size ());
+        ofs.close ();
+        if (! ofs)
+            Throw<std::runtime_error> ("unable to write " +
+                temp.string ());
+    }
+    {
+        nudb::error_code ec;
+        nudb::native_file f;
+        f.open (nudb::file_mode::write, temp.string (), ec);
+        if (! ec)
+            f.sync (ec);
+        if (ec)
+            Throw<nudb::system_error> (ec);
+    }
+    boost::filesystem::rename (temp, file);
+
+#if ! BEAST_WINDOWS
+    // Windows can't open a directory to sync it
+    auto syncDirectory = [](boost::filesystem::path const& path)
+    {
+        auto const fd = ::open (path.c_str (), O_RDONLY);
+        if (fd == -1 || ::fsync (fd) != 0)
+        {
+            auto const ev = errno;
+            if (fd != -1)
+                ::close (fd);
+            Throw<nudb::system_error> (
+                nudb::error_code {ev, nudb::system_category ()});
+        }
+        ::close (fd);
+    };
+    syncDirectory (dir_);
+    if (created)
+        syncDirectory (dir_.parent_path ());
+#else
+    (void) created;
+#endif
+}
+
+Blob
+DictionaryCodec::train (std::vector<Blob> const& samples, std::size_t size)
+{
+    // Byte strings are identified by their first k bytes
+    std::size_t constexpr k = 8;
+    std::size_t constexpr segmentSize = 64;
+
+    auto kmer = [](std::uint8_t const* p)
+    {
+        std::uint64_t v;
+        std::memcpy (&v, p, sizeof (v));
+        return v;
+    };
+
+    // How many samples each k-mer appears in
+    std::unordered_map<std::uint64_t, std::uint32_t> frequency;
+    for (auto const& s : samples)
+    {
+        std::unordered_set<std::uint64_t> seen;
+        for (std::size_t i = 0; i + k <= s.size (); ++i)
+        {
+            auto const v = kmer (s.data () + i);
+            if (seen.insert (v).second)
+                ++frequency[v];
+        }
+    }
+
+    // A segment is worth the k-mers it holds which other samples share
+    auto score = [&](std::uint8_t const* p, std::size_t n)
+    {
+        std::uint64_t total = 0;
+        std::unordered_set<std::uint64_t> seen;
+        for (std::size_t i = 0; i + k <= n; ++i)
+        {
+            auto const v = kmer (p + i);
+            if (! seen.insert (v).second)
+                continue;
+            auto const it = frequency.find (v);
+            if (it != frequency.end () && it->second > 1)
+                total += it->second - 1;
+        }
+        return total;
+    };
+
+    struct Segment
+    {
+        std::uint64_t score;
+        std::uint8_t const* data;
+        std::size_t size;
+    };
+    std::vector<Segment> segments;
+    for (auto const& s : samples)
+    {
+        for (std::size_t i = 0; i < s.size (); i += segmentSize / 2)
+        {
+            auto const n = std::min (segmentSize, s.size () - i);
+            if (n < k)
+                break;
+            auto const sc = score (s.data () + i, n);
+            if (sc != 0)
+                segments.push_back ({sc, s.data () + i, n});
+        }
+    }
+    std::sort (segments.begin (), segments.end (),
+        [](Segment const& a, Segment const& b)
+        {
+            return a.score > b.score;
+        });
+
+    // Take the best segments, scoring each again without the
+    // k-mers already covered so the dictionary doesn't repeat itself.
+    std::vector<Segment const*> picked;
+    std::size_t total = 0;
+    for (auto const& segment : segments)
+    {
+        if (total + segment.size > size)
+            continue;
+        if (score (segment.data, segment.size) * 2 < segment.score)
+            continue;
+        picked.push_back (&segment);
+        total += segment.size;
+        for (std::size_t i = 0; i + k <= segment.size; ++i)
+            frequency.erase (kmer (segment.data + i));
+        if (total + k > size)
+            break;
+    }
+
+    // LZ4 remembers the last position of each string in the
+    // dictionary, so the best segments go last
+    Blob ret;
+    ret.reserve (total);
+    for (auto it = picked.rbegin (); it != picked.rend (); ++it)
+        ret.insert (ret.end (), (*it)->data, (*it)->data + (*it)->size);
+    return ret;
+}
+
+}
+}
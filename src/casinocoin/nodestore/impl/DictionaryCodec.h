@@ -0,0 +1,264 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_NODESTORE_DICTIONARYCODEC_H_INCLUDED
+#define CASINOCOIN_NODESTORE_DICTIONARYCODEC_H_INCLUDED
+
+#include <casinocoin/basics/Blob.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/nodestore/NodeObject.h>
+#include <casinocoin/nodestore/Scheduler.h>
+#include <casinocoin/nodestore/Task.h>
+#include <casinocoin/nodestore/impl/varint.h>
+#include <lz4/lib/lz4.h>
+#include <boost/filesystem.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace casinocoin {
+namespace NodeStore {
+
+/** Compresses node objects using a dictionary for each object type.
+
+    Leaf nodes are small and share most of their structure with other
+    nodes of the same type, which a compressor working on one object
+    at a time can't take advantage of. Starting LZ4 with a dictionary
+    trained on earlier objects of the type lets it refer to that
+    common structure instead.
+
+    Dictionaries are trained from the first objects stored of each
+    type in a scheduled task, so storing isn't held up meanwhile, and
+    saved in a directory next to the data. A dictionary is synced to
+    disk before any object is compressed with it. They are never
+    changed or removed, since stored objects refer to them by number.
+
+    Objects are laid out as
+
+        varint  codec type (7)
+        varint  dictionary number
+        varint  uncompressed size
+        bytes   lz4 compressed data
+
+    Compression and decompression can be called concurrently.
+*/
+class DictionaryCodec : private Task
+{
+public:
+    /** The codec type in the nodeobject_compress output */
+    static std::size_t constexpr codecType = 7;
+
+    /** Open the dictionaries in a directory.
+
+        @param dir The directory holding the dictionaries.
+        @param train Whether to train dictionaries for the types
+                     which have none. Without it, compress always
+                     declines and only decompression works.
+        @param dictionarySize The size of trained dictionaries.
+        @param scheduler Runs the training.
+    */
+    DictionaryCodec (boost::filesystem::path dir, bool train,
+        std::size_t dictionarySize, Scheduler& scheduler,
+            beast::Journal journal);
+
+    /** Destroy the codec.
+
+        Training in progress is finished before this returns.
+    */
+    ~DictionaryCodec ();
+
+    DictionaryCodec (DictionaryCodec const&) = delete;
+    DictionaryCodec& operator= (DictionaryCodec const&) = delete;
+
+    /** Compress an encoded object with the dictionary of its type.
+
+        @return The compressed object including the codec type,
+                or an empty buffer if the type has no dictionary yet.
+    */
+    template <class BufferFactory>
+    std::pair<void const*, std::size_t>
+    compress (void const* in, std::size_t in_size, BufferFactory&& bf);
+
+    /** Decompress the output of compress, after the codec type. */
+    template <class BufferFactory>
+    std::pair<void const*, std::size_t>
+    decompress (void const* in, std::size_t in_size,
+        BufferFactory&& bf) const;
+
+    /** Build a dictionary from samples of similar data.
+
+        Picks the segments of the samples holding the byte strings
+        found in the most samples, as described by Liao, Petri,
+        Moffat and Wirth in "Effective Construction of Relative
+        Lempel-Ziv Dictionaries".
+    */
+    static
+    Blob
+    train (std::vector<Blob> const& samples, std::size_t size);
+
+private:
+    struct Dictionary
+    {
+        std::size_t number;
+        Blob data;
+        // Compression state with the dictionary loaded, copied
+        // for each object instead of loading the dictionary again
+        LZ4_stream_t stream;
+    };
+
+    // Object types are stored in one byte after 8 unused ones
+    static std::size_t constexpr typeOffset = 8;
+    static std::size_t constexpr numTypes = hotTRANSACTION_NODE + 1;
+    static std::size_t constexpr maxDictionaries = 256;
+
+    // Samples of a type waiting to be trained on
+    struct Training
+    {
+        std::size_t type;
+        std::vector<Blob> samples;
+    };
+
+    Dictionary const*
+    add (std::size_t number, std::size_t type, Blob data);
+
+    void
+    sample (std::size_t type, void const* in, std::size_t in_size);
+
+    void
+    performScheduledTask () override;
+
+    void
+    build (Training const& training);
+
+    void
+    save (std::size_t number, std::size_t type, Blob const& data);
+
+    boost::filesystem::path const dir_;
+    bool const train_;
+    std::size_t const dictionarySize_;
+    Scheduler& scheduler_;
+    beast::Journal j_;
+
+    // Readers never lock, dictionaries are only ever added
+    std::array<std::atomic<Dictionary const*>, maxDictionaries> byNumber_;
+    std::array<std::atomic<Dictionary const*>, numTypes> byType_;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Dictionary>> dictionaries_;
+    std::array<std::vector<Blob>, numTypes> samples_;
+    std::array<std::size_t, numTypes> sampleBytes_;
+    std::array<bool, numTypes> training_;
+    std::vector<Training> pending_;
+    bool trainPending_;
+    std::condition_variable trainCondition_;
+};
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+DictionaryCodec::compress (void const* in,
+    std::size_t in_size, BufferFactory&& bf)
+{
+    std::pair<void const*, std::size_t> result {nullptr, 0};
+    if (in_size <= typeOffset)
+        return result;
+    auto const type = reinterpret_cast<
+        std::uint8_t const*>(in)[typeOffset];
+    if (type >= numTypes)
+        return result;
+
+    auto const dict = byType_[type].load ();
+    if (! dict)
+    {
+        if (train_)
+            sample (type, in, in_size);
+        return result;
+    }
+
+    std::array<std::uint8_t, 3 * varint_traits<
+        std::size_t>::max> vi;
+    auto vn = write_varint (vi.data (), codecType);
+    vn += write_varint (vi.data () + vn, dict->number);
+    vn += write_varint (vi.data () + vn, in_size);
+
+    auto const out_max = LZ4_compressBound (in_size);
+    std::uint8_t* out = reinterpret_cast<
+        std::uint8_t*>(bf (vn + out_max));
+    std::memcpy (out, vi.data (), vn);
+
+    LZ4_stream_t stream;
+    std::memcpy (&stream, &dict->stream, sizeof (stream));
+    auto const out_size = LZ4_compress_fast_continue (&stream,
+        reinterpret_cast<char const*>(in),
+            reinterpret_cast<char*>(out + vn),
+                in_size, out_max, 1);
+    if (out_size <= 0)
+        Throw<std::runtime_error> (
+            "dictionary compress");
+    result.first = out;
+    result.second = vn + out_size;
+    return result;
+}
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+DictionaryCodec::decompress (void const* in,
+    std::size_t in_size, BufferFactory&& bf) const
+{
+    std::uint8_t const* p = reinterpret_cast<
+        std::uint8_t const*>(in);
+    std::size_t number;
+    auto n = read_varint (p, in_size, number);
+    if (n == 0 || number >= maxDictionaries)
+        Throw<std::runtime_error> (
+            "dictionary decompress");
+    auto const dict = byNumber_[number].load ();
+    if (! dict)
+        Throw<std::runtime_error> (
+            "dictionary decompress: missing dictionary " +
+                std::to_string (number));
+    std::pair<void const*, std::size_t> result;
+    auto const vn = read_varint (p + n, in_size - n, result.second);
+    if (vn == 0)
+        Throw<std::runtime_error> (
+            "dictionary decompress");
+    n += vn;
+    void* const out = bf (result.second);
+    result.first = out;
+    if (LZ4_decompress_safe_usingDict (
+            reinterpret_cast<char const*>(p + n),
+                reinterpret_cast<char*>(out),
+                    in_size - n, result.second,
+                        reinterpret_cast<char const*>(dict->data.data ()),
+                            dict->data.size ()) !=
+        static_cast<int>(result.second))
+    {
+        Throw<std::runtime_error> (
+            "dictionary decompress");
+    }
+    return result;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,207 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/nodestore/impl/FilteredBackend.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/beast/core/CurrentThreadName.h>
+#include <casinocoin/nodestore/NodeObject.h>
+#include <casinocoin/nodestore/impl/Tuning.h>
+#include <chrono>
+
+namespace casinocoin {
+namespace NodeStore {
+
+FilteredBackend::FilteredBackend (std::unique_ptr <Backend> backend,
+        bool isNew, std::uint64_t bits, boost::filesystem::path file,
+            beast::Journal journal)
+    : backend_ (std::move (backend))
+    , filter_ (bits, filterHashes)
+    , file_ (std::move (file))
+    , j_ (journal)
+{
+    if (isNew)
+    {
+        valid_ = true;
+        return;
+    }
+
+    if (filter_.load (file_))
+    {
+        // Until the next clean close, the file on disk
+        // doesn't know about new objects.
+        boost::system::error_code ec;
+        boost::filesystem::remove (file_, ec);
+        valid_ = ! ec;
+        if (! valid_)
+        {
+            JLOG (j_.error()) <<
+                "unable to remove " << file_ << ": " << ec.message ();
+        }
+        return;
+    }
+
+    // Objects stored from now on are added by store, so the
+    // rebuild only has to find the ones already there.
+    rebuilder_ = std::thread (&FilteredBackend::rebuild, this);
+}
+
+void
+FilteredBackend::rebuild ()
+{
+    beast::setCurrentThreadName ("bloom");
+
+    // Thrown to cut the rebuild short when closing
+    struct Stopped {};
+
+    JLOG (j_.warn()) <<
+        "rebuilding the Bloom filter of " << backend_->getName ();
+    auto const start = std::chrono::steady_clock::now ();
+    std::uint64_t count = 0;
+    try
+    {
+        backend_->for_each_key (
+            [&](void const* key)
+            {
+                if (stopRebuild_)
+                    throw Stopped {};
+                filter_.insert (key);
+                ++count;
+            });
+    }
+    catch (Stopped const&)
+    {
+        return;
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j_.error()) <<
+            "unable to build the Bloom filter of " <<
+            backend_->getName () << ": " << e.what ();
+        return;
+    }
+
+    valid_ = true;
+    JLOG (j_.info()) <<
+        "Bloom filter of " << backend_->getName () << " holds " <<
+        count << " objects, built in " <<
+        std::chrono::duration_cast <std::chrono::seconds> (
+            std::chrono::steady_clock::now () - start).count () << "s";
+}
+
+FilteredBackend::~FilteredBackend ()
+{
+    try
+    {
+        close ();
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j_.error()) <<
+            "closing " << backend_->getName () << ": " << e.what ();
+    }
+}
+
+void
+FilteredBackend::close ()
+{
+    if (closed_)
+        return;
+    closed_ = true;
+
+    if (rebuilder_.joinable ())
+    {
+        stopRebuild_ = true;
+        rebuilder_.join ();
+    }
+
+    if (valid_ && ! deletePath_)
+    {
+        JLOG (j_.debug()) <<
+            "Bloom filter of " << backend_->getName () << " skipped " <<
+            skipped_.load () << " reads, " <<
+            static_cast <int> (filter_.fill () * 100) << "% full";
+        if (! filter_.save (file_))
+        {
+            JLOG (j_.warn()) << "unable to save " << file_;
+        }
+    }
+    backend_->close ();
+}
+
+Status
+FilteredBackend::fetch (void const* key, std::shared_ptr<NodeObject>* pObject)
+{
+    if (valid_ && ! filter_.mayContain (key))
+    {
+        ++skipped_;
+        pObject->reset ();
+        return notFound;
+    }
+    return backend_->fetch (key, pObject);
+}
+
+std::vector<std::shared_ptr<NodeObject>>
+FilteredBackend::fetchBatch (std::size_t n, void const* const* keys)
+{
+    if (! valid_)
+        return backend_->fetchBatch (n, keys);
+
+    // Only ask the backend for the keys which may be there
+    std::vector <void const*> maybe;
+    std::vector <std::size_t> index;
+    maybe.reserve (n);
+    index.reserve (n);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        if (filter_.mayContain (keys[i]))
+        {
+            maybe.push_back (keys[i]);
+            index.push_back (i);
+        }
+    }
+    skipped_ += n - maybe.size ();
+
+    std::vector<std::shared_ptr<NodeObject>> ret (n);
+    if (maybe.empty ())
+        return ret;
+    auto found = backend_->fetchBatch (maybe.size (), maybe.data ());
+    for (std::size_t i = 0; i < found.size () && i < index.size (); ++i)
+        ret[index[i]] = std::move (found[i]);
+    return ret;
+}
+
+void
+FilteredBackend::store (std::shared_ptr<NodeObject> const& object)
+{
+    // The filter learns of the object first, so that it
+    // is never found in the backend but not the filter.
+    filter_.insert (object->getHash ().begin ());
+    backend_->store (object);
+}
+
+void
+FilteredBackend::storeBatch (Batch const& batch)
+{
+    for (auto const& object : batch)
+        filter_.insert (object->getHash ().begin ());
+    backend_->storeBatch (batch);
+}
+
+}
+}
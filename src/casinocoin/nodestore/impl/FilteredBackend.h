@@ -0,0 +1,161 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+#define CASINOCOIN_NODESTORE_FILTEREDBACKEND_H_INCLUDED
+
+#include <casinocoin/nodestore/Backend.h>
+#include <casinocoin/nodestore/impl/BloomFilter.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <atomic>
+#include <thread>
+
+namespace casinocoin {
+namespace NodeStore {
+
+/** A backend answering lookups of absent objects from a Bloom filter.
+
+    Every object stored is added to the filter, so a fetch of a key
+    the filter has never seen returns notFound without touching the
+    wrapped backend.
+
+    The filter is saved next to the data when the backend is closed,
+    and the saved copy is removed when it is loaded again. Without a
+    saved filter, such as after a crash, the filter is rebuilt from
+    the contents of the backend by a thread of its own. Until that
+    finishes, every fetch goes to the wrapped backend.
+*/
+class FilteredBackend
+    : public Backend
+{
+public:
+    /** Wrap a backend.
+
+        @param backend The backend to filter. It must not be in use yet.
+        @param isNew `true` if the backend was created empty.
+        @param bits The size of the filter.
+        @param file Where the filter is saved.
+    */
+    FilteredBackend (std::unique_ptr <Backend> backend, bool isNew,
+        std::uint64_t bits, boost::filesystem::path file,
+            beast::Journal journal);
+
+    ~FilteredBackend () override;
+
+    std::string
+    getName () override
+    {
+        return backend_->getName ();
+    }
+
+    void
+    close () override;
+
+    Status
+    fetch (void const* key, std::shared_ptr<NodeObject>* pObject) override;
+
+    bool
+    canFetchBatch () override
+    {
+        return backend_->canFetchBatch ();
+    }
+
+    std::vector<std::shared_ptr<NodeObject>>
+    fetchBatch (std::size_t n, void const* const* keys) override;
+
+    void
+    store (std::shared_ptr<NodeObject> const& object) override;
+
+    void
+    storeBatch (Batch const& batch) override;
+
+    void
+    for_each (std::function <void (std::shared_ptr<NodeObject>)> f) override
+    {
+        backend_->for_each (std::move (f));
+    }
+
+    void
+    for_each_key (std::function <void (void const*)> f) override
+    {
+        backend_->for_each_key (std::move (f));
+    }
+
+    void
+    sync () override
+    {
+        backend_->sync ();
+    }
+
+    int
+    getWriteLoad () override
+    {
+        return backend_->getWriteLoad ();
+    }
+
+    void
+    setDeletePath () override
+    {
+        deletePath_ = true;
+        backend_->setDeletePath ();
+    }
+
+    void
+    verify () override
+    {
+        backend_->verify ();
+    }
+
+    int
+    fdlimit () const override
+    {
+        return backend_->fdlimit ();
+    }
+
+    /** Whether fetches are answered by the filter yet. */
+    bool
+    filtering () const
+    {
+        return valid_;
+    }
+
+private:
+    // Add the keys already in the backend to the filter
+    void
+    rebuild ();
+
+    std::unique_ptr <Backend> backend_;
+    BloomFilter filter_;
+    boost::filesystem::path const file_;
+    beast::Journal j_;
+    // Whether the filter holds every stored key. If not, it is unused.
+    std::atomic <bool> valid_ {false};
+    std::atomic <bool> deletePath_ {false};
+    bool closed_ = false;
+
+    std::thread rebuilder_;
+    std::atomic <bool> stopRebuild_ {false};
+
+    // Lookups answered by the filter
+    std::atomic <std::uint64_t> skipped_ {0};
+};
+
+}
+}
+
+#endif
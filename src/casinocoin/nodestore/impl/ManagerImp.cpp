@@ -26,6 +26,8 @@
 #include <BeastConfig.h>
 #include <casinocoin/nodestore/impl/ManagerImp.h>
 #include <casinocoin/nodestore/impl/DatabaseRotatingImp.h>
+#include <casinocoin/nodestore/impl/DatabaseShardImp.h>
+#include <casinocoin/nodestore/impl/FilteredBackend.h>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -70,8 +72,26 @@ ManagerImp::make_Backend (
 
         if (factory != nullptr)
         {
+            // Objects outside the filesystem can't be told apart
+            // from a new backend, so they are never filtered.
+            auto const filterMB = get<std::uint64_t> (
+                parameters, "filter_mb", 0);
+            auto const path = boost::filesystem::path (
+                get<std::string> (parameters, "path"));
+            bool const filter = filterMB != 0 && ! path.empty () &&
+                ! beast::detail::ci_equal (type, std::string ("memory")) &&
+                ! beast::detail::ci_equal (type, std::string ("none"));
+            bool const isNew = ! boost::filesystem::exists (path);
+
             backend = factory->createInstance (
                 NodeObject::keyBytes, parameters, scheduler, journal);
+
+            if (filter)
+            {
+                backend = std::make_unique <FilteredBackend> (
+                    std::move (backend), isNew, filterMB << 23,
+                        path / "bloom.dat", journal);
+            }
         }
         else
         {
@@ -127,6 +147,24 @@ ManagerImp::make_DatabaseRotating (
         journal);
 }
 
+std::unique_ptr <DatabaseShard>
+ManagerImp::make_DatabaseShard (
+        std::string const& name,
+        Scheduler& scheduler,
+        int readThreads,
+        Stoppable& parent,
+        Section const& config,
+        beast::Journal journal)
+{
+    return std::make_unique <DatabaseShardImp> (
+        name,
+        scheduler,
+        readThreads,
+        parent,
+        config,
+        journal);
+}
+
 Factory*
 ManagerImp::find (std::string const& name)
 {
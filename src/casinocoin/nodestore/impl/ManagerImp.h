@@ -83,6 +83,15 @@ public:
         std::shared_ptr <Backend> writableBackend,
         std::shared_ptr <Backend> archiveBackend,
         beast::Journal journal) override;
+
+    std::unique_ptr <DatabaseShard>
+    make_DatabaseShard (
+        std::string const& name,
+        Scheduler& scheduler,
+        int readThreads,
+        Stoppable& parent,
+        Section const& config,
+        beast::Journal journal) override;
 };
 
 }
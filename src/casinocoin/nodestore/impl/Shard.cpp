@@ -0,0 +1,258 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/nodestore/impl/Shard.h>
+#include <casinocoin/nodestore/Manager.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/Slice.h>
+#include <casinocoin/beast/core/LexicalCast.h>
+#include <casinocoin/protocol/digest.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+namespace casinocoin {
+namespace NodeStore {
+
+// Parse the output of RangeSet::toString
+static
+RangeSet
+parseRangeSet (std::string const& s)
+{
+    RangeSet ret;
+    if (s == "empty")
+        return ret;
+
+    std::vector<std::string> ranges;
+    boost::split (ranges, s, boost::algorithm::is_any_of (","));
+    for (auto const& range : ranges)
+    {
+        auto const dash = range.find ('-');
+        if (dash == std::string::npos)
+        {
+            ret.setValue (
+                beast::lexicalCastThrow <std::uint32_t> (range));
+        }
+        else
+        {
+            ret.setRange (
+                beast::lexicalCastThrow <std::uint32_t> (
+                    range.substr (0, dash)),
+                beast::lexicalCastThrow <std::uint32_t> (
+                    range.substr (dash + 1)));
+        }
+    }
+    return ret;
+}
+
+Shard::Shard (std::uint32_t index, std::uint32_t ledgersPerShard,
+        boost::filesystem::path dir, beast::Journal journal)
+    : index_ (index)
+    , firstSeq_ (1 + index * ledgersPerShard)
+    , lastSeq_ ((index + 1) * ledgersPerShard)
+    , dir_ (std::move (dir))
+    , control_ (dir_ / "control.txt")
+    , j_ (journal)
+{
+}
+
+void
+Shard::open (Section config, Scheduler& scheduler)
+{
+    using namespace boost::filesystem;
+
+    // The control file goes in first, so that a directory
+    // without one is never a partially created shard.
+    if (! exists (dir_))
+    {
+        create_directories (dir_);
+        saveControl ();
+    }
+    else if (exists (control_))
+    {
+        ifstream ifs (control_);
+        std::string s;
+        if (! ifs || ! std::getline (ifs, s))
+            Throw<std::runtime_error> (
+                "Shard: unable to read " + control_.string());
+        storedSeqs_ = parseRangeSet (boost::trim_copy (s));
+        if (storedSeqs_.getFirst () != RangeSet::absent &&
+            (storedSeqs_.getFirst () < firstSeq_ ||
+                storedSeqs_.getLast () > lastSeq_))
+        {
+            Throw<std::runtime_error> (
+                "Shard: invalid ranges in " + control_.string());
+        }
+    }
+    else
+    {
+        complete_ = true;
+    }
+
+    config.set ("path", dir_.string());
+    if (get<std::string> (config, "type").empty ())
+        config.set ("type", "NuDB");
+    backend_ = Manager::instance().make_Backend (config, scheduler, j_);
+}
+
+bool
+Shard::setStored (std::uint32_t seq)
+{
+    assert (seq >= firstSeq_ && seq <= lastSeq_);
+    if (complete_ || storedSeqs_.hasValue (seq))
+        return false;
+
+    storedSeqs_.setValue (seq);
+    saveControl ();
+
+    return storedSeqs_.lebesgue_sum () == lastSeq_ - firstSeq_ + 1;
+}
+
+bool
+Shard::hasLedger (std::uint32_t seq) const
+{
+    if (seq < firstSeq_ || seq > lastSeq_)
+        return false;
+    return complete_ || storedSeqs_.hasValue (seq);
+}
+
+boost::optional<std::uint32_t>
+Shard::prepare () const
+{
+    if (complete_)
+        return boost::none;
+    auto const seq = storedSeqs_.prevMissing (lastSeq_ + 1);
+    if (seq == RangeSet::absent || seq < firstSeq_)
+        return boost::none;
+    return seq;
+}
+
+bool
+Shard::validate ()
+{
+    std::uint64_t objects = 0;
+    std::uint64_t invalid = 0;
+
+    // Objects are checked in groups so their keys can be hashed together
+    std::vector<std::shared_ptr<NodeObject>> group;
+    std::vector<Slice> messages;
+    std::vector<uint256> digests;
+    auto const checkGroup = [&]
+    {
+        messages.clear ();
+        for (auto const& object : group)
+            messages.push_back (makeSlice (object->getData ()));
+        digests.resize (messages.size ());
+        sha512HalfBatch (messages.data (), digests.data (), messages.size ());
+
+        for (std::size_t i = 0; i < group.size (); ++i)
+        {
+            ++objects;
+            if (digests[i] != group[i]->getHash () && invalid++ == 0)
+            {
+                JLOG (j_.error()) <<
+                    "shard " << index_ << " object " <<
+                    group[i]->getHash () << " doesn't match its key";
+            }
+        }
+        group.clear ();
+    };
+
+    try
+    {
+        backend_->verify ();
+        backend_->for_each (
+            [&](std::shared_ptr<NodeObject> object)
+            {
+                group.push_back (std::move (object));
+                if (group.size () == 64)
+                    checkGroup ();
+            });
+        checkGroup ();
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j_.error()) <<
+            "shard " << index_ << " failed to validate: " << e.what ();
+        return false;
+    }
+
+    if (invalid != 0)
+    {
+        JLOG (j_.error()) <<
+            "shard " << index_ << " has " << invalid <<
+            " invalid objects out of " << objects;
+        return false;
+    }
+
+    JLOG (j_.info()) <<
+        "shard " << index_ << " validated " << objects << " objects";
+    return true;
+}
+
+void
+Shard::finalize ()
+{
+    boost::filesystem::remove (control_);
+    storedSeqs_ = RangeSet ();
+    complete_ = true;
+}
+
+std::uint64_t
+Shard::fileSize () const
+{
+    using namespace boost::filesystem;
+
+    std::uint64_t size = 0;
+    boost::system::error_code ec;
+    for (directory_iterator it (dir_, ec), end; it != end; ++it)
+    {
+        if (is_regular_file (it->status ()))
+            size += file_size (it->path (), ec);
+    }
+    return size;
+}
+
+void
+Shard::close ()
+{
+    if (backend_)
+        backend_->close ();
+}
+
+void
+Shard::saveControl ()
+{
+    using namespace boost::filesystem;
+
+    // Write a new file and swap it in, so a crash
+    // never leaves a truncated control file behind.
+    auto const temp = dir_ / "control.tmp";
+    {
+        ofstream ofs (temp, std::ios::trunc);
+        ofs << storedSeqs_.toString () << '\n';
+        if (! ofs)
+            Throw<std::runtime_error> (
+                "Shard: unable to write " + temp.string());
+    }
+    rename (temp, control_);
+}
+
+}
+}
@@ -0,0 +1,131 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef CASINOCOIN_NODESTORE_SHARD_H_INCLUDED
+#define CASINOCOIN_NODESTORE_SHARD_H_INCLUDED
+
+#include <casinocoin/basics/BasicConfig.h>
+#include <casinocoin/basics/RangeSet.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <casinocoin/nodestore/Backend.h>
+#include <casinocoin/nodestore/Scheduler.h>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+namespace casinocoin {
+namespace NodeStore {
+
+/** One range of ledgers of the shard store, kept in its own directory.
+
+    While a shard is being filled, the ledgers it holds are recorded in a
+    control file next to the backend so that filling can resume after a
+    restart. A shard directory without a control file is complete.
+
+    Not thread safe, except for access to the backend.
+*/
+class Shard
+{
+public:
+    Shard (std::uint32_t index, std::uint32_t ledgersPerShard,
+        boost::filesystem::path dir, beast::Journal journal);
+
+    /** Open or create the backend.
+
+        @param config The parameters of the backend. The path is
+                      replaced by the directory of the shard.
+        @note Throws if the backend or control file can't be used.
+    */
+    void
+    open (Section config, Scheduler& scheduler);
+
+    /** Record a stored ledger.
+
+        @return `true` if that was the last ledger missing.
+    */
+    bool
+    setStored (std::uint32_t seq);
+
+    bool
+    hasLedger (std::uint32_t seq) const;
+
+    /** The highest ledger of the shard not stored yet. */
+    boost::optional<std::uint32_t>
+    prepare () const;
+
+    /** Check every object of the shard against its key.
+
+        @note The backend must not be in use while this runs.
+    */
+    bool
+    validate ();
+
+    /** Mark the shard complete by removing its control file. */
+    void
+    finalize ();
+
+    bool
+    complete () const
+    {
+        return complete_;
+    }
+
+    std::uint32_t
+    index () const
+    {
+        return index_;
+    }
+
+    Backend&
+    getBackend ()
+    {
+        return *backend_;
+    }
+
+    boost::filesystem::path const&
+    getDir () const
+    {
+        return dir_;
+    }
+
+    /** The space the shard uses on disk, in bytes. */
+    std::uint64_t
+    fileSize () const;
+
+    /** Close the backend, so the directory can be moved or removed. */
+    void
+    close ();
+
+private:
+    void
+    saveControl ();
+
+    std::uint32_t const index_;
+    std::uint32_t const firstSeq_;
+    std::uint32_t const lastSeq_;
+    boost::filesystem::path const dir_;
+    boost::filesystem::path const control_;
+    std::unique_ptr <Backend> backend_;
+    RangeSet storedSeqs_;
+    bool complete_ = false;
+    beast::Journal j_;
+};
+
+}
+}
+
+#endif
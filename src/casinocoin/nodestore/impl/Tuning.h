@@ -39,6 +39,31 @@ enum
 
     // Fraction of the cache one query source can take
     ,asyncDivider = 8
+
+    // Pending asynchronous reads for each busy read thread
+    ,readsPerThread = 16
+
+    // While both read queues are busy, every this many reads one is
+    // taken from the low priority queue so it can't starve
+    ,lowReadInterval = 8
+
+    // Buckets of the asynchronous read latency histogram
+    ,readLatencyBuckets = 12
+
+    // Bits of a backend's Bloom filter set for each object
+    ,filterHashes = 7
+
+    // Bytes of objects of a type to train a compression dictionary on
+    ,dictionaryTrainingBytes = 1024 * 1024
+
+    // Objects larger than this are not used to train dictionaries
+    ,dictionarySampleMax = 4096
+
+    // Size of trained compression dictionaries
+    ,dictionarySize = 32 * 1024
+
+    // Seconds between records of the progress of an import
+    ,importCheckpointSeconds = 10
 };
 
 }
@@ -28,6 +28,7 @@
 
 #include <casinocoin/basics/contract.h>
 #include <nudb/detail/field.hpp>
+#include <casinocoin/nodestore/impl/DictionaryCodec.h>
 #include <casinocoin/nodestore/impl/varint.h>
 #include <casinocoin/nodestore/NodeObject.h>
 #include <casinocoin/protocol/HashPrefix.h>
@@ -142,12 +143,19 @@ lz4_compress (void const* in,
     1 = lz4 compressed
     2 = inner node compressed
     3 = full inner node
+    5 = v2 inner node compressed
+    6 = full v2 inner node
+    7 = lz4 compressed with a dictionary
+
+    Objects of type 7 can only be decompressed with the
+    DictionaryCodec holding the dictionary they refer to.
 */
 
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
 nodeobject_decompress (void const* in,
-    std::size_t in_size, BufferFactory&& bf)
+    std::size_t in_size, BufferFactory&& bf,
+        DictionaryCodec const* dictionaries = nullptr)
 {
     using namespace nudb::detail;
 
@@ -315,6 +323,15 @@ nodeobject_decompress (void const* in,
         write(os, is((depth+1)/2), (depth+1)/2);
         break;
     }
+    case DictionaryCodec::codecType: // lz4 with a dictionary
+    {
+        if (! dictionaries)
+            Throw<std::runtime_error> (
+                "nodeobject codec: no dictionaries");
+        result = dictionaries->decompress(
+            p, in_size, bf);
+        break;
+    }
     default:
         Throw<std::runtime_error> (
             "nodeobject codec: bad type=" +
@@ -340,7 +357,8 @@ zero32()
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
 nodeobject_compress (void const* in,
-    std::size_t in_size, BufferFactory&& bf)
+    std::size_t in_size, BufferFactory&& bf,
+        DictionaryCodec* dictionaries = nullptr)
 {
     using std::runtime_error;
     using namespace nudb::detail;
@@ -493,6 +511,14 @@ nodeobject_compress (void const* in,
         }
     }
 
+    if (dictionaries)
+    {
+        auto const result = dictionaries->compress(
+            in, in_size, bf);
+        if (result.first)
+            return result;
+    }
+
     std::array<std::uint8_t, varint_traits<
         std::size_t>::max> vi;
     auto const vn = write_varint(
@@ -25,6 +25,7 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <casinocoin/app/main/CollectorManager.h>
 #include <casinocoin/app/misc/HashRouter.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
 #include <casinocoin/app/misc/ValidatorList.h>
@@ -52,6 +53,9 @@
 
 #include <boost/utility/in_place_factory.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace casinocoin {
 
 /** A functor to visit all active peers and retrieve their JSON data */
@@ -162,6 +166,10 @@ OverlayImpl::OverlayImpl (
     , m_resolver (resolver)
     , next_id_(1)
     , timer_count_(0)
+    , checkBatcher_ (std::make_shared <CheckBatcher> (app_.getJobQueue (),
+        static_cast<int>(std::max (1u, std::thread::hardware_concurrency ()))))
+    , stats_ (std::bind (&OverlayImpl::collect_metrics, this),
+        app_.getCollectorManager ().group ("overlay"))
 {
     beast::PropertyStream::Source::add (m_peerFinder.get());
 }
@@ -777,6 +785,32 @@ OverlayImpl::size()
     return ids_.size ();
 }
 
+// Per peer queues are summarized, since a gauge
+// for each peer would come and go with the peer.
+void
+OverlayImpl::collect_metrics()
+{
+    std::size_t peers = 0;
+    std::size_t total = 0;
+    std::size_t largest = 0;
+    {
+        std::lock_guard <decltype(mutex_)> lock (mutex_);
+        for (auto const& e : ids_)
+        {
+            if (auto const peer = e.second.lock ())
+            {
+                auto const size = peer->sendQueueSize ();
+                ++peers;
+                total += size;
+                largest = std::max (largest, size);
+            }
+        }
+    }
+    stats_.peers = peers;
+    stats_.sendq_total = total;
+    stats_.sendq_max = largest;
+}
+
 int
 OverlayImpl::limit()
 {
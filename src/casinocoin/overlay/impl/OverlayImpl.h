@@ -27,6 +27,7 @@
 #define CASINOCOIN_OVERLAY_OVERLAYIMPL_H_INCLUDED
 
 #include <casinocoin/app/main/Application.h>
+#include <casinocoin/core/CheckBatcher.h>
 #include <casinocoin/core/Job.h>
 #include <casinocoin/overlay/Overlay.h>
 #include <casinocoin/overlay/impl/TrafficCount.h>
@@ -37,6 +38,7 @@
 #include <casinocoin/basics/UnorderedContainers.h>
 #include <casinocoin/peerfinder/PeerfinderManager.h>
 #include <casinocoin/resource/ResourceManager.h>
+#include <casinocoin/beast/insight/Collector.h>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/ssl/context.hpp>
 #include <boost/asio/strand.hpp>
@@ -125,6 +127,30 @@ private:
     std::atomic <Peer::id_t> next_id_;
     int timer_count_;
 
+    // Signature checks of proposals and validations from all peers
+    std::shared_ptr <CheckBatcher> checkBatcher_;
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats (Handler const& handler,
+                beast::insight::Collector::ptr const& collector)
+            : hook (collector->make_hook (handler))
+            , peers (collector->make_gauge ("peers"))
+            , sendq_total (collector->make_gauge ("sendq_total"))
+            , sendq_max (collector->make_gauge ("sendq_max"))
+        {
+        }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge peers;
+        beast::insight::Gauge sendq_total;
+        beast::insight::Gauge sendq_max;
+    };
+
+    // Last, so that it is unhooked before the peers go away
+    Stats stats_;
+
     //--------------------------------------------------------------------------
 
 public:
@@ -162,6 +188,12 @@ public:
         return setup_;
     }
 
+    CheckBatcher&
+    checkBatcher()
+    {
+        return *checkBatcher_;
+    }
+
     Handoff
     onHandoff (std::unique_ptr <beast::asio::ssl_bundle>&& bundle,
         http_request_type&& request,
@@ -342,6 +374,9 @@ private:
 
     void
     sendEndpoints();
+
+    void
+    collect_metrics();
 };
 
 } // casinocoin
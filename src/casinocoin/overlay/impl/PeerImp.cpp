@@ -45,6 +45,7 @@
 #include <casinocoin/core/JobQueue.h>
 #include <casinocoin/core/TimeKeeper.h>
 #include <casinocoin/json/json_reader.h>
+#include <casinocoin/nodestore/DatabaseShard.h>
 #include <casinocoin/resource/Fees.h>
 #include <casinocoin/rpc/ServerHandler.h>
 #include <casinocoin/overlay/Cluster.h>
@@ -224,6 +225,7 @@ PeerImp::send (Message::pointer const& m)
     }
 
     send_queue_.push(m);
+    sendQueueSize_ = send_queue_.size();
 
     if(sendq_size != 0)
         return;
@@ -801,6 +803,7 @@ PeerImp::onWriteMessage (error_code ec, std::size_t bytes_transferred)
 
     assert(! send_queue_.empty());
     send_queue_.pop();
+    sendQueueSize_ = send_queue_.size();
     if (! send_queue_.empty())
     {
         // Timeout on writes only
@@ -1295,11 +1298,15 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMProposeSet> const& m)
             app_.timeKeeper().closeTime(),calcNodeID(publicKey)});
 
     std::weak_ptr<PeerImp> weak = shared_from_this();
-    app_.getJobQueue ().addJob (
-        isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut, "recvPropose->checkPropose",
-        [weak, m, proposal] (Job& job) {
+    bool const fromCluster = cluster();
+    overlay_.checkBatcher().add (
+        isTrusted ? jtPROPOSAL_t : jtPROPOSAL_ut,
+        [fromCluster, proposal] {
+            return fromCluster || proposal->checkSign ();
+        },
+        [weak, m, proposal, isTrusted] (bool validSig) {
             if (auto peer = weak.lock())
-                peer->checkPropose(job, m, proposal);
+                peer->checkPropose(validSig, isTrusted, m, proposal);
         });
 }
 
@@ -1607,13 +1614,18 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMValidation> const& m)
         if (isTrusted || !app_.getFeeTrack ().isLoadedLocal ())
         {
             std::weak_ptr<PeerImp> weak = shared_from_this();
-            app_.getJobQueue ().addJob (
+            bool const fromCluster = cluster();
+            overlay_.checkBatcher().add (
                 isTrusted ? jtVALIDATION_t : jtVALIDATION_ut,
-                "recvValidation->checkValidation",
-                [weak, val, isTrusted, m] (Job&)
+                [fromCluster, val]
+                {
+                    return fromCluster || val->isValid ();
+                },
+                [weak, val, isTrusted, m] (bool validSig)
                 {
                     if (auto peer = weak.lock())
                         peer->checkValidation(
+                            validSig,
                             val,
                             isTrusted,
                             m);
@@ -1682,6 +1694,13 @@ PeerImp::onMessage (std::shared_ptr <protocol::TMGetObjectByHash> const& m)
                 std::shared_ptr<NodeObject> hObj =
                     app_.getNodeStore ().fetch (hash);
 
+                // Older history may only be in the shard store
+                if (! hObj && obj.has_ledgerseq ())
+                {
+                    if (auto const shards = app_.getShardStore ())
+                        hObj = shards->fetch (hash, obj.ledgerseq ());
+                }
+
                 if (hObj)
                 {
                     protocol::TMIndexedObject& newObj = *reply.add_objects ();
@@ -1890,19 +1909,17 @@ PeerImp::checkTransaction (int flags,
 
 // Called from our JobQueue
 void
-PeerImp::checkPropose (Job& job,
+PeerImp::checkPropose (bool validSig, bool isTrusted,
     std::shared_ptr <protocol::TMProposeSet> const& packet,
         CCLCxPeerPos::pointer peerPos)
 {
-    bool isTrusted = (job.getType () == jtPROPOSAL_t);
-
     JLOG(p_journal_.trace()) <<
         "Checking " << (isTrusted ? "trusted" : "UNTRUSTED") << " proposal";
 
     assert (packet);
     protocol::TMProposeSet& set = *packet;
 
-    if (! cluster() && !peerPos->checkSign ())
+    if (! validSig)
     {
         JLOG(p_journal_.warn()) <<
             "Proposal fails sig check";
@@ -1933,14 +1950,14 @@ PeerImp::checkPropose (Job& job,
 }
 
 void
-PeerImp::checkValidation (STValidation::pointer val,
+PeerImp::checkValidation (bool validSig, STValidation::pointer val,
     bool isTrusted, std::shared_ptr<protocol::TMValidation> const& packet)
 {
     try
     {
         // VFALCO Which functions throw?
         uint256 signingHash = val->getSigningHash();
-        if (! cluster() && !val->isValid (signingHash))
+        if (! validSig)
         {
             JLOG(p_journal_.warn()) <<
                 "Validation is invalid";
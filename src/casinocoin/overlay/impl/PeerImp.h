@@ -47,6 +47,7 @@
 #include <beast/http/message.hpp>
 #include <beast/http/parser_v1.hpp>
 #include <casinocoin/beast/utility/WrappedSink.h>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <queue>
@@ -163,6 +164,8 @@ private:
     beast::http::fields const& headers_;
     beast::streambuf write_buffer_;
     std::queue<Message::pointer> send_queue_;
+    // The size of send_queue_, which is only touched on the strand
+    std::atomic <std::size_t> sendQueueSize_ {0};
     bool gracefulClose_ = false;
     int large_sendq_ = 0;
     int no_ping_ = 0;
@@ -223,6 +226,13 @@ public:
     void
     send (Message::pointer const& m) override;
 
+    /** The number of messages waiting to be written. */
+    std::size_t
+    sendQueueSize () const
+    {
+        return sendQueueSize_;
+    }
+
     /** Send a set of PeerFinder endpoints as a protocol message. */
     template <class FwdIt, class = typename std::enable_if_t<std::is_same<
         typename std::iterator_traits<FwdIt>::value_type,
@@ -455,13 +465,15 @@ private:
     checkTransaction (int flags, bool checkSignature,
         std::shared_ptr<STTx const> const& stx);
 
+    // Act on a proposal once its signature has been checked
     void
-    checkPropose (Job& job,
+    checkPropose (bool validSig, bool isTrusted,
         std::shared_ptr<protocol::TMProposeSet> const& packet,
             CCLCxPeerPos::pointer peerPos);
 
+    // Act on a validation once its signature has been checked
     void
-    checkValidation (STValidation::pointer val,
+    checkValidation (bool validSig, STValidation::pointer val,
         bool isTrusted, std::shared_ptr<protocol::TMValidation> const& packet);
 
     void
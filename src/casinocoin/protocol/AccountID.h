@@ -148,6 +148,9 @@ inline std::ostream& operator<< (std::ostream& os, AccountID const& x)
     justify having a cache. In the future, casinocoind should
     require clients to receive "binary" results, where
     AccountIDs are hex-encoded.
+
+    Addresses sent by clients are cached the same way in
+    the other direction.
 */
 class AccountIDCache
 {
@@ -158,6 +161,10 @@ private:
         std::string> mutable m0_;
     hash_map<AccountID,
         std::string> mutable m1_;
+    hash_map<std::string,
+        AccountID> mutable parsed0_;
+    hash_map<std::string,
+        AccountID> mutable parsed1_;
 
 public:
     AccountIDCache(AccountIDCache const&) = delete;
@@ -176,6 +183,16 @@ public:
     */
     std::string
     toBase58 (AccountID const&) const;
+
+    /** Return casinocoin::parseBase58<AccountID> for the string
+
+        Strings which fail to parse are not cached.
+
+        Thread Safety:
+            Safe to call from any thread concurrently
+    */
+    boost::optional<AccountID>
+    fromBase58 (std::string const&) const;
 };
 
 } // casinocoin
@@ -80,6 +80,7 @@ JSS ( accounts );                   // in: LedgerEntry, Subscribe,
                                     //     handlers/Ledger, Unsubscribe
                                     // out: WalletAccounts
 JSS ( accounts_proposed );          // in: Subscribe, Unsubscribe
+JSS ( acquired );                   // out: GetCounts
 JSS ( action );
 JSS ( acquiring );                  // out: LedgerRequest
 JSS ( address );                    // out: PeerImp
@@ -128,7 +129,9 @@ JSS ( code );                       // out: errors
 JSS ( command );                    // in: RPCHandler
 JSS ( complete );                   // out: NetworkOPs, InboundLedger
 JSS ( complete_ledgers );           // out: NetworkOPs, PeerImp
+JSS ( complete_shards );            // out: NetworkOPs
 JSS ( consensus );                  // out: NetworkOPs, LedgerConsensus
+JSS ( contended );                  // out: GetCounts
 JSS ( converge_time );              // out: NetworkOPs
 JSS ( converge_time_s );            // out: NetworkOPs
 JSS ( count );                      // in: AccountTx*
@@ -201,6 +204,8 @@ JSS ( have_header );                // out: InboundLedger
 JSS ( have_state );                 // out: InboundLedger
 JSS ( have_transactions );          // out: InboundLedger
 JSS ( highest_sequence );           // out: AccountInfo
+JSS ( hold_max_us );                // out: GetCounts
+JSS ( hold_us );                    // out: GetCounts
 JSS ( hostid );                     // out: NetworkOPs
 JSS ( hotwallet );                  // in: GatewayBalances
 JSS ( id );                         // websocket.
@@ -225,6 +230,7 @@ JSS ( key_type );                   // in/out: WalletPropose, TransactionSign
 JSS ( latency );                    // out: PeerImp
 JSS ( last );                       // out: RPCVersion
 JSS ( last_close );                 // out: NetworkOPs
+JSS ( last_rotated );               // out: SHAMapStore
 JSS ( ledger );                     // in: NetworkOPs, LedgerCleaner,
                                     //     RPCHelpers
                                     // out: NetworkOPs, PeerImp
@@ -262,6 +268,7 @@ JSS ( load_factor_server );         // out: NetworkOPs
 JSS ( load_fee );                   // out: LoadFeeTrackImp, NetworkOPs
 JSS ( local );                      // out: resource/Logic.h
 JSS ( local_txs );                  // out: GetCounts
+JSS ( locks );                      // out: GetCounts
 JSS ( lowest_sequence );            // out: AccountInfo
 JSS ( majority );                   // out: RPC feature
 JSS ( marker );                     // in/out: AccountTx, AccountOffers,
@@ -298,16 +305,20 @@ JSS ( node );                       // out: LedgerEntry
 JSS ( node_binary );                // out: LedgerEntry
 JSS ( node_hit_rate );              // out: GetCounts
 JSS ( node_read_bytes );            // out: GetCounts
+JSS ( node_read_latency_high );     // out: GetCounts
+JSS ( node_read_latency_low );      // out: GetCounts
 JSS ( node_reads_hit );             // out: GetCounts
 JSS ( node_reads_total );           // out: GetCounts
 JSS ( node_writes );                // out: GetCounts
 JSS ( node_written_bytes );         // out: GetCounts
 JSS ( nodes );                      // out: PathState
+JSS ( nodes_copied );               // out: SHAMapStore
 JSS ( obligations );                // out: GatewayBalances
 JSS ( offer );                      // in: LedgerEntry
 JSS ( offers );                     // out: NetworkOPs, AccountOffers, Subscribe
 JSS ( offline );                    // in: TransactionSign
 JSS ( offset );                     // in/out: AccountTxOld
+JSS ( online_delete );              // out: NetworkOPs
 JSS ( open );                       // out: handlers/Ledger
 JSS ( open_ledger_fee );            // out: TxQ
 JSS ( open_ledger_level );          // out: TxQ
@@ -378,6 +389,8 @@ JSS ( server_status );              // out: NetworkOPs
 JSS ( settle_delay );               // out: AccountChannels
 JSS ( severity );                   // in: LogLevel
 JSS ( signature );                  // out: NetworkOPs, ChannelAuthorize
+JSS ( signature_cache_size );       // out: GetCounts
+JSS ( signature_hit_rate );         // out: GetCounts
 JSS ( signature_verified );         // out: ChannelVerify
 JSS ( signing_key );                // out: NetworkOPs
 JSS ( signing_time );               // out: NetworkOPs
@@ -401,6 +414,7 @@ JSS ( sub_index );                  // in: LedgerEntry
 JSS ( subcommand );                 // in: PathFind
 JSS ( success );                    // rpc
 JSS ( supported );                  // out: AmendmentTableImpl
+JSS ( synced_ledger );              // out: SHAMapStore
 JSS ( system_time_offset );         // out: NetworkOPs
 JSS ( tag );                        // out: Peers
 JSS ( taker );                      // in: Subscribe, BookOffers
@@ -460,6 +474,8 @@ JSS ( value );                      // out: STAmount
 JSS ( version );                    // out: RPCVersion
 JSS ( vetoed );                     // out: AmendmentTableImpl
 JSS ( vote );                       // in: Feature
+JSS ( wait_max_us );                // out: GetCounts
+JSS ( wait_us );                    // out: GetCounts
 JSS ( warning );                    // rpc:
 JSS ( write_load );                 // out: GetCounts
 
@@ -225,7 +225,9 @@ publicKeyType (PublicKey const& publicKey)
 }
 /** @} */
 
-/** Verify a secp256k1 signature on the digest of a message. */
+/** Verify a secp256k1 signature on the digest of a message.
+    Signatures which verify are remembered in SignatureCache.
+*/
 bool
 verifyDigest (PublicKey const& publicKey,
     uint256 const& digest,
@@ -235,6 +237,7 @@ verifyDigest (PublicKey const& publicKey,
 /** Verify a signature on a message.
     With secp256k1 signatures, the data is first hashed with
     SHA512-Half, and the resulting digest is signed.
+    Signatures which verify are remembered in SignatureCache.
 */
 bool
 verify (PublicKey const& publicKey,
@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_PROTOCOL_SIGNATURECACHE_H_INCLUDED
+#define CASINOCOIN_PROTOCOL_SIGNATURECACHE_H_INCLUDED
+
+#include <casinocoin/basics/base_uint.h>
+#include <casinocoin/basics/Slice.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace casinocoin {
+
+class PublicKey;
+
+/** Remembers signatures which have been verified.
+
+    The same validations, proposals, manifests and transactions reach
+    a server from many peers and are checked again when they are relayed
+    or reprocessed. verify and verifyDigest record each signature that
+    checks out, so checking it again is a lookup.
+
+    An entry is the hash of the signed digest, the public key, the
+    signature and whether the signature had to be fully canonical.
+    Failed checks are not recorded.
+
+    Thread Safety:
+        Safe to call from any thread concurrently
+*/
+class SignatureCache
+{
+private:
+    // Entries are spread over partitions to keep lock contention low.
+    // Each partition keeps two generations like AccountIDCache: when
+    // the newer one fills up, the older one is dropped.
+    struct Partition
+    {
+        std::mutex mutex;
+        hardened_hash_set<uint256> recent;
+        hardened_hash_set<uint256> old;
+    };
+
+    static std::size_t const partitions = 16;
+
+    std::array<Partition, partitions> partitions_;
+    std::atomic<std::size_t> capacity_;
+    std::atomic<std::uint64_t> hits_ {0};
+    std::atomic<std::uint64_t> misses_ {0};
+
+    Partition&
+    partition (uint256 const& key);
+
+    // Called with the partition locked
+    void
+    add (Partition& p, uint256 const& key);
+
+public:
+    SignatureCache (SignatureCache const&) = delete;
+    SignatureCache& operator= (SignatureCache const&) = delete;
+
+    /** Create a cache holding about this many signatures. */
+    explicit
+    SignatureCache (std::size_t capacity);
+
+    /** The cache consulted by verify and verifyDigest. */
+    static
+    SignatureCache&
+    instance ();
+
+    /** Return the entry for a signature on a digest. */
+    static
+    uint256
+    makeKey (uint256 const& digest, PublicKey const& publicKey,
+        Slice const& sig, bool mustBeFullyCanonical);
+
+    /** Return true if the signature was verified before. */
+    bool
+    contains (uint256 const& key);
+
+    /** Record a signature which verified. */
+    void
+    insert (uint256 const& key);
+
+    /** Change how many signatures the cache holds.
+
+        Entries beyond the new capacity are dropped as new ones arrive.
+    */
+    void
+    setCapacity (std::size_t capacity);
+
+    /** The number of signatures remembered. */
+    std::size_t
+    size ();
+
+    /** The percentage of lookups which found the signature. */
+    float
+    getHitRate () const;
+};
+
+} // casinocoin
+
+#endif
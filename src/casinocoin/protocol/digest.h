@@ -27,6 +27,7 @@
 #define CASINOCOIN_PROTOCOL_DIGEST_H_INCLUDED
 
 #include <casinocoin/basics/base_uint.h>
+#include <casinocoin/basics/Slice.h>
 #include <casinocoin/beast/crypto/ripemd.h>
 #include <casinocoin/beast/crypto/sha2.h>
 #include <casinocoin/beast/hash/endian.h>
@@ -280,6 +281,21 @@ sha512Half (Args const&... args)
         sha512_half_hasher::result_type>(h);
 }
 
+/** Computes the SHA512-Half of many messages at once.
+
+    Messages are hashed several at a time with the vector
+    instructions of the processor (AVX2 or AVX-512 on x86-64)
+    when it has them, which is much faster than hashing them
+    one after the other. The result is the same either way.
+
+    @param messages The messages to hash.
+    @param digests Receives the digest of each message.
+    @param count The number of messages.
+*/
+void
+sha512HalfBatch (Slice const* messages, uint256* digests,
+    std::size_t count);
+
 /** Returns the SHA512-Half of a series of objects.
 
     Postconditions:
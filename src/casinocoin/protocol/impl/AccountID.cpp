@@ -206,6 +206,7 @@ AccountIDCache::AccountIDCache(
     : capacity_(capacity)
 {
     m1_.reserve(capacity_);
+    parsed1_.reserve(capacity_);
 }
 
 std::string
@@ -241,4 +242,37 @@ AccountIDCache::toBase58(
     return result;
 }
 
+boost::optional<AccountID>
+AccountIDCache::fromBase58(
+    std::string const& s) const
+{
+    std::lock_guard<
+        std::mutex> lock(mutex_);
+    auto iter = parsed1_.find(s);
+    if (iter != parsed1_.end())
+        return iter->second;
+    iter = parsed0_.find(s);
+    boost::optional<AccountID> result;
+    if (iter != parsed0_.end())
+    {
+        result = iter->second;
+        parsed0_.erase(iter);
+    }
+    else
+    {
+        result =
+            parseBase58<AccountID>(s);
+        if (! result)
+            return result;
+    }
+    if (parsed1_.size() >= capacity_)
+    {
+        parsed0_ = std::move(parsed1_);
+        parsed1_.clear();
+        parsed1_.reserve(capacity_);
+    }
+    parsed1_.emplace(s, *result);
+    return result;
+}
+
 } // casinocoin
@@ -26,6 +26,7 @@
 #include <BeastConfig.h>
 #include <casinocoin/protocol/PublicKey.h>
 #include <casinocoin/protocol/digest.h>
+#include <casinocoin/protocol/SignatureCache.h>
 #include <casinocoin/protocol/impl/secp256k1.h>
 #include <casinocoin/basics/contract.h>
 #include <casinocoin/basics/strHex.h>
@@ -225,14 +226,13 @@ publicKeyType (Slice const& slice)
     return boost::none;
 }
 
+static
 bool
-verifyDigest (PublicKey const& publicKey,
+verifySecp256k1 (PublicKey const& publicKey,
     uint256 const& digest,
     Slice const& sig,
     bool mustBeFullyCanonical)
 {
-    if (publicKeyType(publicKey) != KeyType::secp256k1)
-        LogicError("sign: secp256k1 required for digest signing");
     auto const canonicality = ecdsaCanonicality(sig);
     if (! canonicality)
         return false;
@@ -280,6 +280,27 @@ verifyDigest (PublicKey const& publicKey,
         &pubkey_imp) == 1;
 }
 
+bool
+verifyDigest (PublicKey const& publicKey,
+    uint256 const& digest,
+    Slice const& sig,
+    bool mustBeFullyCanonical)
+{
+    if (publicKeyType(publicKey) != KeyType::secp256k1)
+        LogicError("sign: secp256k1 required for digest signing");
+
+    auto& cache = SignatureCache::instance();
+    auto const key = SignatureCache::makeKey(
+        digest, publicKey, sig, mustBeFullyCanonical);
+    if (cache.contains(key))
+        return true;
+    if (! verifySecp256k1 (publicKey,
+            digest, sig, mustBeFullyCanonical))
+        return false;
+    cache.insert(key);
+    return true;
+}
+
 bool
 verify (PublicKey const& publicKey,
     Slice const& m,
@@ -298,13 +319,22 @@ verify (PublicKey const& publicKey,
             if (! ed25519Canonical(sig))
                 return false;
 
+            auto& cache = SignatureCache::instance();
+            auto const key = SignatureCache::makeKey(
+                sha512Half(m), publicKey, sig, mustBeFullyCanonical);
+            if (cache.contains(key))
+                return true;
+
             // We internally prefix Ed25519 keys with a 0xED
             // byte to distinguish them from secp256k1 keys
             // so when verifying the signature, we need to
             // first strip that prefix.
-            return ed25519_sign_open(
+            if (ed25519_sign_open(
                 m.data(), m.size(), publicKey.data() + 1,
-                    sig.data()) == 0;
+                    sig.data()) != 0)
+                return false;
+            cache.insert(key);
+            return true;
         }
     }
     return false;
@@ -0,0 +1,131 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/protocol/SignatureCache.h>
+#include <casinocoin/protocol/PublicKey.h>
+#include <casinocoin/protocol/digest.h>
+#include <algorithm>
+
+namespace casinocoin {
+
+SignatureCache::SignatureCache (std::size_t capacity)
+    : capacity_ (capacity)
+{
+}
+
+SignatureCache&
+SignatureCache::instance ()
+{
+    static SignatureCache cache (65536);
+    return cache;
+}
+
+uint256
+SignatureCache::makeKey (uint256 const& digest, PublicKey const& publicKey,
+    Slice const& sig, bool mustBeFullyCanonical)
+{
+    sha512_half_hasher h;
+    h (digest.data (), digest.size ());
+    h (publicKey.data (), publicKey.size ());
+    h (sig.data (), sig.size ());
+    std::uint8_t const canonical = mustBeFullyCanonical ? 1 : 0;
+    h (&canonical, sizeof (canonical));
+    return static_cast<sha512_half_hasher::result_type>(h);
+}
+
+SignatureCache::Partition&
+SignatureCache::partition (uint256 const& key)
+{
+    return partitions_[*key.begin () % partitions];
+}
+
+void
+SignatureCache::add (Partition& p, uint256 const& key)
+{
+    auto const limit = std::max<std::size_t> (
+        capacity_.load () / partitions, 1);
+    if (p.recent.size () >= limit)
+    {
+        p.old = std::move (p.recent);
+        p.recent.clear ();
+    }
+    p.recent.insert (key);
+}
+
+bool
+SignatureCache::contains (uint256 const& key)
+{
+    auto& p = partition (key);
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock (p.mutex);
+        if (p.recent.count (key) != 0)
+        {
+            found = true;
+        }
+        else if (p.old.erase (key) != 0)
+        {
+            // Keep it from being dropped with the old generation
+            add (p, key);
+            found = true;
+        }
+    }
+    if (found)
+        ++hits_;
+    else
+        ++misses_;
+    return found;
+}
+
+void
+SignatureCache::insert (uint256 const& key)
+{
+    auto& p = partition (key);
+    std::lock_guard<std::mutex> lock (p.mutex);
+    add (p, key);
+}
+
+void
+SignatureCache::setCapacity (std::size_t capacity)
+{
+    capacity_ = capacity;
+}
+
+std::size_t
+SignatureCache::size ()
+{
+    std::size_t n = 0;
+    for (auto& p : partitions_)
+    {
+        std::lock_guard<std::mutex> lock (p.mutex);
+        n += p.recent.size () + p.old.size ();
+    }
+    return n;
+}
+
+float
+SignatureCache::getHitRate () const
+{
+    auto const hits = hits_.load ();
+    auto const total = static_cast<float> (hits + misses_.load ());
+    return hits * (100.0f / std::max (1.0f, total));
+}
+
+} // casinocoin
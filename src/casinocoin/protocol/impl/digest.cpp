@@ -25,10 +25,18 @@
 
 #include <BeastConfig.h>
 #include <casinocoin/protocol/digest.h>
+#include <cstring>
 #include <type_traits>
 #include <openssl/ripemd.h>
 #include <openssl/sha.h>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CASINOCOIN_SHA512_MULTI_BUFFER 1
+#include <immintrin.h>
+#else
+#define CASINOCOIN_SHA512_MULTI_BUFFER 0
+#endif
+
 namespace casinocoin {
 
 openssl_ripemd160_hasher::openssl_ripemd160_hasher()
@@ -119,4 +127,345 @@ openssl_sha256_hasher::operator result_type() noexcept
     return digest;
 }
 
+//------------------------------------------------------------------------------
+
+namespace detail {
+
+#if CASINOCOIN_SHA512_MULTI_BUFFER
+
+// Multi-buffer SHA-512: each 64-bit lane of a vector register holds
+// the state of a different message, so one pass of the compression
+// function processes a block of every message at once.
+
+static std::uint64_t const sha512K[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+    0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+    0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+    0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+    0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+    0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+    0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+    0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+    0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+    0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+    0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+    0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+    0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+    0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+    0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+    0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+    0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static std::uint64_t const sha512IV[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+    0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+    0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+// Load word t of each lane's block, converted from big endian
+template <int Lanes>
+static inline
+void
+loadWords (std::uint64_t (&w)[Lanes],
+    unsigned char const* const* blocks, int t)
+{
+    for (int l = 0; l < Lanes; ++l)
+    {
+        std::uint64_t x;
+        std::memcpy (&x, blocks[l] + 8 * t, 8);
+        w[l] = __builtin_bswap64 (x);
+    }
+}
+
+template <int n>
+__attribute__((target("avx2")))
+static inline
+__m256i
+ror4 (__m256i x)
+{
+    return _mm256_or_si256 (
+        _mm256_srli_epi64 (x, n), _mm256_slli_epi64 (x, 64 - n));
+}
+
+__attribute__((target("avx2")))
+static
+void
+compress4 (std::uint64_t (*state)[4], unsigned char const* const* blocks)
+{
+    __m256i w[16];
+    for (int t = 0; t < 16; ++t)
+    {
+        alignas(32) std::uint64_t x[4];
+        loadWords<4> (x, blocks, t);
+        w[t] = _mm256_load_si256 (reinterpret_cast<__m256i const*>(x));
+    }
+
+    __m256i v[8];
+    for (int i = 0; i < 8; ++i)
+        v[i] = _mm256_loadu_si256 (
+            reinterpret_cast<__m256i const*>(state[i]));
+    __m256i a = v[0], b = v[1], c = v[2], d = v[3];
+    __m256i e = v[4], f = v[5], g = v[6], h = v[7];
+
+    for (int t = 0; t < 80; ++t)
+    {
+        if (t >= 16)
+        {
+            auto const w15 = w[(t - 15) & 15];
+            auto const w2 = w[(t - 2) & 15];
+            auto const s0 = _mm256_xor_si256 (
+                _mm256_xor_si256 (ror4<1> (w15), ror4<8> (w15)),
+                _mm256_srli_epi64 (w15, 7));
+            auto const s1 = _mm256_xor_si256 (
+                _mm256_xor_si256 (ror4<19> (w2), ror4<61> (w2)),
+                _mm256_srli_epi64 (w2, 6));
+            w[t & 15] = _mm256_add_epi64 (
+                _mm256_add_epi64 (w[t & 15], s0),
+                _mm256_add_epi64 (w[(t - 7) & 15], s1));
+        }
+
+        auto const S1 = _mm256_xor_si256 (
+            _mm256_xor_si256 (ror4<14> (e), ror4<18> (e)), ror4<41> (e));
+        auto const ch = _mm256_xor_si256 (
+            _mm256_and_si256 (e, f), _mm256_andnot_si256 (e, g));
+        auto const t1 = _mm256_add_epi64 (
+            _mm256_add_epi64 (h, S1),
+            _mm256_add_epi64 (ch, _mm256_add_epi64 (
+                _mm256_set1_epi64x (sha512K[t]), w[t & 15])));
+        auto const S0 = _mm256_xor_si256 (
+            _mm256_xor_si256 (ror4<28> (a), ror4<34> (a)), ror4<39> (a));
+        auto const maj = _mm256_or_si256 (_mm256_and_si256 (a, b),
+            _mm256_and_si256 (c, _mm256_or_si256 (a, b)));
+
+        h = g;
+        g = f;
+        f = e;
+        e = _mm256_add_epi64 (d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm256_add_epi64 (t1, _mm256_add_epi64 (S0, maj));
+    }
+
+    __m256i const r[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; ++i)
+        _mm256_storeu_si256 (reinterpret_cast<__m256i*>(state[i]),
+            _mm256_add_epi64 (v[i], r[i]));
+}
+
+__attribute__((target("avx512f")))
+static
+void
+compress8 (std::uint64_t (*state)[8], unsigned char const* const* blocks)
+{
+    __m512i w[16];
+    for (int t = 0; t < 16; ++t)
+    {
+        alignas(64) std::uint64_t x[8];
+        loadWords<8> (x, blocks, t);
+        w[t] = _mm512_load_si512 (x);
+    }
+
+    __m512i v[8];
+    for (int i = 0; i < 8; ++i)
+        v[i] = _mm512_loadu_si512 (state[i]);
+    __m512i a = v[0], b = v[1], c = v[2], d = v[3];
+    __m512i e = v[4], f = v[5], g = v[6], h = v[7];
+
+    for (int t = 0; t < 80; ++t)
+    {
+        if (t >= 16)
+        {
+            auto const w15 = w[(t - 15) & 15];
+            auto const w2 = w[(t - 2) & 15];
+            auto const s0 = _mm512_ternarylogic_epi64 (
+                _mm512_ror_epi64 (w15, 1), _mm512_ror_epi64 (w15, 8),
+                _mm512_srli_epi64 (w15, 7), 0x96);
+            auto const s1 = _mm512_ternarylogic_epi64 (
+                _mm512_ror_epi64 (w2, 19), _mm512_ror_epi64 (w2, 61),
+                _mm512_srli_epi64 (w2, 6), 0x96);
+            w[t & 15] = _mm512_add_epi64 (
+                _mm512_add_epi64 (w[t & 15], s0),
+                _mm512_add_epi64 (w[(t - 7) & 15], s1));
+        }
+
+        // 0x96 is a ^ b ^ c, 0xca is a ? b : c, 0xe8 is the majority
+        auto const S1 = _mm512_ternarylogic_epi64 (_mm512_ror_epi64 (e, 14),
+            _mm512_ror_epi64 (e, 18), _mm512_ror_epi64 (e, 41), 0x96);
+        auto const ch = _mm512_ternarylogic_epi64 (e, f, g, 0xca);
+        auto const t1 = _mm512_add_epi64 (
+            _mm512_add_epi64 (h, S1),
+            _mm512_add_epi64 (ch, _mm512_add_epi64 (
+                _mm512_set1_epi64 (sha512K[t]), w[t & 15])));
+        auto const S0 = _mm512_ternarylogic_epi64 (_mm512_ror_epi64 (a, 28),
+            _mm512_ror_epi64 (a, 34), _mm512_ror_epi64 (a, 39), 0x96);
+        auto const maj = _mm512_ternarylogic_epi64 (a, b, c, 0xe8);
+
+        h = g;
+        g = f;
+        f = e;
+        e = _mm512_add_epi64 (d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = _mm512_add_epi64 (t1, _mm512_add_epi64 (S0, maj));
+    }
+
+    __m512i const r[8] = {a, b, c, d, e, f, g, h};
+    for (int i = 0; i < 8; ++i)
+        _mm512_storeu_si512 (state[i], _mm512_add_epi64 (v[i], r[i]));
+}
+
+// A message being hashed in one lane
+struct Sha512Lane
+{
+    unsigned char const* data;
+    std::size_t fullBlocks;
+    std::size_t blocks;
+    std::size_t next = 0;
+    std::size_t index;
+    bool active = false;
+
+    // The padded end of the message
+    unsigned char tail[256];
+
+    void
+    start (Slice const& message, std::size_t i)
+    {
+        auto const size = message.size ();
+        auto const rest = size % 128;
+
+        data = message.data ();
+        fullBlocks = size / 128;
+        auto const tailBlocks = (rest + 17 <= 128) ? 1 : 2;
+        blocks = fullBlocks + tailBlocks;
+        next = 0;
+        index = i;
+        active = true;
+
+        auto const tailSize = tailBlocks * 128;
+        std::memset (tail, 0, tailSize);
+        if (rest != 0)
+            std::memcpy (tail, data + fullBlocks * 128, rest);
+        tail[rest] = 0x80;
+
+        // The length in bits, as a 128-bit big endian number
+        std::uint64_t const bitsHigh = size >> 61;
+        std::uint64_t const bitsLow = size << 3;
+        for (int i = 0; i < 8; ++i)
+        {
+            tail[tailSize - 16 + i] = bitsHigh >> (56 - 8 * i);
+            tail[tailSize - 8 + i] = bitsLow >> (56 - 8 * i);
+        }
+    }
+
+    unsigned char const*
+    block () const
+    {
+        if (next < fullBlocks)
+            return data + next * 128;
+        return tail + (next - fullBlocks) * 128;
+    }
+};
+
+template <int Lanes, class Compress>
+static
+void
+sha512HalfLanes (Slice const* messages, uint256* digests,
+    std::size_t count, Compress compress)
+{
+    static unsigned char const idle[128] = {};
+
+    std::uint64_t state[8][Lanes];
+    Sha512Lane lanes[Lanes];
+    unsigned char const* blocks[Lanes];
+    std::size_t nextMessage = 0;
+
+    while (true)
+    {
+        bool busy = false;
+        for (int l = 0; l < Lanes; ++l)
+        {
+            auto& lane = lanes[l];
+            if (!lane.active && nextMessage < count)
+            {
+                lane.start (messages[nextMessage], nextMessage);
+                ++nextMessage;
+                for (int i = 0; i < 8; ++i)
+                    state[i][l] = sha512IV[i];
+            }
+            blocks[l] = lane.active ? lane.block () : idle;
+            busy = busy || lane.active;
+        }
+
+        if (!busy)
+            break;
+
+        compress (state, blocks);
+
+        for (int l = 0; l < Lanes; ++l)
+        {
+            auto& lane = lanes[l];
+            if (!lane.active || ++lane.next != lane.blocks)
+                continue;
+
+            // The first half of the digest, in big endian
+            auto out = digests[lane.index].begin ();
+            for (int i = 0; i < 4; ++i)
+            {
+                for (int j = 0; j < 8; ++j)
+                    *out++ = state[i][l] >> (56 - 8 * j);
+            }
+            lane.active = false;
+        }
+    }
+}
+
+#endif
+
+static
+void
+sha512HalfEach (Slice const* messages, uint256* digests, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        sha512_half_hasher h;
+        h (messages[i].data (), messages[i].size ());
+        digests[i] = static_cast<sha512_half_hasher::result_type>(h);
+    }
+}
+
+} // detail
+
+void
+sha512HalfBatch (Slice const* messages, uint256* digests,
+    std::size_t count)
+{
+#if CASINOCOIN_SHA512_MULTI_BUFFER
+    static int const lanes =
+        __builtin_cpu_supports ("avx512f") ? 8 :
+            __builtin_cpu_supports ("avx2") ? 4 : 1;
+
+    // A single message is hashed faster on its own
+    if (lanes == 8 && count > 4)
+        return detail::sha512HalfLanes<8> (
+            messages, digests, count, detail::compress8);
+    if (lanes >= 4 && count > 1)
+        return detail::sha512HalfLanes<4> (
+            messages, digests, count, detail::compress4);
+#endif
+    detail::sha512HalfEach (messages, digests, count);
+}
+
 } // casinocoin
@@ -28,6 +28,7 @@
 #include <BeastConfig.h>
 #include <casinocoin/protocol/tokens.h>
 #include <casinocoin/protocol/digest.h>
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <memory>
@@ -96,61 +97,84 @@ checksum (void* out,
 
 //------------------------------------------------------------------------------
 
-// Code from Bitcoin: https://github.com/bitcoin/bitcoin
-// Copyright (c) 2014 The Bitcoin Core developers
-// Distributed under the MIT software license, see the accompanying
-// file COPYING or http://www.opensource.org/licenses/mit-license.php.
-//
-// Modified from the original
-//
-// WARNING Do not call this directly, use
-//         encodeBase58Token instead since it
-//         calculates the size of buffer needed.
+// Base58 digits are produced and consumed five at a time. 58^5 fits in
+// 32 bits, so the number is held in 32-bit limbs and each step works
+// on a whole limb with 64-bit arithmetic instead of on a single byte.
+static std::uint64_t const base58Pow5 = 656356768; // 58^5
+
+// Limbs kept on the stack. This covers every token casinocoind makes:
+// account IDs expand to 25 bytes and public keys to 38.
+static std::size_t const fixedLimbs = 20;
+
+// Each leading zero byte becomes a leading zero digit
 static
 std::string
 encodeBase58(
     void const* message, std::size_t size,
-        void *temp, char const* const alphabet)
+        char const* const alphabet)
 {
     auto pbegin = reinterpret_cast<
         unsigned char const*>(message);
     auto const pend = pbegin + size;
     // Skip & count leading zeroes.
-    int zeroes = 0;
+    std::size_t zeroes = 0;
     while (pbegin != pend && *pbegin == 0)
     {
         pbegin++;
         zeroes++;
     }
-    auto const b58begin = reinterpret_cast<
-        unsigned char*>(temp);
-    // log(256) / log(58), rounded up.
-    auto const b58end = b58begin +
-        size * (138 / 100 + 1);
-    std::fill(b58begin, b58end, 0);
-    while (pbegin != pend)
+
+    // Load the rest as big endian limbs
+    std::size_t const bytes = pend - pbegin;
+    std::size_t const count = (bytes + 3) / 4;
+    std::uint32_t fixed[fixedLimbs];
+    std::vector<std::uint32_t> dynamic;
+    auto limbs = fixed;
+    if (count > fixedLimbs)
+    {
+        dynamic.resize (count);
+        limbs = dynamic.data ();
+    }
+    std::size_t lead = (bytes % 4 == 0) ? 4 : bytes % 4;
+    std::uint32_t limb = 0;
+    for (std::size_t i = 0; pbegin != pend; ++pbegin)
     {
-        int carry = *pbegin;
-        // Apply "b58 = b58 * 256 + ch".
-        for (auto iter = b58end; iter != b58begin; --iter)
+        limb = (limb << 8) | *pbegin;
+        if (--lead == 0)
         {
-            carry += 256 * (iter[-1]);
-            iter[-1] = carry % 58;
-            carry /= 58;
+            limbs[i++] = limb;
+            limb = 0;
+            lead = 4;
         }
-        assert(carry == 0);
-        pbegin++;
     }
-    // Skip leading zeroes in base58 result.
-    auto iter = b58begin;
-    while (iter != b58end && *iter == 0)
-        ++iter;
-    // Translate the result into a string.
+
+    // Divide by 58^5 until nothing is left, appending the
+    // digits least significant first.
     std::string str;
-    str.reserve(zeroes + (b58end - iter));
+    str.reserve(zeroes + (count + 1) * 7);
     str.assign(zeroes, alphabet[0]);
-    while (iter != b58end)
-        str += alphabet[*(iter++)];
+    std::size_t first = 0;
+    while (first != count)
+    {
+        std::uint64_t rem = 0;
+        for (auto i = first; i != count; ++i)
+        {
+            auto const cur = (rem << 32) | limbs[i];
+            limbs[i] = static_cast<std::uint32_t>(cur / base58Pow5);
+            rem = cur % base58Pow5;
+        }
+        while (first != count && limbs[first] == 0)
+            ++first;
+        for (int i = 0; i < 5; ++i)
+        {
+            str += alphabet[rem % 58];
+            rem /= 58;
+        }
+    }
+    // Skip leading zeroes in base58 result.
+    while (str.size () > zeroes && str.back () == alphabet[0])
+        str.pop_back ();
+    std::reverse (str.begin () + zeroes, str.end ());
     return str;
 }
 
@@ -159,18 +183,15 @@ std::string
 encodeToken (std::uint8_t type,
     void const* token, std::size_t size, bool btc)
 {
-    char buf[1024];
+    char buf[64];
     // expanded token includes type + checksum
     auto const expanded = 1 + size + 4;
-    // add scratch, log(256) / log(58), rounded up.
-    auto const needed = expanded +
-        size * (138 / 100 + 1);
     std::unique_ptr<
         char[]> pbuf;
     char* temp;
-    if (needed > sizeof(buf))
+    if (expanded > sizeof(buf))
     {
-        pbuf.reset(new char[needed]);
+        pbuf.reset(new char[expanded]);
         temp = pbuf.get();
     }
     else
@@ -183,7 +204,7 @@ encodeToken (std::uint8_t type,
     std::memcpy(temp + 1, token, size);
     checksum(temp + 1 + size, temp, 1 + size);
     return encodeBase58(temp, expanded,
-        temp + expanded, btc ? bitcoinAlphabet : casinocoinAlphabet);
+        btc ? bitcoinAlphabet : casinocoinAlphabet);
 }
 
 std::string
@@ -202,12 +223,6 @@ base58EncodeTokenBitcoin (std::uint8_t type,
 
 //------------------------------------------------------------------------------
 
-// Code from Bitcoin: https://github.com/bitcoin/bitcoin
-// Copyright (c) 2014 The Bitcoin Core developers
-// Distributed under the MIT software license, see the accompanying
-// file COPYING or http://www.opensource.org/licenses/mit-license.php.
-//
-// Modified from the original
 template <class InverseArray>
 static
 std::string
@@ -224,36 +239,67 @@ decodeBase58 (std::string const& s,
         ++psz;
         --remain;
     }
-    // Allocate enough space in big-endian base256 representation.
-    // log(58) / log(256), rounded up.
-    std::vector<unsigned char> b256(
-        remain * 733 / 1000 + 1);
+
+    // Enough little endian limbs for the result.
+    // log(58) / log(2^32), rounded up.
+    std::size_t const capacity = remain * 1465 / 8000 + 1;
+    std::uint32_t fixed[fixedLimbs];
+    std::vector<std::uint32_t> dynamic;
+    auto limbs = fixed;
+    if (capacity > fixedLimbs)
+    {
+        dynamic.resize (capacity);
+        limbs = dynamic.data ();
+    }
+    std::size_t count = 0;
+
+    // Take the digits five at a time, any odd ones first.
+    // Apply "limbs = limbs * 58^n + chunk".
+    auto chunk = (remain % 5 == 0) ? 5 : remain % 5;
     while (remain > 0)
     {
-        auto carry = inv[*psz];
-        if (carry == -1)
-            return {};
-        // Apply "b256 = b256 * 58 + carry".
-        for (auto iter = b256.rbegin();
-            iter != b256.rend(); ++iter)
+        std::uint64_t carry = 0;
+        std::uint64_t scale = 1;
+        for (; chunk != 0; --chunk)
         {
-            carry += 58 * *iter;
-            *iter = carry % 256;
-            carry /= 256;
+            auto const digit = inv[*psz];
+            if (digit == -1)
+                return {};
+            carry = carry * 58 + digit;
+            scale *= 58;
+            ++psz;
+            --remain;
         }
-        assert(carry == 0);
-        ++psz;
-        --remain;
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            carry += scale * limbs[i];
+            limbs[i] = static_cast<std::uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0)
+        {
+            assert (count < capacity);
+            limbs[count++] = static_cast<std::uint32_t>(carry);
+        }
+        chunk = 5;
     }
-    // Skip leading zeroes in b256.
-    auto iter = std::find_if(
-        b256.begin(), b256.end(),[](unsigned char c)
-            { return c != 0; });
+
+    // Write the limbs out big endian, skipping leading zeroes
     std::string result;
-    result.reserve (zeroes + (b256.end() - iter));
+    result.reserve (zeroes + 4 * count);
     result.assign (zeroes, 0x00);
-    while (iter != b256.end())
-        result.push_back(*(iter++));
+    bool leading = true;
+    for (auto i = count; i != 0; --i)
+    {
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            auto const c = static_cast<char>(limbs[i - 1] >> shift);
+            if (leading && c == 0)
+                continue;
+            leading = false;
+            result.push_back (c);
+        }
+    }
     return result;
 }
 
@@ -33,6 +33,7 @@
 
 #include <casinocoin/beast/utility/Journal.h>
 #include <casinocoin/beast/net/IPEndpoint.h>
+#include <chrono>
 
 namespace casinocoin {
 
@@ -66,6 +67,9 @@ struct Context
     std::shared_ptr<JobQueue::Coro> coro;
     InfoSub::pointer infoSub;
     Headers headers;
+
+    /** When the request was received, if known. */
+    std::chrono::steady_clock::time_point received {};
 };
 
 } // RPC
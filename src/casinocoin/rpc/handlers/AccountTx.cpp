@@ -74,7 +74,7 @@ Json::Value doAccountTx (RPC::Context& context)
     if (!params.isMember (jss::account))
         return rpcError (rpcINVALID_PARAMS);
 
-    auto const account = parseBase58<AccountID>(
+    auto const account = context.app.accountIDCache().fromBase58(
         params[jss::account].asString());
     if (! account)
         return rpcError (rpcACT_MALFORMED);
@@ -71,7 +71,7 @@ Json::Value doAccountTxOld (RPC::Context& context)
     if (!context.params.isMember (jss::account))
         return rpcError (rpcINVALID_PARAMS);
 
-    auto const raAccount = parseBase58<AccountID>(
+    auto const raAccount = context.app.accountIDCache().fromBase58(
         context.params[jss::account].asString());
     if (! raAccount)
         return rpcError (rpcACT_MALFORMED);
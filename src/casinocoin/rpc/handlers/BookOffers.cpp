@@ -165,7 +165,7 @@ Json::Value doBookOffers (RPC::Context& context)
         if (! context.params [jss::taker].isString ())
             return RPC::expected_field_error (jss::taker, "string");
 
-        takerID = parseBase58<AccountID>(
+        takerID = context.app.accountIDCache().fromBase58(
             context.params [jss::taker].asString());
         if (! takerID)
             return RPC::invalid_field_error (jss::taker);
@@ -29,6 +29,7 @@
 #include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/NetworkOPs.h>
+#include <casinocoin/basics/ProfiledMutex.h>
 #include <casinocoin/basics/UptimeTimer.h>
 #include <casinocoin/core/DatabaseCon.h>
 #include <casinocoin/json/json_value.h>
@@ -37,6 +38,7 @@
 #include <casinocoin/nodestore/Database.h>
 #include <casinocoin/protocol/ErrorCodes.h>
 #include <casinocoin/protocol/JsonFields.h>
+#include <casinocoin/protocol/SignatureCache.h>
 #include <casinocoin/rpc/Context.h>
 
 namespace casinocoin {
@@ -111,6 +113,9 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::node_hit_rate] = context.app.getNodeStore ().getCacheHitRate ();
     ret[jss::ledger_hit_rate] = context.app.getLedgerMaster ().getCacheHitRate ();
     ret[jss::AL_hit_rate] = context.app.getAcceptedLedgerCache ().getHitRate ();
+    ret[jss::signature_hit_rate] = SignatureCache::instance ().getHitRate ();
+    ret[jss::signature_cache_size] = static_cast<Json::UInt> (
+        SignatureCache::instance ().size ());
 
     ret[jss::fullbelow_size] = static_cast<int>(context.app.family().fullbelow().size());
     ret[jss::treenode_cache_size] = context.app.family().treecache().getCacheSize();
@@ -131,6 +136,43 @@ Json::Value doGetCounts (RPC::Context& context)
     ret[jss::node_written_bytes] = context.app.getNodeStore().getStoreSize();
     ret[jss::node_read_bytes] = context.app.getNodeStore().getFetchSize();
 
+    // Asynchronous read latency histograms. Entry i counts the
+    // reads that took less than 2^i ms, the last one the rest.
+    auto readLatency = [&](NodeStore::FetchPriority priority)
+    {
+        Json::Value counts (Json::arrayValue);
+        for (auto const c :
+                context.app.getNodeStore().getReadLatency (priority))
+            counts.append (static_cast<Json::UInt> (c));
+        return counts;
+    };
+    ret[jss::node_read_latency_high] =
+        readLatency (NodeStore::FetchPriority::high);
+    ret[jss::node_read_latency_low] =
+        readLatency (NodeStore::FetchPriority::low);
+
+#if CASINOCOIN_PROFILE_LOCKS
+    // Waits are only counted when the lock was contended
+    {
+        auto toUs = [](std::uint64_t ns)
+        {
+            return std::to_string (ns / 1000);
+        };
+        Json::Value locks (Json::objectValue);
+        for (auto const& s : getLockStats ())
+        {
+            Json::Value& lock = locks[s.name];
+            lock[jss::acquired] = std::to_string (s.acquired);
+            lock[jss::contended] = std::to_string (s.contended);
+            lock[jss::wait_us] = toUs (s.waitTotal);
+            lock[jss::wait_max_us] = toUs (s.waitMax);
+            lock[jss::hold_us] = toUs (s.holdTotal);
+            lock[jss::hold_max_us] = toUs (s.holdMax);
+        }
+        ret[jss::locks] = locks;
+    }
+#endif
+
     return ret;
 }
 
@@ -139,6 +139,7 @@ Handler handlerArray[] {
     {   "noCasinocoin_check",   byRef (&doNoCasinocoinCheck),   Role::USER,  NO_CONDITION               },
     {   "owner_info",           byRef (&doOwnerInfo),           Role::USER,  NEEDS_CURRENT_LEDGER       },
     {   "peers",                byRef (&doPeers),               Role::ADMIN, NO_CONDITION               },
+    {   "perf",                 byRef (&doPerf),                Role::ADMIN, NO_CONDITION               },
     {   "path_find",            byRef (&doPathFind),            Role::USER,  NEEDS_CURRENT_LEDGER       },
     {   "ping",                 byRef (&doPing),                Role::USER,  NO_CONDITION               },
     {   "print",                byRef (&doPrint),               Role::ADMIN, NO_CONDITION               },
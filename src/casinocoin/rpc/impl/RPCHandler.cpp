@@ -35,6 +35,7 @@
 #include <casinocoin/basics/Log.h>
 #include <casinocoin/core/Config.h>
 #include <casinocoin/core/JobQueue.h>
+#include <casinocoin/core/PerfLog.h>
 #include <casinocoin/json/Object.h>
 #include <casinocoin/json/to_string.h>
 #include <casinocoin/net/InfoSub.h>
@@ -215,6 +216,18 @@ Status callMethod (
     }
 }
 
+void recordCommand (Context& context, std::string const& name,
+    std::chrono::steady_clock::time_point start, bool failed)
+{
+    using namespace std::chrono;
+    auto const now = steady_clock::now ();
+    auto const queued = context.received == steady_clock::time_point{}
+        ? microseconds{0}
+        : duration_cast<microseconds> (start - context.received);
+    context.app.getPerfLog ().rpcFinish (name, queued,
+        duration_cast<microseconds> (now - start), failed);
+}
+
 template <class Method, class Object>
 void getResult (
     Context& context, Method method, Object& object, std::string const& name)
@@ -246,6 +259,9 @@ Status doCommand (
 
     if (auto method = handler->valueMethod_)
     {
+        auto const start = std::chrono::steady_clock::now ();
+        Status ret;
+
         if (! context.headers.user.empty() ||
             ! context.headers.forwardedFor.empty())
         {
@@ -253,18 +269,20 @@ Status doCommand (
                 ", X-User: " << context.headers.user << ", X-Forwarded-For: " <<
                     context.headers.forwardedFor;
 
-            auto ret = callMethod (context, method, handler->name_, result);
+            ret = callMethod (context, method, handler->name_, result);
 
             JLOG(context.j.debug()) << "finish command: " << handler->name_ <<
                 ", X-User: " << context.headers.user << ", X-Forwarded-For: " <<
                     context.headers.forwardedFor;
-
-            return ret;
         }
         else
         {
-            return callMethod (context, method, handler->name_, result);
+            ret = callMethod (context, method, handler->name_, result);
         }
+
+        recordCommand (context, handler->name_, start,
+            ret || result.isMember (jss::error));
+        return ret;
     }
 
     return rpcUNKNOWN_COMMAND;
@@ -326,9 +326,11 @@ ServerHandlerImp::onRequest (Session& session)
     }
 
     m_jobQueue.postCoro(jtCLIENT, "RPC-Client",
-        [this, detach = session.detach()](std::shared_ptr<JobQueue::Coro> c)
+        [this, detach = session.detach(),
+            received = std::chrono::steady_clock::now()](
+                std::shared_ptr<JobQueue::Coro> c)
         {
-            processSession(detach, c);
+            processSession(detach, c, received);
         });
 }
 
@@ -367,11 +369,11 @@ ServerHandlerImp::onWSMessage(
         << "Websocket received '" << jv << "'";
 
     m_jobQueue.postCoro(jtCLIENT, "WS-Client",
-        [this, session = std::move(session),
-            jv = std::move(jv)](auto const& c)
+        [this, session = std::move(session), jv = std::move(jv),
+            received = std::chrono::steady_clock::now()](auto const& c)
         {
             auto const jr =
-                this->processSession(session, c, jv);
+                this->processSession(session, c, jv, received);
             auto const s = to_string(jr);
             auto const n = s.length();
             beast::streambuf sb(n);
@@ -403,7 +405,8 @@ Json::Value
 ServerHandlerImp::processSession(
     std::shared_ptr<WSSession> const& session,
         std::shared_ptr<JobQueue::Coro> const& coro,
-            Json::Value const& jv)
+            Json::Value const& jv,
+                std::chrono::steady_clock::time_point received)
 {
     auto is = std::static_pointer_cast<WSInfoSub> (session->appDefined);
     if (is->getConsumer().disconnect())
@@ -464,7 +467,8 @@ ServerHandlerImp::processSession(
             role,
             coro,
             is,
-            {is->user(), is->forwarded_for()}
+            {is->user(), is->forwarded_for()},
+            received
             };
         RPC::doCommand(context, jr[jss::result]);
     }
@@ -508,7 +512,8 @@ ServerHandlerImp::processSession(
 // Run as a coroutine.
 void
 ServerHandlerImp::processSession (std::shared_ptr<Session> const& session,
-    std::shared_ptr<JobQueue::Coro> coro)
+    std::shared_ptr<JobQueue::Coro> coro,
+        std::chrono::steady_clock::time_point received)
 {
     processRequest (
         session->port(), buffers_to_string(
@@ -532,7 +537,8 @@ ServerHandlerImp::processSession (std::shared_ptr<Session> const& session,
             if(iter != session->request().fields.end())
                 return iter->second;
             return std::string{};
-        }());
+        }(),
+        received);
 
     if(is_keep_alive(session->request()))
         session->complete();
@@ -544,7 +550,8 @@ void
 ServerHandlerImp::processRequest (Port const& port,
     std::string const& request, beast::IP::Endpoint const& remoteIPAddress,
         Output&& output, std::shared_ptr<JobQueue::Coro> coro,
-        std::string forwardedFor, std::string user)
+        std::string forwardedFor, std::string user,
+        std::chrono::steady_clock::time_point received)
 {
     auto rpcJ = app_.journal ("RPC");
 
@@ -687,7 +694,8 @@ ServerHandlerImp::processRequest (Port const& port,
         role,
         coro,
         InfoSub::pointer(),
-        {user, forwardedFor}
+        {user, forwardedFor},
+        received
     };
     Json::Value result;
     RPC::doCommand (context, result);
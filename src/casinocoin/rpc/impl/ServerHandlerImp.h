@@ -159,17 +159,20 @@ private:
     processSession(
         std::shared_ptr<WSSession> const& session,
             std::shared_ptr<JobQueue::Coro> const& coro,
-                Json::Value const& jv);
+                Json::Value const& jv,
+                    std::chrono::steady_clock::time_point received);
 
     void
     processSession (std::shared_ptr<Session> const&,
-        std::shared_ptr<JobQueue::Coro> coro);
+        std::shared_ptr<JobQueue::Coro> coro,
+            std::chrono::steady_clock::time_point received);
 
     void
     processRequest (Port const& port, std::string const& request,
         beast::IP::Endpoint const& remoteIPAddress, Output&&,
         std::shared_ptr<JobQueue::Coro> coro,
-        std::string forwardedFor, std::string user);
+        std::string forwardedFor, std::string user,
+        std::chrono::steady_clock::time_point received);
 
     Handoff
     statusResponse(http_request_type const& request) const;
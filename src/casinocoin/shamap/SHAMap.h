@@ -42,6 +42,7 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/shared_lock_guard.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <atomic>
 #include <cassert>
 #include <stack>
 #include <vector>
@@ -184,6 +185,13 @@ public:
     const_iterator upper_bound(uint256 const& id) const;
 
     void visitNodes (std::function<bool (SHAMapAbstractNode&)> const&) const;
+
+    /** Visit the nodes held in memory, parents before their children.
+        Nodes that are not resident are skipped rather than fetched.
+        The visit stops when the function returns true.
+    */
+    void visitResidentNodes (
+        std::function<bool (SHAMapAbstractNode&)> const&) const;
     void
         visitLeaves(
             std::function<void(std::shared_ptr<SHAMapItem const> const&)> const&) const;
@@ -198,10 +206,12 @@ public:
 
         @param maxNodes The maximum number of found nodes to return
         @param filter The filter to use when retrieving nodes
+        @param priority The priority of the node store reads
         @param return The nodes known to be missing
     */
     std::vector<std::pair<SHAMapNodeID, uint256>>
-    getMissingNodes (int maxNodes, SHAMapSyncFilter *filter);
+    getMissingNodes (int maxNodes, SHAMapSyncFilter *filter,
+        NodeStore::FetchPriority priority = NodeStore::FetchPriority::high);
 
     bool getNodeFat (SHAMapNodeID node,
         std::vector<SHAMapNodeID>& nodeIDs,
@@ -209,11 +219,18 @@ public:
                 bool fatLeaves, std::uint32_t depth) const;
 
     bool getRootNode (Serializer & s, SHANodeFormat format) const;
-    std::vector<uint256> getNeededHashes (int max, SHAMapSyncFilter * filter);
+    std::vector<uint256> getNeededHashes (int max, SHAMapSyncFilter * filter,
+        NodeStore::FetchPriority priority = NodeStore::FetchPriority::high);
     SHAMapAddNode addRootNode (SHAMapHash const& hash, Slice const& rootNode,
                                SHANodeFormat format, SHAMapSyncFilter * filter);
     SHAMapAddNode addKnownNode (SHAMapNodeID const& nodeID, Slice const& rawNode,
                                 SHAMapSyncFilter * filter);
+    /** Add a node already parsed from wire format, or null if the
+        received data couldn't be parsed.
+    */
+    SHAMapAddNode addKnownNode (SHAMapNodeID const& nodeID,
+                                std::shared_ptr<SHAMapAbstractNode> node,
+                                SHAMapSyncFilter * filter);
 
 
     // status functions
@@ -229,7 +246,24 @@ public:
                   Delta& differences, int maxCount) const;
 
     int flushDirty (NodeObjectType t, std::uint32_t seq);
-    void walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
+
+    /** Like flushDirty, but collect the node objects in `batch` instead
+        of storing them. The caller must store the batch before the
+        nodes can be fetched from the node store by hash.
+    */
+    int flushDirty (NodeObjectType t, std::uint32_t seq,
+                    NodeStore::Batch& batch);
+
+    /** Find the nodes missing from this map.
+
+        The subtrees below the top levels of the map are shared among
+        `threads` threads. The children of each inner node are read
+        from the node store together, by its read threads.
+
+        @param maxMissing The walk stops after this many missing nodes
+    */
+    void walkMap (std::vector<SHAMapMissingNode>& missingNodes,
+        int maxMissing, int threads = 1) const;
     bool deepCompare (SHAMap & other) const;  // Intended for debug/test only
 
     using fetchPackEntry_t = std::pair <uint256, Blob>;
@@ -237,6 +271,18 @@ public:
     void getFetchPack (SHAMap const* have, bool includeLeaves, int max,
         std::function<void (SHAMapHash const&, const Blob&)>) const;
 
+    /** Visit every node in this map that is not in `have`.
+
+        The subtrees below the root are shared among `threads` threads,
+        so `func` may be called concurrently. The walk stops once any
+        call to `func` returns false.
+
+        @return false if the walk was stopped early.
+    */
+    bool visitDifferences (SHAMap const* have,
+        std::function<bool (SHAMapAbstractNode&)> const& func,
+            int threads) const;
+
     void setUnbacked ();
     bool is_v2() const;
     version get_version() const;
@@ -254,6 +300,20 @@ private:
                                std::shared_ptr<SHAMapItem const> const&>;
 
     void visitDifferences(SHAMap const* have, std::function<bool(SHAMapAbstractNode&)>) const;
+    bool walkDifferences (SHAMap const* have,
+        std::function<bool (SHAMapAbstractNode&)> const& func,
+            SHAMapInnerNode* top, SHAMapNodeID const& topID) const;
+
+    using InnerNodes = std::vector<std::shared_ptr<SHAMapInnerNode>>;
+
+    // walkMap helpers. They return false once `budget` missing
+    // nodes have been found, by this thread or another.
+    bool walkChildren (SHAMapInnerNode& node, InnerNodes& inner,
+        std::vector<SHAMapMissingNode>& missingNodes,
+            std::atomic<int>& budget) const;
+    bool walkSubtrees (InnerNodes stack,
+        std::vector<SHAMapMissingNode>& missingNodes,
+            std::atomic<int>& budget) const;
 
      // tree node cache operations
     std::shared_ptr<SHAMapAbstractNode> getCache (SHAMapHash const& hash) const;
@@ -294,7 +354,11 @@ private:
     /** write and canonicalize modified node */
     std::shared_ptr<SHAMapAbstractNode>
         writeNode(NodeObjectType t, std::uint32_t seq,
-                  std::shared_ptr<SHAMapAbstractNode> node) const;
+                  std::shared_ptr<SHAMapAbstractNode> node,
+                  NodeStore::Batch* batch) const;
+
+    /** unshare the modified nodes below an inner node and hash them */
+    void hashDirty (std::shared_ptr<SHAMapInnerNode> const& node);
 
     SHAMapTreeNode* firstBelow (std::shared_ptr<SHAMapAbstractNode>,
                                 SharedPtrNodeStack& stack, int branch = 0) const;
@@ -308,7 +372,8 @@ private:
 
     // Descend with filter
     SHAMapAbstractNode* descendAsync (SHAMapInnerNode* parent, int branch,
-        SHAMapSyncFilter* filter, bool& pending) const;
+        SHAMapSyncFilter* filter, NodeStore::FetchPriority priority,
+        bool& pending) const;
 
     std::pair <SHAMapAbstractNode*, SHAMapNodeID>
         descend (SHAMapInnerNode* parent, SHAMapNodeID const& parentID,
@@ -330,7 +395,8 @@ private:
     bool walkBranch (SHAMapAbstractNode* node,
                      std::shared_ptr<SHAMapItem const> const& otherMapItem,
                      bool isFirstMap, Delta & differences, int & maxCount) const;
-    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq);
+    int walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+                     NodeStore::Batch* batch = nullptr);
     bool isInconsistentNode(std::shared_ptr<SHAMapAbstractNode> const& node) const;
 
     // Structure to track information about call to
@@ -344,6 +410,7 @@ private:
         // basic parameters
         int               max_;
         SHAMapSyncFilter* filter_;
+        NodeStore::FetchPriority const priority_;
         int const         maxDefer_;
         std::uint32_t     generation_;
 
@@ -368,8 +435,9 @@ private:
 
         MissingNodes (
             int max, SHAMapSyncFilter* filter,
+            NodeStore::FetchPriority priority,
             int maxDefer, std::uint32_t generation) :
-                max_(max), filter_(filter),
+                max_(max), filter_(filter), priority_(priority),
                 maxDefer_(maxDefer), generation_(generation)
         {
             missingNodes_.reserve (max);
@@ -64,6 +64,11 @@ public:
     {
     }
 
+    SHAMapHash const& getNodeHash () const
+    {
+        return mNodeHash;
+    }
+
     friend std::ostream& operator<< (std::ostream&, SHAMapMissingNode const&);
 };
 
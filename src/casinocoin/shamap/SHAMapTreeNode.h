@@ -35,6 +35,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace casinocoin {
 
@@ -142,6 +143,24 @@ public:
              SHAMapHash const& hash, bool hashValid, beast::Journal j,
              SHAMapNodeID const& id = SHAMapNodeID{});
 
+    /** Parse many nodes received in wire format.
+
+        The hashes of the nodes are computed together, which is faster
+        than making each node on its own. A node that can't be parsed
+        is returned as null.
+    */
+    static std::vector<std::shared_ptr<SHAMapAbstractNode>>
+        make(std::vector<Blob> const& rawNodes,
+             std::vector<SHAMapNodeID> const& ids, std::uint32_t seq,
+             beast::Journal j);
+
+    /** Recompute the hashes of many nodes at once.
+
+        An inner node takes the hashes of its children first, so
+        children must come before their parents.
+    */
+    static void updateHashes (std::vector<SHAMapAbstractNode*> const& nodes);
+
     // debugging
 #ifdef BEAST_DEBUG
     static void dump (SHAMapNodeID const&, beast::Journal journal);
@@ -180,6 +199,7 @@ public:
     void setFullBelowGen (std::uint32_t gen);
 
     bool updateHash () override;
+    void updateChildHashes();
     void updateHashDeep();
     void addRaw (Serializer&, SHANodeFormat format) const override;
     std::string getString (SHAMapNodeID const&) const override;
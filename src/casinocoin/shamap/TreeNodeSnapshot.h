@@ -0,0 +1,68 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#ifndef CASINOCOIN_SHAMAP_TREENODESNAPSHOT_H_INCLUDED
+#define CASINOCOIN_SHAMAP_TREENODESNAPSHOT_H_INCLUDED
+
+#include <casinocoin/shamap/Family.h>
+#include <casinocoin/shamap/SHAMap.h>
+#include <casinocoin/beast/utility/Journal.h>
+#include <boost/filesystem.hpp>
+#include <memory>
+#include <vector>
+
+namespace casinocoin {
+
+/** The nodes of a map read back from a snapshot file. */
+struct TreeNodeSnapshot
+{
+    std::uint32_t seq = 0;
+    SHAMapHash root;
+
+    // Holding the nodes keeps them in the tree node cache
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> nodes;
+};
+
+/** Write the nodes of a map that are held in memory to a file.
+
+    Nodes are written parents first, so the inner nodes and the
+    recently used leaves survive a restart. At most maxNodes are
+    written. Throws on failure.
+*/
+void
+saveTreeNodeSnapshot (boost::filesystem::path const& path,
+    SHAMap const& map, std::uint32_t seq, std::size_t maxNodes);
+
+/** Read back the nodes written by saveTreeNodeSnapshot.
+
+    Every node is rehashed and must be a child of a node read
+    before it, starting from the stored root hash, so a stale or
+    damaged file contributes nothing. The nodes are added to the
+    family's tree node cache.
+
+    @return The nodes, or an empty snapshot if the file was
+            missing or invalid.
+*/
+TreeNodeSnapshot
+loadTreeNodeSnapshot (boost::filesystem::path const& path,
+    Family& family, beast::Journal j);
+
+} // casinocoin
+
+#endif
@@ -469,7 +469,8 @@ SHAMap::descend (SHAMapInnerNode * parent, SHAMapNodeID const& parentID,
 
 SHAMapAbstractNode*
 SHAMap::descendAsync (SHAMapInnerNode* parent, int branch,
-    SHAMapSyncFilter * filter, bool & pending) const
+    SHAMapSyncFilter * filter, NodeStore::FetchPriority priority,
+    bool & pending) const
 {
     pending = false;
 
@@ -488,7 +489,7 @@ SHAMap::descendAsync (SHAMapInnerNode* parent, int branch,
         if (!ptr && backed_)
         {
             std::shared_ptr<NodeObject> obj;
-            if (! f_.db().asyncFetch (hash.as_uint256(), obj))
+            if (! f_.db().asyncFetch (hash.as_uint256(), obj, priority))
             {
                 pending = true;
                 return nullptr;
@@ -1112,7 +1113,8 @@ bool SHAMap::fetchRoot (SHAMapHash const& hash, SHAMapSyncFilter* filter)
 // a mutable snapshot of a mutable SHAMap.
 std::shared_ptr<SHAMapAbstractNode>
 SHAMap::writeNode (
-    NodeObjectType t, std::uint32_t seq, std::shared_ptr<SHAMapAbstractNode> node) const
+    NodeObjectType t, std::uint32_t seq, std::shared_ptr<SHAMapAbstractNode> node,
+    NodeStore::Batch* batch) const
 {
     // Node is ours, so we can just make it shareable
     assert (node->getSeq() == seq_);
@@ -1123,8 +1125,12 @@ SHAMap::writeNode (
 
     Serializer s;
     node->addRaw (s, snfPREFIX);
-    f_.db().store (t,
-        std::move (s.modData ()), node->getNodeHash ().as_uint256());
+    if (batch)
+        batch->push_back (NodeObject::createObject (t,
+            std::move (s.modData ()), node->getNodeHash ().as_uint256()));
+    else
+        f_.db().store (t,
+            std::move (s.modData ()), node->getNodeHash ().as_uint256());
     return node;
 }
 
@@ -1148,6 +1154,56 @@ SHAMap::preFlushNode (std::shared_ptr<Node> node) const
     return node;
 }
 
+void
+SHAMap::hashDirty (std::shared_ptr<SHAMapInnerNode> const& node)
+{
+    // Modified nodes by depth. Leaves can be hashed in any order but
+    // an inner node needs the hashes of its children first.
+    std::vector<SHAMapAbstractNode*> leaves;
+    std::vector<std::vector<SHAMapAbstractNode*>> inners (1);
+    inners[0].push_back (node.get ());
+
+    std::stack <std::pair <SHAMapInnerNode*, std::size_t>> stack;
+    stack.emplace (node.get (), 0);
+    while (! stack.empty ())
+    {
+        auto const parent = stack.top ().first;
+        auto const depth = stack.top ().second + 1;
+        stack.pop ();
+
+        for (int branch = 0; branch < 16; ++branch)
+        {
+            if (parent->isEmptyBranch (branch))
+                continue;
+
+            // No need to do I/O. If the node isn't linked,
+            // it can't need to be flushed
+            auto child = parent->getChild (branch);
+            if (! child || child->getSeq () == 0)
+                continue;
+
+            child = preFlushNode (std::move (child));
+            parent->shareChild (branch, child);
+            if (child->isInner ())
+            {
+                if (inners.size () <= depth)
+                    inners.resize (depth + 1);
+                inners[depth].push_back (child.get ());
+                stack.emplace (
+                    static_cast<SHAMapInnerNode*>(child.get ()), depth);
+            }
+            else
+            {
+                leaves.push_back (child.get ());
+            }
+        }
+    }
+
+    SHAMapAbstractNode::updateHashes (leaves);
+    for (auto it = inners.rbegin (); it != inners.rend (); ++it)
+        SHAMapAbstractNode::updateHashes (*it);
+}
+
 int SHAMap::unshare ()
 {
     // Don't share nodes wth parent map
@@ -1161,8 +1217,15 @@ int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq)
     return walkSubTree (true, t, seq);
 }
 
+int SHAMap::flushDirty (NodeObjectType t, std::uint32_t seq,
+    NodeStore::Batch& batch)
+{
+    return walkSubTree (true, t, seq, &batch);
+}
+
 int
-SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
+SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq,
+    NodeStore::Batch* batch)
 {
     int flushed = 0;
     Serializer s;
@@ -1175,7 +1238,7 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
         root_ = preFlushNode (std::move(root_));
         root_->updateHash();
         if (doWrite && backed_)
-            root_ = writeNode(t, seq, std::move(root_));
+            root_ = writeNode(t, seq, std::move(root_), batch);
         else
             root_->setSeq (0);
         return 1;
@@ -1199,6 +1262,9 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
 
     node = preFlushNode(std::move(node));
 
+    // Hash everything that will be flushed in a few large batches
+    hashDirty (node);
+
     int pos = 0;
 
     // We can't flush an inner node until we flush its children
@@ -1238,10 +1304,9 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
                         ++flushed;
 
                         assert (node->getSeq() == seq_);
-                        child->updateHash();
 
                         if (doWrite && backed_)
-                            child = writeNode(t, seq, std::move(child));
+                            child = writeNode(t, seq, std::move(child), batch);
                         else
                             child->setSeq (0);
 
@@ -1251,13 +1316,10 @@ SHAMap::walkSubTree (bool doWrite, NodeObjectType t, std::uint32_t seq)
             }
         }
 
-        // update the hash of this inner node
-        node->updateHashDeep();
-
         // This inner node can now be shared
         if (doWrite && backed_)
             node = std::static_pointer_cast<SHAMapInnerNode>(writeNode(t, seq,
-                                                                       std::move(node)));
+                                                                       std::move(node), batch));
         else
             node->setSeq (0);
 
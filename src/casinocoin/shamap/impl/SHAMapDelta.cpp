@@ -26,6 +26,10 @@
 #include <BeastConfig.h>
 #include <casinocoin/basics/contract.h>
 #include <casinocoin/shamap/SHAMap.h>
+#include <casinocoin/nodestore/Database.h>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace casinocoin {
 
@@ -233,42 +237,148 @@ SHAMap::compare (SHAMap const& otherMap,
     return true;
 }
 
-void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const
+bool SHAMap::walkChildren (SHAMapInnerNode& node, InnerNodes& inner,
+    std::vector<SHAMapMissingNode>& missingNodes,
+        std::atomic<int>& budget) const
+{
+    if (budget <= 0)
+        return false;
+
+    // Post the reads of all the children first, so the node
+    // store reads them in parallel while they are walked.
+    if (backed_)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            if (node.isEmptyBranch (i) || node.getChildPointer (i))
+                continue;
+
+            auto const& hash = node.getChildHash (i);
+            if (!getCache (hash))
+            {
+                std::shared_ptr<NodeObject> obj;
+                f_.db().asyncFetch (hash.as_uint256(), obj,
+                    NodeStore::FetchPriority::low);
+            }
+        }
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        if (node.isEmptyBranch (i))
+            continue;
+
+        auto next = node.getChild (i);
+        if (!next && backed_)
+            next = fetchNodeNT (node.getChildHash (i));
+
+        if (!next)
+        {
+            missingNodes.emplace_back (type_, node.getChildHash (i));
+            if (--budget <= 0)
+                return false;
+        }
+        else if (next->isInner ())
+        {
+            inner.push_back (std::static_pointer_cast<SHAMapInnerNode>(next));
+        }
+    }
+    return true;
+}
+
+bool SHAMap::walkSubtrees (InnerNodes stack,
+    std::vector<SHAMapMissingNode>& missingNodes,
+        std::atomic<int>& budget) const
+{
+    while (!stack.empty ())
+    {
+        auto node = std::move (stack.back ());
+        stack.pop_back ();
+
+        if (!walkChildren (*node, stack, missingNodes, budget))
+            return false;
+    }
+    return true;
+}
+
+void SHAMap::walkMap (std::vector<SHAMapMissingNode>& missingNodes,
+    int maxMissing, int threads) const
 {
     if (!root_->isInner ())  // root_ is only node, and we have it
         return;
 
-    using StackEntry = std::shared_ptr<SHAMapInnerNode>;
-    std::stack <StackEntry, std::vector <StackEntry>> nodeStack;
+    std::atomic<int> budget {maxMissing};
+    InnerNodes subtrees {std::static_pointer_cast<SHAMapInnerNode>(root_)};
 
-    nodeStack.push (std::static_pointer_cast<SHAMapInnerNode>(root_));
-
-    while (!nodeStack.empty ())
+    if (threads <= 1)
     {
-        std::shared_ptr<SHAMapInnerNode> node = std::move (nodeStack.top());
-        nodeStack.pop ();
+        walkSubtrees (std::move (subtrees), missingNodes, budget);
+        return;
+    }
 
-        for (int i = 0; i < 16; ++i)
+    // Walk the top levels here until there are enough subtrees
+    // to keep the threads busy when some are much larger than
+    // others.
+    std::vector<SHAMapMissingNode> found;
+    for (int depth = 0; depth < 3 && !subtrees.empty () &&
+        subtrees.size () < 4 * threads; ++depth)
+    {
+        InnerNodes next;
+        for (auto const& node : subtrees)
         {
-            if (!node->isEmptyBranch (i))
+            if (!walkChildren (*node, next, found, budget))
             {
-                std::shared_ptr<SHAMapAbstractNode> nextNode = descendNoStore (node, i);
-
-                if (nextNode)
-                {
-                    if (nextNode->isInner ())
-                        nodeStack.push(
-                            std::static_pointer_cast<SHAMapInnerNode>(nextNode));
-                }
-                else
-                {
-                    missingNodes.emplace_back (type_, node->getChildHash (i));
-                    if (--maxMissing <= 0)
-                        return;
-                }
+                missingNodes.insert (missingNodes.end (),
+                    found.begin (), found.end ());
+                return;
             }
         }
+        subtrees = std::move (next);
     }
+
+    std::atomic<std::size_t> nextSubtree {0};
+    std::exception_ptr error;
+    std::mutex mutex;
+
+    auto const work = [&]()
+    {
+        std::vector<SHAMapMissingNode> missing;
+        try
+        {
+            for (auto i = nextSubtree++; i < subtrees.size();
+                i = nextSubtree++)
+            {
+                if (!walkSubtrees ({subtrees[i]}, missing, budget))
+                    break;
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            if (!error)
+                error = std::current_exception();
+            budget = 0;
+        }
+
+        std::lock_guard<std::mutex> lock (mutex);
+        found.insert (found.end (), missing.begin (), missing.end ());
+    };
+
+    std::vector<std::thread> workers;
+    threads = std::min<int> (threads, subtrees.size());
+    for (int i = 1; i < threads; ++i)
+        workers.emplace_back (work);
+    work();
+    for (auto& t : workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception (error);
+
+    // Threads may each have found one more after the budget ran out
+    if (found.size () > maxMissing)
+        found.erase (found.begin () + std::max (maxMissing, 0), found.end ());
+    missingNodes.insert (missingNodes.end (), found.begin (), found.end ());
 }
 
 } // casinocoin
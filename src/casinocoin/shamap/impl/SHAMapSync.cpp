@@ -27,6 +27,10 @@
 #include <casinocoin/basics/random.h>
 #include <casinocoin/shamap/SHAMap.h>
 #include <casinocoin/nodestore/Database.h>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace casinocoin {
 
@@ -106,6 +110,39 @@ void SHAMap::visitNodes(std::function<bool (SHAMapAbstractNode&)> const& functio
     }
 }
 
+void SHAMap::visitResidentNodes (
+    std::function<bool (SHAMapAbstractNode&)> const& function) const
+{
+    if (!root_)
+        return;
+
+    std::stack <SHAMapAbstractNode*, std::vector <SHAMapAbstractNode*>> stack;
+    stack.push (root_.get ());
+
+    while (!stack.empty ())
+    {
+        auto node = stack.top ();
+        stack.pop ();
+
+        if (function (*node))
+            return;
+
+        if (node->isInner ())
+        {
+            // Push in reverse so branches are visited in order
+            auto inner = static_cast<SHAMapInnerNode*>(node);
+            for (int i = 15; i >= 0; --i)
+            {
+                if (!inner->isEmptyBranch (i))
+                {
+                    if (auto child = inner->getChildPointer (i))
+                        stack.push (child);
+                }
+            }
+        }
+    }
+}
+
 // Starting at the position referred to by the specfied
 // StackEntry, process that node and its first resident
 // children, descending the SHAMap until we complete the
@@ -135,7 +172,8 @@ void SHAMap::gmn_ProcessNodes (MissingNodes& mn, MissingNodes::StackEntry& se)
         {
             SHAMapNodeID childID = nodeID.getChildNodeID (branch);
             bool pending = false;
-            auto d = descendAsync (node, branch, mn.filter_, pending);
+            auto d = descendAsync (node, branch, mn.filter_,
+                mn.priority_, pending);
 
             if (!d)
             {
@@ -190,7 +228,7 @@ void SHAMap::gmn_ProcessDeferredReads (MissingNodes& mn)
 {
     // Wait for our deferred reads to finish
     auto const before = std::chrono::steady_clock::now();
-    f_.db().waitReads();
+    f_.db().waitReads(mn.priority_);
     auto const after = std::chrono::steady_clock::now();
 
     auto const elapsed = std::chrono::duration_cast
@@ -246,13 +284,14 @@ void SHAMap::gmn_ProcessDeferredReads (MissingNodes& mn)
     nodes that are not permanently stored locally
 */
 std::vector<std::pair<SHAMapNodeID, uint256>>
-SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
+SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter,
+    NodeStore::FetchPriority priority)
 {
     assert (root_->isValid ());
     assert (root_->getNodeHash().isNonZero ());
     assert (max > 0);
 
-    MissingNodes mn (max, filter,
+    MissingNodes mn (max, filter, priority,
         f_.db().getDesiredAsyncReadCount(),
         f_.fullbelow().getGeneration());
 
@@ -354,9 +393,10 @@ SHAMap::getMissingNodes(int max, SHAMapSyncFilter* filter)
     return std::move(mn.missingNodes_);
 }
 
-std::vector<uint256> SHAMap::getNeededHashes (int max, SHAMapSyncFilter* filter)
+std::vector<uint256> SHAMap::getNeededHashes (int max, SHAMapSyncFilter* filter,
+    NodeStore::FetchPriority priority)
 {
-    auto ret = getMissingNodes(max, filter);
+    auto ret = getMissingNodes(max, filter, priority);
 
     std::vector<uint256> hashes;
     hashes.reserve (ret.size());
@@ -513,6 +553,15 @@ SHAMapAddNode SHAMap::addRootNode (SHAMapHash const& hash, Slice const& rootNode
 SHAMapAddNode
 SHAMap::addKnownNode (const SHAMapNodeID& node, Slice const& rawNode,
                       SHAMapSyncFilter* filter)
+{
+    return addKnownNode (node, SHAMapAbstractNode::make(rawNode, 0, snfWIRE,
+        SHAMapHash{}, false, f_.journal(), node), filter);
+}
+
+SHAMapAddNode
+SHAMap::addKnownNode (const SHAMapNodeID& node,
+                      std::shared_ptr<SHAMapAbstractNode> newNode,
+                      SHAMapSyncFilter* filter)
 {
     // return value: true=okay, false=error
     assert (!node.isRoot ());
@@ -524,8 +573,6 @@ SHAMap::addKnownNode (const SHAMapNodeID& node, Slice const& rawNode,
     }
 
     std::uint32_t generation = f_.fullbelow().getGeneration();
-    auto newNode = SHAMapAbstractNode::make(rawNode, 0, snfWIRE,
-                      SHAMapHash{}, false, f_.journal(), node);
     SHAMapNodeID iNodeID;
     auto iNode = root_.get();
 
@@ -779,11 +826,120 @@ SHAMap::visitDifferences(SHAMap const* have,
 
         return;
     }
+
+    walkDifferences (have, func,
+        static_cast<SHAMapInnerNode*>(root_.get()), SHAMapNodeID{});
+}
+
+bool
+SHAMap::visitDifferences (SHAMap const* have,
+    std::function<bool (SHAMapAbstractNode&)> const& func, int threads) const
+{
+    if (root_->getNodeHash ().isZero ())
+        return true;
+
+    if (have && (root_->getNodeHash () == have->root_->getNodeHash ()))
+        return true;
+
+    if (threads <= 1 || root_->isLeaf ())
+    {
+        bool completed = true;
+        visitDifferences (have,
+            [&func, &completed](SHAMapAbstractNode& node)
+            {
+                completed = func (node);
+                return completed;
+            });
+        return completed;
+    }
+
+    auto const root = static_cast<SHAMapInnerNode*>(root_.get());
+    if (!func (*root))
+        return false;
+
+    // Gather the branches of the root that differ, and handle
+    // leaves right away. Each inner node is the top of a subtree
+    // that one of the threads walks.
+    std::vector<std::pair<SHAMapInnerNode*, SHAMapNodeID>> subtrees;
+    for (int i = 0; i < 16; ++i)
+    {
+        if (root->isEmptyBranch (i))
+            continue;
+
+        auto const& childHash = root->getChildHash (i);
+        SHAMapNodeID const childID = SHAMapNodeID{}.getChildNodeID (i);
+        auto next = descendThrow (root, i);
+
+        if (next->isInner ())
+        {
+            if (!have || !have->hasInnerNode (childID, childHash))
+                subtrees.emplace_back (
+                    static_cast<SHAMapInnerNode*>(next), childID);
+        }
+        else if (!have || !have->hasLeafNode (
+                 static_cast<SHAMapTreeNode*>(next)->peekItem()->key(),
+                 childHash))
+        {
+            if (!func (*next))
+                return false;
+        }
+    }
+
+    std::atomic<std::size_t> nextSubtree {0};
+    std::atomic<bool> stopped {false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto const work = [&]()
+    {
+        try
+        {
+            for (auto i = nextSubtree++; i < subtrees.size() && !stopped;
+                i = nextSubtree++)
+            {
+                if (!walkDifferences (have,
+                    [&](SHAMapAbstractNode& node)
+                    {
+                        return !stopped && func (node);
+                    },
+                    subtrees[i].first, subtrees[i].second))
+                {
+                    stopped = true;
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (errorMutex);
+            if (!error)
+                error = std::current_exception();
+            stopped = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    threads = std::min<int> (threads, subtrees.size());
+    for (int i = 1; i < threads; ++i)
+        workers.emplace_back (work);
+    work();
+    for (auto& t : workers)
+        t.join();
+
+    if (error)
+        std::rethrow_exception (error);
+    return !stopped;
+}
+
+bool
+SHAMap::walkDifferences (SHAMap const* have,
+    std::function<bool (SHAMapAbstractNode&)> const& func,
+        SHAMapInnerNode* top, SHAMapNodeID const& topID) const
+{
     // contains unexplored non-matching inner node entries
     using StackEntry = std::pair <SHAMapInnerNode*, SHAMapNodeID>;
     std::stack <StackEntry, std::vector<StackEntry>> stack;
 
-    stack.push ({static_cast<SHAMapInnerNode*>(root_.get()), SHAMapNodeID{}});
+    stack.push ({top, topID});
 
     while (!stack.empty())
     {
@@ -794,7 +950,7 @@ SHAMap::visitDifferences(SHAMap const* have,
 
         // 1) Add this node to the pack
         if (!func (*node))
-            return;
+            return false;
 
         // 2) push non-matching child inner nodes
         for (int i = 0; i < 16; ++i)
@@ -815,11 +971,12 @@ SHAMap::visitDifferences(SHAMap const* have,
                          childHash))
                 {
                     if (! func (*next))
-                        return;
+                        return false;
                 }
             }
         }
     }
+    return true;
 }
 
 } // casinocoin
@@ -365,6 +365,92 @@ SHAMapAbstractNode::make(Slice const& rawNode, std::uint32_t seq, SHANodeFormat
     return{}; // Silence compiler warning.
 }
 
+std::vector<std::shared_ptr<SHAMapAbstractNode>>
+SHAMapAbstractNode::make(std::vector<Blob> const& rawNodes,
+                         std::vector<SHAMapNodeID> const& ids,
+                         std::uint32_t seq, beast::Journal j)
+{
+    assert (rawNodes.size () == ids.size ());
+
+    std::vector<std::shared_ptr<SHAMapAbstractNode>> ret;
+    std::vector<SHAMapAbstractNode*> parsed;
+    ret.reserve (rawNodes.size ());
+    parsed.reserve (rawNodes.size ());
+    for (std::size_t i = 0; i < rawNodes.size (); ++i)
+    {
+        std::shared_ptr<SHAMapAbstractNode> node;
+        try
+        {
+            // The hashes are filled in below
+            node = make (makeSlice (rawNodes[i]), seq, snfWIRE,
+                SHAMapHash{}, true, j, ids[i]);
+        }
+        catch (std::exception const&)
+        {
+            JLOG (j.debug()) << "Unable to parse node " << ids[i];
+        }
+        if (node)
+            parsed.push_back (node.get ());
+        ret.push_back (std::move (node));
+    }
+
+    updateHashes (parsed);
+    return ret;
+}
+
+void
+SHAMapAbstractNode::updateHashes (std::vector<SHAMapAbstractNode*> const& nodes)
+{
+    // Nodes are serialized and hashed a group at a time,
+    // which gives the hasher enough messages to interleave.
+    std::size_t const groupSize = 64;
+
+    std::vector<Serializer> raw (std::min (groupSize, nodes.size ()));
+    std::vector<SHAMapAbstractNode*> group;
+    std::vector<Slice> messages;
+    std::vector<uint256> digests;
+    group.reserve (raw.size ());
+    messages.reserve (raw.size ());
+    digests.reserve (raw.size ());
+
+    auto const hashGroup = [&]
+    {
+        digests.resize (messages.size ());
+        sha512HalfBatch (messages.data (), digests.data (), messages.size ());
+        for (std::size_t i = 0; i < group.size (); ++i)
+            group[i]->mHash = SHAMapHash{digests[i]};
+        group.clear ();
+        messages.clear ();
+    };
+
+    for (auto node : nodes)
+    {
+        if (node->isInner ())
+        {
+            auto inner = static_cast<SHAMapInnerNode*>(node);
+            inner->updateChildHashes ();
+
+            // An empty inner node has a zero hash
+            if (inner->isEmpty ())
+            {
+                inner->updateHash ();
+                continue;
+            }
+        }
+
+        auto& s = raw[group.size ()];
+        s.erase ();
+        node->addRaw (s, snfPREFIX);
+        group.push_back (node);
+        messages.push_back (s.slice ());
+
+        if (group.size () == raw.size ())
+            hashGroup ();
+    }
+    if (! group.empty ())
+        hashGroup ();
+}
+
 bool
 SHAMapInnerNode::updateHash()
 {
@@ -386,13 +472,19 @@ SHAMapInnerNode::updateHash()
 }
 
 void
-SHAMapInnerNode::updateHashDeep()
+SHAMapInnerNode::updateChildHashes()
 {
     for (auto pos = 0; pos < 16; ++pos)
     {
         if (mChildren[pos] != nullptr)
             mHashes[pos] = mChildren[pos]->getNodeHash();
     }
+}
+
+void
+SHAMapInnerNode::updateHashDeep()
+{
+    updateChildHashes();
     updateHash();
 }
 
@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/shamap/TreeNodeSnapshot.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/basics/UnorderedContainers.h>
+#include <casinocoin/protocol/digest.h>
+#include <casinocoin/protocol/Serializer.h>
+#include <boost/filesystem/fstream.hpp>
+
+namespace casinocoin {
+
+static std::uint32_t const treeSnapshotVersion = 1;
+
+void
+saveTreeNodeSnapshot (boost::filesystem::path const& path,
+    SHAMap const& map, std::uint32_t seq, std::size_t maxNodes)
+{
+    // Brings the hashes of a modified map up to date
+    auto const root = map.getHash ();
+
+    Serializer nodes;
+    std::uint32_t count = 0;
+    map.visitResidentNodes (
+        [&](SHAMapAbstractNode& node)
+        {
+            Serializer s;
+            node.addRaw (s, snfPREFIX);
+            nodes.addVL (s.slice ());
+            return ++count >= maxNodes;
+        });
+
+    Serializer s (nodes.size () + 80);
+    s.add32 (treeSnapshotVersion);
+    s.add32 (seq);
+    s.add256 (root.as_uint256 ());
+    s.add32 (count);
+    s.addRaw (nodes.peekData ());
+    s.add256 (s.getSHA512Half ());
+
+    // Write a new file and swap it in, so a crash
+    // never leaves a truncated snapshot behind.
+    auto temp = path;
+    temp += ".tmp";
+    {
+        boost::filesystem::ofstream ofs (temp,
+            std::ios::binary | std::ios::trunc);
+        ofs.write (reinterpret_cast<char const*> (s.data ()), s.size ());
+        if (! ofs)
+            Throw<std::runtime_error> ("unable to write " + temp.string());
+    }
+    boost::filesystem::rename (temp, path);
+}
+
+TreeNodeSnapshot
+loadTreeNodeSnapshot (boost::filesystem::path const& path,
+    Family& family, beast::Journal j)
+{
+    using namespace boost::filesystem;
+
+    TreeNodeSnapshot ret;
+    if (! exists (path))
+        return ret;
+
+    try
+    {
+        Blob data (file_size (path));
+        {
+            ifstream ifs (path, std::ios::binary);
+            if (! ifs.read (reinterpret_cast<char*> (data.data ()),
+                    data.size ()))
+            {
+                Throw<std::runtime_error> ("unable to read");
+            }
+        }
+
+        // The file ends with a hash of its contents
+        if (data.size () < uint256::bytes)
+            Throw<std::runtime_error> ("truncated");
+        auto const size = data.size () - uint256::bytes;
+        if (sha512Half (Slice (data.data (), size)) !=
+            uint256::fromVoid (data.data () + size))
+        {
+            Throw<std::runtime_error> ("checksum mismatch");
+        }
+
+        SerialIter sit (data.data (), size);
+        if (sit.get32 () != treeSnapshotVersion)
+            Throw<std::runtime_error> ("unknown version");
+        ret.seq = sit.get32 ();
+        ret.root = SHAMapHash {sit.get256 ()};
+        auto count = sit.get32 ();
+        ret.nodes.reserve (count);
+
+        // A node is only accepted if its parent was
+        hash_set<SHAMapHash> expected {ret.root};
+        for (; count != 0; --count)
+        {
+            auto const raw = sit.getVL ();
+            auto node = SHAMapAbstractNode::make (makeSlice (raw), 0,
+                snfPREFIX, SHAMapHash{}, false, j);
+            if (! node || expected.erase (node->getNodeHash ()) == 0)
+                Throw<std::runtime_error> ("unexpected node");
+
+            if (node->isInner ())
+            {
+                auto inner = static_cast<SHAMapInnerNode*> (node.get ());
+                for (int i = 0; i < 16; ++i)
+                {
+                    if (! inner->isEmptyBranch (i))
+                        expected.insert (inner->getChildHash (i));
+                }
+            }
+            ret.nodes.push_back (std::move (node));
+        }
+        if (! sit.empty () || ret.nodes.empty ())
+            Throw<std::runtime_error> ("invalid contents");
+    }
+    catch (std::exception const& e)
+    {
+        JLOG (j.warn())
+            << "ignoring tree node snapshot " << path << ": " << e.what ();
+        return {};
+    }
+
+    for (auto& node : ret.nodes)
+    {
+        auto const hash = node->getNodeHash ().as_uint256 ();
+        family.treecache ().canonicalize (hash, node);
+    }
+
+    JLOG (j.info())
+        << "loaded " << ret.nodes.size () << " tree nodes of ledger "
+        << ret.seq;
+    return ret;
+}
+
+} // casinocoin
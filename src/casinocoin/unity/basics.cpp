@@ -32,6 +32,7 @@
 #include <casinocoin/basics/impl/Log.cpp>
 #include <casinocoin/basics/impl/make_SSLContext.cpp>
 #include <casinocoin/basics/impl/mulDiv.cpp>
+#include <casinocoin/basics/impl/ProfiledMutex.cpp>
 #include <casinocoin/basics/impl/RangeSet.cpp>
 #include <casinocoin/basics/impl/ResolverAsio.cpp>
 #include <casinocoin/basics/impl/strHex.cpp>
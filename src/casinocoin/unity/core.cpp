@@ -25,11 +25,13 @@
 
 #include <BeastConfig.h>
 
+#include <casinocoin/core/impl/CheckBatcher.cpp>
 #include <casinocoin/core/impl/Config.cpp>
 #include <casinocoin/core/impl/DatabaseCon.cpp>
 #include <casinocoin/core/impl/DeadlineTimer.cpp>
 #include <casinocoin/core/impl/LoadEvent.cpp>
 #include <casinocoin/core/impl/LoadMonitor.cpp>
+#include <casinocoin/core/impl/PerfLogImp.cpp>
 #include <casinocoin/core/impl/Job.cpp>
 #include <casinocoin/core/impl/JobQueue.cpp>
 #include <casinocoin/core/impl/SNTPClock.cpp>
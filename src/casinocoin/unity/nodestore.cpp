@@ -32,11 +32,16 @@
 #include <casinocoin/nodestore/backend/RocksDBQuickFactory.cpp>
 
 #include <casinocoin/nodestore/impl/BatchWriter.cpp>
+#include <casinocoin/nodestore/impl/BloomFilter.cpp>
 #include <casinocoin/nodestore/impl/DatabaseImp.h>
 #include <casinocoin/nodestore/impl/DatabaseRotatingImp.cpp>
+#include <casinocoin/nodestore/impl/DatabaseShardImp.cpp>
 #include <casinocoin/nodestore/impl/DummyScheduler.cpp>
 #include <casinocoin/nodestore/impl/DecodedBlob.cpp>
+#include <casinocoin/nodestore/impl/DictionaryCodec.cpp>
 #include <casinocoin/nodestore/impl/EncodedBlob.cpp>
+#include <casinocoin/nodestore/impl/FilteredBackend.cpp>
 #include <casinocoin/nodestore/impl/ManagerImp.cpp>
 #include <casinocoin/nodestore/impl/NodeObject.cpp>
+#include <casinocoin/nodestore/impl/Shard.cpp>
 
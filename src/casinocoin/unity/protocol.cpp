@@ -45,6 +45,7 @@
 #include <casinocoin/protocol/impl/Serializer.cpp>
 #include <casinocoin/protocol/impl/SField.cpp>
 #include <casinocoin/protocol/impl/Sign.cpp>
+#include <casinocoin/protocol/impl/SignatureCache.cpp>
 #include <casinocoin/protocol/impl/SOTemplate.cpp>
 #include <casinocoin/protocol/impl/TER.cpp>
 #include <casinocoin/protocol/impl/tokens.cpp>
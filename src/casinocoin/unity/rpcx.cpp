@@ -71,6 +71,7 @@
 #include <casinocoin/rpc/handlers/PathFind.cpp>
 #include <casinocoin/rpc/handlers/PayChanClaim.cpp>
 #include <casinocoin/rpc/handlers/Peers.cpp>
+#include <casinocoin/rpc/handlers/Perf.cpp>
 #include <casinocoin/rpc/handlers/Ping.cpp>
 #include <casinocoin/rpc/handlers/Print.cpp>
 #include <casinocoin/rpc/handlers/Random.cpp>
@@ -31,3 +31,4 @@
 #include <casinocoin/shamap/impl/SHAMapNodeID.cpp>
 #include <casinocoin/shamap/impl/SHAMapSync.cpp>
 #include <casinocoin/shamap/impl/SHAMapTreeNode.cpp>
+#include <casinocoin/shamap/impl/TreeNodeSnapshot.cpp>
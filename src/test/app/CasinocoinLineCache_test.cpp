@@ -0,0 +1,200 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/paths/CasinocoinLineCache.h>
+#include <casinocoin/app/paths/Pathfinder.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class CasinocoinLineCache_test : public beast::unit_test::suite
+{
+    void
+    testLines ()
+    {
+        testcase ("share lines between ledgers");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const alice = Account ("alice");
+        auto const bob = Account ("bob");
+        auto const carol = Account ("carol");
+        auto const USD = gw["USD"];
+        env.fund (CSC (10000), gw, alice, bob, carol);
+        env.trust (USD (1000), alice, bob, carol);
+        env (pay (gw, alice, USD (100)));
+        env.close ();
+
+        auto const first = std::make_shared<CasinocoinLineCache> (
+            env.closed ());
+        auto const& aliceLines = first->getCasinocoinLines (alice);
+        auto const& carolLines = first->getCasinocoinLines (carol);
+        BEAST_EXPECT(aliceLines.size () == 1);
+        BEAST_EXPECT(carolLines.size () == 1);
+
+        env (pay (alice, bob, USD (10)));
+        env.close ();
+
+        CasinocoinLineCache::Changes changes;
+        BEAST_EXPECT(CasinocoinLineCache::getChanges (
+            *env.closed (), changes));
+        BEAST_EXPECT(changes.accounts.count (alice.id ()) == 1);
+        BEAST_EXPECT(changes.accounts.count (bob.id ()) == 1);
+        BEAST_EXPECT(changes.accounts.count (gw.id ()) == 1);
+        BEAST_EXPECT(changes.accounts.count (carol.id ()) == 0);
+        BEAST_EXPECT(changes.issuers.empty ());
+
+        // An open ledger has no metadata to go by
+        CasinocoinLineCache::Changes none;
+        BEAST_EXPECT(! CasinocoinLineCache::getChanges (
+            *env.current (), none));
+
+        auto const second = std::make_shared<CasinocoinLineCache> (
+            env.closed (), *first, changes);
+
+        // Unchanged lines are shared, changed ones are read again
+        BEAST_EXPECT(&second->getCasinocoinLines (carol) == &carolLines);
+        auto const& newLines = second->getCasinocoinLines (alice);
+        BEAST_EXPECT(&newLines != &aliceLines);
+        if (BEAST_EXPECT(newLines.size () == 1))
+            BEAST_EXPECT(newLines[0]->getBalance () == USD (90));
+        BEAST_EXPECT(aliceLines[0]->getBalance () == USD (100));
+    }
+
+    void
+    testPaths ()
+    {
+        testcase ("share paths between ledgers");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const alice = Account ("alice");
+        auto const bob = Account ("bob");
+        auto const carol = Account ("carol");
+        auto const USD = gw["USD"];
+        env.fund (CSC (10000), gw, alice, bob, carol);
+        env.trust (USD (1000), alice, bob, carol);
+        env.close ();
+
+        STPath const path ({STPathElement (
+            STPathElement::typeAccount, gw.id (), Currency (), AccountID ())});
+        STPathSet paths;
+        paths.push_back (path);
+
+        auto const first = std::make_shared<CasinocoinLineCache> (
+            env.closed ());
+        uint256 const viaGateway (1);
+        uint256 const direct (2);
+        first->setPaths (viaGateway, paths, {alice.id (), gw.id ()});
+        first->setPaths (direct, STPathSet (), {carol.id (), bob.id ()});
+        BEAST_EXPECT(first->getPaths (viaGateway));
+        BEAST_EXPECT(! first->getPaths (uint256 (3)));
+
+        // A line of the gateway changes
+        env (pay (gw, alice, USD (10)));
+        env.close ();
+        CasinocoinLineCache::Changes changes;
+        BEAST_EXPECT(CasinocoinLineCache::getChanges (
+            *env.closed (), changes));
+        auto second = std::make_shared<CasinocoinLineCache> (
+            env.closed (), *first, changes);
+        BEAST_EXPECT(! second->getPaths (viaGateway));
+        BEAST_EXPECT(second->getPaths (direct));
+
+        // So does an order book of the gateway
+        env (offer (carol, USD (10), CSC (100)));
+        env.close ();
+        changes = {};
+        BEAST_EXPECT(CasinocoinLineCache::getChanges (
+            *env.closed (), changes));
+        BEAST_EXPECT(changes.issuers.count (gw.id ()) == 1);
+        second->setPaths (viaGateway, paths, {alice.id (), gw.id ()});
+        auto const third = std::make_shared<CasinocoinLineCache> (
+            env.closed (), *second, changes);
+        BEAST_EXPECT(! third->getPaths (viaGateway));
+        BEAST_EXPECT(third->getPaths (direct));
+    }
+
+    void
+    testSearch ()
+    {
+        testcase ("reuse a search until the issuer's lines change");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const alice = Account ("alice");
+        auto const bob = Account ("bob");
+        auto const carol = Account ("carol");
+        auto const dan = Account ("dan");
+        auto const USD = gw["USD"];
+        auto const EUR = carol["EUR"];
+        env.fund (CSC (10000), gw, alice, bob, carol, dan);
+        env.trust (USD (1000), alice, bob);
+        env (pay (gw, alice, USD (100)));
+        env.close ();
+
+        auto const first = std::make_shared<CasinocoinLineCache> (
+            env.closed ());
+        Pathfinder pf (first, alice.id (), bob.id (), USD.currency,
+            boost::none, USD (10), boost::none, env.app ());
+        BEAST_EXPECT(pf.findPaths (2));
+        auto const key = pf.getSearchKey (2);
+        BEAST_EXPECT(first->getPaths (key));
+
+        // Lines the search doesn't depend on change
+        env.trust (EUR (1000), dan);
+        env.close ();
+        CasinocoinLineCache::Changes changes;
+        BEAST_EXPECT(CasinocoinLineCache::getChanges (
+            *env.closed (), changes));
+        auto const second = std::make_shared<CasinocoinLineCache> (
+            env.closed (), *first, changes);
+        BEAST_EXPECT(second->getPaths (key));
+
+        // A line of the destination amount's issuer changes
+        env.trust (USD (1000), dan);
+        env.close ();
+        changes = {};
+        BEAST_EXPECT(CasinocoinLineCache::getChanges (
+            *env.closed (), changes));
+        BEAST_EXPECT(changes.accounts.count (gw.id ()) == 1);
+        auto const third = std::make_shared<CasinocoinLineCache> (
+            env.closed (), *second, changes);
+        BEAST_EXPECT(! third->getPaths (key));
+    }
+
+public:
+    void
+    run () override
+    {
+        testLines ();
+        testPaths ();
+        testSearch ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CasinocoinLineCache,app,ripple);
+
+}
+}
@@ -229,6 +229,39 @@ class HashRouter_test : public beast::unit_test::suite
         BEAST_EXPECT(peers && peers->size() == 0);
     }
 
+    void
+    testResults()
+    {
+        using namespace std::chrono_literals;
+        TestStopwatch stopwatch;
+        HashRouter router(stopwatch, 2s);
+
+        uint256 const key1(1);
+        uint256 const key2(2);
+        uint256 const key3(3);
+        uint256 const context1(10);
+        uint256 const context2(20);
+
+        BEAST_EXPECT(!router.getResult(key1, context1));
+        router.setResult(key1, context1, 5);
+        router.setResult(key1, context2, -7);
+        BEAST_EXPECT(router.getResult(key1, context1) == 5);
+        BEAST_EXPECT(router.getResult(key1, context2) == -7);
+        BEAST_EXPECT(!router.getResult(key2, context1));
+        // Results don't affect the flags
+        BEAST_EXPECT(router.getFlags(key1) == 0);
+        // Overwrite
+        router.setResult(key1, context1, 6);
+        BEAST_EXPECT(router.getResult(key1, context1) == 6);
+        // Results expire with the entry
+        ++stopwatch;
+        ++stopwatch;
+        ++stopwatch;
+        router.addSuppression(key3); // force expiration
+        BEAST_EXPECT(!router.getResult(key1, context1));
+        BEAST_EXPECT(!router.getResult(key1, context2));
+    }
+
 public:
 
     void
@@ -239,6 +272,7 @@ public:
         testSuppression();
         testSetFlags();
         testRelay();
+        testResults();
     }
 };
 
@@ -0,0 +1,185 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/app/ledger/LedgerMaster.h>
+#include <casinocoin/app/ledger/OpenLedger.h>
+#include <casinocoin/app/tx/apply.h>
+#include <casinocoin/protocol/JsonFields.h>
+#include <test/jtx.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+
+namespace casinocoin {
+namespace test {
+
+class OpenLedger_test : public beast::unit_test::suite
+{
+    class TestSink : public beast::Journal::Sink
+    {
+    public:
+        std::stringstream strm_;
+
+        TestSink () : Sink (beast::severities::kDebug, false) {  }
+
+        void
+        write (beast::severities::Severity level,
+            std::string const& text) override
+        {
+            if (level < threshold())
+                return;
+
+            strm_ << text << std::endl;
+        }
+    };
+
+    // Transactions and account state of the open ledger
+    struct Outcome
+    {
+        std::set<uint256> txs;
+        std::map<AccountID, std::pair<STAmount, std::uint32_t>> accounts;
+
+        bool
+        operator== (Outcome const& other) const
+        {
+            return txs == other.txs &&
+                accounts == other.accounts;
+        }
+    };
+
+    // Build the ledger following the last closed ledger
+    // out of `txs`, the way consensus would.
+    std::shared_ptr<Ledger const>
+    buildNext(jtx::Env& env, std::vector<jtx::JTx> const& txs)
+    {
+        auto next = std::make_shared<Ledger>(
+            *env.app().getLedgerMaster().getClosedLedger(),
+                env.app().timeKeeper().closeTime());
+        {
+            OpenView accum(&*next);
+            for (auto const& jt : txs)
+                BEAST_EXPECT(casinocoin::apply(env.app(), accum,
+                    *jt.stx, tapNONE, env.journal).second);
+            accum.apply(*next);
+        }
+        next->updateSkipList();
+        next->setImmutable(env.app().config());
+        return next;
+    }
+
+    Outcome
+    accept(bool incremental)
+    {
+        using namespace jtx;
+        Env env(*this);
+        Account const alice("alice");
+        Account const bob("bob");
+        Account const carol("carol");
+        Account const dan("dan");
+        env.fund(CSC(10000), alice, bob, carol, dan);
+        env.close();
+
+        TestSink sink;
+        OpenLedger::Setup setup;
+        setup.incremental = incremental;
+        OpenLedger openLedger(
+            env.app().getLedgerMaster().getClosedLedger(),
+                env.app().cachedSLEs(), beast::Journal(sink), setup);
+        auto const submit = [&](JTx const& jt)
+        {
+            openLedger.modify(
+                [&](OpenView& view, beast::Journal j)
+                {
+                    auto const result = casinocoin::apply(
+                        env.app(), view, *jt.stx, tapNONE, j);
+                    BEAST_EXPECT(result.first == tesSUCCESS);
+                    return result.second;
+                });
+        };
+
+        // Transactions the new ledger doesn't affect, which
+        // can be carried forward
+        auto const aliceSeq = env.seq(alice);
+        submit(env.jt(pay(alice, carol, CSC(100)), seq(aliceSeq)));
+        submit(env.jt(pay(alice, carol, CSC(200)), seq(aliceSeq + 1)));
+        // bob starts requiring a destination tag in the
+        // next ledger, spending the sequence used by his
+        // open ledger transaction.
+        auto const bobSeq = env.seq(bob);
+        std::vector<JTx> txs;
+        txs.push_back(env.jt(fset(bob, asfRequireDest), seq(bobSeq)));
+        // Transactions the new ledger invalidates, which
+        // must be re-checked
+        submit(env.jt(pay(dan, bob, CSC(300)), seq(env.seq(dan))));
+        submit(env.jt(noop(bob), seq(bobSeq)));
+        BEAST_EXPECT(openLedger.current()->txCount() == 4);
+
+        auto const ledger = buildNext(env, txs);
+
+        OrderedTxs retries({});
+        openLedger.accept(env.app(), env.current()->rules(),
+            ledger, OrderedTxs({}), false, retries, tapNONE);
+
+        Outcome outcome;
+        auto const open = openLedger.current();
+        for (auto const& item : open->txs)
+            outcome.txs.insert(item.first->getTransactionID());
+        for (auto const& account : { alice, bob, carol, dan })
+        {
+            auto const sle = open->read(keylet::account(account));
+            if (BEAST_EXPECT(sle))
+                outcome.accounts[account.id()] = {
+                    (*sle)[sfBalance], (*sle)[sfSequence] };
+        }
+
+        BEAST_EXPECT(open->seq() == ledger->seq() + 1);
+        // Only bob's noop, whose sequence the ledger used,
+        // is dropped. dan's payment is claimed since bob
+        // now requires a destination tag.
+        BEAST_EXPECT(open->txCount() == 3);
+        auto const balance = [&](Account const& account)
+        {
+            return ledger->read(keylet::account(account))->
+                getFieldAmount(sfBalance);
+        };
+        BEAST_EXPECT(outcome.accounts[bob.id()].first ==
+            balance(bob));
+        BEAST_EXPECT(outcome.accounts[dan.id()].first ==
+            balance(dan) - drops(env.current()->fees().base).value());
+        BEAST_EXPECT(outcome.accounts[carol.id()].first ==
+            balance(carol) + CSC(300).value());
+        BEAST_EXPECT((sink.strm_.str().find(
+            "carried 2 of 4") != std::string::npos) == incremental);
+        return outcome;
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("incremental accept");
+        BEAST_EXPECT(accept(true) == accept(false));
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OpenLedger,app,casinocoin);
+
+} // test
+} // casinocoin
@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/ledger/OrderBookDB.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class OrderBookDB_test : public beast::unit_test::suite
+{
+    void
+    testIncremental ()
+    {
+        testcase ("incremental updates");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const alice = Account ("alice");
+        auto const USD = gw["USD"];
+        env.fund (CSC (10000), gw, alice);
+        env.close ();
+
+        auto& db = env.app ().getOrderBookDB ();
+        db.setup (env.closed ());
+        BEAST_EXPECT(db.getBookSize (USD.issue ()) == 0);
+
+        // Two offers at different qualities make two directories
+        auto const seq = env.seq (alice);
+        env (offer (alice, USD (10), CSC (100)));
+        env (offer (alice, USD (10), CSC (50)));
+        env.close ();
+        db.setup (env.closed ());
+        BEAST_EXPECT(db.getBookSize (USD.issue ()) == 1);
+        BEAST_EXPECT(db.isBookToCSC (USD.issue ()));
+
+        // The book stays until its last directory is gone
+        env (offer_cancel (alice, seq));
+        env.close ();
+        db.setup (env.closed ());
+        BEAST_EXPECT(db.getBookSize (USD.issue ()) == 1);
+
+        // Catching up over more than one ledger
+        env (offer_cancel (alice, seq + 1));
+        env.close ();
+        env.close ();
+        db.setup (env.closed ());
+        BEAST_EXPECT(db.getBookSize (USD.issue ()) == 0);
+        BEAST_EXPECT(! db.isBookToCSC (USD.issue ()));
+    }
+
+    void
+    testAddedBooks ()
+    {
+        testcase ("books added ahead of a ledger");
+
+        using namespace jtx;
+        Env env (*this);
+        auto const gw = Account ("gateway");
+        auto const EUR = gw["EUR"];
+        env.close ();
+
+        auto& db = env.app ().getOrderBookDB ();
+        db.setup (env.closed ());
+
+        // A book that no ledger ever creates is dropped again
+        db.addOrderBook (Book {EUR.issue (), cscIssue ()});
+        BEAST_EXPECT(db.getBookSize (EUR.issue ()) == 1);
+        for (int i = 0; i < 3; ++i)
+            env.close ();
+        db.setup (env.closed ());
+        BEAST_EXPECT(db.getBookSize (EUR.issue ()) == 0);
+    }
+
+public:
+    void
+    run () override
+    {
+        testIncremental ();
+        testAddedBooks ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(OrderBookDB,app,ripple);
+
+}
+}
@@ -0,0 +1,84 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/app/misc/HashRouter.h>
+#include <casinocoin/app/tx/applySteps.h>
+#include <casinocoin/protocol/Feature.h>
+#include <test/jtx.h>
+
+namespace casinocoin {
+namespace test {
+
+class Preflight_test : public beast::unit_test::suite
+{
+    void
+    testReuse()
+    {
+        testcase("reuse results");
+
+        using namespace jtx;
+        Env env(*this);
+        Account const alice("alice");
+        env.fund(CSC(10000), alice);
+        env.close();
+
+        auto const tx = env.jt(pay(alice, env.master, CSC(100))).stx;
+        if (! BEAST_EXPECT(tx))
+            return;
+
+        std::unordered_set<uint256, beast::uhash<>> const presets1;
+        std::unordered_set<uint256, beast::uhash<>> const presets2 {
+            featureTickets };
+        Rules const rules1(presets1);
+        Rules const rules2(presets2);
+        BEAST_EXPECT(rules1.digest() != rules2.digest());
+        BEAST_EXPECT(Rules(presets1).digest() == rules1.digest());
+
+        auto const check = [&](Rules const& rules, ApplyFlags flags)
+        {
+            return preflight(env.app(), rules, *tx,
+                flags, env.journal).ter;
+        };
+        BEAST_EXPECT(check(rules1, tapNONE) == tesSUCCESS);
+
+        // Once the signature is known to be bad, preflight fails
+        // wherever it runs again, but the earlier result stands
+        // for the same rules and flags.
+        // SF_PRIVATE1 is how apply.cpp marks a bad signature.
+        env.app().getHashRouter().setFlags(
+            tx->getTransactionID(), SF_PRIVATE1);
+        BEAST_EXPECT(check(rules1, tapNONE) == tesSUCCESS);
+        BEAST_EXPECT(check(rules2, tapNONE) == temINVALID);
+        BEAST_EXPECT(check(rules1, tapRETRY) == temINVALID);
+        BEAST_EXPECT(check(rules1, tapNONE) == tesSUCCESS);
+    }
+
+public:
+    void
+    run() override
+    {
+        testReuse();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(Preflight,app,casinocoin);
+
+} // test
+} // casinocoin
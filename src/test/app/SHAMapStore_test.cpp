@@ -18,11 +18,15 @@
 //==============================================================================
 
 #include <BeastConfig.h>
+#include <casinocoin/app/ledger/LedgerMaster.h>
 #include <casinocoin/app/main/Application.h>
 #include <casinocoin/app/misc/SHAMapStore.h>
+#include <casinocoin/beast/utility/temp_dir.h>
 #include <casinocoin/core/ConfigSections.h>
 #include <casinocoin/core/DatabaseCon.h>
 #include <casinocoin/core/SociDB.h>
+#include <casinocoin/nodestore/DatabaseShard.h>
+#include <casinocoin/protocol/HashPrefix.h>
 #include <casinocoin/protocol/JsonFields.h>
 #include <test/jtx.h>
 #include <test/jtx/envconfig.h>
@@ -442,6 +446,22 @@ public:
 
         lastRotated = store.getLastRotated();
 
+        {
+            env.close();
+
+            auto ledger = env.rpc("ledger", "validated");
+            BEAST_EXPECT(goodLedger(env, ledger, to_string(ledgerSeq), true));
+            store.rendezvous();
+
+            // Between rotations, the validated state is copied into
+            // the writable backend as ledgers validate
+            auto const info = env.rpc("server_info")
+                [jss::result][jss::info][jss::online_delete];
+            BEAST_EXPECT(info[jss::last_rotated].asUInt() == lastRotated);
+            BEAST_EXPECT(info[jss::synced_ledger].asUInt() == ledgerSeq++);
+            BEAST_EXPECT(info[jss::state] == "idle");
+        }
+
         // Close enough ledgers to trigger another rotate
         for (; ledgerSeq < lastRotated + deleteInterval + 1; ++ledgerSeq)
         {
@@ -624,11 +644,104 @@ public:
         lastRotated = ledgerSeq - 1;
     }
 
+    void testShardFallback()
+    {
+        testcase("history shard fallback");
+        using namespace jtx;
+
+        beast::temp_dir shardDir;
+        Env env(*this, envconfig([&](std::unique_ptr<Config> cfg)
+        {
+            cfg = onlineDelete(std::move(cfg));
+            auto& section = cfg->section(ConfigSection::shardDatabase());
+            section.set("type", "nudb");
+            section.set("path", shardDir.path());
+            section.set("ledgers_per_shard", "4");
+            return cfg;
+        }));
+        auto& store = env.app().getSHAMapStore();
+        auto& ledgerMaster = env.app().getLedgerMaster();
+        auto const shards = env.app().getShardStore();
+        if (!BEAST_EXPECT(shards))
+            return;
+
+        auto ledgerSeq = waitForReady(env);
+        auto lastRotated = ledgerSeq - 1;
+        for (; ledgerSeq < lastRotated + deleteInterval - 1; ++ledgerSeq)
+            env.close();
+        store.rendezvous();
+
+        // Store a ledger the node store still has in the shards
+        auto const seq = shards->prepare(ledgerMaster.getValidLedgerIndex());
+        if (!BEAST_EXPECT(seq))
+            return;
+        auto const ledger = ledgerMaster.getLedgerBySeq(*seq);
+        if (!BEAST_EXPECT(ledger))
+            return;
+        auto const storeNode = [&](SHAMapAbstractNode& node,
+            NodeObjectType type)
+        {
+            Serializer s;
+            node.addRaw(s, snfPREFIX);
+            return shards->store(type, std::move(s.modData()),
+                node.getNodeHash().as_uint256(), *seq);
+        };
+        {
+            Serializer s(128);
+            s.add32(HashPrefix::ledgerMaster);
+            addRaw(ledger->info(), s);
+            BEAST_EXPECT(shards->store(hotLEDGER, std::move(s.modData()),
+                ledger->info().hash, *seq));
+        }
+        ledger->stateMap().visitDifferences(nullptr,
+            [&](SHAMapAbstractNode& node)
+            {
+                return storeNode(node, hotACCOUNT_NODE);
+            }, 1);
+        if (ledger->info().txHash.isNonZero())
+        {
+            ledger->txMap().visitDifferences(nullptr,
+                [&](SHAMapAbstractNode& node)
+                {
+                    return storeNode(node, hotTRANSACTION_NODE);
+                }, 1);
+        }
+        BEAST_EXPECT(!shards->setStored(*seq));
+        BEAST_EXPECT(shards->hasLedger(*seq));
+
+        // Rotate twice, so the node store and the ledger
+        // database no longer have the ledger
+        for (int i = 0; i < 2; ++i)
+        {
+            for (; ledgerSeq <= lastRotated + deleteInterval; ++ledgerSeq)
+                env.close();
+            store.rendezvous();
+            BEAST_EXPECT(lastRotated != store.getLastRotated());
+            lastRotated = store.getLastRotated();
+        }
+        BEAST_EXPECT(ledgerMaster.getHashBySeq(*seq).isZero());
+
+        // The ledger is loaded from the shards by its sequence
+        auto const loaded = ledgerMaster.getLedgerBySeq(*seq);
+        if (BEAST_EXPECT(loaded))
+        {
+            BEAST_EXPECT(loaded->info().hash == ledger->info().hash);
+            BEAST_EXPECT(loaded->stateMap().getHash() ==
+                ledger->stateMap().getHash());
+            BEAST_EXPECT(loaded->exists(keylet::account(
+                Account::master.id())));
+        }
+
+        // A ledger of the same shard which wasn't stored is gone
+        BEAST_EXPECT(!ledgerMaster.getLedgerBySeq(*seq - 1));
+    }
+
     void run()
     {
         testClear();
         testAutomatic();
         testCanDelete();
+        testShardFallback();
     }
 };
 
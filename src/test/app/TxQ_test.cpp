@@ -23,6 +23,7 @@
 #include <casinocoin/app/tx/apply.h>
 #include <casinocoin/basics/Log.h>
 #include <casinocoin/basics/mulDiv.h>
+#include <casinocoin/beast/xor_shift_engine.h>
 #include <test/jtx/TestSuite.h>
 #include <test/jtx/envconfig.h>
 #include <casinocoin/protocol/ErrorCodes.h>
@@ -33,6 +34,11 @@
 #include <test/jtx/ticket.h>
 #include <boost/optional.hpp>
 #include <test/jtx/WSClient.h>
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <sstream>
 
 namespace casinocoin {
 
@@ -2817,7 +2823,142 @@ public:
     }
 };
 
+//------------------------------------------------------------------------------
+
+/*  Times the real queue: TxQ::apply for 100,000 transactions which all
+    have to wait, then the ledger closes in which TxQ::accept drains
+    them. Fees are drawn from a few distributions, so the fee ordering
+    sees anything from a single fee level to nearly every level
+    distinct.
+*/
+class TxQTiming_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+    using duration_type = std::chrono::milliseconds;
+
+    static std::size_t const accountCount = 1000;
+    static std::size_t const perAccount = 100;
+
+    static
+    std::unique_ptr<Config>
+    makeConfig()
+    {
+        auto p = test::jtx::envconfig();
+        auto& section = p->section("transaction_queue");
+        section.set("ledgers_in_queue", "1000");
+        section.set("min_ledgers_to_compute_size_limit", "1000");
+        section.set("minimum_txn_in_ledger_standalone", "500");
+        section.set("maximum_txn_per_account",
+            std::to_string(perAccount));
+        return p;
+    }
+
+    template <class Function>
+    static
+    duration_type
+    elapsed(Function&& f)
+    {
+        auto const start = clock_type::now();
+        f();
+        return std::chrono::duration_cast<duration_type>(
+            clock_type::now() - start);
+    }
+
+    // `feeOf` returns the fee as a multiple of the base fee
+    template <class FeeFunction>
+    void
+    testTiming(std::string const& name, FeeFunction&& feeOf)
+    {
+        using namespace jtx;
+        testcase(name);
+
+        Env env(*this, makeConfig());
+        env.disable_sigs();
+        auto& txq = env.app().getTxQ();
+
+        std::vector<Account> accounts;
+        accounts.reserve(accountCount);
+        for (std::size_t i = 0; i < accountCount; ++i)
+        {
+            accounts.emplace_back("acct" + std::to_string(i));
+            env.fund(CSC(100000), accounts.back());
+            if (i % 200 == 199)
+                env.close();
+        }
+        env.close();
+
+        // Every account submits its sequences in order,
+        // interleaved at random with the other accounts.
+        beast::xor_shift_engine g(accountCount);
+        auto const base = env.current()->fees().base;
+        std::vector<std::size_t> order(accountCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<std::shared_ptr<STTx const>> txs;
+        txs.reserve(accountCount * perAccount);
+        for (std::uint32_t i = 0; i < perAccount; ++i)
+        {
+            std::shuffle(order.begin(), order.end(), g);
+            for (auto const index : order)
+            {
+                auto const& account = accounts[index];
+                auto const drops = static_cast<std::uint64_t>(
+                    base * std::max(1.0, feeOf(g)));
+                txs.push_back(env.jt(noop(account),
+                    seq(env.seq(account) + i), fee(drops)).stx);
+            }
+        }
+
+        std::size_t queued = 0;
+        auto const applyTime = elapsed([&]
+        {
+            env.app().openLedger().modify(
+                [&](OpenView& view, beast::Journal j)
+                {
+                    for (auto const& tx : txs)
+                    {
+                        auto const result = txq.apply(env.app(),
+                            view, tx, tapNO_CHECK_SIGN, j);
+                        queued += result.first == terQUEUED;
+                    }
+                    return true;
+                });
+        });
+
+        std::stringstream ss;
+        ss << txs.size() << " submitted, " << queued << " queued, apply " <<
+            applyTime.count() << "ms, accept";
+        for (int i = 0; i < 5; ++i)
+            ss << " " << elapsed([&] { env.close(); }).count() << "ms";
+        auto const metrics = txq.getMetrics(*env.current());
+        if (BEAST_EXPECT(metrics))
+            ss << ", " << metrics->txCount << " left";
+        log << ss.str() << std::endl;
+        BEAST_EXPECT(queued > txs.size() / 2);
+    }
+
+public:
+    void
+    run() override
+    {
+        // Every transaction pays the reference fee
+        testTiming("reference fee",
+            [](beast::xor_shift_engine&) { return 1.0; });
+
+        // Most pay close to the reference fee and a few pay a lot
+        // more, so nearly every fee level is distinct.
+        std::lognormal_distribution<double> lognormal(0.5, 1.0);
+        testTiming("log-normal fees",
+            [&](beast::xor_shift_engine& g) { return lognormal(g); });
+
+        // Spread evenly over 1 to 100 times the reference fee
+        std::uniform_real_distribution<double> uniform(1.0, 100.0);
+        testTiming("uniform fees",
+            [&](beast::xor_shift_engine& g) { return uniform(g); });
+    }
+};
+
 BEAST_DEFINE_TESTSUITE(TxQ,app,ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(TxQTiming,app,ripple);
 
 }
 }
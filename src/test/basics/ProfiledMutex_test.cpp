@@ -0,0 +1,167 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/basics/ProfiledMutex.h>
+#include <casinocoin/beast/unit_test.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace casinocoin {
+
+class ProfiledMutex_test : public beast::unit_test::suite
+{
+#if CASINOCOIN_PROFILE_LOCKS
+    static
+    LockStats
+    find (std::string const& name)
+    {
+        auto const stats = getLockStats ();
+        auto const it = std::find_if (stats.begin (), stats.end (),
+            [&](LockStats const& s) { return s.name == name; });
+        if (it == stats.end ())
+            return {};
+        return *it;
+    }
+#endif
+
+    void
+    testLock ()
+    {
+        testcase ("lock");
+
+        ProfiledMutex <std::mutex> m ("ProfiledMutex_test::lock");
+        {
+            std::lock_guard <ProfiledMutex <std::mutex>> lock (m);
+            // Another thread can't take it while it's held
+            bool locked = true;
+            std::thread ([&] { locked = m.try_lock (); }).join ();
+            BEAST_EXPECT(! locked);
+        }
+        BEAST_EXPECT(m.try_lock ());
+        m.unlock ();
+
+#if CASINOCOIN_PROFILE_LOCKS
+        auto const s = find ("ProfiledMutex_test::lock");
+        BEAST_EXPECT(s.acquired == 2);
+        BEAST_EXPECT(s.contended == 0);
+        BEAST_EXPECT(s.waitTotal == 0);
+        BEAST_EXPECT(s.holdMax <= s.holdTotal);
+#endif
+    }
+
+    void
+    testRecursive ()
+    {
+        testcase ("recursive");
+
+        using namespace std::chrono_literals;
+
+        ProfiledMutex <std::recursive_mutex> m (
+            "ProfiledMutex_test::recursive");
+        {
+            std::lock_guard <ProfiledMutex <std::recursive_mutex>> outer (m);
+            std::this_thread::sleep_for (5ms);
+            std::lock_guard <ProfiledMutex <std::recursive_mutex>> inner (m);
+        }
+
+#if CASINOCOIN_PROFILE_LOCKS
+        // Held once, for as long as the outer lock
+        auto const s = find ("ProfiledMutex_test::recursive");
+        BEAST_EXPECT(s.acquired == 1);
+        BEAST_EXPECT(s.holdTotal >= 5000000);
+        BEAST_EXPECT(s.holdMax == s.holdTotal);
+#endif
+
+        // Released along with the outer lock
+        bool locked = false;
+        std::thread ([&]
+            {
+                locked = m.try_lock ();
+                if (locked)
+                    m.unlock ();
+            }).join ();
+        BEAST_EXPECT(locked);
+    }
+
+    void
+    testContention ()
+    {
+        testcase ("contention");
+
+        using namespace std::chrono_literals;
+
+        ProfiledMutex <std::mutex> m ("ProfiledMutex_test::contention");
+        int value = 0;
+
+        std::unique_lock <ProfiledMutex <std::mutex>> lock (m);
+        std::thread t (
+            [&]
+            {
+                std::lock_guard <ProfiledMutex <std::mutex>> lock (m);
+                ++value;
+            });
+        std::this_thread::sleep_for (20ms);
+        lock.unlock ();
+        t.join ();
+        BEAST_EXPECT(value == 1);
+
+#if CASINOCOIN_PROFILE_LOCKS
+        auto const s = find ("ProfiledMutex_test::contention");
+        BEAST_EXPECT(s.acquired == 2);
+        BEAST_EXPECT(s.contended == 1);
+        BEAST_EXPECT(s.waitTotal > 0);
+        BEAST_EXPECT(s.waitMax == s.waitTotal);
+#endif
+    }
+
+    void
+    testShared ()
+    {
+        testcase ("shared counters");
+
+        ProfiledMutex <std::mutex> a ("ProfiledMutex_test::shared");
+        ProfiledMutex <std::mutex> b ("ProfiledMutex_test::shared");
+        std::lock (a, b);
+        a.unlock ();
+        b.unlock ();
+
+#if CASINOCOIN_PROFILE_LOCKS
+        BEAST_EXPECT(find ("ProfiledMutex_test::shared").acquired == 2);
+#else
+        BEAST_EXPECT(getLockStats ().empty ());
+#endif
+    }
+
+public:
+    void
+    run () override
+    {
+        testLock ();
+        testRecursive ();
+        testContention ();
+        testShared ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ProfiledMutex,basics,ripple);
+
+} // casinocoin
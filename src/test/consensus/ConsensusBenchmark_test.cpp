@@ -0,0 +1,255 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+#include <BeastConfig.h>
+#include <casinocoin/beast/unit_test.h>
+#include <casinocoin/consensus/Consensus.h>
+#include <casinocoin/json/json_value.h>
+#include <casinocoin/json/json_writer.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/function_output_iterator.hpp>
+#include <boost/lexical_cast.hpp>
+#include <test/csf.h>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace casinocoin {
+namespace test {
+
+/** Measure consensus over simulated networks.
+
+    Runs the csf simulation over every combination of the swept
+    parameters and writes one JSON object per line for each run, so
+    the output can be collected and compared offline. The parameters
+    may be overridden with the suite argument, for example:
+
+        peers=10,50;delay=50,250;rate=10;overlap=1.0;ledgers=20
+
+    peers       Number of peers in the network
+    delay       One way latency of every link, in milliseconds
+    rate        Transactions submitted per second, network wide
+    overlap     Fraction of peers trusting both halves of the network.
+                1.0 is a network where everyone trusts everyone.
+    ledgers     Number of ledgers each peer builds per run
+
+    The timing parameters in LedgerTiming.h are compiled in; change
+    them and run the suite again to compare.
+*/
+class ConsensusBenchmark_test : public beast::unit_test::suite
+{
+    struct Params
+    {
+        int peers;
+        std::chrono::milliseconds delay;
+        double rate;
+        double overlap;
+        int ledgers;
+    };
+
+    template <class T>
+    static
+    std::vector<T>
+    parseList(std::string const& s)
+    {
+        std::vector<std::string> items;
+        boost::split(items, s, boost::algorithm::is_any_of(","));
+        std::vector<T> result;
+        for (auto& item : items)
+        {
+            boost::trim(item);
+            if (!item.empty())
+                result.push_back(boost::lexical_cast<T>(item));
+        }
+        return result;
+    }
+
+    static
+    Json::Value
+    distribution(std::vector<double> v)
+    {
+        Json::Value ret(Json::objectValue);
+        ret["count"] = static_cast<Json::UInt>(v.size());
+        if (v.empty())
+            return ret;
+        std::sort(v.begin(), v.end());
+        auto const pct = [&](double p)
+        {
+            return v[static_cast<std::size_t>(p * (v.size() - 1))];
+        };
+        double sum = 0;
+        for (auto const x : v)
+            sum += x;
+        ret["min"] = v.front();
+        ret["mean"] = sum / v.size();
+        ret["p50"] = pct(0.5);
+        ret["p90"] = pct(0.9);
+        ret["p99"] = pct(0.99);
+        ret["max"] = v.back();
+        return ret;
+    }
+
+    Json::Value
+    simulate(Params const& params)
+    {
+        using namespace csf;
+        using namespace std::chrono;
+
+        std::mt19937_64 rng;
+        auto const tg = TrustGraph::makeClique(params.peers,
+            static_cast<int>(params.overlap * params.peers + 0.5));
+        Sim sim(tg, topology(tg, fixed{params.delay}));
+
+        // Initial round to set prior state
+        sim.run(1);
+        for (auto& p : sim.peers)
+        {
+            p.accepted.clear();
+            p.messagesSent = 0;
+        }
+        auto const start = sim.net.now();
+
+        // Submit transactions to random peers at a steady rate
+        // until every peer has built its ledgers.
+        auto const done = [&]
+        {
+            return std::all_of(sim.peers.begin(), sim.peers.end(),
+                [](Peer const& p)
+                {
+                    return p.completedLedgers >= p.targetLedgers;
+                });
+        };
+        Tx::ID nextTx = 0;
+        std::uniform_int_distribution<std::size_t> pick(
+            0, sim.peers.size() - 1);
+        std::function<void()> submit;
+        if (params.rate > 0)
+        {
+            auto const interval = duration_cast<nanoseconds>(
+                duration<double>(1.0 / params.rate));
+            submit = [&, interval]
+            {
+                if (done())
+                    return;
+                sim.peers[pick(rng)].submit(Tx{nextTx++});
+                sim.net.timer(interval, submit);
+            };
+            sim.net.timer(interval, submit);
+        }
+
+        sim.run(params.ledgers);
+
+        std::vector<double> roundTimes;
+        std::vector<double> intervals;
+        std::vector<double> positions;
+        std::size_t messages = 0;
+        std::size_t movedOn = 0;
+        std::map<std::uint32_t, std::set<Ledger::ID>> bySeq;
+        for (auto const& p : sim.peers)
+        {
+            messages += p.messagesSent;
+            auto last = start;
+            for (auto const& a : p.accepted)
+            {
+                roundTimes.push_back(a.roundTime.count());
+                intervals.push_back(
+                    duration_cast<milliseconds>(a.when - last).count());
+                last = a.when;
+                if (a.proposeSeq != Proposal::seqLeave)
+                    positions.push_back(a.proposeSeq);
+                if (a.state == ConsensusState::MovedOn)
+                    ++movedOn;
+                bySeq[a.ledger.seq].insert(a.ledger);
+            }
+        }
+        std::size_t forks = 0;
+        for (auto const& seq : bySeq)
+            if (seq.second.size() > 1)
+                ++forks;
+
+        auto const elapsed = duration_cast<milliseconds>(
+            sim.net.now() - start);
+        Json::Value ret(Json::objectValue);
+        ret["peers"] = params.peers;
+        ret["delay_ms"] = static_cast<Json::Int>(params.delay.count());
+        ret["tx_rate"] = params.rate;
+        ret["overlap"] = params.overlap;
+        ret["ledgers"] = params.ledgers;
+        ret["transactions"] = nextTx;
+        ret["elapsed_ms"] = static_cast<Json::Int>(elapsed.count());
+        ret["round_ms"] = distribution(std::move(roundTimes));
+        ret["close_interval_ms"] = distribution(std::move(intervals));
+        ret["position_changes"] = distribution(std::move(positions));
+        ret["messages"] = static_cast<Json::UInt>(messages);
+        ret["messages_per_ledger"] =
+            static_cast<double>(messages) / params.ledgers;
+        ret["moved_on"] = static_cast<Json::UInt>(movedOn);
+        ret["forked_ledgers"] = static_cast<Json::UInt>(forks);
+        return ret;
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono;
+
+        std::map<std::string, std::string> args = {
+            {"peers", "10,50,100,250,500"},
+            {"delay", "50,250,1000"},
+            {"rate", "1,10"},
+            {"overlap", "1.0,0.8,0.6"},
+            {"ledgers", "10"}};
+        std::vector<std::string> overrides;
+        boost::split(overrides, arg(), boost::algorithm::is_any_of(";"));
+        for (auto const& o : overrides)
+        {
+            auto const eq = o.find('=');
+            if (eq == std::string::npos)
+                continue;
+            auto const key = boost::trim_copy(o.substr(0, eq));
+            if (args.find(key) == args.end())
+            {
+                fail("unknown parameter " + key);
+                return;
+            }
+            args[key] = o.substr(eq + 1);
+        }
+
+        Json::FastWriter writer;
+        for (auto const peers : parseList<int>(args["peers"]))
+        for (auto const delay : parseList<int>(args["delay"]))
+        for (auto const rate : parseList<double>(args["rate"]))
+        for (auto const overlap : parseList<double>(args["overlap"]))
+        for (auto const ledgers : parseList<int>(args["ledgers"]))
+        {
+            auto const result = simulate({peers,
+                milliseconds{delay}, rate, overlap, ledgers});
+            log << writer.write(result) << std::endl;
+            pass();
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(ConsensusBenchmark, consensus, casinocoin);
+
+}  // test
+}  // casinocoin
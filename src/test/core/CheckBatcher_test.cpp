@@ -0,0 +1,191 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <casinocoin/core/CheckBatcher.h>
+#include <casinocoin/core/PerfLog.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/beast/insight/NullCollector.h>
+#include <casinocoin/beast/unit_test.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace casinocoin {
+
+class CheckBatcher_test : public beast::unit_test::suite
+{
+    // Records dispatches in the order they happen
+    class Dispatched
+    {
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::vector <std::pair <int, bool>> results_;
+
+    public:
+        CheckBatcher::Dispatch
+        make (int id)
+        {
+            return [this, id] (bool valid)
+            {
+                std::lock_guard <std::mutex> lock (mutex_);
+                results_.emplace_back (id, valid);
+                cond_.notify_all ();
+            };
+        }
+
+        std::vector <std::pair <int, bool>>
+        wait (std::size_t count)
+        {
+            std::unique_lock <std::mutex> lock (mutex_);
+            cond_.wait_for (lock, std::chrono::seconds (30),
+                [&] { return results_.size () >= count; });
+            return results_;
+        }
+    };
+
+    void
+    testResults (JobQueue& jobQueue)
+    {
+        testcase ("results");
+
+        auto batcher = std::make_shared <CheckBatcher> (jobQueue, 4);
+        Dispatched dispatched;
+        int const count = 1000;
+        for (int i = 0; i < count; ++i)
+        {
+            batcher->add (i % 3 == 0 ? jtPROPOSAL_t : jtPROPOSAL_ut,
+                [i] { return i % 2 == 0; }, dispatched.make (i));
+        }
+
+        auto const results = dispatched.wait (count);
+        BEAST_EXPECT(results.size () == count);
+        std::vector <int> seen (count, 0);
+        for (auto const& r : results)
+        {
+            ++seen[r.first];
+            BEAST_EXPECT(r.second == (r.first % 2 == 0));
+        }
+        BEAST_EXPECT(std::all_of (seen.begin (), seen.end (),
+            [](int n) { return n == 1; }));
+    }
+
+    void
+    testTrusted (JobQueue& jobQueue)
+    {
+        testcase ("trusted not delayed");
+
+        auto batcher = std::make_shared <CheckBatcher> (jobQueue, 1);
+        Dispatched dispatched;
+
+        // Both workers are held so the checks are all queued
+        // before any batch job runs
+        std::promise <void> release;
+        auto released = release.get_future ().share ();
+        std::vector <std::promise <void>> holding (2);
+        for (auto& held : holding)
+        {
+            jobQueue.addJob (jtCLIENT, "hold",
+                [&held, released] (Job&)
+                {
+                    held.set_value ();
+                    released.wait ();
+                });
+        }
+        for (auto& held : holding)
+            held.get_future ().wait ();
+
+        // A slow untrusted check, then a trusted one
+        std::promise <void> started;
+        std::promise <void> gate;
+        auto opened = gate.get_future ().share ();
+        batcher->add (jtVALIDATION_ut,
+            [&started, opened]
+            {
+                started.set_value ();
+                opened.wait ();
+                return true;
+            },
+            dispatched.make (0));
+        batcher->add (jtVALIDATION_t,
+            [] { return false; }, dispatched.make (1));
+        release.set_value ();
+
+        // The trusted result doesn't wait for the untrusted check
+        started.get_future ().wait ();
+        auto results = dispatched.wait (1);
+        std::vector <std::pair <int, bool>> expected {{1, false}};
+        BEAST_EXPECT(results == expected);
+
+        gate.set_value ();
+        results = dispatched.wait (2);
+        expected.emplace_back (0, true);
+        BEAST_EXPECT(results == expected);
+    }
+
+    void
+    testException (JobQueue& jobQueue)
+    {
+        testcase ("exception");
+
+        auto batcher = std::make_shared <CheckBatcher> (jobQueue, 4);
+        Dispatched dispatched;
+        batcher->add (jtCLIENT,
+            [] () -> bool { Throw<std::runtime_error> ("bad"); return true; },
+            dispatched.make (0));
+        batcher->add (jtCLIENT,
+            [] { return true; }, dispatched.make (1));
+
+        // They may run in separate batches, in either order
+        auto results = dispatched.wait (2);
+        std::sort (results.begin (), results.end ());
+        std::vector <std::pair <int, bool>> const expected {
+            {0, false}, {1, true}};
+        BEAST_EXPECT(results == expected);
+    }
+
+public:
+    void
+    run () override
+    {
+        Logs logs {beast::severities::kError};
+        RootStoppable root {"root"};
+        auto perfLog = perf::make_PerfLog ({}, root, logs.journal ("PerfLog"));
+        JobQueue jobQueue (beast::insight::NullCollector::New (),
+            root, logs.journal ("JobQueue"), logs, *perfLog);
+        jobQueue.setThreadCount (2, false);
+        root.prepare ();
+        root.start ();
+
+        testResults (jobQueue);
+        testTrusted (jobQueue);
+        testException (jobQueue);
+
+        root.stop (logs.journal ("JobQueue"));
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(CheckBatcher,core,ripple);
+
+}
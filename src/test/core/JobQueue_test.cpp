@@ -0,0 +1,363 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/core/JobQueue.h>
+#include <casinocoin/core/PerfLog.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/beast/insight/NullCollector.h>
+#include <casinocoin/beast/unit_test.h>
+#include <casinocoin/json/json_value.h>
+#include <casinocoin/json/json_writer.h>
+#include <boost/lexical_cast.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace casinocoin {
+
+// Runs a JobQueue with its own root for the duration of a test
+class TestJobQueue
+{
+    Logs logs_ {beast::severities::kError};
+    RootStoppable root_ {"root"};
+    std::unique_ptr <perf::PerfLog> perfLog_;
+
+public:
+    JobQueue jobQueue;
+
+    explicit
+    TestJobQueue (int threads)
+        : perfLog_ (perf::make_PerfLog ({}, root_, logs_.journal ("PerfLog")))
+        , jobQueue (beast::insight::NullCollector::New (),
+            root_, logs_.journal ("JobQueue"), logs_, *perfLog_)
+    {
+        jobQueue.setThreadCount (threads, false);
+        root_.prepare ();
+        root_.start ();
+    }
+
+    ~TestJobQueue ()
+    {
+        root_.stop (logs_.journal ("JobQueue"));
+    }
+};
+
+// Holds jobs running on the queue until it is opened
+class Gate
+{
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+
+public:
+    void
+    wait ()
+    {
+        std::unique_lock <std::mutex> lock (mutex_);
+        cv_.wait (lock, [this] { return open_; });
+    }
+
+    void
+    open ()
+    {
+        std::lock_guard <std::mutex> lock (mutex_);
+        open_ = true;
+        cv_.notify_all ();
+    }
+};
+
+class JobQueue_test : public beast::unit_test::suite
+{
+    void
+    testPriority ()
+    {
+        testcase ("priority order");
+
+        TestJobQueue q (1);
+        Gate started;
+        Gate gate;
+        std::mutex mutex;
+        std::vector <std::pair <JobType, int>> order;
+
+        // Keep the only thread busy while the jobs are added
+        q.jobQueue.addJob (jtCLIENT, "gate",
+            [&](Job&)
+            {
+                started.open ();
+                gate.wait ();
+            });
+        started.wait ();
+
+        for (int i = 0; i < 3; ++i)
+        {
+            for (auto const type : {jtPACK, jtTRANSACTION, jtADMIN, jtCLIENT})
+            {
+                q.jobQueue.addJob (type, "order",
+                    [&, type, i](Job&)
+                    {
+                        std::lock_guard <std::mutex> lock (mutex);
+                        order.emplace_back (type, i);
+                    });
+            }
+        }
+        BEAST_EXPECT(q.jobQueue.getJobCount (jtTRANSACTION) == 3);
+        BEAST_EXPECT(q.jobQueue.getJobCountGE (jtTRANSACTION) == 6);
+
+        gate.open ();
+        q.jobQueue.rendezvous ();
+
+        // Higher types first, and each type in the order added
+        std::vector <std::pair <JobType, int>> expected;
+        for (auto const type : {jtADMIN, jtTRANSACTION, jtCLIENT, jtPACK})
+            for (int i = 0; i < 3; ++i)
+                expected.emplace_back (type, i);
+        BEAST_EXPECT(order == expected);
+        BEAST_EXPECT(q.jobQueue.getJobCountTotal (jtTRANSACTION) == 0);
+    }
+
+    void
+    testLimit ()
+    {
+        testcase ("job limit");
+
+        // jtPUBOLDLEDGER may only run two at a time
+        TestJobQueue q (8);
+        Gate gate;
+        std::atomic <int> running {0};
+        std::atomic <int> peak {0};
+        std::atomic <int> others {0};
+
+        for (int i = 0; i < 6; ++i)
+        {
+            q.jobQueue.addJob (jtPUBOLDLEDGER, "limited",
+                [&](Job&)
+                {
+                    auto const n = ++running;
+                    for (auto p = peak.load ();
+                        n > p && ! peak.compare_exchange_weak (p, n);)
+                    {
+                    }
+                    gate.wait ();
+                    --running;
+                });
+        }
+
+        // Other types still run while the limited ones wait
+        for (int i = 0; i < 10; ++i)
+            q.jobQueue.addJob (jtCLIENT, "other", [&](Job&) { ++others; });
+
+        using namespace std::chrono_literals;
+        auto const start = std::chrono::steady_clock::now ();
+        while (others < 10 &&
+            std::chrono::steady_clock::now () - start < 10s)
+        {
+            std::this_thread::sleep_for (1ms);
+        }
+        BEAST_EXPECT(others == 10);
+        BEAST_EXPECT(q.jobQueue.getJobCountTotal (jtPUBOLDLEDGER) == 6);
+        BEAST_EXPECT(q.jobQueue.getJobCount (jtPUBOLDLEDGER) == 4);
+
+        gate.open ();
+        q.jobQueue.rendezvous ();
+        BEAST_EXPECT(peak == 2);
+        BEAST_EXPECT(q.jobQueue.getJobCountTotal (jtPUBOLDLEDGER) == 0);
+    }
+
+    void
+    testStoreLedger ()
+    {
+        testcase ("store ledger order");
+
+        // Ledgers are stored one at a time, in the order added
+        TestJobQueue q (8);
+        std::mutex mutex;
+        std::vector <int> order;
+        std::atomic <int> running {0};
+        std::atomic <int> peak {0};
+
+        for (int i = 0; i < 20; ++i)
+        {
+            q.jobQueue.addJob (jtSTORE_LEDGER, "storeLedger",
+                [&, i](Job&)
+                {
+                    auto const n = ++running;
+                    for (auto p = peak.load ();
+                        n > p && ! peak.compare_exchange_weak (p, n);)
+                    {
+                    }
+                    {
+                        std::lock_guard <std::mutex> lock (mutex);
+                        order.push_back (i);
+                    }
+                    std::this_thread::sleep_for (
+                        std::chrono::milliseconds (1));
+                    --running;
+                });
+        }
+        q.jobQueue.rendezvous ();
+
+        std::vector <int> expected (20);
+        std::iota (expected.begin (), expected.end (), 0);
+        BEAST_EXPECT(order == expected);
+        BEAST_EXPECT(peak == 1);
+    }
+
+    void
+    testConcurrentAdd ()
+    {
+        testcase ("concurrent add");
+
+        TestJobQueue q (4);
+        std::atomic <int> done {0};
+        int const perThread = 2000;
+        JobType const types[] = {jtCLIENT, jtRPC, jtTRANSACTION, jtWRITE};
+
+        // Jobs add more jobs while other threads add them too
+        std::vector <std::thread> threads;
+        for (auto const type : types)
+        {
+            threads.emplace_back (
+                [&, type]
+                {
+                    for (int i = 0; i < perThread; ++i)
+                    {
+                        q.jobQueue.addJob (type, "add",
+                            [&, type](Job&)
+                            {
+                                q.jobQueue.addJob (type, "nested",
+                                    [&](Job&) { ++done; });
+                            });
+                    }
+                });
+        }
+        for (auto& t : threads)
+            t.join ();
+
+        using namespace std::chrono_literals;
+        auto const start = std::chrono::steady_clock::now ();
+        while (done < 4 * perThread &&
+            std::chrono::steady_clock::now () - start < 30s)
+        {
+            std::this_thread::sleep_for (1ms);
+        }
+        q.jobQueue.rendezvous ();
+        BEAST_EXPECT(done == 4 * perThread);
+        BEAST_EXPECT(q.jobQueue.getJobCountGE (jtPACK) == 0);
+    }
+
+public:
+    void
+    run () override
+    {
+        testPriority ();
+        testLimit ();
+        testStoreLedger ();
+        testConcurrentAdd ();
+    }
+};
+
+/** Measure how many jobs per second the JobQueue runs.
+
+    For each thread count, producer threads add trivial jobs spread
+    over several job types, and the time until every job has run is
+    measured. One JSON object is written per line. The thread counts
+    may be given with the suite argument, for example "1,2,4,8".
+*/
+class JobQueueBenchmark_test : public beast::unit_test::suite
+{
+    Json::Value
+    measure (int threads, int producers, int jobsPerProducer)
+    {
+        using namespace std::chrono;
+
+        TestJobQueue q (threads);
+        JobType const types[] = {jtCLIENT, jtRPC, jtTRANSACTION,
+            jtVALIDATION_t, jtPROPOSAL_t, jtWRITE};
+        std::atomic <std::uint64_t> sum {0};
+
+        auto const start = steady_clock::now ();
+        std::vector <std::thread> workers;
+        for (int p = 0; p < producers; ++p)
+        {
+            workers.emplace_back (
+                [&, p]
+                {
+                    for (int i = 0; i < jobsPerProducer; ++i)
+                    {
+                        q.jobQueue.addJob (
+                            types[(p + i) % std::extent<decltype(types)>::value],
+                            "bench", [&sum, i](Job&) { sum += i; });
+                    }
+                });
+        }
+        for (auto& w : workers)
+            w.join ();
+        q.jobQueue.rendezvous ();
+        auto const elapsed = duration_cast <duration <double>> (
+            steady_clock::now () - start);
+
+        auto const jobs = producers * jobsPerProducer;
+        BEAST_EXPECT(sum == static_cast <std::uint64_t> (producers) *
+            jobsPerProducer * (jobsPerProducer - 1) / 2);
+
+        Json::Value ret (Json::objectValue);
+        ret["threads"] = threads;
+        ret["producers"] = producers;
+        ret["jobs"] = jobs;
+        ret["seconds"] = elapsed.count ();
+        ret["jobs_per_second"] = jobs / elapsed.count ();
+        return ret;
+    }
+
+public:
+    void
+    run () override
+    {
+        std::vector <int> counts;
+        std::string s = arg ();
+        while (! s.empty ())
+        {
+            auto const comma = s.find (',');
+            counts.push_back (boost::lexical_cast <int> (s.substr (0, comma)));
+            s = comma == std::string::npos ? "" : s.substr (comma + 1);
+        }
+        if (counts.empty ())
+        {
+            auto const hw = std::max (1,
+                static_cast <int> (std::thread::hardware_concurrency ()));
+            for (int n = 1; n < 2 * hw; n *= 2)
+                counts.push_back (n);
+            counts.push_back (2 * hw);
+        }
+
+        Json::FastWriter writer;
+        for (auto const threads : counts)
+            log << writer.write (measure (threads, 4, 100000)) << std::endl;
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(JobQueue,core,ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(JobQueueBenchmark,core,ripple);
+
+}
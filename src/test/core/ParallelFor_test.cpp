@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/core/ParallelFor.h>
+#include <casinocoin/core/PerfLog.h>
+#include <casinocoin/basics/contract.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/beast/insight/NullCollector.h>
+#include <casinocoin/beast/unit_test.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace casinocoin {
+
+class ParallelFor_test : public beast::unit_test::suite
+{
+    void
+    testEachIndex (JobQueue& jobQueue)
+    {
+        testcase ("each index once");
+
+        std::size_t const count = 1000;
+        std::vector <std::atomic <int>> calls (count);
+        for (auto& c : calls)
+            c = 0;
+        std::atomic <std::size_t> sum {0};
+
+        parallelFor (jobQueue, jtCLIENT, 4, count,
+            [&](std::size_t i)
+            {
+                ++calls[i];
+                sum += i;
+            });
+
+        BEAST_EXPECT(sum == count * (count - 1) / 2);
+        BEAST_EXPECT(std::all_of (calls.begin (), calls.end (),
+            [](std::atomic <int> const& c) { return c == 1; }));
+    }
+
+    void
+    testSingleThread (JobQueue& jobQueue)
+    {
+        testcase ("single thread");
+
+        // Without helpers the indexes are done in order by the caller
+        auto const caller = std::this_thread::get_id ();
+        std::vector <std::size_t> order;
+        bool sameThread = true;
+        parallelFor (jobQueue, jtCLIENT, 1, 10,
+            [&](std::size_t i)
+            {
+                sameThread = sameThread &&
+                    std::this_thread::get_id () == caller;
+                order.push_back (i);
+            });
+        BEAST_EXPECT(sameThread);
+        BEAST_EXPECT(order.size () == 10);
+        BEAST_EXPECT(std::is_sorted (order.begin (), order.end ()));
+
+        parallelFor (jobQueue, jtCLIENT, 4, 0,
+            [&](std::size_t) { fail ("called without indexes"); });
+    }
+
+    void
+    testException (JobQueue& jobQueue)
+    {
+        testcase ("exception");
+
+        std::atomic <int> calls {0};
+        try
+        {
+            parallelFor (jobQueue, jtCLIENT, 4, 100,
+                [&](std::size_t i)
+                {
+                    ++calls;
+                    if (i == 42)
+                        Throw<std::runtime_error> ("index 42");
+                });
+            fail ("no exception");
+        }
+        catch (std::runtime_error const& e)
+        {
+            BEAST_EXPECT(e.what () == std::string ("index 42"));
+        }
+
+        // The other indexes are still done
+        BEAST_EXPECT(calls == 100);
+    }
+
+public:
+    void
+    run () override
+    {
+        Logs logs {beast::severities::kError};
+        RootStoppable root {"root"};
+        auto perfLog = perf::make_PerfLog ({}, root, logs.journal ("PerfLog"));
+        JobQueue jobQueue (beast::insight::NullCollector::New (),
+            root, logs.journal ("JobQueue"), logs, *perfLog);
+        jobQueue.setThreadCount (4, false);
+        root.prepare ();
+        root.start ();
+
+        testEachIndex (jobQueue);
+        testSingleThread (jobQueue);
+        testException (jobQueue);
+
+        root.stop (logs.journal ("JobQueue"));
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ParallelFor,core,ripple);
+
+}
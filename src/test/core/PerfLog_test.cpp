@@ -0,0 +1,236 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/core/impl/PerfLogImp.h>
+#include <casinocoin/core/JobQueue.h>
+#include <casinocoin/basics/Log.h>
+#include <casinocoin/json/json_reader.h>
+#include <casinocoin/beast/insight/NullCollector.h>
+#include <casinocoin/beast/unit_test.h>
+#include <casinocoin/beast/utility/temp_dir.h>
+#include <boost/filesystem/fstream.hpp>
+#include <thread>
+
+namespace casinocoin {
+namespace perf {
+
+class PerfLog_test : public beast::unit_test::suite
+{
+    void
+    testBuckets ()
+    {
+        testcase ("buckets");
+
+        // Small values are exact
+        for (std::uint64_t v = 0; v < 16; ++v)
+        {
+            BEAST_EXPECT(Histogram::bucket (v) == v);
+            BEAST_EXPECT(Histogram::highestInBucket (v) == v);
+        }
+
+        // Every value lies in its bucket, which is at most
+        // 1/16th of the value wide.
+        for (std::uint64_t v = 16; v < (1 << 20); v = v * 5 / 4 + 1)
+        {
+            auto const b = Histogram::bucket (v);
+            auto const high = Histogram::highestInBucket (b);
+            BEAST_EXPECT(v <= high);
+            BEAST_EXPECT(b == 0 || Histogram::highestInBucket (b - 1) < v);
+            BEAST_EXPECT(high - v < v / 16 + 1);
+        }
+        BEAST_EXPECT(Histogram::bucket (31) + 1 == Histogram::bucket (32));
+
+        // Huge values share the last bucket
+        BEAST_EXPECT(Histogram::bucket (std::uint64_t (1) << 50) ==
+            Histogram::buckets - 1);
+        BEAST_EXPECT(Histogram::bucket (
+            std::numeric_limits <std::uint64_t>::max ()) ==
+                Histogram::buckets - 1);
+    }
+
+    void
+    testPercentiles ()
+    {
+        testcase ("percentiles");
+
+        Histogram h;
+        BEAST_EXPECT(h.percentile (50) == 0);
+        BEAST_EXPECT(h.getJson ()["count"] == "0");
+
+        for (std::uint64_t v = 1; v <= 1000; ++v)
+            h.insert (v);
+        BEAST_EXPECT(h.count () == 1000);
+        BEAST_EXPECT(h.max () == 1000);
+
+        auto const near = [](std::uint64_t got, std::uint64_t want)
+        {
+            return got >= want && got - want <= want / 16;
+        };
+        BEAST_EXPECT(near (h.percentile (50), 500));
+        BEAST_EXPECT(near (h.percentile (90), 900));
+        BEAST_EXPECT(near (h.percentile (99), 990));
+        BEAST_EXPECT(h.percentile (100) == 1000);
+
+        auto const jv = h.getJson ();
+        BEAST_EXPECT(jv["count"] == "1000");
+        BEAST_EXPECT(jv["avg_us"] == "500");
+        BEAST_EXPECT(jv["max_us"] == "1000");
+    }
+
+    void
+    testCounters ()
+    {
+        testcase ("counters");
+
+        using namespace std::chrono;
+
+        RootStoppable root {"root"};
+        PerfLogImp log ({}, root, beast::Journal{});
+
+        log.jobFinish (jtCLIENT, microseconds (100), microseconds (2000));
+        log.jobFinish (jtCLIENT, microseconds (300), microseconds (4000));
+        log.rpcFinish ("ledger", microseconds (50), microseconds (700), false);
+        log.rpcFinish ("ledger", microseconds (0), microseconds (900), true);
+
+        auto const jv = log.countersJson ();
+
+        // Only job types which ran are reported
+        BEAST_EXPECT(jv["jobs"].size () == 1);
+        auto const& client = jv["jobs"]["clientCommand"];
+        BEAST_EXPECT(client["queued"]["count"] == "2");
+        BEAST_EXPECT(client["queued"]["max_us"] == "300");
+        BEAST_EXPECT(client["running"]["max_us"] == "4000");
+        BEAST_EXPECT(! client.isMember ("failed"));
+
+        // An unknown wait is not counted as a wait
+        auto const& ledger = jv["rpc"]["ledger"];
+        BEAST_EXPECT(ledger["queued"]["count"] == "1");
+        BEAST_EXPECT(ledger["running"]["count"] == "2");
+        BEAST_EXPECT(ledger["running"]["max_us"] == "900");
+        BEAST_EXPECT(ledger["failed"] == "1");
+    }
+
+    void
+    testJobQueue ()
+    {
+        testcase ("job queue");
+
+        Logs logs {beast::severities::kError};
+        RootStoppable root {"root"};
+        PerfLogImp log ({}, root, beast::Journal{});
+        JobQueue jobQueue (beast::insight::NullCollector::New (),
+            root, logs.journal ("JobQueue"), logs, log);
+        jobQueue.setThreadCount (2, false);
+        root.prepare ();
+        root.start ();
+
+        for (int i = 0; i < 10; ++i)
+        {
+            jobQueue.addJob (jtRPC, "perf",
+                [](Job&)
+                {
+                    std::this_thread::sleep_for (
+                        std::chrono::milliseconds (1));
+                });
+        }
+        jobQueue.rendezvous ();
+
+        auto const jv = log.countersJson ();
+        BEAST_EXPECT(jv["jobs"]["RPC"]["running"]["count"] == "10");
+        BEAST_EXPECT(std::stoull (
+            jv["jobs"]["RPC"]["running"]["p50_us"].asString ()) >= 1000);
+
+        root.stop (logs.journal ("JobQueue"));
+    }
+
+    void
+    testFile ()
+    {
+        testcase ("file");
+
+        using namespace std::chrono;
+
+        beast::temp_dir dir;
+
+        Section section;
+        section.set ("perf_log", "perf/perf.log");
+        auto setup = setup_PerfLog (section, dir.path ());
+        BEAST_EXPECT(setup.perfLog ==
+            boost::filesystem::path (dir.path ()) / "perf" / "perf.log");
+        BEAST_EXPECT(setup.logInterval == seconds (10));
+
+        setup.logInterval = milliseconds (10);
+        {
+            RootStoppable root {"root"};
+            PerfLogImp log (setup, root, beast::Journal{});
+            root.prepare ();
+            root.start ();
+            log.rpcFinish ("ping", microseconds (5), microseconds (10), false);
+            std::this_thread::sleep_for (milliseconds (50));
+            root.stop (beast::Journal{});
+        }
+
+        // Every line is a complete object, the last
+        // written when the log stopped.
+        boost::filesystem::ifstream in (setup.perfLog);
+        std::string line;
+        int lines = 0;
+        Json::Value last;
+        while (std::getline (in, line))
+        {
+            ++lines;
+            BEAST_EXPECT(Json::Reader ().parse (line, last));
+        }
+        BEAST_EXPECT(lines >= 2);
+        BEAST_EXPECT(last.isMember ("time"));
+        BEAST_EXPECT(last["rpc"]["ping"]["running"]["count"] == "1");
+
+        boost::filesystem::remove_all (
+            boost::filesystem::path (dir.path ()) / "perf");
+
+        Section bad;
+        bad.set ("log_interval", "0");
+        try
+        {
+            setup_PerfLog (bad, dir.path ());
+            fail ("no exception");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testBuckets ();
+        testPercentiles ();
+        testCounters ();
+        testJobQueue ();
+        testFile ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(PerfLog,core,ripple);
+
+}
+}
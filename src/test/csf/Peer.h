@@ -172,6 +172,26 @@ struct Peer : public Consensus<Peer, Traits>
     bool validating_ = true;
     bool proposing_ = true;
 
+    //! Summary of a consensus round which ended with us accepting a ledger
+    struct AcceptStats
+    {
+        Ledger::ID ledger;
+        //! Network time when the ledger was accepted
+        BasicNetwork<Peer*>::time_point when;
+        //! Duration of the establish phase
+        std::chrono::milliseconds roundTime;
+        //! Number of times we changed our position
+        std::uint32_t proposeSeq;
+        ConsensusState state;
+        std::size_t proposers;
+    };
+
+    //! Ledgers this peer accepted, in order
+    std::vector<AcceptStats> accepted;
+
+    //! Number of messages this peer has sent to the network
+    std::size_t messagesSent = 0;
+
     //! All peers start from the default constructed ledger
     Peer(PeerID i, BasicNetwork<Peer*>& n, UNL const& u)
         : Consensus<Peer, Traits>(n.clock(), beast::Journal{})
@@ -284,6 +304,13 @@ struct Peer : public Consensus<Peer, Traits>
             result.position.closeTime() != NetClock::time_point{});
         ledgers[newLedger.id()] = newLedger;
 
+        accepted.push_back(AcceptStats{newLedger.id(),
+                                       net.now(),
+                                       prevRoundTime(),
+                                       result.position.proposeSeq(),
+                                       result.state,
+                                       prevProposers()});
+
         lastClosedLedger = newLedger;
 
         auto it =
@@ -377,8 +404,11 @@ struct Peer : public Consensus<Peer, Traits>
     relay(T const& t)
     {
         for (auto const& link : net.links(this))
+        {
             net.send(
                 this, link.to, [ msg = t, to = link.to ] { to->receive(msg); });
+            ++messagesSent;
+        }
     }
 
     // Receive and relay locally submitted transaction
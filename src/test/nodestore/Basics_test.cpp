@@ -23,6 +23,10 @@
 #include <casinocoin/nodestore/Manager.h>
 #include <casinocoin/nodestore/impl/DecodedBlob.h>
 #include <casinocoin/nodestore/impl/EncodedBlob.h>
+#include <casinocoin/nodestore/impl/Tuning.h>
+#include <casinocoin/nodestore/impl/codec.h>
+#include <casinocoin/beast/utility/temp_dir.h>
+#include <nudb/detail/buffer.hpp>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -77,6 +81,151 @@ public:
         }
     }
 
+    // Checks compressing blobs with trained dictionaries
+    void testDictionaries (std::uint64_t const seedValue)
+    {
+        testcase ("dictionaries");
+
+        beast::temp_dir tempDir;
+        auto const dir =
+            boost::filesystem::path (tempDir.path ()) / "dictionaries";
+        auto const batch = createLedgerLikeBatch (20000, seedValue);
+
+        // Returns `true` if a compressed blob decodes to the original
+        auto decodes = [](Blob const& packed, EncodedBlob const& encoded,
+            DictionaryCodec const* codec)
+        {
+            nudb::detail::buffer bf;
+            auto const result = nodeobject_decompress (
+                packed.data (), packed.size (), bf, codec);
+            return result.second == encoded.getSize () &&
+                std::memcmp (result.first, encoded.getData (),
+                    result.second) == 0;
+        };
+
+        DummyScheduler scheduler;
+        std::vector<Blob> packed;
+        int withDictionary = 0;
+        {
+            DictionaryCodec codec (dir, true, dictionarySize, scheduler,
+                beast::Journal{});
+            EncodedBlob encoded;
+            for (auto const& object : batch)
+            {
+                encoded.prepare (object);
+                nudb::detail::buffer bf;
+                auto const result = nodeobject_compress (
+                    encoded.getData (), encoded.getSize (), bf, &codec);
+                auto const p = static_cast<std::uint8_t const*> (result.first);
+                packed.emplace_back (p, p + result.second);
+                if (packed.back ()[0] == DictionaryCodec::codecType)
+                    ++withDictionary;
+                BEAST_EXPECT(decodes (packed.back (), encoded, &codec));
+            }
+        }
+        // Both types got a dictionary once they had enough samples
+        BEAST_EXPECT(withDictionary > batch.size () / 4);
+
+        // The dictionaries are loaded again to read the objects
+        DictionaryCodec codec (dir, false, dictionarySize, scheduler,
+            beast::Journal{});
+        EncodedBlob encoded;
+        bool all = true;
+        for (std::size_t i = 0; i < batch.size (); ++i)
+        {
+            encoded.prepare (batch[i]);
+            all = all && decodes (packed[i], encoded, &codec);
+        }
+        BEAST_EXPECT(all);
+
+        // Without them the objects can't be read
+        auto const i = std::distance (packed.begin (), std::find_if (
+            packed.begin (), packed.end (), [](Blob const& b)
+            {
+                return b[0] == DictionaryCodec::codecType;
+            }));
+        encoded.prepare (batch[i]);
+        try
+        {
+            decodes (packed[i], encoded, nullptr);
+            fail ();
+        }
+        catch (std::runtime_error const&)
+        {
+            pass ();
+        }
+    }
+
+    // Checks that training waits for the scheduler
+    void testTraining (std::uint64_t const seedValue)
+    {
+        testcase ("dictionary training");
+
+        // Holds tasks until asked to run them
+        struct ManualScheduler : DummyScheduler
+        {
+            std::vector<Task*> tasks;
+
+            void
+            scheduleTask (Task& task) override
+            {
+                tasks.push_back (&task);
+            }
+
+            void
+            run ()
+            {
+                auto const pending = std::move (tasks);
+                tasks.clear ();
+                for (auto task : pending)
+                    task->performScheduledTask ();
+            }
+        };
+
+        beast::temp_dir tempDir;
+        auto const dir =
+            boost::filesystem::path (tempDir.path ()) / "dictionaries";
+        auto const batch = createLedgerLikeBatch (20000, seedValue);
+
+        ManualScheduler scheduler;
+        DictionaryCodec codec (dir, true, dictionarySize, scheduler,
+            beast::Journal{});
+
+        // Returns `true` if the object was compressed with a dictionary
+        EncodedBlob encoded;
+        auto compress = [&](std::shared_ptr<NodeObject> const& object)
+        {
+            encoded.prepare (object);
+            nudb::detail::buffer bf;
+            auto const result = nodeobject_compress (
+                encoded.getData (), encoded.getSize (), bf, &codec);
+            return static_cast<std::uint8_t const*> (
+                result.first)[0] == DictionaryCodec::codecType;
+        };
+
+        // Enough samples are taken, but nothing is trained
+        bool none = true;
+        for (auto const& object : batch)
+            none = none && ! compress (object);
+        BEAST_EXPECT(none);
+        BEAST_EXPECT(scheduler.tasks.size () == 1);
+        BEAST_EXPECT(! boost::filesystem::exists (dir));
+
+        // Once the task runs, the saved dictionaries are used
+        scheduler.run ();
+        BEAST_EXPECT(scheduler.tasks.empty ());
+        BEAST_EXPECT(boost::filesystem::exists (dir / "0.dict"));
+        BEAST_EXPECT(boost::filesystem::exists (dir / "1.dict"));
+        int withDictionary = 0;
+        for (auto const& object : batch)
+        {
+            if (compress (object))
+                ++withDictionary;
+        }
+        scheduler.run ();
+        BEAST_EXPECT(withDictionary > batch.size () / 4);
+    }
+
     void run ()
     {
         std::uint64_t const seedValue = 50;
@@ -84,6 +233,10 @@ public:
         testBatches (seedValue);
 
         testBlobs (seedValue);
+
+        testDictionaries (seedValue);
+
+        testTraining (seedValue);
     }
 };
 
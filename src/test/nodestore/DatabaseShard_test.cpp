@@ -0,0 +1,282 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <test/nodestore/TestBase.h>
+#include <casinocoin/nodestore/DummyScheduler.h>
+#include <casinocoin/nodestore/Manager.h>
+#include <casinocoin/basics/Slice.h>
+#include <casinocoin/protocol/digest.h>
+#include <casinocoin/beast/utility/temp_dir.h>
+
+namespace casinocoin {
+namespace NodeStore {
+
+class DatabaseShard_test : public TestBase
+{
+    static std::uint32_t const ledgersPerShard = 4;
+
+    DummyScheduler scheduler_;
+    RootStoppable parent_ {"TestRootStoppable"};
+
+    std::unique_ptr <DatabaseShard>
+    makeShardStore (beast::temp_dir const& dir, bool validate = false)
+    {
+        Section params;
+        params.set ("type", "nudb");
+        params.set ("path", dir.path());
+        params.set ("ledgers_per_shard", std::to_string (ledgersPerShard));
+        if (validate)
+            params.set ("validate", "1");
+        auto db = Manager::instance().make_DatabaseShard (
+            "test", scheduler_, 2, parent_, params, beast::Journal{});
+        BEAST_EXPECT(db->init ());
+        return db;
+    }
+
+    // The objects making up a ledger. Their keys are the hashes of
+    // their data, like those of real ledger entries.
+    static
+    Batch
+    makeLedger (std::uint32_t seq, bool corrupt = false)
+    {
+        Batch batch;
+        for (std::uint32_t i = 0; i < 3; ++i)
+        {
+            Blob data (32 + i, static_cast<std::uint8_t> (i));
+            std::memcpy (data.data (), &seq, sizeof (seq));
+            auto hash = sha512Half (makeSlice (data));
+            if (corrupt && i == 0)
+                hash = ~hash;
+            batch.push_back (NodeObject::createObject (
+                hotACCOUNT_NODE, std::move (data), hash));
+        }
+        return batch;
+    }
+
+    void
+    storeLedger (DatabaseShard& db, std::uint32_t seq, bool corrupt = false)
+    {
+        for (auto const& object : makeLedger (seq, corrupt))
+        {
+            Blob data (object->getData ());
+            BEAST_EXPECT(db.store (object->getType (),
+                std::move (data), object->getHash (), seq));
+        }
+        if (db.setStored (seq))
+        {
+            // Nothing more is wanted until the full shard is checked
+            BEAST_EXPECT(! db.prepare (seq + 2 * ledgersPerShard));
+            db.finalize ();
+        }
+    }
+
+    bool
+    hasLedgerObjects (DatabaseShard& db, std::uint32_t seq)
+    {
+        for (auto const& object : makeLedger (seq))
+        {
+            auto const fetched = db.fetch (object->getHash (), seq);
+            if (! fetched || ! isSame (fetched, object))
+                return false;
+        }
+        return true;
+    }
+
+    void
+    testFill ()
+    {
+        testcase ("fill shards");
+
+        beast::temp_dir dir;
+        {
+            auto db = makeShardStore (dir);
+            BEAST_EXPECT(db->getCompleteShards () == "empty");
+
+            // No shard ends before the first validated ledger
+            BEAST_EXPECT(! db->prepare (ledgersPerShard));
+
+            // Ledgers are requested from the end of a shard back
+            std::vector<std::uint32_t> requested;
+            while (auto const seq = db->prepare (2 * ledgersPerShard + 1))
+            {
+                requested.push_back (*seq);
+                storeLedger (*db, *seq);
+            }
+            BEAST_EXPECT(requested.size () == 2 * ledgersPerShard);
+            BEAST_EXPECT(db->seqToShardIndex (requested.front ()) !=
+                db->seqToShardIndex (requested.back ()));
+            BEAST_EXPECT(requested[0] == requested[1] + 1);
+            BEAST_EXPECT(db->getCompleteShards () == "0-1");
+
+            for (std::uint32_t seq = 1; seq <= 2 * ledgersPerShard; ++seq)
+            {
+                BEAST_EXPECT(db->hasLedger (seq));
+                BEAST_EXPECT(hasLedgerObjects (*db, seq));
+            }
+            BEAST_EXPECT(! db->hasLedger (2 * ledgersPerShard + 1));
+
+            // Objects are found without a ledger sequence too
+            auto& database = dynamic_cast <Database&> (*db);
+            auto const object = makeLedger (3)[1];
+            auto const fetched = database.fetch (object->getHash ());
+            BEAST_EXPECT(fetched && isSame (fetched, object));
+        }
+
+        // Complete shards are immutable and are reopened as such
+        {
+            auto db = makeShardStore (dir, true);
+            BEAST_EXPECT(db->getCompleteShards () == "0-1");
+            BEAST_EXPECT(hasLedgerObjects (*db, 1));
+            BEAST_EXPECT(! db->prepare (2 * ledgersPerShard + 1));
+        }
+    }
+
+    void
+    testResume ()
+    {
+        testcase ("resume filling");
+
+        beast::temp_dir dir;
+        std::uint32_t next;
+        {
+            auto db = makeShardStore (dir);
+            auto const seq = db->prepare (ledgersPerShard + 1);
+            if (! BEAST_EXPECT(seq && *seq == ledgersPerShard))
+                return;
+            storeLedger (*db, *seq);
+            next = *db->prepare (ledgersPerShard + 1);
+            BEAST_EXPECT(next == *seq - 1);
+        }
+
+        auto db = makeShardStore (dir);
+        BEAST_EXPECT(db->hasLedger (ledgersPerShard));
+        BEAST_EXPECT(! db->hasLedger (next));
+        BEAST_EXPECT(hasLedgerObjects (*db, ledgersPerShard));
+        auto const seq = db->prepare (ledgersPerShard + 1);
+        BEAST_EXPECT(seq && *seq == next);
+    }
+
+    void
+    testCorrupt ()
+    {
+        testcase ("reject corrupt shard");
+
+        beast::temp_dir dir;
+        auto db = makeShardStore (dir);
+        for (std::uint32_t i = 0; i < ledgersPerShard; ++i)
+        {
+            auto const seq = db->prepare (ledgersPerShard + 1);
+            if (! BEAST_EXPECT(seq))
+                return;
+            storeLedger (*db, *seq, *seq == 2);
+        }
+
+        // The shard failed to validate and was removed
+        BEAST_EXPECT(db->getCompleteShards () == "empty");
+        BEAST_EXPECT(! db->hasLedger (1));
+        BEAST_EXPECT(! boost::filesystem::exists (
+            boost::filesystem::path (dir.path ()) / "0"));
+    }
+
+    void
+    testAbandon ()
+    {
+        testcase ("abandon shard");
+
+        beast::temp_dir dir;
+        auto db = makeShardStore (dir);
+        auto const seq = db->prepare (2 * ledgersPerShard + 1);
+        if (! BEAST_EXPECT(seq))
+            return;
+        storeLedger (*db, *seq);
+        auto const index = db->seqToShardIndex (*seq);
+
+        // The other shard is filled instead
+        db->abandon ();
+        BEAST_EXPECT(! db->hasLedger (*seq));
+        BEAST_EXPECT(! boost::filesystem::exists (
+            boost::filesystem::path (dir.path ()) / std::to_string (index)));
+        auto const next = db->prepare (2 * ledgersPerShard + 1);
+        BEAST_EXPECT(next && db->seqToShardIndex (*next) != index);
+        storeLedger (*db, *next);
+
+        // Once that is given up on too, nothing is left to fill
+        db->abandon ();
+        BEAST_EXPECT(! db->prepare (2 * ledgersPerShard + 1));
+    }
+
+    void
+    testDatabase ()
+    {
+        testcase ("generic database");
+
+        // Ledgers loaded from the shards reach the store as a
+        // Database, which must not write or throw without a sequence
+        beast::temp_dir dir;
+        auto db = makeShardStore (dir);
+        auto const seq = db->prepare (ledgersPerShard + 1);
+        if (! BEAST_EXPECT(seq))
+            return;
+        auto& database = dynamic_cast <Database&> (*db);
+
+        auto const object = makeLedger (*seq)[0];
+        try
+        {
+            database.store (object->getType (),
+                Blob (object->getData ()), object->getHash ());
+            pass ();
+        }
+        catch (std::exception const&)
+        {
+            fail ("store without a ledger sequence threw");
+        }
+        BEAST_EXPECT(! db->fetch (object->getHash (), *seq));
+        BEAST_EXPECT(! database.fetch (object->getHash ()));
+
+        try
+        {
+            database.import (database, ImportOptions {});
+            pass ();
+        }
+        catch (std::exception const&)
+        {
+            fail ("import threw");
+        }
+
+        storeLedger (*db, *seq);
+        auto const fetched = database.fetch (object->getHash ());
+        BEAST_EXPECT(fetched && isSame (fetched, object));
+    }
+
+public:
+    void
+    run () override
+    {
+        testFill ();
+        testResume ();
+        testCorrupt ();
+        testAbandon ();
+        testDatabase ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(DatabaseShard,NodeStore,ripple);
+
+}
+}
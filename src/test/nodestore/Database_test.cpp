@@ -21,7 +21,13 @@
 #include <test/nodestore/TestBase.h>
 #include <casinocoin/nodestore/DummyScheduler.h>
 #include <casinocoin/nodestore/Manager.h>
+#include <casinocoin/basics/Slice.h>
+#include <casinocoin/protocol/digest.h>
 #include <casinocoin/beast/utility/temp_dir.h>
+#include <boost/filesystem/fstream.hpp>
+#include <chrono>
+#include <numeric>
+#include <thread>
 
 namespace casinocoin {
 namespace NodeStore {
@@ -72,8 +78,10 @@ public:
             testcase ("import into '" + destBackendType +
                 "' from '" + srcBackendType + "'");
 
-            // Do the import
-            dest->import (*src);
+            // Do the import. The test objects have random keys.
+            ImportOptions options;
+            options.verify = false;
+            dest->import (*src, options);
 
             // Get the results of the import
             fetchCopyOfBatch (*dest, &copy, batch);
@@ -85,6 +93,99 @@ public:
         BEAST_EXPECT(areBatchesEqual (batch, copy));
     }
 
+    // An interrupted import resumes from its checkpoint, leaving
+    // out objects which don't match their key.
+    void testImportResume (std::int64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+        RootStoppable parent ("TestRootStoppable");
+        beast::Journal j;
+
+        testcase ("resume import");
+
+        // Objects with real keys, and some without
+        Batch batch;
+        for (auto const& object : createLedgerLikeBatch (
+            numObjectsToTest, seedValue))
+        {
+            Blob data (object->getData ());
+            auto const hash = batch.size () % 100 == 0 ?
+                object->getHash () : sha512Half (makeSlice (data));
+            batch.push_back (NodeObject::createObject (
+                object->getType (), std::move (data), hash));
+        }
+
+        beast::temp_dir node_db;
+        Section srcParams;
+        srcParams.set ("type", "nudb");
+        srcParams.set ("path", node_db.path());
+        {
+            std::unique_ptr <Database> src = Manager::instance().make_Database (
+                "test", scheduler, 2, parent, srcParams, j);
+            storeBatch (*src, batch);
+        }
+        std::unique_ptr <Database> src = Manager::instance().make_Database (
+            "test", scheduler, 2, parent, srcParams, j);
+        Batch order;
+        src->for_each ([&](std::shared_ptr<NodeObject> object)
+        {
+            order.push_back (object);
+        });
+        if (! BEAST_EXPECT(order.size () == batch.size ()))
+            return;
+
+        beast::temp_dir dest_db;
+        Section destParams;
+        destParams.set ("type", "nudb");
+        destParams.set ("path", dest_db.path());
+        std::unique_ptr <Database> dest = Manager::instance().make_Database (
+            "test", scheduler, 2, parent, destParams, j);
+
+        // Pretend an earlier import got through the first half
+        auto const half = order.size () / 2;
+        ImportOptions options;
+        options.threads = 4;
+        options.verify = true;
+        options.checkpoint = (boost::filesystem::path (dest_db.path ()) /
+            "import.checkpoint").string ();
+        {
+            boost::filesystem::ofstream ofs (options.checkpoint);
+            ofs << src->getName () << "\n" << dest->getName () << "\n" << half;
+        }
+        dest->import (*src, options);
+        BEAST_EXPECT(! boost::filesystem::exists (options.checkpoint));
+
+        auto const valid = [](std::shared_ptr<NodeObject> const& object)
+        {
+            return sha512Half (makeSlice (object->getData ())) ==
+                object->getHash ();
+        };
+        int wrong = 0;
+        for (std::size_t i = 0; i < order.size (); ++i)
+        {
+            auto const fetched = dest->fetch (order[i]->getHash ());
+            bool const expected = i >= half && valid (order[i]);
+            if (expected != (fetched && isSame (fetched, order[i])))
+                ++wrong;
+        }
+        BEAST_EXPECT(wrong == 0);
+
+        // Without a checkpoint everything valid is copied. The
+        // database is opened again to forget the missing objects.
+        dest->import (*src, options);
+        dest.reset ();
+        dest = Manager::instance().make_Database (
+            "test", scheduler, 2, parent, destParams, j);
+        wrong = 0;
+        for (auto const& object : order)
+        {
+            auto const fetched = dest->fetch (object->getHash ());
+            if (valid (object) != (fetched && isSame (fetched, object)))
+                ++wrong;
+        }
+        BEAST_EXPECT(wrong == 0);
+    }
+
     //--------------------------------------------------------------------------
 
     void testNodeStore (std::string const& type,
@@ -160,6 +261,79 @@ public:
 
     //--------------------------------------------------------------------------
 
+    // A low priority read completes while high priority
+    // reads keep arriving
+    void testReadPriority (std::int64_t const seedValue)
+    {
+        testcase ("low priority reads under load");
+
+        DummyScheduler scheduler;
+        RootStoppable parent ("TestRootStoppable");
+        beast::temp_dir node_db;
+        Section nodeParams;
+        nodeParams.set ("type", "nudb");
+        nodeParams.set ("path", node_db.path());
+        beast::Journal j;
+
+        auto const batch = createPredictableBatch (20000, seedValue);
+        {
+            std::unique_ptr <Database> db = Manager::instance().make_Database (
+                "test", scheduler, 2, parent, nodeParams, j);
+            storeBatch (*db, batch);
+        }
+
+        // Reopen, so nothing is cached
+        std::unique_ptr <Database> db = Manager::instance().make_Database (
+            "test", scheduler, 2, parent, nodeParams, j);
+
+        auto const completed = [&db](FetchPriority priority)
+        {
+            auto const latency = db->getReadLatency (priority);
+            return std::accumulate (
+                latency.begin (), latency.end (), std::uint64_t (0));
+        };
+
+        // Read the last object at low priority in the middle of
+        // reading all the others at high priority
+        bool lowQueued = false;
+        std::thread flood ([&]
+        {
+            for (std::size_t i = 0; i + 1 < batch.size (); ++i)
+            {
+                std::shared_ptr <NodeObject> object;
+                db->asyncFetch (
+                    batch[i]->getHash (), object, FetchPriority::high);
+                if (i == 1000)
+                {
+                    lowQueued = ! db->asyncFetch (batch.back ()->getHash (),
+                        object, FetchPriority::low);
+                }
+            }
+        });
+
+        using namespace std::chrono;
+        auto const deadline = steady_clock::now () + seconds (10);
+        while (completed (FetchPriority::low) == 0 &&
+                steady_clock::now () < deadline)
+            std::this_thread::yield ();
+        auto const highReads = completed (FetchPriority::high);
+        std::shared_ptr <NodeObject> object;
+
+        // The low priority read did not wait for the high priority
+        // queue to drain
+        BEAST_EXPECT(completed (FetchPriority::low) == 1);
+        BEAST_EXPECT(highReads + 100 < batch.size () - 1);
+        db->waitReads (FetchPriority::low);
+        BEAST_EXPECT(db->asyncFetch (
+            batch.back ()->getHash (), object, FetchPriority::low));
+        BEAST_EXPECT(object && isSame (object, batch.back ()));
+
+        flood.join ();
+        BEAST_EXPECT(lowQueued);
+    }
+
+    //--------------------------------------------------------------------------
+
     void runBackendTests (std::int64_t const seedValue)
     {
         testNodeStore ("nudb", true, seedValue);
@@ -175,6 +349,8 @@ public:
     {
         testImport ("nudb", "nudb", seedValue);
 
+        testImportResume (seedValue);
+
     #if CASINOCOIN_ROCKSDB_AVAILABLE
         testImport ("rocksdb", "rocksdb", seedValue);
     #endif
@@ -192,6 +368,8 @@ public:
 
         testNodeStore ("memory", false, seedValue);
 
+        testReadPriority (seedValue);
+
         runBackendTests (seedValue);
 
         runImportTests (seedValue);
@@ -0,0 +1,203 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <BeastConfig.h>
+#include <test/nodestore/TestBase.h>
+#include <casinocoin/nodestore/DummyScheduler.h>
+#include <casinocoin/nodestore/Manager.h>
+#include <casinocoin/nodestore/impl/FilteredBackend.h>
+#include <casinocoin/beast/utility/temp_dir.h>
+#include <chrono>
+#include <thread>
+
+namespace casinocoin {
+namespace NodeStore {
+
+class FilteredBackend_test : public TestBase
+{
+    DummyScheduler scheduler_;
+
+    // How many objects of a batch the backend finds
+    static
+    int
+    countFound (Backend& backend, Batch const& batch)
+    {
+        int found = 0;
+        for (auto const& object : batch)
+        {
+            std::shared_ptr<NodeObject> fetched;
+            if (backend.fetch (object->getHash ().cbegin (), &fetched) == ok &&
+                    isSame (fetched, object))
+                ++found;
+        }
+        return found;
+    }
+
+    void
+    testFilter ()
+    {
+        testcase ("filter");
+
+        BloomFilter filter (1 << 16, 7);
+        auto const batch = createPredictableBatch (1000, 1);
+        auto const others = createPredictableBatch (1000, 2);
+        for (auto const& object : batch)
+            filter.insert (object->getHash ().cbegin ());
+
+        // No false negatives
+        bool all = true;
+        for (auto const& object : batch)
+            all = all && filter.mayContain (object->getHash ().cbegin ());
+        BEAST_EXPECT(all);
+
+        // About 1% false positives at 64 bits per key
+        int positives = 0;
+        for (auto const& object : others)
+            if (filter.mayContain (object->getHash ().cbegin ()))
+                ++positives;
+        BEAST_EXPECT(positives < 10);
+
+        // Saving and loading keeps the filter, but not for another size
+        beast::temp_dir dir;
+        auto const file = boost::filesystem::path (dir.path ()) / "bloom.dat";
+        BEAST_EXPECT(filter.save (file));
+        BloomFilter copy (1 << 16, 7);
+        BEAST_EXPECT(copy.load (file));
+        BEAST_EXPECT(copy.mayContain (batch[0]->getHash ().cbegin ()));
+        BloomFilter other (1 << 17, 7);
+        BEAST_EXPECT(! other.load (file));
+    }
+
+    void
+    testBackend ()
+    {
+        testcase ("backend");
+
+        beast::temp_dir dir;
+        auto const path = boost::filesystem::path (dir.path ()) / "db";
+        auto const file = path / "bloom.dat";
+        Section params;
+        params.set ("type", "nudb");
+        params.set ("path", path.string ());
+        params.set ("filter_mb", "1");
+        beast::Journal j;
+
+        auto const batch = createPredictableBatch (numObjectsToTest, 3);
+        auto const more = createPredictableBatch (numObjectsToTest, 4);
+
+        // Objects stored behind the filter's back are never found
+        // in a new backend, proving that the filter answered.
+        {
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler_, j);
+            storeBatch (*backend, batch);
+            BEAST_EXPECT(countFound (*backend, batch) == batch.size ());
+        }
+        BEAST_EXPECT(boost::filesystem::exists (file));
+        {
+            Section raw (params);
+            raw.set ("filter_mb", "0");
+            auto backend = Manager::instance().make_Backend (
+                raw, scheduler_, j);
+            storeBatch (*backend, more);
+        }
+
+        // The saved filter is loaded, and removed until the next close
+        {
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler_, j);
+            BEAST_EXPECT(! boost::filesystem::exists (file));
+            BEAST_EXPECT(countFound (*backend, batch) == batch.size ());
+            BEAST_EXPECT(countFound (*backend, more) < 10);
+        }
+
+        // Without a saved filter, as after a crash, it is rebuilt
+        // from the backend in the background. Meanwhile fetches
+        // go to the backend.
+        BEAST_EXPECT(boost::filesystem::remove (file));
+        auto backend = Manager::instance().make_Backend (
+            params, scheduler_, j);
+        BEAST_EXPECT(countFound (*backend, batch) == batch.size ());
+        BEAST_EXPECT(countFound (*backend, more) == more.size ());
+
+        auto const& filtered = dynamic_cast <FilteredBackend&> (*backend);
+        using namespace std::chrono;
+        auto const deadline = steady_clock::now () + seconds (10);
+        while (! filtered.filtering () && steady_clock::now () < deadline)
+            std::this_thread::sleep_for (milliseconds (1));
+        BEAST_EXPECT(filtered.filtering ());
+        BEAST_EXPECT(countFound (*backend, batch) == batch.size ());
+        BEAST_EXPECT(countFound (*backend, more) == more.size ());
+        backend->close ();
+        BEAST_EXPECT(boost::filesystem::exists (file));
+    }
+
+    void
+    testCloseWhileRebuilding ()
+    {
+        testcase ("close while rebuilding");
+
+        beast::temp_dir dir;
+        auto const path = boost::filesystem::path (dir.path ()) / "db";
+        auto const file = path / "bloom.dat";
+        Section params;
+        params.set ("type", "nudb");
+        params.set ("path", path.string ());
+        params.set ("filter_mb", "1");
+        beast::Journal j;
+
+        auto const batch = createPredictableBatch (numObjectsToTest, 5);
+        {
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler_, j);
+            storeBatch (*backend, batch);
+        }
+
+        // A filter which may not have been finished is never
+        // saved, so it is rebuilt again on the next open
+        for (int i = 0; i < 3; ++i)
+        {
+            boost::filesystem::remove (file);
+            auto backend = Manager::instance().make_Backend (
+                params, scheduler_, j);
+            bool const filtering =
+                dynamic_cast <FilteredBackend&> (*backend).filtering ();
+            backend->close ();
+            if (filtering)
+                BEAST_EXPECT(boost::filesystem::exists (file));
+        }
+
+        auto backend = Manager::instance().make_Backend (
+            params, scheduler_, j);
+        BEAST_EXPECT(countFound (*backend, batch) == batch.size ());
+    }
+
+public:
+    void
+    run () override
+    {
+        testFilter ();
+        testBackend ();
+        testCloseWhileRebuilding ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(FilteredBackend,NodeStore,ripple);
+
+}
+}
@@ -111,6 +111,68 @@ public:
         return batch;
     }
 
+    // Create a predictable batch of leaf nodes laid out like serialized
+    // account roots and payments, which compress like real ones do.
+    static
+    Batch createLedgerLikeBatch(
+        int numObjects, std::uint64_t seed)
+    {
+        Batch batch;
+        batch.reserve (numObjects);
+
+        beast::xor_shift_engine rng (seed);
+
+        // A field id followed by that many random bytes
+        auto field = [&rng](Blob& blob,
+            std::initializer_list<std::uint8_t> id, std::size_t bytes)
+        {
+            blob.insert (blob.end (), id);
+            auto const n = blob.size ();
+            blob.resize (n + bytes);
+            beast::rngfill (&blob[n], bytes, rng);
+        };
+
+        for (int i = 0; i < numObjects; ++i)
+        {
+            bool const tx = rand_int(rng, 1) == 0;
+            Blob blob;
+            if (tx)
+            {
+                blob = { 'S', 'N', 'D', 0, 0x12, 0x00, 0x00 };
+                field (blob, { 0x22, 0x80, 0x00, 0x00 }, 0);
+                field (blob, { 0x24, 0x00, 0x00 }, 2);
+                field (blob, { 0x61, 0x40, 0x00, 0x00 }, 5);
+                field (blob, { 0x68, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00 }, 1);
+                field (blob, { 0x73, 0x21, 0x02 }, 32);
+                field (blob, { 0x74, 0x47, 0x30, 0x45, 0x02, 0x21, 0x00 }, 32);
+                field (blob, { 0x02, 0x20 }, 32);
+                field (blob, { 0x81, 0x14 }, 20);
+                field (blob, { 0x83, 0x14 }, 20);
+            }
+            else
+            {
+                blob = { 'M', 'L', 'N', 0, 0x11, 0x00, 0x61 };
+                field (blob, { 0x22, 0x00, 0x00, 0x00, 0x00 }, 0);
+                field (blob, { 0x24, 0x00, 0x00 }, 2);
+                field (blob, { 0x25, 0x00 }, 3);
+                field (blob, { 0x2D, 0x00, 0x00, 0x00 }, 1);
+                field (blob, { 0x55 }, 32);
+                field (blob, { 0x62, 0x40, 0x00 }, 6);
+                field (blob, { 0x81, 0x14 }, 20);
+            }
+            uint256 hash;
+            beast::rngfill (hash.begin(), hash.size(), rng);
+            blob.insert (blob.end (), hash.begin (), hash.end ());
+
+            batch.push_back (
+                NodeObject::createObject(
+                    tx ? hotTRANSACTION_NODE : hotACCOUNT_NODE,
+                        std::move(blob), hash));
+        }
+
+        return batch;
+    }
+
     // Compare two batches for equality
     static bool areBatchesEqual (Batch const& lhs, Batch const& rhs)
     {
@@ -21,6 +21,10 @@
 #include <test/nodestore/TestBase.h>
 #include <casinocoin/nodestore/DummyScheduler.h>
 #include <casinocoin/nodestore/Manager.h>
+#include <casinocoin/nodestore/impl/EncodedBlob.h>
+#include <casinocoin/nodestore/impl/Tuning.h>
+#include <casinocoin/nodestore/impl/codec.h>
+#include <nudb/detail/buffer.hpp>
 #include <casinocoin/basics/BasicConfig.h>
 #include <casinocoin/unity/rocksdb.h>
 #include <casinocoin/beast/utility/temp_dir.h>
@@ -636,6 +640,76 @@ public:
 
     //--------------------------------------------------------------------------
 
+    // Compare the compression ratio and decoding speed of the
+    // node object codecs on objects shaped like ledger entries
+    void
+    do_codec ()
+    {
+        using std::setw;
+        auto const batch =
+            TestBase::createLedgerLikeBatch (default_items, 1);
+        beast::temp_dir tempDir;
+        DummyScheduler scheduler;
+        DictionaryCodec dictionaries (tempDir.path (), true,
+            dictionarySize, scheduler, beast::Journal{});
+
+        std::vector <Blob> encoded;
+        encoded.reserve (batch.size ());
+        std::size_t size = 0;
+        for (auto const& object : batch)
+        {
+            EncodedBlob e;
+            e.prepare (object);
+            auto const p = static_cast <std::uint8_t const*> (e.getData ());
+            encoded.emplace_back (p, p + e.getSize ());
+            size += e.getSize ();
+
+            // Train the dictionaries
+            nudb::detail::buffer bf;
+            nodeobject_compress (e.getData (), e.getSize (), bf,
+                &dictionaries);
+        }
+
+        log << "Codec, " << batch.size () << " objects" << std::endl;
+        log << std::left << setw(12) << "Codec" << std::right <<
+            setw(8) << "Ratio" << setw(10) << "Decode" << std::endl;
+        for (DictionaryCodec* codec : { static_cast <DictionaryCodec*> (nullptr),
+            &dictionaries })
+        {
+            std::vector <Blob> packed;
+            packed.reserve (encoded.size ());
+            std::size_t packedSize = 0;
+            for (auto const& e : encoded)
+            {
+                nudb::detail::buffer bf;
+                auto const result = nodeobject_compress (
+                    e.data (), e.size (), bf, codec);
+                auto const p = static_cast <std::uint8_t const*> (
+                    result.first);
+                packed.emplace_back (p, p + result.second);
+                packedSize += result.second;
+            }
+
+            auto const start = clock_type::now ();
+            for (auto i = default_repeat; i--;)
+            {
+                nudb::detail::buffer bf;
+                for (auto const& p : packed)
+                    nodeobject_decompress (p.data (), p.size (), bf, codec);
+            }
+            auto const elapsed = std::chrono::duration_cast <duration_type> (
+                clock_type::now () - start);
+
+            std::stringstream ss;
+            ss << std::left << setw(12) <<
+                (codec ? "dictionary" : "lz4") << std::right <<
+                std::fixed << std::setprecision(3) <<
+                setw(8) << (static_cast <double> (packedSize) / size) <<
+                setw(10) << to_string (elapsed);
+            log << ss.str () << std::endl;
+        }
+    }
+
     using test_func = void (Timing_test::*)(Section const&, Params const&);
     using test_list = std::vector <std::pair<std::string, test_func>>;
 
@@ -733,6 +807,8 @@ public:
             else
                 ++iter;
 
+        do_codec ();
+
         do_tests ( 1, tests, config_strings);
         do_tests ( 4, tests, config_strings);
         do_tests ( 8, tests, config_strings);
@@ -0,0 +1,147 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/protocol/SignatureCache.h>
+#include <casinocoin/protocol/PublicKey.h>
+#include <casinocoin/protocol/SecretKey.h>
+#include <casinocoin/protocol/digest.h>
+#include <casinocoin/beast/unit_test.h>
+#include <string>
+
+namespace casinocoin {
+
+class SignatureCache_test : public beast::unit_test::suite
+{
+    static
+    uint256
+    keyFor (int i)
+    {
+        auto const s = std::to_string (i);
+        return sha512Half (makeSlice (s));
+    }
+
+    void
+    testCache ()
+    {
+        testcase ("cache");
+
+        SignatureCache cache (64);
+        BEAST_EXPECT(! cache.contains (keyFor (0)));
+        cache.insert (keyFor (0));
+        BEAST_EXPECT(cache.contains (keyFor (0)));
+        BEAST_EXPECT(cache.getHitRate () == 50.0f);
+
+        // Old entries are dropped once the cache has been filled
+        // twice over, unless they are used.
+        for (int i = 1; i < 1000; ++i)
+        {
+            cache.insert (keyFor (i));
+            BEAST_EXPECT(cache.contains (keyFor (0)));
+        }
+        BEAST_EXPECT(cache.size () <= 2 * 64 + 2 * 16);
+        BEAST_EXPECT(! cache.contains (keyFor (1)));
+        BEAST_EXPECT(cache.contains (keyFor (999)));
+    }
+
+    void
+    testCapacity ()
+    {
+        testcase ("capacity");
+
+        SignatureCache cache (64);
+        cache.setCapacity (4096);
+        for (int i = 0; i < 1000; ++i)
+            cache.insert (keyFor (i));
+        BEAST_EXPECT(cache.size () == 1000);
+
+        // Shrinking takes effect as new entries arrive
+        cache.setCapacity (64);
+        for (int i = 1000; i < 2000; ++i)
+            cache.insert (keyFor (i));
+        BEAST_EXPECT(cache.size () <= 2 * 64 + 2 * 16);
+    }
+
+    void
+    testKeys ()
+    {
+        testcase ("keys");
+
+        auto const keys = randomKeyPair (KeyType::secp256k1);
+        auto const digest = sha512Half (makeSlice (std::string ("msg")));
+        auto const sig = signDigest (keys.first, keys.second, digest);
+
+        auto const key = SignatureCache::makeKey (
+            digest, keys.first, sig, true);
+        BEAST_EXPECT(key == SignatureCache::makeKey (
+            digest, keys.first, sig, true));
+        BEAST_EXPECT(key != SignatureCache::makeKey (
+            digest, keys.first, sig, false));
+        BEAST_EXPECT(key != SignatureCache::makeKey (
+            ~digest, keys.first, sig, true));
+        BEAST_EXPECT(key != SignatureCache::makeKey (digest,
+            randomKeyPair (KeyType::secp256k1).first, sig, true));
+    }
+
+    void
+    testVerify (KeyType type)
+    {
+        testcase (std::string ("verify ") + to_string (type));
+
+        auto& cache = SignatureCache::instance ();
+        auto const keys = randomKeyPair (type);
+        std::string const message = "a message to sign";
+        auto const sig = sign (keys.first, keys.second, makeSlice (message));
+
+        auto const key = SignatureCache::makeKey (
+            sha512Half (makeSlice (message)), keys.first, sig, true);
+        BEAST_EXPECT(! cache.contains (key));
+        BEAST_EXPECT(verify (keys.first, makeSlice (message), sig));
+        BEAST_EXPECT(cache.contains (key));
+        BEAST_EXPECT(verify (keys.first, makeSlice (message), sig));
+
+        // A bad signature is rejected every time and not remembered
+        Buffer bad (sig.data (), sig.size ());
+        bad.data ()[bad.size () / 2] ^= 0x01;
+        auto const badKey = SignatureCache::makeKey (
+            sha512Half (makeSlice (message)), keys.first, bad, true);
+        BEAST_EXPECT(! verify (keys.first, makeSlice (message), bad));
+        BEAST_EXPECT(! verify (keys.first, makeSlice (message), bad));
+        BEAST_EXPECT(! cache.contains (badKey));
+
+        // So is a good signature on a different message
+        std::string const other = "another message";
+        BEAST_EXPECT(! verify (keys.first, makeSlice (other), sig));
+    }
+
+public:
+    void
+    run () override
+    {
+        testCache ();
+        testCapacity ();
+        testKeys ();
+        testVerify (KeyType::secp256k1);
+        testVerify (KeyType::ed25519);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SignatureCache,protocol,ripple);
+
+}
@@ -0,0 +1,127 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/protocol/digest.h>
+#include <casinocoin/basics/Slice.h>
+#include <casinocoin/beast/unit_test.h>
+#include <vector>
+
+namespace casinocoin {
+
+class sha512Half_test : public beast::unit_test::suite
+{
+    // Messages of varying length with distinct contents
+    static
+    std::vector<Blob>
+    makeMessages (std::vector<std::size_t> const& sizes)
+    {
+        std::vector<Blob> messages;
+        for (auto const size : sizes)
+        {
+            Blob m (size);
+            for (std::size_t i = 0; i < size; ++i)
+                m[i] = static_cast<std::uint8_t> (
+                    i * 31 + size * 7 + messages.size ());
+            messages.push_back (std::move (m));
+        }
+        return messages;
+    }
+
+    bool
+    batchMatches (std::vector<Blob> const& messages)
+    {
+        std::vector<Slice> slices;
+        for (auto const& m : messages)
+            slices.push_back (makeSlice (m));
+        std::vector<uint256> digests (messages.size ());
+        sha512HalfBatch (slices.data (), digests.data (), slices.size ());
+
+        for (std::size_t i = 0; i < messages.size (); ++i)
+        {
+            if (digests[i] != sha512Half (slices[i]))
+                return false;
+        }
+        return true;
+    }
+
+    void
+    testKnownValue ()
+    {
+        testcase ("known value");
+
+        // The first half of SHA-512("abc")
+        uint256 expected;
+        BEAST_EXPECT(expected.SetHex (
+            "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"));
+
+        std::vector<Blob> messages (5, Blob {'a', 'b', 'c'});
+        std::vector<Slice> slices;
+        for (auto const& m : messages)
+            slices.push_back (makeSlice (m));
+        std::vector<uint256> digests (slices.size ());
+        sha512HalfBatch (slices.data (), digests.data (), slices.size ());
+        for (auto const& d : digests)
+            BEAST_EXPECT(d == expected);
+    }
+
+    void
+    testLengths ()
+    {
+        testcase ("message lengths");
+
+        // Every length up to and past where padding spills into
+        // a second block, hashed together.
+        std::vector<std::size_t> sizes;
+        for (std::size_t size = 0; size <= 300; ++size)
+            sizes.push_back (size);
+        BEAST_EXPECT(batchMatches (makeMessages (sizes)));
+
+        // The boundaries again, mixed with long messages
+        BEAST_EXPECT(batchMatches (makeMessages (
+            {111, 4000, 112, 127, 128, 1000, 239, 240, 0, 129})));
+    }
+
+    void
+    testCounts ()
+    {
+        testcase ("batch sizes");
+
+        for (std::size_t count : {0, 1, 2, 3, 4, 5, 8, 9, 17})
+        {
+            std::vector<std::size_t> sizes;
+            for (std::size_t i = 0; i < count; ++i)
+                sizes.push_back (65 + 37 * i);
+            BEAST_EXPECT(batchMatches (makeMessages (sizes)));
+        }
+    }
+
+public:
+    void
+    run () override
+    {
+        testKnownValue ();
+        testLengths ();
+        testCounts ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(sha512Half,protocol,ripple);
+
+}
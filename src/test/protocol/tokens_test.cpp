@@ -0,0 +1,319 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/protocol/AccountID.h>
+#include <casinocoin/protocol/digest.h>
+#include <casinocoin/protocol/tokens.h>
+#include <casinocoin/beast/utility/rngfill.h>
+#include <casinocoin/beast/xor_shift_engine.h>
+#include <casinocoin/beast/unit_test.h>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace casinocoin {
+
+namespace test {
+
+// The byte at a time base58 codec casinocoind used to have,
+// kept to check the current one against and to time it.
+struct ReferenceBase58
+{
+    static char const* alphabet ()
+    {
+        return "cpshnaf39wBUDNEGHJKLM4PQRST7VWXYZ2brdeCg65jkm8oFqi1tuvAxyz";
+    }
+
+    static
+    std::string
+    encode (std::uint8_t type, void const* token, std::size_t size)
+    {
+        std::vector<unsigned char> data (1 + size);
+        data[0] = type;
+        std::memcpy (data.data () + 1, token, size);
+        sha256_hasher h1;
+        h1 (data.data (), data.size ());
+        auto const d1 = static_cast<sha256_hasher::result_type>(h1);
+        sha256_hasher h2;
+        h2 (d1.data (), d1.size ());
+        auto const d2 = static_cast<sha256_hasher::result_type>(h2);
+        data.insert (data.end (), d2.data (), d2.data () + 4);
+
+        auto pbegin = data.begin ();
+        int zeroes = 0;
+        while (pbegin != data.end () && *pbegin == 0)
+        {
+            ++pbegin;
+            ++zeroes;
+        }
+        std::vector<unsigned char> b58 (data.size () * 138 / 100 + 1);
+        for (; pbegin != data.end (); ++pbegin)
+        {
+            int carry = *pbegin;
+            for (auto iter = b58.rbegin (); iter != b58.rend (); ++iter)
+            {
+                carry += 256 * *iter;
+                *iter = carry % 58;
+                carry /= 58;
+            }
+        }
+        auto iter = b58.begin ();
+        while (iter != b58.end () && *iter == 0)
+            ++iter;
+        std::string str (zeroes, alphabet ()[0]);
+        while (iter != b58.end ())
+            str += alphabet ()[*(iter++)];
+        return str;
+    }
+
+    // Decodes without checking the type or checksum
+    static
+    std::string
+    decode (std::string const& s)
+    {
+        auto const digit = [](char c)
+        {
+            auto const p = std::strchr (alphabet (), c);
+            return (c == 0 || p == nullptr) ? -1 : int (p - alphabet ());
+        };
+
+        auto psz = s.begin ();
+        int zeroes = 0;
+        while (psz != s.end () && digit (*psz) == 0)
+        {
+            ++zeroes;
+            ++psz;
+        }
+        std::vector<unsigned char> b256 ((s.end () - psz) * 733 / 1000 + 1);
+        for (; psz != s.end (); ++psz)
+        {
+            int carry = digit (*psz);
+            if (carry == -1)
+                return {};
+            for (auto iter = b256.rbegin (); iter != b256.rend (); ++iter)
+            {
+                carry += 58 * *iter;
+                *iter = carry % 256;
+                carry /= 256;
+            }
+        }
+        auto iter = b256.begin ();
+        while (iter != b256.end () && *iter == 0)
+            ++iter;
+        std::string result (zeroes, 0);
+        result.append (iter, b256.end ());
+        return result;
+    }
+};
+
+class tokens_test : public beast::unit_test::suite
+{
+    beast::xor_shift_engine g_ {20171024};
+
+    std::vector<std::uint8_t>
+    randomToken (std::size_t size, std::size_t zeroes = 0)
+    {
+        std::vector<std::uint8_t> token (size);
+        beast::rngfill (token.data (), token.size (), g_);
+        for (std::size_t i = 0; i < zeroes && i < size; ++i)
+            token[i] = 0;
+        return token;
+    }
+
+    void
+    testEncode ()
+    {
+        testcase ("encode");
+
+        for (std::size_t size : {0, 1, 4, 16, 20, 32, 33, 64, 100})
+        {
+            for (std::size_t zeroes : {0, 1, 3})
+            {
+                for (std::uint8_t type : {0, 33, 35})
+                {
+                    auto const token = randomToken (size, zeroes);
+                    BEAST_EXPECT(base58EncodeToken (
+                        type, token.data (), token.size ()) ==
+                            ReferenceBase58::encode (
+                                type, token.data (), token.size ()));
+                }
+            }
+        }
+    }
+
+    void
+    testDecode ()
+    {
+        testcase ("decode");
+
+        for (std::size_t size : {0, 1, 4, 16, 20, 32, 33, 64, 100})
+        {
+            for (std::size_t zeroes : {0, 1, 3})
+            {
+                for (std::uint8_t type : {0, 33, 35})
+                {
+                    auto const token = randomToken (size, zeroes);
+                    auto const s = ReferenceBase58::encode (
+                        type, token.data (), token.size ());
+                    auto const decoded = decodeBase58Token (s, type);
+                    BEAST_EXPECT(decoded == std::string (
+                        token.begin (), token.end ()));
+
+                    // The wrong type or a changed digit is rejected
+                    BEAST_EXPECT(decodeBase58Token (s, type + 1).empty ());
+                    auto bad = s;
+                    bad.back () = (bad.back () == 'c') ? 'p' : 'c';
+                    BEAST_EXPECT(decodeBase58Token (bad, type).empty ());
+                }
+            }
+        }
+
+        // Strings which aren't base58 at all
+        for (auto const& s : {std::string (), std::string ("0"),
+            std::string ("cccl"), std::string ("cO"),
+                std::string ("cp\0s", 4)})
+        {
+            BEAST_EXPECT(decodeBase58Token (s, 0).empty ());
+        }
+    }
+
+    void
+    testAccountIDCache ()
+    {
+        testcase ("AccountIDCache");
+
+        AccountIDCache cache (2);
+        std::vector<AccountID> ids;
+        for (int i = 0; i < 5; ++i)
+        {
+            auto const token = randomToken (20);
+            ids.push_back (AccountID::fromVoid (token.data ()));
+        }
+
+        // Run through the entries more times than the cache holds
+        for (int pass = 0; pass < 3; ++pass)
+        {
+            for (auto const& id : ids)
+            {
+                auto const s = cache.toBase58 (id);
+                BEAST_EXPECT(s == toBase58 (id));
+                auto const parsed = cache.fromBase58 (s);
+                BEAST_EXPECT(parsed && *parsed == id);
+            }
+        }
+
+        auto bad = toBase58 (ids.front ());
+        bad.back () = (bad.back () == 'c') ? 'p' : 'c';
+        BEAST_EXPECT(! cache.fromBase58 (bad));
+        BEAST_EXPECT(! cache.fromBase58 (""));
+    }
+
+public:
+    void
+    run () override
+    {
+        testEncode ();
+        testDecode ();
+        testAccountIDCache ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(tokens,protocol,ripple);
+
+//------------------------------------------------------------------------------
+
+class base58_benchmark_test : public beast::unit_test::suite
+{
+    template <class F>
+    void
+    measure (char const* name, std::size_t count, F&& f)
+    {
+        using namespace std::chrono;
+
+        auto const start = steady_clock::now ();
+        for (std::size_t i = 0; i < count; ++i)
+            f (i);
+        auto const elapsed = duration_cast<microseconds> (
+            steady_clock::now () - start);
+        auto const rate = count * 1000000.0 /
+            std::max<microseconds::rep> (elapsed.count (), 1);
+        log << "    " << name << ": " <<
+            static_cast<std::uint64_t> (rate) << " per second" << std::endl;
+    }
+
+    void
+    benchmark (std::size_t size, std::uint8_t type)
+    {
+        std::size_t const count = 200000;
+        beast::xor_shift_engine g (size);
+        std::vector<std::vector<std::uint8_t>> tokens (
+            1000, std::vector<std::uint8_t> (size));
+        std::vector<std::string> encoded;
+        for (auto& token : tokens)
+        {
+            beast::rngfill (token.data (), token.size (), g);
+            encoded.push_back (base58EncodeToken (
+                type, token.data (), token.size ()));
+        }
+
+        testcase (std::to_string (size) + " byte tokens");
+        measure ("reference encode", count, [&](std::size_t i)
+        {
+            auto const& t = tokens[i % tokens.size ()];
+            ReferenceBase58::encode (type, t.data (), t.size ());
+        });
+        measure ("encode", count, [&](std::size_t i)
+        {
+            auto const& t = tokens[i % tokens.size ()];
+            base58EncodeToken (type, t.data (), t.size ());
+        });
+        measure ("reference decode", count, [&](std::size_t i)
+        {
+            ReferenceBase58::decode (encoded[i % encoded.size ()]);
+        });
+        measure ("decode", count, [&](std::size_t i)
+        {
+            decodeBase58Token (encoded[i % encoded.size ()], type);
+        });
+
+        if (size == 20)
+        {
+            AccountIDCache cache (encoded.size ());
+            measure ("cached decode", count, [&](std::size_t i)
+            {
+                cache.fromBase58 (encoded[i % encoded.size ()]);
+            });
+        }
+        pass ();
+    }
+
+public:
+    void
+    run () override
+    {
+        benchmark (20, TOKEN_ACCOUNT_ID);
+        benchmark (33, TOKEN_ACCOUNT_PUBLIC);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(base58_benchmark,protocol,ripple);
+
+} // test
+} // casinocoin
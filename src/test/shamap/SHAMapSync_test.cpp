@@ -24,6 +24,9 @@
 #include <casinocoin/basics/random.h>
 #include <casinocoin/basics/StringUtilities.h>
 #include <casinocoin/beast/unit_test.h>
+#include <limits>
+#include <mutex>
+#include <set>
 
 namespace casinocoin {
 namespace tests {
@@ -82,13 +85,125 @@ public:
         return true;
     }
 
+    void testWalkMap (SHAMap::version v)
+    {
+        beast::Journal const j;
+        TestFamily f(j);
+
+        // Store a map without some of its leaves
+        uint256 hash;
+        std::set<uint256> removed;
+        {
+            SHAMap source (SHAMapType::STATE, f, v);
+            for (int i = 0; i < 2000; ++i)
+                source.addItem (std::move(*makeRandomAS ()), false, false);
+
+            NodeStore::Batch batch;
+            source.flushDirty (hotACCOUNT_NODE, 1, batch);
+            hash = source.getHash ().as_uint256();
+            for (auto const& object : batch)
+            {
+                if (removed.size () < 10 && object->getData ().size () < 512)
+                    removed.insert (object->getHash ());
+                else
+                    f.db().store (object->getType (),
+                        Blob (object->getData ()), object->getHash ());
+            }
+        }
+        f.treecache().clear ();
+        BEAST_EXPECT(removed.size () == 10);
+
+        auto const missing = [&](int maxMissing, int threads)
+        {
+            SHAMap map (SHAMapType::STATE, hash, f, v);
+            BEAST_EXPECT(map.fetchRoot (SHAMapHash{hash}, nullptr));
+            std::vector<SHAMapMissingNode> missingNodes;
+            map.walkMap (missingNodes, maxMissing, threads);
+            std::set<uint256> ret;
+            for (auto const& node : missingNodes)
+                ret.insert (node.getNodeHash ().as_uint256());
+            BEAST_EXPECT(ret.size () == missingNodes.size ());
+            return ret;
+        };
+
+        BEAST_EXPECT(missing (32, 1) == removed);
+        BEAST_EXPECT(missing (32, 4) == removed);
+        BEAST_EXPECT(missing (3, 1).size () == 3);
+        BEAST_EXPECT(missing (3, 4).size () == 3);
+    }
+
+    // Syncs a map parsing each reply's nodes together,
+    // the way InboundLedger does
+    void testBatchParse (SHAMap::version v)
+    {
+        beast::Journal const j;
+        TestFamily f(j), f2(j);
+        SHAMap source (SHAMapType::FREE, f, v);
+        SHAMap destination (SHAMapType::FREE, f2, v);
+
+        for (int i = 0; i < 2000; ++i)
+            source.addItem (std::move(*makeRandomAS ()), false, false);
+        BEAST_EXPECT(source.getHash ().isNonZero ());
+        source.setImmutable ();
+
+        destination.setSynching ();
+        {
+            std::vector<SHAMapNodeID> nodeIDs;
+            std::vector<Blob> nodes;
+            BEAST_EXPECT(source.getNodeFat (
+                SHAMapNodeID (), nodeIDs, nodes, false, 1));
+            if (! BEAST_EXPECT(! nodes.empty ()))
+                return;
+            BEAST_EXPECT(destination.addRootNode (source.getHash(),
+                makeSlice(nodes.front ()), snfWIRE, nullptr).isGood());
+        }
+
+        int rounds = 0;
+        while (true)
+        {
+            auto const nodesMissing =
+                destination.getMissingNodes (2048, nullptr);
+            if (nodesMissing.empty ())
+                break;
+            if (! BEAST_EXPECT(++rounds < 64))
+                return;
+
+            std::vector<SHAMapNodeID> nodeIDs;
+            std::vector<Blob> nodes;
+            for (auto const& missing : nodesMissing)
+            {
+                BEAST_EXPECT(source.getNodeFat (
+                    missing.first, nodeIDs, nodes, true, 1));
+            }
+
+            auto const parsed = SHAMapAbstractNode::make (
+                nodes, nodeIDs, 0, beast::Journal{});
+            if (! BEAST_EXPECT(parsed.size () == nodes.size ()))
+                return;
+            for (std::size_t i = 0; i < nodeIDs.size(); ++i)
+            {
+                BEAST_EXPECT(parsed[i]);
+                BEAST_EXPECT(destination.addKnownNode (
+                    nodeIDs[i], parsed[i], nullptr).isUseful ());
+            }
+        }
+        destination.clearSynching ();
+
+        BEAST_EXPECT(source.deepCompare (destination));
+        destination.invariants();
+    }
+
     void run()
     {
         log << "Run, version 1\n" << std::endl;
         run(SHAMap::version{1});
+        testWalkMap(SHAMap::version{1});
+        testBatchParse(SHAMap::version{1});
 
         log << "Run, version 2\n" << std::endl;
         run(SHAMap::version{2});
+        testWalkMap(SHAMap::version{2});
+        testBatchParse(SHAMap::version{2});
     }
 
     void run(SHAMap::version v)
@@ -123,6 +238,39 @@ public:
         source.walkMap(missingNodes, 2048);
         BEAST_EXPECT(missingNodes.empty());
 
+        // The parallel walk visits the same nodes as the serial one
+        {
+            auto const changed = source.snapShot (true);
+            for (int i = 0; i < 50; ++i)
+                changed->addItem (std::move(*makeRandomAS ()), false, false);
+            BEAST_EXPECT(changed->getHash () != source.getHash ());
+            changed->setImmutable ();
+
+            for (SHAMap const* have : {static_cast<SHAMap const*>(nullptr),
+                static_cast<SHAMap const*>(&source)})
+            {
+                std::set<uint256> serial;
+                changed->getFetchPack (have, true,
+                    std::numeric_limits<int>::max(),
+                    [&serial](SHAMapHash const& hash, Blob const&)
+                    {
+                        serial.insert (hash.as_uint256());
+                    });
+
+                std::mutex mutex;
+                std::set<uint256> parallel;
+                BEAST_EXPECT(changed->visitDifferences (have,
+                    [&](SHAMapAbstractNode& node)
+                    {
+                        std::lock_guard<std::mutex> lock (mutex);
+                        parallel.insert (node.getNodeHash().as_uint256());
+                        return true;
+                    }, 4));
+                BEAST_EXPECT(!serial.empty());
+                BEAST_EXPECT(serial == parallel);
+            }
+        }
+
         std::vector<SHAMapNodeID> nodeIDs, gotNodeIDs;
         std::vector< Blob > gotNodes;
         std::vector<uint256> hashes;
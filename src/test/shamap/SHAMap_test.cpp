@@ -318,6 +318,38 @@ public:
                 BEAST_EXPECT(k.key() == keys[h]);
                 --h;
             }
+
+            if (backed)
+                testcase ("flush to batch backed");
+            else
+                testcase ("flush to batch unbacked");
+
+            // Hashing shares the nodes, so flush before asking
+            SHAMap fmap{SHAMapType::FREE, tf, v};
+            if (! backed)
+                fmap.setUnbacked ();
+            for (auto const& k : keys)
+                fmap.addItem(SHAMapItem{k, IntToVUC(1)}, true, false);
+            NodeStore::Batch batch;
+            auto const flushed = fmap.flushDirty (hotACCOUNT_NODE, 1, batch);
+            auto const hash = fmap.getHash ().as_uint256();
+            if (backed)
+            {
+                BEAST_EXPECT(flushed > 0);
+                BEAST_EXPECT(batch.size () == flushed);
+                BEAST_EXPECT(batch.back ()->getHash () == hash);
+                BEAST_EXPECT(! tf.db().fetch (hash));
+                for (auto const& object : batch)
+                    tf.db().store (object->getType (),
+                        Blob (object->getData ()), object->getHash ());
+                BEAST_EXPECT(tf.db().fetch (hash));
+            }
+            else
+            {
+                BEAST_EXPECT(batch.empty ());
+            }
+            // Everything was flushed
+            BEAST_EXPECT(fmap.flushDirty (hotACCOUNT_NODE, 1, batch) == 0);
         }
     }
 };
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of casinocoind: https://github.com/casinocoin/casinocoind
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+
+#include <BeastConfig.h>
+#include <casinocoin/shamap/TreeNodeSnapshot.h>
+#include <test/shamap/common.h>
+#include <casinocoin/basics/random.h>
+#include <casinocoin/beast/unit_test.h>
+#include <casinocoin/beast/utility/temp_dir.h>
+#include <boost/filesystem/fstream.hpp>
+
+namespace casinocoin {
+namespace tests {
+
+class TreeNodeSnapshot_test : public beast::unit_test::suite
+{
+    static int const items = 500;
+
+    static
+    void
+    fill (SHAMap& map)
+    {
+        for (int i = 0; i < items; ++i)
+        {
+            Serializer s;
+            for (int d = 0; d < 3; ++d)
+                s.add32 (rand_int<std::uint32_t>());
+            map.addItem (SHAMapItem{s.getSHA512Half (), s.peekData ()},
+                false, false);
+        }
+        map.setImmutable ();
+    }
+
+    void
+    testRoundTrip (SHAMap::version v)
+    {
+        testcase ("round trip");
+
+        beast::temp_dir dir;
+        auto const path = boost::filesystem::path (dir.path ()) / "nodes.dat";
+
+        beast::Journal const j;
+        TestFamily f (j);
+        SHAMap source (SHAMapType::FREE, f, v);
+        fill (source);
+
+        int resident = 0;
+        source.visitResidentNodes (
+            [&resident](SHAMapAbstractNode&)
+            {
+                ++resident;
+                return false;
+            });
+        BEAST_EXPECT(resident > items);
+
+        saveTreeNodeSnapshot (path, source, 7, resident);
+
+        // The nodes come from the snapshot, since
+        // the second family's node store is empty.
+        TestFamily f2 (j);
+        auto const snapshot = loadTreeNodeSnapshot (path, f2, j);
+        BEAST_EXPECT(snapshot.seq == 7);
+        BEAST_EXPECT(snapshot.root == source.getHash ());
+        BEAST_EXPECT(snapshot.nodes.size () == resident);
+
+        SHAMap destination (SHAMapType::FREE, source.getHash ().as_uint256 (),
+            f2, v);
+        BEAST_EXPECT(destination.fetchRoot (source.getHash (), nullptr));
+        int count = 0;
+        destination.visitLeaves (
+            [&count](auto const&)
+            {
+                ++count;
+            });
+        BEAST_EXPECT(count == items);
+    }
+
+    void
+    testPartial ()
+    {
+        testcase ("partial snapshot");
+
+        beast::temp_dir dir;
+        auto const path = boost::filesystem::path (dir.path ()) / "nodes.dat";
+
+        beast::Journal const j;
+        TestFamily f (j);
+        SHAMap source (SHAMapType::FREE, f, SHAMap::version{1});
+        fill (source);
+
+        // Parents are written first, so a capped snapshot
+        // is still a valid top of the tree.
+        saveTreeNodeSnapshot (path, source, 7, 10);
+        TestFamily f2 (j);
+        auto const snapshot = loadTreeNodeSnapshot (path, f2, j);
+        BEAST_EXPECT(snapshot.nodes.size () == 10);
+        BEAST_EXPECT(snapshot.nodes.front ()->getNodeHash () ==
+            source.getHash ());
+    }
+
+    void
+    testCorrupt ()
+    {
+        testcase ("reject corrupt snapshot");
+
+        beast::temp_dir dir;
+        auto const path = boost::filesystem::path (dir.path ()) / "nodes.dat";
+
+        beast::Journal const j;
+        TestFamily f (j);
+
+        // Missing file
+        BEAST_EXPECT(loadTreeNodeSnapshot (path, f, j).nodes.empty ());
+
+        SHAMap source (SHAMapType::FREE, f, SHAMap::version{1});
+        fill (source);
+        saveTreeNodeSnapshot (path, source, 7, 1000000);
+        BEAST_EXPECT(! loadTreeNodeSnapshot (path, f, j).nodes.empty ());
+
+        // Damage one byte in the middle of the file
+        {
+            boost::filesystem::fstream fs (path,
+                std::ios::in | std::ios::out | std::ios::binary);
+            fs.seekp (boost::filesystem::file_size (path) / 2);
+            fs.put ('\xff');
+        }
+        BEAST_EXPECT(loadTreeNodeSnapshot (path, f, j).nodes.empty ());
+    }
+
+public:
+    void
+    run () override
+    {
+        testRoundTrip (SHAMap::version{1});
+        testRoundTrip (SHAMap::version{2});
+        testPartial ();
+        testCorrupt ();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(TreeNodeSnapshot,shamap,ripple);
+
+} // tests
+} // casinocoin
@@ -20,6 +20,7 @@
 
 #include <test/app/AccountTxPaging_test.cpp>
 #include <test/app/AmendmentTable_test.cpp>
+#include <test/app/CasinocoinLineCache_test.cpp>
 #include <test/app/CrossingLimits_test.cpp>
 #include <test/app/DeliverMin_test.cpp>
 #include <test/app/Discrepancy_test.cpp>
@@ -31,6 +32,8 @@
 #include <test/app/Manifest_test.cpp>
 #include <test/app/MultiSign_test.cpp>
 #include <test/app/OfferStream_test.cpp>
+#include <test/app/OpenLedger_test.cpp>
+#include <test/app/OrderBookDB_test.cpp>
 #include <test/app/Offer_test.cpp>
 #include <test/app/OversizeMeta_test.cpp>
 #include <test/app/Path_test.cpp>
@@ -49,4 +52,5 @@
 #include <test/app/ValidatorSite_test.cpp>
 #include <test/app/SetTrust_test.cpp>
 #include <test/app/Ticket_test.cpp>
+#include <test/app/Preflight_test.cpp>
 #include <test/app/PseudoTx_test.cpp>
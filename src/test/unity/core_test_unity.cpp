@@ -18,11 +18,15 @@
 */
 //==============================================================================
 
+#include <test/core/CheckBatcher_test.cpp>
 #include <test/core/Config_test.cpp>
 #include <test/core/Coroutine_test.cpp>
 #include <test/core/CryptoPRNG_test.cpp>
 #include <test/core/DeadlineTimer_test.cpp>
 #include <test/core/JobCounter_test.cpp>
+#include <test/core/JobQueue_test.cpp>
+#include <test/core/ParallelFor_test.cpp>
+#include <test/core/PerfLog_test.cpp>
 #include <test/core/SociDB_test.cpp>
 #include <test/core/Stoppable_test.cpp>
 #include <test/core/TerminateHandler_test.cpp>
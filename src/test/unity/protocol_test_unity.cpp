@@ -20,6 +20,7 @@
 
 #include <test/protocol/BuildInfo_test.cpp>
 #include <test/protocol/digest_test.cpp>
+#include <test/protocol/sha512Half_test.cpp>
 #include <test/protocol/InnerObjectFormats_test.cpp>
 #include <test/protocol/IOUAmount_test.cpp>
 #include <test/protocol/Issue_test.cpp>
@@ -27,10 +28,12 @@
 #include <test/protocol/Quality_test.cpp>
 #include <test/protocol/SecretKey_test.cpp>
 #include <test/protocol/Seed_test.cpp>
+#include <test/protocol/SignatureCache_test.cpp>
 #include <test/protocol/STAccount_test.cpp>
 #include <test/protocol/STAmount_test.cpp>
 #include <test/protocol/STObject_test.cpp>
 #include <test/protocol/STTx_test.cpp>
 #include <test/protocol/TER_test.cpp>
+#include <test/protocol/tokens_test.cpp>
 #include <test/protocol/types_test.cpp>
 #include <test/protocol/CSCAmount_test.cpp>
\ No newline at end of file